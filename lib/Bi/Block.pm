@@ -29,7 +29,7 @@ use strict;
 
 use Carp::Assert;
 use Bi::Action;
-use Bi::Utility qw(find);
+use Bi::Utility qw(find contains);
 
 use Bi::Model::Dim;
 use Bi::Model::Var;
@@ -38,6 +38,15 @@ use Bi::Model::Inline;
 
 our $_next_block_id = 0;
 
+# blocks that update particles element by element, and so may be fused
+our $FUSABLE_BLOCKS = [
+    'transition',
+    'observation',
+    'eval_',
+    'pdf_',
+    'wiener_'
+];
+
 =item B<new>
 
 Constructor.
@@ -665,6 +674,29 @@ sub is_block {
     return $self->_is_item($self->get_blocks, $name);
 }
 
+=item B<is_fusable>
+
+Can the block, and all of its sub-blocks, be evaluated one particle at a
+time, within an existing parallel region on host? Blocks that use matrix
+operations, or integrate differential equations, over all particles at
+once, cannot.
+
+=cut
+sub is_fusable {
+    my $self = shift;
+    my $name = $self->get_name;
+
+    if (!defined($name) || !contains($FUSABLE_BLOCKS, $name)) {
+        return 0;
+    }
+    foreach my $block (@{$self->get_blocks}) {
+        if (!$block->is_fusable) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 =item B<validate>
 
 Validate arguments.
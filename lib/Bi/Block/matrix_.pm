@@ -7,6 +7,13 @@ matrix_ - matrix expression block.
 This block behaves the same as L<eval_>, but is required to group matrix
 actions into separate blocks from scalar actions.
 
+Where possible (see L<is_batched>), the block is evaluated for all
+trajectories at once, rather than one trajectory at a time.
+
+=head1 METHODS
+
+=over 4
+
 =cut
 
 package Bi::Block::matrix_;
@@ -23,8 +30,60 @@ sub validate {
     $self->process_args($BLOCK_ARGS);
 }
 
+=item B<is_batched>
+
+Can the block be evaluated for all trajectories at once? This is the case
+when it contains only C<gemv_> and C<gemm_> actions, with no sub-blocks, and
+for each action the right operand and target are not common, and the target
+is not also an operand. Where the matrix operand is common, the action
+becomes a single matrix-matrix multiplication over all trajectories,
+otherwise a batch of small matrix multiplications, one per trajectory.
+
+=cut
+sub is_batched {
+    my $self = shift;
+
+    if (@{$self->get_blocks} > 0 || @{$self->get_actions} == 0) {
+        return 0;
+    }
+    foreach my $action (@{$self->get_actions}) {
+        my $name = $action->get_name;
+        my $A;
+        my $X;
+        my $Y = $action->get_left;
+
+        if ($name eq 'gemv_') {
+            $A = $action->get_named_arg('A');
+            $X = $action->get_named_arg('x');
+        } elsif ($name eq 'gemm_') {
+            $A = $action->get_named_arg('A');
+            $X = $action->get_named_arg('X');
+        } else {
+            return 0;
+        }
+        if (!$A->isa('Bi::Expression::VarIdentifier') ||
+                !$X->isa('Bi::Expression::VarIdentifier')) {
+            return 0;
+        }
+        if ($X->is_common || $Y->is_common) {
+            return 0;
+        }
+        foreach my $expr ($A, $X, $Y) {
+            if (@{$expr->get_indexes} != $expr->get_var->get_shape->get_count) {
+                return 0;
+            }
+        }
+        if ($Y->get_var == $A->get_var || $Y->get_var == $X->get_var) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 1;
 
+=back
+
 =head1 AUTHOR
 
 Lawrence Murray <lawrence.murray@csiro.au>
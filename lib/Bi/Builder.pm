@@ -49,7 +49,8 @@ C<--with-gdb> or C<--with-cuda-gdb> when debugging.
 
 =item C<--enable-diagnostics n> (default 0)
 
-Enable diagnostic output n to standard error.
+Enable diagnostic output n to standard error. For timings, use the
+C<--with-profile> option of client programs instead, which needs no rebuild.
 
 =item C<--enable-diagnostics2> (default off)
 
@@ -86,6 +87,22 @@ Enable SSE code.
 
 Enable AVX code.
 
+=item C<--enable-philox> (default off)
+
+Use the counter-based Philox4x32 pseudorandom number generator on host, in
+place of the Mersenne Twister. Variates for each particle are then a function
+of the seed, particle index and step only, so that results are reproducible
+regardless of the number of threads.
+
+=item C<--enable-aosoa> (default off)
+
+Integrate each group of particles in a tile with all of its variables
+contiguous in memory (an array of structures of arrays layout), rather than
+directly in the state, where each variable is strided by the number of
+particles. With C<--enable-sse> or C<--enable-avx>, groups are the width of
+a SIMD register. This keeps the working set of the ODE integrators in cache
+for models with many state variables.
+
 =item C<--enable-mpi> (default off)
 
 Enable MPI code.
@@ -150,6 +167,8 @@ sub new {
         _gpu_cache => 0,
         _sse => 0,
         _avx => 0,
+        _philox => 0,
+        _aosoa => 0,
         _mpi => 0,
         _vampir => 0,
         _single => 0,
@@ -181,6 +200,10 @@ sub new {
         'disable-sse' => sub { $self->{_sse} = 0 },
         'enable-avx' => sub { $self->{_avx} = 1 },
         'disable-avx' => sub { $self->{_avx} = 0 },
+        'enable-philox' => sub { $self->{_philox} = 1 },
+        'disable-philox' => sub { $self->{_philox} = 0 },
+        'enable-aosoa' => sub { $self->{_aosoa} = 1 },
+        'disable-aosoa' => sub { $self->{_aosoa} = 0 },
         'enable-mpi' => sub { $self->{_mpi} = 1 },
         'disable-mpi' => sub { $self->{_mpi} = 0 },
         'enable-vampir' => sub { $self->{_vampir} = 1 },
@@ -228,6 +251,8 @@ sub new {
     push(@builddir, 'gpucache') if $self->{_gpu_cache};
     push(@builddir, 'sse') if $self->{_sse};
     push(@builddir, 'avx') if $self->{_avx};
+    push(@builddir, 'philox') if $self->{_philox};
+    push(@builddir, 'aosoa') if $self->{_aosoa};
     push(@builddir, 'mpi') if $self->{_mpi};
     push(@builddir, 'vampir') if $self->{_vampir};
     push(@builddir, 'single') if $self->{_single};
@@ -350,6 +375,8 @@ sub _configure {
     $options .= $self->{_gpu_cache} ? ' --enable-gpucache' : ' --disable-gpucache';
     $options .= $self->{_sse} ? ' --enable-sse' : ' --disable-sse';
     $options .= $self->{_avx} ? ' --enable-avx' : ' --disable-avx';
+    $options .= $self->{_philox} ? ' --enable-philox' : ' --disable-philox';
+    $options .= $self->{_aosoa} ? ' --enable-aosoa' : ' --disable-aosoa';
     $options .= $self->{_mpi} ? ' --enable-mpi' : ' --disable-mpi';
     $options .= $self->{_vampir} ? ' --enable-vampir' : ' --disable-vampir';
     $options .= $self->{_single} ? ' --enable-single' : ' --disable-single';
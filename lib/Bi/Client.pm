@@ -29,6 +29,27 @@ Pseudorandom number generator seed.
 Run with C<N> threads. If zero, the number of threads used is the
 default for OpenMP on the platform.
 
+=item C<--with-work-stealing> (default off)
+
+Schedule particles across threads with work stealing, rather than in
+equal contiguous blocks. This helps when the cost of particles varies
+widely, as with adaptive step-size ODE integrators, or with data-dependent
+branches in the model. With C<--enable-philox>, random variates are tied to
+particles, and results do not depend on the schedule. Without it, they are
+tied to threads, and as the schedule varies from run to run, so do results,
+even with the same C<--seed>.
+
+=item C<--arena-limit> (default 1024)
+
+Maximum size, in megabytes, of the temporary host memory that each thread
+keeps for reuse, rather than returning it to the system.
+
+=item C<--with-arena-reset> (default off)
+
+Return the temporary host memory kept for reuse to the system at the end of
+each time step of the filter, so that memory use never exceeds that needed
+for one step, at the cost of allocating afresh at the start of the next.
+
 =item C<--with-gdb> (default off)
 
 Run within the C<gdb> debugger.
@@ -50,6 +71,26 @@ Run within C<cuda-memcheck>.
 Output file to use under C<--enable-gperftools>. The default is
 C<I<command>.prof>.
 
+=item C<--with-profile> (default off)
+
+Time the stages of the run (prediction, correction, resampling, gather of
+particles, output, waits on other processes, and so on) on each thread, and
+count the steps and rejected steps of ODE integrators, writing totals to
+C<--profile-file> at the end. This costs almost nothing when off, and needs
+no rebuild.
+
+=item C<--profile-file> (default C<profile.json>)
+
+File to which to write totals under C<--with-profile>, in JSON. Under MPI,
+the rank of the process is appended.
+
+=item C<--profile-trace-file> (default none)
+
+Under C<--with-profile>, also record each entry into each stage, and write
+these to this file in the trace event format, for viewing with Chrome
+(C<chrome://tracing>) and similar tools. Under MPI, the rank of the process is
+appended.
+
 =item C<--mpi-np>
 
 Number of processes under C<--enable-mpi>, corresponding to the C<-np>
@@ -137,6 +178,55 @@ Index along the C<ns> dimension of C<--obs-file> to use.
 
 Index along the C<np> dimension of C<--obs-file> to use.
 
+=item C<--input-cache> (default 0)
+
+Number of time points of C<--input-file> and C<--obs-file> to hold in memory.
+When nonzero, the contents of each file are decoded once into memory, in
+windows of this many time points, and repeated runs over the same schedule,
+as in each step of a marginal sampler, read from memory rather than the file.
+The next window is prefetched in the background: by C<filter> and
+C<optimise> always, and by C<sample> where its output writer thread is
+running (see C<--output-queue>), otherwise in the foreground. -1 holds the
+whole of each file in memory. 0 reads from file each time.
+
+=item C<--output-chunking> (default C<default>)
+
+Chunk layout of variables in C<--output-file>; one of:
+
+=over 8
+
+=item C<default>
+
+To leave chunk shapes to the NetCDF library.
+
+=item C<time>
+
+To chunk by time, with each chunk holding one time and as many trajectories
+as fit. This suits writing, which proceeds one time at a time.
+
+=item C<particle>
+
+To chunk by particle, with each chunk holding all times and as few
+trajectories as fit. This suits reading one trajectory at a time.
+
+=back
+
+=item C<--output-deflate> (default 0)
+
+Deflate level of variables in C<--output-file>, from 1 (fastest) to 9
+(smallest). 0 disables compression.
+
+=item C<--with-output-shuffle> (default off)
+
+Apply the shuffle filter to variables in C<--output-file> before deflating.
+This usually improves compression of floating point values.
+
+=item C<--output-cache> (default 0)
+
+Size, in bytes, of the NetCDF chunk cache kept for each variable of
+C<--output-file>. 0 uses the NetCDF library default. The cache should hold
+at least the chunks touched by one write for chunking to pay off.
+
 =back
 
 =head2 Model transformations
@@ -257,6 +347,31 @@ our @CLIENT_OPTIONS = (
       type => 'int',
       default => 0
     },
+    {
+      name => 'input-cache',
+      type => 'int',
+      default => 0
+    },
+    {
+      name => 'output-chunking',
+      type => 'string',
+      default => 'default'
+    },
+    {
+      name => 'output-deflate',
+      type => 'int',
+      default => 0
+    },
+    {
+      name => 'with-output-shuffle',
+      type => 'bool',
+      default => 0
+    },
+    {
+      name => 'output-cache',
+      type => 'int',
+      default => 0
+    },
     {
       name => 'seed',
       type => 'int',
@@ -267,11 +382,41 @@ our @CLIENT_OPTIONS = (
       type => 'int',
       default => 0
     },
+    {
+      name => 'with-work-stealing',
+      type => 'bool',
+      default => 0
+    },
+    {
+      name => 'arena-limit',
+      type => 'int',
+      default => 1024
+    },
+    {
+      name => 'with-arena-reset',
+      type => 'bool',
+      default => 0
+    },
     {
       name => 'gperftools-file',
       type => 'string',
       default => 'pprof.prof'
     },
+    {
+      name => 'with-profile',
+      type => 'bool',
+      default => 0
+    },
+    {
+      name => 'profile-file',
+      type => 'string',
+      default => 'profile.json'
+    },
+    {
+      name => 'profile-trace-file',
+      type => 'string',
+      default => ''
+    },
     {
       name => 'with-mpi',
       type => 'bool',
@@ -650,7 +795,15 @@ sub process_args {
     if (@ARGV) {
         die("unrecognised options '" . join(' ', @ARGV) . "'\n");
     }
-    
+
+    # check enumerated arguments, as the client program takes any other
+    # value as the default
+    my $chunking = $self->get_named_arg('output-chunking');
+    if (defined $chunking && $chunking !~ /^(default|time|particle)$/) {
+        die("unrecognised --output-chunking '$chunking', use one of " .
+            "'default', 'time' or 'particle'\n");
+    }
+
     # create output file directory if necessary
     my ($vol, $dir, $file) = File::Spec->splitpath($self->get_named_arg('output-file'));
     $dir = File::Spec->catpath($vol, $dir);
@@ -0,0 +1,81 @@
+=head1 NAME
+
+convert - convert a memory-mapped output file to NetCDF.
+
+=head1 SYNOPSIS
+
+    libbi sample --output-format mmap --output-file results.mmap ...
+    libbi convert --mmap-file results.mmap --output-file results.nc
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+The C<convert> command reads a file written with C<--output-format mmap>
+and writes a NetCDF file with the same variables, dimensions and schema
+as would have been written with C<--output-format netcdf>, for use with
+downstream tools. The C<--output-chunking>, C<--output-deflate>,
+C<--with-output-shuffle> and C<--output-cache> options apply to the NetCDF
+file.
+
+=cut
+
+package Bi::Client::convert;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--mmap-file>
+
+File to convert.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'mmap-file',
+      type => 'string',
+      default => ''
+    }
+);
+
+=head1 METHODS
+
+=over 4
+
+=cut
+
+sub init {
+    my $self = shift;
+
+    $self->{_binary} = 'convert';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+sub needs_transform {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
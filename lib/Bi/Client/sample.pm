@@ -111,10 +111,103 @@ If positive, C<--nmoves> and C<--sample-ess-rel> are ignored. Resampling is
 performed after each step, and the number of moves subsequently made becomes
 a random variable dependent on C<--tmoves>.
 
+=item C<--nparallel> (default 1)
+
+Number of parameter particles to propagate concurrently, each with its own
+particle filter running on its own group of threads. Use 0 to split threads
+between parameter and state particles automatically, giving each thread at
+least 256 state particles. Not supported with C<--filter adaptive> or
+C<--resampler rejection>, and ignored when C<--tmoves> is positive.
+
+=item C<--nchains> (default 1)
+
+Number of chains to run concurrently for C<--sampler mh>, each with its own
+particle filter running on its own group of threads, but sharing the inputs
+and observations. The C<--nsamples> samples are drawn in rounds of one per
+chain, and interleaved in the output file, so that sample I<i> belongs to
+chain I<i> modulo C<--nchains>. Not supported with C<--filter adaptive> or
+C<--resampler rejection>.
+
+=item C<--with-early-reject> (default 0)
+
+For C<--sampler mh>, draw the uniform variate of the acceptance test before
+running the filter on each proposal, and stop the filter as soon as the
+proposal can no longer be accepted, given the bound of
+C<--early-reject-bound>. The chain is the same as without early rejection,
+provided that the bound holds. Only supported with C<--filter bootstrap> or
+C<--filter kalman>: the other filters weight particles with bridge or
+lookahead densities that are divided out later, so that the log-likelihood
+so far is not a sum of increments within the bound.
+
+=item C<--early-reject-bound> (default 0.0)
+
+Upper bound on the log-likelihood increment of each observation, for
+C<--with-early-reject>. The default of zero holds for observations with a
+probability mass function, such as Poisson or binomial observations, but
+not in general for those with a density.
+
+=item C<--output-queue> (default 1)
+
+Number of filled pages of output that may wait to be written to the output
+file by a background thread while sampling continues. Each page is held in
+a buffer of its own, so that memory use grows with the depth of the queue.
+Use 0 to write synchronously.
+
+Only samples of the posterior (C<--target posterior>) are written in the
+background. Samples of the prior or joint distribution, and the output of
+other clients, are written synchronously, as they are produced.
+
+=item C<--output-backpressure> (default C<block>)
+
+What to do when the output queue is full; one of:
+
+=over 8
+
+=item C<block>
+
+To wait for the background thread to write the oldest page.
+
+=item C<sync>
+
+To write the page on the sampling thread.
+
+=back
+
+=item C<--output-format> (default C<netcdf>)
+
+Format of C<--output-file>; one of:
+
+=over 8
+
+=item C<netcdf>
+
+To write a NetCDF file.
+
+=item C<mmap>
+
+To write a flat binary file through a memory mapping, with space for all
+samples and times allocated up front. This avoids the overhead of the
+NetCDF library for very high output rates. Use the C<convert> command to
+convert the file to NetCDF afterward.
+
+=back
+
 =item C<--sample-resampler> (default C<systematic>)
 
 The type of resampler to use on parameter particles, see C<--resampler> for
-options.
+options. With C<--enable-mpi>, C<decentralised> may also be used: systematic
+resampling in which each process exchanges only the sum of its weights with
+the others, rather than gathering all weights to one process, and particles
+pass mostly between neighbouring processes. Without C<--enable-mpi> it is the
+same as C<systematic>.
+
+=item C<--with-sample-pipeline> (default 0)
+
+With C<--enable-mpi>, move parameter particles after resampling while those
+being passed between processes are still in transit, rather than waiting for
+all to arrive. Particles that stay on their process are moved first, then
+those arriving from each other process as they come in. Ignored when
+C<--tmoves> is positive, and with C<--sample-resampler decentralised>.
 
 =item C<--sample-ess-rel> (default 0.5)
 
@@ -208,11 +301,51 @@ our @CLIENT_OPTIONS = (
       type => 'float',
       default => 0.0
     },
+    {
+      name => 'nparallel',
+      type => 'int',
+      default => 1
+    },
+    {
+      name => 'nchains',
+      type => 'int',
+      default => 1
+    },
+    {
+      name => 'with-early-reject',
+      type => 'bool',
+      default => 0
+    },
+    {
+      name => 'early-reject-bound',
+      type => 'float',
+      default => 0.0
+    },
+    {
+      name => 'output-queue',
+      type => 'int',
+      default => 1
+    },
+    {
+      name => 'output-backpressure',
+      type => 'string',
+      default => 'block'
+    },
+    {
+      name => 'output-format',
+      type => 'string',
+      default => 'netcdf'
+    },
     {
       name => 'sample-resampler',
       type => 'string',
       default => 'systematic'
     },
+    {
+      name => 'with-sample-pipeline',
+      type => 'bool',
+      default => 0
+    },
     {
       name => 'sample-ess-rel',
       type => 'float',
@@ -282,6 +415,29 @@ sub process_args {
 	    	$self->set_named_arg('sampler', 'sir'); # standardise name
     	}
     }
+
+    # concurrent filters cannot share a resampler that holds state
+    if ($self->get_named_arg('nparallel') != 1 &&
+        ($filter eq 'adaptive' || $self->get_named_arg('resampler') eq 'rejection')) {
+        warn("--nparallel has been set to 1, unsupported with this filter or resampler\n");
+        $self->set_named_arg('nparallel', 1);
+    }
+    if ($self->get_named_arg('nchains') != 1 &&
+        ($filter eq 'adaptive' || $self->get_named_arg('resampler') eq 'rejection')) {
+        warn("--nchains has been set to 1, unsupported with this filter or resampler\n");
+        $self->set_named_arg('nchains', 1);
+    }
+    if ($self->get_named_arg('with-early-reject') &&
+        $filter ne 'bootstrap' && $filter ne 'kalman') {
+        warn("--with-early-reject has been set to 0, unsupported with this filter\n");
+        $self->set_named_arg('with-early-reject', 0);
+    }
+
+    my $backpressure = $self->get_named_arg('output-backpressure');
+    if (defined $backpressure && $backpressure !~ /^(block|sync)$/) {
+        die("unrecognised --output-backpressure '$backpressure', use one " .
+            "of 'block' or 'sync'\n");
+    }
     
     $self->{_binary} = 'sample';
 }
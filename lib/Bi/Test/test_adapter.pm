@@ -0,0 +1,77 @@
+=head1 NAME
+
+test_adapter - test the adaptation of Gaussian proposals.
+
+=head1 SYNOPSIS
+
+    libbi test_adapter --model-file Test.bi ...
+    libbi test_adapter @test_adapter.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Adapts a C<GaussianAdapter> to weighted samples of the parameters of the
+model, then:
+
+=over 4
+
+=item * changes a few samples, so that its statistics are updated
+incrementally, and checks its proposal against that of a new adapter,
+
+=item * collapses all samples onto one point, so that the covariance is not
+positive definite, and checks that the last proposal is kept, and
+
+=item * restores the samples, and checks that adaptation recovers.
+
+=back
+
+The program exits with a nonzero status if any check fails.
+
+=cut
+
+package Bi::Test::test_adapter;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 256)
+
+Number of samples.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 256
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_adapter';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
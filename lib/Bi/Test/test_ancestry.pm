@@ -0,0 +1,80 @@
+=head1 NAME
+
+test_ancestry - test reading of paths from the ancestry cache.
+
+=head1 SYNOPSIS
+
+    libbi test_ancestry --model-file Test.bi ...
+    libbi test_ancestry @test_ancestry.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Writes generations of particles to the ancestry cache, with ancestors drawn
+from a few parents only, so that lineages coalesce within a few generations,
+and interspersed with generations that are not resampled. After each
+generation, the paths of all particles, in shuffled order and with repeats,
+are read at once and checked against paths reconstructed from the full
+history of ancestors, one at a time. At the end, each path is also read
+alone and checked against the same. With C<--enable-cuda>, the checks are
+repeated with the cache on device, where each read after a write must
+refresh the copy of the ancestry on host. The program exits with a nonzero
+status if any check fails.
+
+=cut
+
+package Bi::Test::test_ancestry;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 256)
+
+Number of particles.
+
+=item C<--T> (default 64)
+
+Number of generations.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 256
+    },
+    {
+      name => 'T',
+      type => 'int',
+      default => 64
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_ancestry';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
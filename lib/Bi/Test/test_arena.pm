@@ -0,0 +1,101 @@
+=head1 NAME
+
+test_arena - time the churn of temporary allocations in a particle filter
+step under each allocator.
+
+=head1 SYNOPSIS
+
+    libbi test_arena ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Repeats the pattern of temporary vector and matrix allocations made by
+C<BootstrapPF::step> on host: weight, ancestry and offspring vectors of
+the number of particles in resampling, an observation matrix in
+correction, and per-thread stage vectors of the number of state variables
+in prediction. The pattern is timed with C<aligned_allocator>,
+C<pooled_allocator> and C<arena_allocator>, and the statistics of the arena
+reported. The program exits with a nonzero status if the arena serves no
+allocations from its free lists.
+
+=cut
+
+package Bi::Test::test_arena;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 1024)
+
+Number of particles.
+
+=item C<--N> (default 16)
+
+Number of state variables.
+
+=item C<--T> (default 1000)
+
+Number of time steps.
+
+=item C<--reset> (default 0)
+
+Use the reset mode of the arena, returning its free blocks to the system at
+the end of each time step.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 1024
+    },
+    {
+      name => 'N',
+      type => 'int',
+      default => 16
+    },
+    {
+      name => 'T',
+      type => 'int',
+      default => 1000
+    },
+    {
+      name => 'reset',
+      type => 'int',
+      default => 0
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_arena';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,93 @@
+=head1 NAME
+
+test_fused - test fused against unfused prediction and correction.
+
+=head1 SYNOPSIS
+
+    libbi test_fused --model-file TestFused.bi ...
+    libbi test_fused @test_fused.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Samples parameters and initial conditions from the model, and
+observations from a standard Gaussian, then from the same seed propagates
+the particles from time zero to C<--T> and weights them against the
+observations twice: once with the fused sampler, one particle at a time,
+as by the bootstrap particle filter, and once with the unfused updaters,
+one step at a time. Reports the log-likelihood of each and the maximum
+relative difference between log-weights. The program exits with a nonzero
+status if either difference exceeds C<--bound>, or if the model does not
+support fused updates.
+
+The two agree draw for draw only if the C<transition> block draws no
+random variates, as in C<TestFused.bi>; otherwise they agree only in
+distribution.
+
+=cut
+
+package Bi::Test::test_fused;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 1024)
+
+Number of particles.
+
+=item C<--T> (default 10.0)
+
+Time to which to propagate.
+
+=item C<--bound> (default 1.0e-4)
+
+Bound on the difference between fused and unfused results, relative to
+C<1 + |x|>, where C<x> is the unfused result.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 1024
+    },
+    {
+      name => 'T',
+      type => 'float',
+      default => 10.0
+    },
+    {
+      name => 'bound',
+      type => 'float',
+      default => 1.0e-4
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_fused';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,89 @@
+=head1 NAME
+
+test_gather - test and time the in-place gather of particles after
+resampling.
+
+=head1 SYNOPSIS
+
+    libbi test_gather ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Resamples a state matrix with a stratified resampler, and gathers its rows
+both with C<gather_rows>, as previously used by C<State::gather>, and with
+C<gather_rows_permuted>, checking that the latter matches an out-of-place
+gather and reporting the speed up. The program exits with a nonzero status
+on a mismatch.
+
+=cut
+
+package Bi::Test::test_gather;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--Ps> (default 5)
+
+Number of particle counts to use, the first 256 and each successive one
+four times the last.
+
+=item C<--N> (default 1000)
+
+Number of state variables.
+
+=item C<--reps> (default 10)
+
+Number of trials for each particle count.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'Ps',
+      type => 'int',
+      default => 5
+    },
+    {
+      name => 'N',
+      type => 'int',
+      default => 1000
+    },
+    {
+      name => 'reps',
+      type => 'int',
+      default => 10
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_gather';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,93 @@
+=head1 NAME
+
+test_gemm - time and check matrix actions evaluated over all trajectories.
+
+=head1 SYNOPSIS
+
+    libbi test_gemm ...
+    libbi test_gemm --trajectories 1000000 --N 50 ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Times the linear transition C<x <- A*x> of a linear-Gaussian model, with
+C<N> state variables, for 1e4 trajectories, then 1e5, and so on up to
+C<--trajectories>. Where the matrix is common to all trajectories, a
+C<gemv> per trajectory is compared to the single C<gemm> over all
+trajectories now used by batched C<matrix_> blocks. Where each trajectory
+has its own matrix, up to C<--matrices> trajectories, a C<gemv> per
+trajectory is compared to C<multi_gemv>. The speed up of each is reported.
+The program exits with a nonzero status if, for any size, the results
+differ by more than 1e-10 relative error (1e-4 with C<--enable-single>).
+
+=cut
+
+package Bi::Test::test_gemm;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--trajectories> (default 1000000)
+
+Largest number of trajectories.
+
+=item C<--matrices> (default 10000)
+
+Largest number of trajectories for which to also time a matrix per
+trajectory.
+
+=item C<--N> (default 50)
+
+Number of state variables.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'trajectories',
+      type => 'int',
+      default => 1000000
+    },
+    {
+      name => 'matrices',
+      type => 'int',
+      default => 10000
+    },
+    {
+      name => 'N',
+      type => 'int',
+      default => 50
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_gemm';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
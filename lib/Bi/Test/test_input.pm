@@ -0,0 +1,70 @@
+=head1 NAME
+
+test_input - test reads of input held in memory against reads from file.
+
+=head1 SYNOPSIS
+
+    libbi test_input --model-file TestInput.bi ...
+    libbi test_input @test_input.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Writes an input file for C<TestInput.bi>, with dense and sparse variables
+along differing record dimensions, then reads it through buffers with
+windows of several sizes (see C<--input-cache>), and through a buffer
+reading from file each time. The time indices are visited forward twice,
+backward, then in random order, so that windows are entered from either
+side and from afar, with the next window prefetched in the background.
+The file is written to C<--output-file>. The program exits with a nonzero
+status if any mask or value read through a window differs from that read
+from file.
+
+=cut
+
+package Bi::Test::test_input;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--K> (default 50)
+
+Number of records of the dense input.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'K',
+      type => 'int',
+      default => 50
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_input';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
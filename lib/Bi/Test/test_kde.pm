@@ -0,0 +1,93 @@
+=head1 NAME
+
+test_kde - time and check dual-tree kernel density estimates.
+
+=head1 SYNOPSIS
+
+    libbi test_kde ...
+    libbi test_kde --enable-avx ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Estimates the density of standard Gaussian samples at C<--queries> query
+points, with a Gaussian kernel of the bandwidth given by C<hopt>, using
+dual-tree evaluation over 1e5 target points, then 1e6, and so on up to
+C<--points>. Each is timed with the SIMD leaf kernel of
+C<FastGaussianKernel> and with the scalar leaf kernel used for other
+kernels, and the speed up reported. Use with C<--enable-sse> or
+C<--enable-avx> to enable the SIMD kernel. The program exits with a nonzero
+status if, for any size, either estimate differs from direct summation at
+some query point by more than 1e-10 relative error (1e-4 with
+C<--enable-single>).
+
+=cut
+
+package Bi::Test::test_kde;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--points> (default 10000000)
+
+Largest number of target points.
+
+=item C<--queries> (default 1000)
+
+Number of query points.
+
+=item C<--N> (default 3)
+
+Number of dimensions.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'points',
+      type => 'int',
+      default => 10000000
+    },
+    {
+      name => 'queries',
+      type => 'int',
+      default => 1000
+    },
+    {
+      name => 'N',
+      type => 'int',
+      default => 3
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_kde';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,71 @@
+=head1 NAME
+
+test_matrix - test matrix_ blocks evaluated over all trajectories.
+
+=head1 SYNOPSIS
+
+    libbi test_matrix --model-file TestMatrix.bi ...
+    libbi test_matrix @test_matrix.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Samples initial conditions from the model, then updates the state with the
+C<matrix_> block of its C<transition> block, which must be batched, and
+checks each C<gemv_> and C<gemm_> action of the block, for each trajectory,
+against a direct evaluation. With C<TestMatrix.bi>, each trajectory has its
+own matrix, so that the block uses C<multi_gemv> and C<multi_gemm> on the
+interleaved layout of the state. The block is updated three times: without
+a mask, with a dense mask, and with a sparse mask of every other element of
+each target, for which the other elements must be unchanged. The program
+exits with a nonzero status if any result differs by more than 1e-10
+relative error (1e-4 with C<--enable-single>).
+
+=cut
+
+package Bi::Test::test_matrix;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 1000)
+
+Number of trajectories.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 1000
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_matrix';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
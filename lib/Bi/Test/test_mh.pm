@@ -0,0 +1,121 @@
+=head1 NAME
+
+test_mh - test the marginal Metropolis-Hastings sampler.
+
+=head1 SYNOPSIS
+
+    libbi test_mh --model-file TestMH.bi ...
+    libbi test_mh @test_mh.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Samples the parameter of a model for which the particle filter computes the
+likelihood exactly, and the posterior is Gaussian, with several chains run
+together in one process, sharing the filter. It checks that:
+
+=over 4
+
+=item * each sample is output once, with the log-likelihood of its own
+parameter, so that chains have not written each other's states,
+
+=item * the chains start apart, and
+
+=item * the mean and variance of the samples of all chains together, after
+burn in, are close to those of the posterior.
+
+=back
+
+It then proposes from the states of a chain with two samplers, one rejecting
+proposals early, with the tightest bound on the log-likelihood increment of
+each observation, and one running the filter in full, and checks that, with
+generators seeded the same, each proposal is accepted or rejected the same by
+both, and that some are rejected early.
+
+The program exits with a nonzero status if any check fails.
+
+=cut
+
+package Bi::Test::test_mh;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--nobs> (default 10)
+
+Number of observations.
+
+=item C<--nparticles> (default 16)
+
+Number of particles in the filter.
+
+=item C<--nsamples> (default 4000)
+
+Number of samples to draw, over all chains.
+
+=item C<--nchains> (default 4)
+
+Number of chains.
+
+=item C<--ntrials> (default 200)
+
+Number of proposals with which to compare early rejection against the full
+filter.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'nobs',
+      type => 'int',
+      default => 10
+    },
+    {
+      name => 'nparticles',
+      type => 'int',
+      default => 16
+    },
+    {
+      name => 'nsamples',
+      type => 'int',
+      default => 4000
+    },
+    {
+      name => 'nchains',
+      type => 'int',
+      default => 4
+    },
+    {
+      name => 'ntrials',
+      type => 'int',
+      default => 200
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_mh';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,83 @@
+=head1 NAME
+
+test_mmap - test the memory-mapped output format and its conversion.
+
+=head1 SYNOPSIS
+
+    libbi test_mmap --model-file Test.bi ...
+    libbi test_mmap @test_mmap.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Writes the same output, of C<--P> samples at C<--T> times, with each of the
+Simulator, MCMC and SMC memory-mapped buffers and their NetCDF equivalents.
+Each memory-mapped file is checked for its magic number, version, byte
+order and schema, and for the alignment of each variable header and its
+data to 64 bytes. It is then converted to NetCDF, as by C<convert>, and
+each variable checked to have the same dimensions and values as in the
+memory-mapped file and in the file of the equivalent NetCDF buffer.
+Finally, copies of a file with a bad magic number, an unsupported version,
+the other byte order, or truncated, are checked to be rejected on opening.
+
+Files are written with names beginning with C<--output-file>, less any
+C<.nc> extension. The program exits with a nonzero status if any check
+fails.
+
+=cut
+
+package Bi::Test::test_mmap;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 16)
+
+Number of samples.
+
+=item C<--T> (default 8)
+
+Number of times.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 16
+    },
+    {
+      name => 'T',
+      type => 'int',
+      default => 8
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_mmap';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
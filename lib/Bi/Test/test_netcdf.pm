@@ -0,0 +1,91 @@
+=head1 NAME
+
+test_netcdf - time writing and reading of output under each chunk layout.
+
+=head1 SYNOPSIS
+
+    libbi test_netcdf ...
+    libbi test_netcdf --trajectories 100000 --times 1000 --output-deflate 1 ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Simulates the output pattern of C<sample>: a variable of C<--N> elements is
+written for all trajectories one time at a time, as by C<writeState>, then
+read back one trajectory at a time, as by a downstream analysis. This is
+timed under each of the chunk layouts of C<--output-chunking>, with the
+filters given by C<--output-deflate> and C<--with-output-shuffle> and the
+cache size given by C<--output-cache>, and the write and read throughput of
+each reported along with the size of the file. The program exits with a
+nonzero status if any value read differs from that written.
+
+=cut
+
+package Bi::Test::test_netcdf;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--trajectories> (default 10000)
+
+Number of trajectories.
+
+=item C<--times> (default 100)
+
+Number of times.
+
+=item C<--N> (default 4)
+
+Number of elements of the variable.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'trajectories',
+      type => 'int',
+      default => 10000
+    },
+    {
+      name => 'times',
+      type => 'int',
+      default => 100
+    },
+    {
+      name => 'N',
+      type => 'int',
+      default => 4
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_netcdf';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
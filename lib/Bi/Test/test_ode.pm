@@ -0,0 +1,93 @@
+=head1 NAME
+
+test_ode - test the SIMD integrators against the scalar integrators.
+
+=head1 SYNOPSIS
+
+    libbi test_ode --model-file TestODE.bi --enable-sse ...
+    libbi test_ode --model-file TestODE.bi --enable-avx ...
+    libbi test_ode @test_ode.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Samples parameters and initial conditions from the model, then integrates
+the first C<ode> block of its C<transition> block from time zero to C<--T>
+with each of the RK4, RK5(4) and RK4(3) integrators, once with the host
+(scalar) implementation and once with the SSE (SIMD) implementation, with
+the tolerances and initial step size given in the block. Reports the
+maximum difference between the two, relative to the tolerances, and the
+speed up. The program exits with a nonzero status if any difference
+exceeds C<--bound>. Must be built with C<--enable-sse> or C<--enable-avx>.
+
+Also reports, to full precision, the sum of the results of each
+implementation. These do not depend on C<--enable-aosoa>, which
+C<t/011_aosoa.t> checks by comparing them between builds.
+
+=cut
+
+package Bi::Test::test_ode;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 1024)
+
+Number of trajectories, rounded up to a multiple of the SIMD width.
+
+=item C<--T> (default 1.0)
+
+Time to which to integrate.
+
+=item C<--bound> (default 10.0)
+
+Bound on the difference between host and SIMD results, as a multiple of
+C<atoler + rtoler*|x|>.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 1024
+    },
+    {
+      name => 'T',
+      type => 'float',
+      default => 1.0
+    },
+    {
+      name => 'bound',
+      type => 'float',
+      default => 10.0
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_ode';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
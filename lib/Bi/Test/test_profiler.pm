@@ -0,0 +1,80 @@
+=head1 NAME
+
+test_profiler - test aggregation and cost of the profiler.
+
+=head1 SYNOPSIS
+
+    libbi test_profiler ...
+    libbi test_profiler --profile-file profile.json --profile-trace-file trace.json ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Reports the cost of a timed region and counter, with the profiler disabled
+and enabled (see C<--with-profile>), then enters nested regions on all
+threads for C<--steps> steps, and checks that the totals written to
+C<--profile-file> match the number of entries and counts. Events are written
+to C<--profile-trace-file>, or C<test_profiler.trace.json> if not given. The
+program exits with a nonzero status if any total differs.
+
+=cut
+
+package Bi::Test::test_profiler;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--iterations> (default 10000000)
+
+Number of iterations over which to time regions and counters.
+
+=item C<--steps> (default 10)
+
+Number of steps of nested regions.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'iterations',
+      type => 'int',
+      default => 10000000
+    },
+    {
+      name => 'steps',
+      type => 'int',
+      default => 10
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_profiler';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
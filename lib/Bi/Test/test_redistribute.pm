@@ -0,0 +1,75 @@
+=head1 NAME
+
+test_redistribute - test the redistribution of particles between processes.
+
+=head1 SYNOPSIS
+
+    libbi test_redistribute --model-file Test.bi --enable-mpi --mpi-np 4 ...
+    libbi test_redistribute @test_redistribute.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Resamples particles across processes with C<DistributedResampler>, once
+blocking and once pipelined, and with C<DecentralisedResampler>, with weights
+that increase with rank so that most particles move between processes. Each
+particle is tagged with an id, held by both its state, sent as one message
+per pair of processes, and its output, sent as one message per particle. The
+particles given by the resampler to propagate are checked: each exactly once,
+with its state and output together, and, across all processes, offspring of
+the weights: the number of offspring of each particle within one of its
+expected number, as for systematic resampling, and, for
+C<DistributedResampler>, exactly those of C<SystematicResampler> on the
+weights of all processes together. The program exits with a nonzero status if
+any check fails.
+
+Must be run with C<--enable-mpi> and more than one process.
+
+=cut
+
+package Bi::Test::test_redistribute;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 64)
+
+Number of particles in each process.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 64
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_redistribute';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -73,6 +73,12 @@ resampling on CPU when copying weight vectors from GPU.
 
 Divisor under the default number of steps in the Metropolis resampler.
 
+=item C<--bench> (default off)
+
+Only time resampling, over C<--Ps> decades of particle counts from 1e3
+(C<--Ps 6> reaches 1e8), reporting the mean time and throughput of each. Nothing
+is written to the output file.
+
 =back
 
 =cut
@@ -116,6 +122,11 @@ our @CLIENT_OPTIONS = (
       name => 'C',
       type => 'int',
       default => 1
+    },
+    {
+      name => 'bench',
+      type => 'bool',
+      default => 0
     }
 );
 
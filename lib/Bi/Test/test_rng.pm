@@ -0,0 +1,68 @@
+=head1 NAME
+
+test_rng - test the random number generator.
+
+=head1 SYNOPSIS
+
+    libbi test_rng --model-file Test.bi ...
+    libbi test_rng @test_rng.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Checks the Philox4x32-10 generator against the known-answer vectors of
+Random123, then samples parameters, initial conditions and one transition
+of the model, and selects ancestors with the multinomial and stratified
+resamplers, once with one thread and once with C<--nthreads> threads, from
+the same seed. With C<--enable-philox>, the two must agree exactly;
+otherwise, and with fewer than two threads, the comparison is skipped. The
+program exits with a nonzero status if either check fails.
+
+=cut
+
+package Bi::Test::test_rng;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 1024)
+
+Number of particles.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 1024
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_rng';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,90 @@
+=head1 NAME
+
+test_scheduler - test the particle scheduler.
+
+=head1 SYNOPSIS
+
+    libbi test_scheduler ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Hands out particles to threads with the particle scheduler, with and without
+work stealing, and checks that each particle is handed out exactly once. Uses
+a range of particle counts, including none and fewer than the number of
+threads, uneven costs per particle, so that threads steal at different
+times, and teams of fewer threads than the scheduler was constructed for.
+The program exits with a nonzero status if any particle is missed or
+repeated.
+
+=cut
+
+package Bi::Test::test_scheduler;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 100000)
+
+Largest number of particles.
+
+=item C<--cost> (default 100)
+
+Units of busy work for each particle, a hundred times that for a few
+particles.
+
+=item C<--reps> (default 10)
+
+Number of trials for each particle count and team size.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 100000
+    },
+    {
+      name => 'cost',
+      type => 'int',
+      default => 100
+    },
+    {
+      name => 'reps',
+      type => 'int',
+      default => 10
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_scheduler';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
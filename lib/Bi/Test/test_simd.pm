@@ -0,0 +1,72 @@
+=head1 NAME
+
+test_simd - test vectorised math functions.
+
+=head1 SYNOPSIS
+
+    libbi test_simd --enable-sse ...
+    libbi test_simd --enable-avx ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Compares the vectorised C<exp>, C<log>, C<expm1>, C<log1p>, C<pow>,
+C<lgamma> and C<erf> of the SIMD types against the scalar (libm) versions,
+reporting the maximum error in ulp on each and the speed up. C<lgamma>, and
+C<pow> with several negative, non-integer exponents, are also evaluated at
+the arguments at which their errors have been greatest. The
+program exits with a nonzero status if any error exceeds its documented
+bound. Use with C<--enable-single> to test the single-precision types.
+
+=cut
+
+package Bi::Test::test_simd;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--reps> (default 1000000)
+
+Number of random arguments on which to test each function.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'reps',
+      type => 'int',
+      default => 1000000
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_simd';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,107 @@
+=head1 NAME
+
+test_sir - test concurrent propagation in the marginal SIR sampler.
+
+=head1 SYNOPSIS
+
+    libbi test_sir --model-file TestMH.bi ...
+    libbi test_sir @test_sir.conf
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Samples the parameter of a model for which the particle filter computes the
+likelihood exactly, and the posterior is Gaussian, with SMC^2, once
+propagating the parameter particles one at a time, and once C<--nparallel>
+at a time. It checks that:
+
+=over 4
+
+=item * the weighted mean and variance of the samples of each run are close
+to those of the posterior, and,
+
+=item * with C<--enable-philox> and C<--enable-openmp>, from the same seed,
+the run with one thread, one parameter particle at a time, and the run with
+C<--nparallel> threads, one parameter particle on each, give exactly the
+same samples and weights.
+
+=back
+
+The second check is skipped with fewer than two threads. The program exits
+with a nonzero status if any check fails.
+
+=cut
+
+package Bi::Test::test_sir;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--nobs> (default 10)
+
+Number of observations.
+
+=item C<--nparticles> (default 16)
+
+Number of particles in the filter.
+
+=item C<--nsamples> (default 1024)
+
+Number of parameter particles.
+
+=item C<--nparallel> (default 4)
+
+Number of parameter particles to propagate concurrently.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'nobs',
+      type => 'int',
+      default => 10
+    },
+    {
+      name => 'nparticles',
+      type => 'int',
+      default => 16
+    },
+    {
+      name => 'nsamples',
+      type => 'int',
+      default => 1024
+    },
+    {
+      name => 'nparallel',
+      type => 'int',
+      default => 4
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_sir';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
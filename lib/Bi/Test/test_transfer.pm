@@ -0,0 +1,100 @@
+=head1 NAME
+
+test_transfer - time the transfer of particles between processes.
+
+=head1 SYNOPSIS
+
+    libbi test_transfer --enable-mpi --mpi-np 8 ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Simulates the redistribution of particles by C<DistributedResampler>: each
+process in the lower half of ranks sends particles, each a matrix, to its
+partner in the upper half. This is timed first with one Boost.MPI message per
+particle, then with all particles packed by C<flat_oarchive> into one
+message, and the throughput of each reported in particles per second. The
+program exits with a nonzero status if the particles received differ.
+
+Must be run with C<--enable-mpi> and an even number of processes, e.g.
+C<--mpi-np 8> on a single host.
+
+=cut
+
+package Bi::Test::test_transfer;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--P> (default 1024)
+
+Number of particles sent by each process.
+
+=item C<--rows> (default 256)
+
+Number of rows in the matrix of each particle.
+
+=item C<--cols> (default 8)
+
+Number of columns in the matrix of each particle.
+
+=item C<--reps> (default 10)
+
+Number of repetitions of each transfer.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'P',
+      type => 'int',
+      default => 1024
+    },
+    {
+      name => 'rows',
+      type => 'int',
+      default => 256
+    },
+    {
+      name => 'cols',
+      type => 'int',
+      default => 8
+    },
+    {
+      name => 'reps',
+      type => 'int',
+      default => 10
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_transfer';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,108 @@
+=head1 NAME
+
+test_writer - time the output of samples with and without the background
+writer.
+
+=head1 SYNOPSIS
+
+    libbi test_writer ...
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=head1 DESCRIPTION
+
+Simulates the output pattern of C<sample>: samples of a number of
+parameters are computed, with a given amount of arithmetic per sample, into
+a page of a cache, which is written to C<--output-file> when full. This is
+timed first with each page written synchronously, then with pages written
+by C<AsyncWriter> from double buffers, and the throughput of each reported
+in samples per second. The program exits with a nonzero status if the
+files written differ.
+
+=cut
+
+package Bi::Test::test_writer;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--samples> (default 1000000)
+
+Number of samples.
+
+=item C<--N> (default 16)
+
+Number of parameters per sample.
+
+=item C<--work> (default 64)
+
+Number of arithmetic iterations per parameter of each sample.
+
+=item C<--page> (default 4096)
+
+Number of samples per page.
+
+=item C<--output-queue> (default 1)
+
+Queue depth of the background writer.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'samples',
+      type => 'int',
+      default => 1000000
+    },
+    {
+      name => 'N',
+      type => 'int',
+      default => 16
+    },
+    {
+      name => 'work',
+      type => 'int',
+      default => 64
+    },
+    {
+      name => 'page',
+      type => 'int',
+      default => 4096
+    },
+    {
+      name => 'output-queue',
+      type => 'int',
+      default => 1
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_writer';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
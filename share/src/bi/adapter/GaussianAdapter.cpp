@@ -7,6 +7,7 @@
 
 bi::GaussianAdapter::GaussianAdapter(const bool local, const double scale,
     const double essRel) :
-    local(local), scale(scale), essRel(essRel) {
+    W(0.0), lw0(0.0), haveStats(false), haveCentre(false),
+    haveProposal(false), local(local), scale(scale), essRel(essRel) {
   //
 }
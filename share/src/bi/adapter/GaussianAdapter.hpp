@@ -13,11 +13,34 @@
 #include "../math/vector.hpp"
 #include "../math/matrix.hpp"
 
+#include <vector>
+
 namespace bi {
 /**
  * Adapter for Gaussian proposal.
  *
  * @ingroup method_adapter
+ *
+ * The adapter keeps weighted sufficient statistics of the samples about a
+ * centre \f$\mathbf{c}\f$: the sum of weights \f$W = \sum_p w_p\f$, the
+ * sum of deviations \f$\mathbf{s} = \sum_p w_p(\mathbf{x}_p -
+ * \mathbf{c})\f$, and the upper-triangular Cholesky factor \f$R\f$ of
+ * \f$\sum_p w_p(\mathbf{x}_p - \mathbf{c})(\mathbf{x}_p -
+ * \mathbf{c})^\top\f$. Weights are kept relative to a reference
+ * log-weight, so that they neither overflow nor underflow.
+ *
+ * On each adaptation, samples and log-weights that have changed since the
+ * last are found, and the statistics updated with one rank-one Cholesky
+ * update for each new sample and one downdate for each old, so that the
+ * cost of the factorisation is \f$O(kN^2)\f$ for \f$k\f$ changed samples
+ * of dimension \f$N\f$, rather than \f$O(PN^2 + N^3)\f$. Where more than
+ * half of the samples have changed, as after resampling, or a downdate
+ * fails, the statistics are recomputed from scratch instead. The
+ * distributed variant all-reduces only the statistics, not the samples.
+ *
+ * Where the statistics do not give a positive definite covariance, as when
+ * samples have collapsed onto one another or include non-finite values, the
+ * proposal of the last successful adaptation is kept.
  */
 class GaussianAdapter {
 public:
@@ -37,12 +60,24 @@ public:
    *
    * @param s State.
    *
-   * @return Was the adaptation successful?
+   * @return Is a proposal ready? False if the ESS is too low, or no
+   * adaptation has yet succeeded.
    */
   template<class S1>
   bool adapt(const S1& s);
 
 #ifdef ENABLE_MPI
+  /**
+   * Adapt the proposal, with samples distributed across processes.
+   *
+   * @param s State.
+   *
+   * @return Is a proposal ready? As for adapt().
+   *
+   * All processes must call this together. The local statistics of each
+   * process share a common centre, that of the proposal last adapted, so
+   * that they may be summed with a single all-reduce.
+   */
   template<class S1>
   bool distributedAdapt(const S1& s);
 #endif
@@ -64,17 +99,110 @@ public:
 
 private:
   /**
-   * Mean.
+   * Read samples and log-weights, and find those that have changed since
+   * the last adaptation.
+   *
+   * @tparam S1 State type.
+   * @tparam M1 Matrix type.
+   * @tparam V1 Vector type.
+   *
+   * @param s State.
+   * @param[out] X1 Samples, one per row.
+   * @param[out] lws1 Log-weights.
+   * @param[out] ps Indices of changed samples, empty if the statistics
+   * cannot be updated incrementally.
    */
-  host_vector<real> mu;
+  template<class S1, class M1, class V1>
+  void collect(const S1& s, M1 X1, V1 lws1, std::vector<int>& ps);
+
+  /**
+   * Recompute statistics from scratch, about the current centre.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam V1 Vector type.
+   * @tparam M2 Matrix type.
+   *
+   * @param X1 Samples, one per row.
+   * @param lws1 Log-weights.
+   * @param lw Reference log-weight.
+   * @param[out] M Weighted sum of outer products of deviations from the
+   * centre, in the upper triangle.
+   *
+   * The samples and log-weights are kept for the next adaptation. If the
+   * Cholesky factorisation of @p M fails, the statistics are marked
+   * invalid, but @p M, #W and #S1 remain correct.
+   */
+  template<class M1, class V1, class M2>
+  void recompute(const M1 X1, const V1 lws1, const double lw, M2 M);
+
+  /**
+   * Update statistics incrementally.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam V1 Vector type.
+   *
+   * @param X1 Samples, one per row.
+   * @param lws1 Log-weights.
+   * @param lw Reference log-weight.
+   * @param ps Indices of changed samples.
+   */
+  template<class M1, class V1>
+  void change(const M1 X1, const V1 lws1, const double lw,
+      const std::vector<int>& ps) throw (CholeskyException);
+
+  /**
+   * Add sample to, or remove sample from, statistics.
+   *
+   * @tparam V1 Vector type.
+   *
+   * @param x Sample.
+   * @param w Weight, negative to remove.
+   */
+  template<class V1>
+  void update(const V1 x, const double w) throw (CholeskyException);
+
+  /**
+   * Move the centre of statistics.
+   *
+   * @tparam V1 Vector type.
+   * @tparam M1 Matrix type.
+   * @tparam V2 Vector type.
+   *
+   * @param W Sum of weights.
+   * @param[in,out] S Weighted sum of deviations from the centre.
+   * @param[in,out] R Upper-triangular Cholesky factor of the weighted sum
+   * of outer products of deviations from the centre.
+   * @param e Old centre minus new centre.
+   */
+  template<class V1, class M1, class V2>
+  static void recentre(const double W, V1 S, M1 R, const V2 e)
+      throw (CholeskyException);
 
   /**
-   * Covariance.
+   * Create the proposal from statistics centred on the mean.
+   *
+   * @tparam V1 Vector type.
+   * @tparam M1 Matrix type.
+   *
+   * @param mu Mean.
+   * @param W Sum of weights.
+   * @param R Upper-triangular Cholesky factor of the weighted sum of outer
+   * products of deviations from the mean.
+   *
+   * Throws CholeskyException, leaving the last proposal in place, if the
+   * factor is singular or not finite.
    */
-  host_matrix<real> Sigma;
+  template<class V1, class M1>
+  void factor(const V1 mu, const double W, const M1 R)
+      throw (CholeskyException);
 
   /**
-   * Upper-triangular Cholesky factor of #Sigma.
+   * Mean.
+   */
+  host_vector<real> mu;
+
+  /**
+   * Upper-triangular Cholesky factor of covariance.
    */
   host_matrix<real> U;
 
@@ -83,6 +211,57 @@ private:
    */
   real detU;
 
+  /**
+   * Centre of statistics.
+   */
+  host_vector<real> c;
+
+  /**
+   * Weighted sum of deviations of samples from #c.
+   */
+  host_vector<real> S1;
+
+  /**
+   * Upper-triangular Cholesky factor of weighted sum of outer products of
+   * deviations of samples from #c.
+   */
+  host_matrix<real> R;
+
+  /**
+   * Sum of weights.
+   */
+  double W;
+
+  /**
+   * Reference log-weight, weights being relative to this.
+   */
+  double lw0;
+
+  /**
+   * Samples at last adaptation, one per row.
+   */
+  host_matrix<real> X;
+
+  /**
+   * Log-weights at last adaptation.
+   */
+  host_vector<real> lws;
+
+  /**
+   * Are #S1, #R and #W valid for #X and #lws?
+   */
+  bool haveStats;
+
+  /**
+   * Has #c been set?
+   */
+  bool haveCentre;
+
+  /**
+   * Have #mu, #U and #detU been set?
+   */
+  bool haveProposal;
+
   /**
    * Local proposal?
    */
@@ -119,38 +298,45 @@ bool bi::GaussianAdapter::adapt(const S1& s) {
 
   bool ready = s.ess >= essRel * P;
   if (ready) {
-    try {
-      typename temp_host_matrix<real>::type X(P, NP);
-      typename temp_host_vector<real>::type ws(P);
+    typename temp_host_matrix<real>::type X1(P, NP), M(NP, NP);
+    typename temp_host_vector<real>::type lws1(P), ws(P), d(NP);
+    std::vector<int> ps;
+
+    /* update statistics where few samples have changed */
+    collect(s, X1, lws1, ps);
+    const double lw = max_reduce(lws1);
+    if (haveStats && 2 * (int)ps.size() < P) {
+      try {
+        change(X1, lws1, lw, ps);
+      } catch (CholeskyException e) {
+        haveStats = false;
+      }
+    }
 
-      /* copy samples into single matrix */
+    /* otherwise recompute them, centred on the mean */
+    if (!haveStats) {
       for (int p = 0; p < P; ++p) {
-        row(X, p) = vec(s.s1s[p]->get(P_VAR));
+        ws(p) = bi::nanexp(static_cast<double>(lws1(p)) - lw);
       }
-      expu_elements(s.logWeights(), ws);
-
-      /* mean */
-      mu.resize(NP);
-      mean(X, ws, mu);
-
-      /* covariance */
-      Sigma.resize(NP, NP);
-      cov(X, ws, mu, Sigma);
-
-      /* Cholesky factor of covariance */
-      U.resize(NP, NP);
-      chol(Sigma, U);
+      c.resize(NP);
+      gemv(1.0 / sum_reduce(ws), X1, ws, 0.0, c, 'T');
+      recompute(X1, lws1, lw, M);
+    }
 
-      /* scale for local moves */
-      if (local) {
-        matrix_scal(scale, U);
+    /* recentre on the mean, and factor; where either fails, the statistics
+     * are recomputed next time, and the last proposal kept meanwhile */
+    if (haveStats && W > 0.0) {
+      try {
+        d = S1;
+        scal(-1.0 / W, d);
+        recentre(W, S1, R, d);
+        axpy(-1.0, d, c);
+        factor(c, W, R);
+      } catch (CholeskyException e) {
+        haveStats = false;
       }
-
-      /* determinant */
-      detU = prod_reduce(diagonal(U));
-    } catch (CholeskyException e) {
-      ready = false;
     }
+    ready = haveProposal;
   }
   return ready;
 }
@@ -159,62 +345,108 @@ bool bi::GaussianAdapter::adapt(const S1& s) {
 template<class S1>
 bool bi::GaussianAdapter::distributedAdapt(const S1& s) {
   boost::mpi::communicator world;
-  const int rank = world.rank();
   const int size = world.size();
   const int NP = s.s1s[0]->get(P_VAR).size2();
   const int P = s.size();
 
   bool ready = s.ess >= essRel * P * size;
   if (ready) {
-    try {
-      typename temp_host_matrix<real>::type X(P, NP), Y(P,NP), Z(P,NP), Smu(NP, size), SSigma(NP*NP, size);
-      typename temp_host_vector<real>::type ws(P), vs(P);
+    typename temp_host_matrix<real>::type X1(P, NP), M(NP, NP), G(NP, NP);
+    typename temp_host_vector<real>::type lws1(P), ws(P), d(NP), St(NP),
+        mu1(NP);
+    typename temp_host_vector<double>::type in(1 + NP + NP * (NP + 1) / 2),
+        out(in.size());
+    std::vector<int> ps;
+    int p, i, j, k;
+
+    /* common reference log-weight */
+    collect(s, X1, lws1, ps);
+    double lw = max_reduce(lws1);
+    lw = boost::mpi::all_reduce(world, lw, boost::mpi::maximum<double>());
+
+    /* common centre, the first time only */
+    if (!haveCentre) {
+      for (p = 0; p < P; ++p) {
+        ws(p) = bi::nanexp(static_cast<double>(lws1(p)) - lw);
+      }
+      c.resize(NP);
+      gemv(1.0, X1, ws, 0.0, c, 'T');
+      in(0) = sum_reduce(ws);
+      for (i = 0; i < NP; ++i) {
+        in(1 + i) = c(i);
+      }
+      boost::mpi::all_reduce(world, in.buf(), 1 + NP, out.buf(),
+          std::plus<double>());
+      for (i = 0; i < NP; ++i) {
+        c(i) = out(1 + i) / out(0);
+      }
+      haveCentre = true;
+      haveStats = false;
+    }
 
-      /* copy samples into single matrix */
-      for (int p = 0; p < P; ++p) {
-        row(X, p) = vec(s.s1s[p]->get(P_VAR));
+    /* local statistics about the common centre */
+    if (haveStats && 2 * (int)ps.size() < P) {
+      try {
+        change(X1, lws1, lw, ps);
+      } catch (CholeskyException e) {
+        haveStats = false;
+      }
+    }
+    if (haveStats && W > 0.0) {
+      syrk(1.0, R, 0.0, M, 'U', 'T');
+    } else {
+      recompute(X1, lws1, lw, M);
+    }
+
+    /* sum statistics across processes, in one reduction, with only the
+     * upper triangle of the sum of outer products */
+    in(0) = W;
+    for (i = 0, k = 1 + NP; i < NP; ++i) {
+      in(1 + i) = S1(i);
+      for (j = i; j < NP; ++j, ++k) {
+        in(k) = M(i, j);
       }
-      synchronize();
-
-      /* weights */
-      ws = s.logWeights();
-      double Wmax = max_reduce(ws);
-      Wmax = boost::mpi::all_reduce(world, Wmax, boost::mpi::maximum<double>());
-      subscal_elements(ws, Wmax, ws);
-      exp_elements(ws, ws);
-      double Wt = sum_reduce(ws);
-      Wt = boost::mpi::all_reduce(world, Wt, std::plus<double>());
-
-      /* mean */
-      mu.resize(NP);
-      gemv(1.0/Wt, X, ws, 0.0, mu, 'T');
-      boost::mpi::all_gather(world, mu.buf(), NP, vec(Smu).buf());
-      sum_columns(Smu, mu);
-
-      /* covariance */
-      Sigma.resize(NP, NP);
-      Y = X;
-      sub_rows(Y, mu);
-      sqrt_elements(ws, vs);
-      gdmm(1.0, vs, Y, 0.0, Z);
-      syrk(1.0/Wt, Z, 0.0, Sigma, 'U', 'T');
-      boost::mpi::all_gather(world, Sigma.buf(), NP*NP, vec(SSigma).buf());
-      sum_columns(SSigma, vec(Sigma));
-
-      /* Cholesky factor of covariance */
-      U.resize(NP, NP);
-      chol(Sigma, U);
-
-      /* scale for local moves */
-      if (local) {
-        matrix_scal(scale, U);
+    }
+    boost::mpi::all_reduce(world, in.buf(), in.size(), out.buf(),
+        std::plus<double>());
+    const double Wt = out(0);
+    for (i = 0, k = 1 + NP; i < NP; ++i) {
+      St(i) = out(1 + i);
+      for (j = i; j < NP; ++j, ++k) {
+        M(i, j) = out(k);
       }
+    }
 
-      /* determinant */
-      detU = prod_reduce(diagonal(U));
-    } catch (CholeskyException e) {
-      ready = false;
+    /* proposal, and move local statistics to the new centre, which all
+     * processes share; where the proposal fails, the last is kept, and the
+     * centre left where it was */
+    if (Wt > 0.0) {
+      try {
+        chol(M, G);
+        d = St;
+        scal(-1.0 / Wt, d);
+        recentre(Wt, St, G, d);
+        mu1 = c;
+        axpy(-1.0, d, mu1);
+        factor(mu1, Wt, G);
+
+        d = c;
+        axpy(-1.0, mu, d);
+        c = mu;
+        if (haveStats && W > 0.0) {
+          try {
+            recentre(W, S1, R, d);
+          } catch (CholeskyException e) {
+            haveStats = false;
+          }
+        } else {
+          haveStats = false;
+        }
+      } catch (CholeskyException e) {
+        //
+      }
     }
+    ready = haveProposal;
   }
   return ready;
 }
@@ -254,4 +486,170 @@ void bi::GaussianAdapter::propose(Random& rng, S1& s1, S2& s2) {
   synchronize();
 }
 
+template<class S1, class M1, class V1>
+void bi::GaussianAdapter::collect(const S1& s, M1 X1, V1 lws1,
+    std::vector<int>& ps) {
+  /* pre-conditions */
+  BI_ASSERT(X1.size1() == s.size());
+  BI_ASSERT(lws1.size() == s.size());
+
+  const int P = X1.size1();
+  const int NP = X1.size2();
+  int p, j;
+  bool changed;
+
+  for (p = 0; p < P; ++p) {
+    row(X1, p) = vec(s.s1s[p]->get(P_VAR));
+  }
+  lws1 = s.logWeights();
+  synchronize();
+
+  ps.clear();
+  if (haveStats && X.size1() == P && X.size2() == NP) {
+    for (p = 0; p < P; ++p) {
+      changed = lws1(p) != lws(p);
+      for (j = 0; !changed && j < NP; ++j) {
+        changed = X1(p, j) != X(p, j);
+      }
+      if (changed) {
+        ps.push_back(p);
+      }
+    }
+  }
+}
+
+template<class M1, class V1, class M2>
+void bi::GaussianAdapter::recompute(const M1 X1, const V1 lws1,
+    const double lw, M2 M) {
+  const int P = X1.size1();
+  const int NP = X1.size2();
+
+  typename temp_host_matrix<real>::type Y(P, NP), Z(P, NP);
+  typename temp_host_vector<real>::type ws(P);
+
+  /* weights */
+  for (int p = 0; p < P; ++p) {
+    ws(p) = bi::nanexp(static_cast<double>(lws1(p)) - lw);
+  }
+  W = sum_reduce(ws);
+  lw0 = lw;
+
+  /* sum of deviations */
+  Y = X1;
+  sub_rows(Y, c);
+  S1.resize(NP);
+  gemv(1.0, Y, ws, 0.0, S1, 'T');
+
+  /* sum of outer products of deviations */
+  sqrt_elements(ws, ws);
+  gdmm(1.0, ws, Y, 0.0, Z);
+  syrk(1.0, Z, 0.0, M, 'U', 'T');
+
+  /* keep samples for next time */
+  X.resize(P, NP);
+  X = X1;
+  lws.resize(P);
+  lws = lws1;
+
+  R.resize(NP, NP);
+  try {
+    chol(M, R);
+    haveStats = true;
+  } catch (CholeskyException e) {
+    haveStats = false;
+  }
+}
+
+template<class M1, class V1>
+void bi::GaussianAdapter::change(const M1 X1, const V1 lws1,
+    const double lw, const std::vector<int>& ps) throw (CholeskyException) {
+  /* rebase weights on new reference log-weight */
+  const double f = bi::exp(lw0 - lw);
+  if (!(f > 0.0 && bi::is_finite(f))) {
+    throw CholeskyException(0);
+  }
+  W *= f;
+  scal(f, S1);
+  matrix_scal(bi::sqrt(f), R);
+  lw0 = lw;
+
+  /* remove old samples, add new */
+  double w0, w1;
+  int i, p;
+  for (i = 0; i < (int)ps.size(); ++i) {
+    p = ps[i];
+    w0 = bi::nanexp(static_cast<double>(lws(p)) - lw0);
+    w1 = bi::nanexp(static_cast<double>(lws1(p)) - lw0);
+    if (w1 > 0.0) {
+      update(row(X1, p), w1);  // update first, to keep R positive definite
+    }
+    if (w0 > 0.0) {
+      update(row(X, p), -w0);
+    }
+    row(X, p) = row(X1, p);
+    lws(p) = lws1(p);
+  }
+}
+
+template<class V1>
+void bi::GaussianAdapter::update(const V1 x, const double w)
+    throw (CholeskyException) {
+  const int NP = x.size();
+  typename temp_host_vector<real>::type a(NP), b(NP);
+
+  a = x;
+  axpy(-1.0, c, a);
+  axpy(w, a, S1);
+  W += w;
+  scal(bi::sqrt(bi::abs(w)), a);
+  if (w > 0.0) {
+    ch1up(R, a, b);
+  } else {
+    ch1dn(R, a, b);
+  }
+}
+
+template<class V1, class M1, class V2>
+void bi::GaussianAdapter::recentre(const double W, V1 S, M1 R, const V2 e)
+    throw (CholeskyException) {
+  /* the sum of outer products gains (S + We)(S + We)'/W - SS'/W */
+  const int NP = S.size();
+  typename temp_host_vector<real>::type a(NP), b(NP), work(NP);
+
+  a = S;
+  scal(1.0 / bi::sqrt(W), a);
+  axpy(W, e, S);
+  b = S;
+  scal(1.0 / bi::sqrt(W), b);
+  ch1up(R, b, work);
+  ch1dn(R, a, work);
+}
+
+template<class V1, class M1>
+void bi::GaussianAdapter::factor(const V1 mu, const double W, const M1 R)
+    throw (CholeskyException) {
+  typename temp_host_matrix<real>::type U1(R.size1(), R.size2());
+  U1 = R;
+  matrix_scal(1.0 / bi::sqrt(W), U1);
+
+  /* scale for local moves */
+  if (local) {
+    matrix_scal(scale, U1);
+  }
+
+  /* determinant, rank-one updates not necessarily keeping the diagonal
+   * positive */
+  const real det = bi::abs(prod_reduce(diagonal(U1)));
+  if (!(det > 0.0 && bi::is_finite(det))) {
+    throw CholeskyException(0);
+  }
+
+  this->mu.resize(mu.size());
+  this->mu = mu;
+  U.resize(U1.size1(), U1.size2());
+  U = U1;
+  detU = det;
+  haveProposal = true;
+}
+
 #endif
@@ -82,6 +82,9 @@
  *   @defgroup io_netcdf NetCDF buffers
  *   @ingroup io
  *
+ *   @defgroup io_mmap Memory-mapped buffers
+ *   @ingroup io
+ *
  * @defgroup math Math
  *
  *   @defgroup math_matvec Matrix and vector containers
@@ -11,7 +11,7 @@
 #include "../math/vector.hpp"
 #include "../math/matrix.hpp"
 #include "../misc/location.hpp"
-#include "../misc/TicToc.hpp"
+#include "../misc/Profiler.hpp"
 #include "../state/State.hpp"
 #include "../model/Model.hpp"
 
@@ -39,6 +39,11 @@ public:
    */
   typedef typename loc_vector<CL,int>::type int_vector_type;
 
+  /**
+   * Integer vector type on host.
+   */
+  typedef typename loc_vector<ON_HOST,int>::type host_int_vector_type;
+
   /**
    * Constructor.
    */
@@ -80,6 +85,26 @@ public:
   template<class M1>
   void readPath(const int p, M1 X) const;
 
+  /**
+   * Read multiple paths from the cache.
+   *
+   * @tparam V1 Integer vector type.
+   * @tparam M1 Matrix type.
+   *
+   * @param ps Indices of particles at current time.
+   * @param[out] X Paths. Rows index variables, columns index times, with
+   * the path of particle <tt>ps(i)</tt> in columns
+   * <tt>i*T</tt> to <tt>(i + 1)*T - 1</tt>, where
+   * <tt>T = X.size2()/ps.size()</tt>.
+   *
+   * All lineages are walked back together, one generation at a time. Where
+   * lineages coalesce, the walk continues for only one of them, and the
+   * shared prefix is copied across to the others as a block of columns at
+   * the end, so that each node of the tree is read at most once.
+   */
+  template<class V1, class M1>
+  void readPaths(const V1 ps, M1 X) const;
+
   /**
    * Add particles at a new time to the cache.
    *
@@ -133,6 +158,22 @@ private:
   template<class M1, class V1>
   void insert(const M1 X, const V1 as);
 
+  /**
+   * Implementation of readPaths().
+   *
+   * @tparam V1 Integer vector type.
+   * @tparam M1 Matrix type.
+   * @tparam V2 Integer vector type.
+   * @tparam V3 Integer vector type.
+   *
+   * @param ps Indices of particles at current time.
+   * @param[out] X Paths.
+   * @param as1 Ancestors, on host.
+   * @param ls1 Leaves, on host.
+   */
+  template<class V1, class M1, class V2, class V3>
+  void readPaths(const V1 ps, M1 X, const V2 as1, const V3 ls1) const;
+
   /**
    * Enlarge the cache.
    *
@@ -180,6 +221,21 @@ private:
    */
   int_vector_type ls;
 
+  /**
+   * Copy of @p as on host, when the cache is on device.
+   */
+  mutable host_int_vector_type asHost;
+
+  /**
+   * Copy of @p ls on host, when the cache is on device.
+   */
+  mutable host_int_vector_type lsHost;
+
+  /**
+   * Are @p asHost and @p lsHost up to date?
+   */
+  mutable bool hostValid;
+
   /**
    * Number of surviving nodes in the cache.
    */
@@ -190,11 +246,6 @@ private:
    */
   int q;
 
-  /**
-   * Time taken for last write, in microseconds.
-   */
-  long usecs;
-
   /**
    * Serialize.
    */
@@ -232,13 +283,14 @@ private:
 
 template<bi::Location CL>
 bi::AncestryCache<CL>::AncestryCache() :
-    m(0), q(0), usecs(0) {
+    hostValid(false), m(0), q(0) {
   //
 }
 
 template<bi::Location CL>
 bi::AncestryCache<CL>::AncestryCache(const AncestryCache<CL>& o) :
-    Xs(o.Xs), as(o.as), os(o.os), ls(o.ls), m(o.m), q(o.q), usecs(o.usecs) {
+    Xs(o.Xs), as(o.as), os(o.os), ls(o.ls), hostValid(false), m(o.m),
+    q(o.q) {
   //
 }
 
@@ -254,9 +306,9 @@ bi::AncestryCache<CL>& bi::AncestryCache<CL>::operator=(
   as = o.as;
   os = o.os;
   ls = o.ls;
+  hostValid = false;
   m = o.m;
   q = o.q;
-  usecs = o.usecs;
 
   return *this;
 }
@@ -267,18 +319,19 @@ void bi::AncestryCache<CL>::swap(AncestryCache<CL>& o) {
   as.swap(o.as);
   os.swap(o.os);
   ls.swap(o.ls);
+  hostValid = false;
+  o.hostValid = false;
   std::swap(m, o.m);
   std::swap(q, o.q);
-  std::swap(usecs, o.usecs);
 }
 
 template<bi::Location CL>
 void bi::AncestryCache<CL>::clear() {
   os.clear();
   ls.resize(0, false);
+  hostValid = false;
   m = 0;
   q = 0;
-  usecs = 0;
 }
 
 template<bi::Location CL>
@@ -287,30 +340,108 @@ void bi::AncestryCache<CL>::empty() {
   as.resize(0, false);
   os.resize(0, false);
   ls.resize(0, false);
+  asHost.resize(0, false);
+  lsHost.resize(0, false);
+  hostValid = false;
   m = 0;
   q = 0;
-  usecs = 0;
 }
 
 template<bi::Location CL>
 template<class M1>
 void bi::AncestryCache<CL>::readPath(const int p, M1 X) const {
+  typename temp_host_vector<int>::type ps(1);
+  ps(0) = p;
+  readPaths(ps, X);
+}
+
+template<bi::Location CL>
+template<class V1, class M1>
+void bi::AncestryCache<CL>::readPaths(const V1 ps, M1 X) const {
+  if (CL == ON_HOST) {
+    readPaths(ps, X, as, ls);
+  } else {
+    /* the ancestry only changes on write, so copy it to host at most once
+     * between writes */
+    if (!hostValid) {
+      asHost.resize(as.size(), false);
+      lsHost.resize(ls.size(), false);
+      asHost = as;
+      lsHost = ls;
+      synchronize(as.on_device);
+      hostValid = true;
+    }
+    readPaths(ps, X, asHost, lsHost);
+  }
+}
+
+template<bi::Location CL>
+template<class V1, class M1, class V2, class V3>
+void bi::AncestryCache<CL>::readPaths(const V1 ps, M1 X, const V2 as1,
+    const V3 ls1) const {
   /* pre-conditions */
   BI_ASSERT(X.size1() == Xs.size2());
-  BI_ASSERT(p >= 0 && p < ls.size());
+  BI_ASSERT(ps.size() > 0 && X.size2() % ps.size() == 0);
 
   ///@todo Implement this with scatter, so that one kernel call on device
 
-  typename temp_host_vector<int>::type as1(as);
-  synchronize(as.on_device);
+  typedef typename temp_host_vector<int>::type temp_int_vector_type;
+
+  const int K = ps.size();
+  const int T = X.size2()/K;
+  temp_int_vector_type ps1(ps), bs(K), js(K), ts(K), is(K), es(K), stamps,
+      owners;
+  synchronize(ps.on_device);
+  int i, k, n, e = 0, a, t = T - 1;
+
+  /* node of each lineage in the tree at the current time, and lineage into
+   * which each has merged, if any */
+  for (i = 0; i < K; ++i) {
+    BI_ASSERT(ps1(i) >= 0 && ps1(i) < ls1.size());
+    bs(i) = ls1(ps1(i));
+    is(i) = i;
+  }
+
+  /* the node at which each lineage was last seen, stamped with time, to
+   * detect coalescence without clearing between generations */
+  if (K > 1) {
+    stamps.resize(Xs.size1(), false);
+    owners.resize(Xs.size1(), false);
+    set_elements(stamps, -1);
+  }
 
-  int a = *(ls.begin() + p);
-  int t = X.size2() - 1;
-  do {
-    column(X, t) = row(Xs, a);
-    a = as1(a);
+  n = K;
+  while (n > 0) {
+    BI_ASSERT(t >= 0);
+    for (k = 0, i = 0; i < n; ++i) {
+      a = bs(is(i));
+      if (K > 1 && stamps(a) == t) {
+        /* coalesced with an earlier lineage */
+        js(is(i)) = owners(a);
+        ts(is(i)) = t;
+        es(e++) = is(i);
+      } else {
+        if (K > 1) {
+          stamps(a) = t;
+          owners(a) = is(i);
+        }
+        column(X, is(i)*T + t) = row(Xs, a);
+        bs(is(i)) = as1(a);
+        if (bs(is(i)) != -1) {
+          is(k++) = is(i);
+        }
+      }
+    }
+    n = k;
     --t;
-  } while (a != -1);
+  }
+
+  /* copy shared prefixes, most recent coalescence last, so that the
+   * prefix of the lineage into which each merged is complete */
+  for (--e; e >= 0; --e) {
+    i = es(e);
+    columns(X, i*T, ts(i) + 1) = columns(X, js(i)*T, ts(i) + 1);
+  }
 }
 
 template<bi::Location CL>
@@ -409,11 +540,9 @@ void bi::AncestryCache<CL>::writeState(const M1 X, const V1 as,
   /* pre-conditions */
   BI_ASSERT(X.size1() == as.size());
 
-#if ENABLE_DIAGNOSTICS == 1
-  synchronize();
-  TicToc clock;
-#endif
+  ProfileScope scope(PROFILE_ANCESTRY);
 
+  hostValid = false;
   if (m == 0) {
     init(X);
   } else {
@@ -429,19 +558,13 @@ void bi::AncestryCache<CL>::writeState(const M1 X, const V1 as,
     }
     insert(X, as);
   }
-#if ENABLE_DIAGNOSTICS == 1
-  synchronize();
-  usecs = clock.toc();
-  report();
-#endif
 }
 
 template<bi::Location CL>
 void bi::AncestryCache<CL>::report() const {
   std::cerr << "AncestryCache: ";
   std::cerr << Xs.size1() << " slots, ";
-  std::cerr << m << " nodes, ";
-  std::cerr << usecs << " us last write.";
+  std::cerr << m << " nodes.";
   std::cerr << std::endl;
 }
 
@@ -454,7 +577,6 @@ void bi::AncestryCache<CL>::save(Archive& ar, const unsigned version) const {
   save_resizable_vector(ar, version, ls);
   ar & m;
   ar & q;
-  ar & usecs;
 }
 
 template<bi::Location CL>
@@ -464,9 +586,9 @@ void bi::AncestryCache<CL>::load(Archive& ar, const unsigned version) {
   load_resizable_vector(ar, version, as);
   load_resizable_vector(ar, version, os);
   load_resizable_vector(ar, version, ls);
+  hostValid = false;
   ar & m;
   ar & q;
-  ar & usecs;
 }
 
 #endif
@@ -0,0 +1,162 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "AsyncWriter.hpp"
+
+#include "../primitive/arena_allocator.hpp"
+#include "../misc/assert.hpp"
+
+std::deque<bi::AsyncTask*> bi::AsyncWriter::queue;
+pthread_t bi::AsyncWriter::thread;
+pthread_mutex_t bi::AsyncWriter::mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t bi::AsyncWriter::submitted = PTHREAD_COND_INITIALIZER;
+pthread_cond_t bi::AsyncWriter::completed = PTHREAD_COND_INITIALIZER;
+int bi::AsyncWriter::depth = 0;
+bi::AsyncWriter::Backpressure bi::AsyncWriter::policy = BLOCK;
+bool bi::AsyncWriter::running = false;
+bool bi::AsyncWriter::stopping = false;
+long bi::AsyncWriter::fulls = 0;
+
+bi::AsyncTask::AsyncTask() : pending(false) {
+  //
+}
+
+bi::AsyncTask::~AsyncTask() {
+  //
+}
+
+bool bi::AsyncTask::isPending() const {
+  return AsyncWriter::isPending(this);
+}
+
+void bi::AsyncWriter::init(const int depth, const Backpressure policy) {
+  term();
+
+  #ifndef ENABLE_CUDA
+  AsyncWriter::depth = depth;
+  AsyncWriter::policy = policy;
+  if (depth > 0) {
+    stopping = false;
+    int err = pthread_create(&thread, NULL, main, NULL);
+    BI_ERROR_MSG(err == 0, "Could not start writer thread");
+    running = true;
+  }
+  #endif
+}
+
+void bi::AsyncWriter::term() {
+  if (running) {
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    pthread_cond_signal(&submitted);
+    pthread_mutex_unlock(&mutex);
+
+    pthread_join(thread, NULL);
+    running = false;
+  }
+}
+
+void bi::AsyncWriter::submit(AsyncTask* task) {
+  /* pre-condition */
+  BI_ASSERT(!task->isPending());
+
+  bool sync = !running;
+  if (running) {
+    pthread_mutex_lock(&mutex);
+    if ((int)queue.size() >= depth) {
+      ++fulls;
+      if (policy == SYNC) {
+        sync = true;
+      } else {
+        while ((int)queue.size() >= depth) {
+          pthread_cond_wait(&completed, &mutex);
+        }
+      }
+    }
+    if (!sync) {
+      task->pending = true;
+      queue.push_back(task);
+      pthread_cond_signal(&submitted);
+    }
+    pthread_mutex_unlock(&mutex);
+  }
+  if (sync) {
+    task->run();
+  }
+}
+
+void bi::AsyncWriter::wait(AsyncTask* task) {
+  if (running) {
+    pthread_mutex_lock(&mutex);
+    while (task->pending) {
+      pthread_cond_wait(&completed, &mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+void bi::AsyncWriter::drain() {
+  if (running) {
+    pthread_mutex_lock(&mutex);
+    while (!queue.empty()) {
+      pthread_cond_wait(&completed, &mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+bool bi::AsyncWriter::isPending(const AsyncTask* task) {
+  bool pending;
+  if (running) {
+    pthread_mutex_lock(&mutex);
+    pending = task->pending;
+    pthread_mutex_unlock(&mutex);
+  } else {
+    pending = task->pending;
+  }
+  return pending;
+}
+
+int bi::AsyncWriter::getDepth() {
+  return running ? depth : 0;
+}
+
+bi::AsyncWriter::Backpressure bi::AsyncWriter::getPolicy() {
+  return policy;
+}
+
+long bi::AsyncWriter::getFullCount() {
+  return fulls;
+}
+
+void* bi::AsyncWriter::main(void* arg) {
+  AsyncTask* task;
+
+  /* this thread is not an OpenMP thread, so must not share the free lists
+   * of one */
+  arena::detach();
+
+  pthread_mutex_lock(&mutex);
+  while (!stopping || !queue.empty()) {
+    if (queue.empty()) {
+      pthread_cond_wait(&submitted, &mutex);
+    } else {
+      /* the task stays at the front of the queue while it runs, so that it
+       * counts toward the depth */
+      task = queue.front();
+      pthread_mutex_unlock(&mutex);
+      task->run();
+      pthread_mutex_lock(&mutex);
+      queue.pop_front();
+      task->pending = false;
+      pthread_cond_broadcast(&completed);
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+
+  return NULL;
+}
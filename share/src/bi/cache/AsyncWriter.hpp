@@ -0,0 +1,202 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_CACHE_ASYNCWRITER_HPP
+#define BI_CACHE_ASYNCWRITER_HPP
+
+#include <deque>
+#include <pthread.h>
+
+namespace bi {
+/**
+ * Task for AsyncWriter.
+ *
+ * @ingroup io_cache
+ */
+class AsyncTask {
+public:
+  /**
+   * Constructor.
+   */
+  AsyncTask();
+
+  /**
+   * Destructor.
+   */
+  virtual ~AsyncTask();
+
+  /**
+   * Run the task.
+   */
+  virtual void run() = 0;
+
+  /**
+   * Is the task submitted and not yet complete? Reads the flag under the
+   * mutex of AsyncWriter, which the writer thread holds to clear it.
+   */
+  bool isPending() const;
+
+private:
+  /**
+   * Is the task pending? Guarded by the mutex of AsyncWriter.
+   */
+  bool pending;
+
+  friend class AsyncWriter;
+};
+
+/**
+ * Background writer for output caches.
+ *
+ * @ingroup io_cache
+ *
+ * Runs tasks, typically the write of a filled page of a cache to a NetCDF
+ * file, or the prefetch of a window of input (see InputNetCDFBuffer), on a
+ * single background thread, in order of submission, so that the
+ * computation can continue in the meantime. Submitted
+ * tasks wait in a bounded queue. When the queue is full, the submitting
+ * thread either blocks until there is room, or runs the task itself,
+ * according to the backpressure policy.
+ *
+ * The writer is disabled, and tasks run synchronously on submission, until
+ * #init is called with a positive queue depth, and always in builds with
+ * CUDA, where temporary host memory is pooled per OpenMP thread.
+ *
+ * Calls into the NetCDF library are serialised by the wrappers in
+ * netcdf.hpp, so that the computation may continue to read input files.
+ */
+class AsyncWriter {
+public:
+  /**
+   * Backpressure policies.
+   */
+  enum Backpressure {
+    /**
+     * Block until there is room in the queue.
+     */
+    BLOCK,
+
+    /**
+     * Run the task on the submitting thread.
+     */
+    SYNC
+  };
+
+  /**
+   * Start the writer thread.
+   *
+   * @param depth Maximum number of tasks waiting in the queue. Zero
+   * disables the writer.
+   * @param policy Backpressure policy.
+   */
+  static void init(const int depth, const Backpressure policy = BLOCK);
+
+  /**
+   * Complete all tasks and stop the writer thread.
+   */
+  static void term();
+
+  /**
+   * Submit a task.
+   *
+   * @param task The task. The caller retains ownership, and must wait for
+   * the task to complete (see #wait) before reusing or destroying it.
+   */
+  static void submit(AsyncTask* task);
+
+  /**
+   * Wait for a task to complete. Returns immediately if the task is not
+   * pending.
+   */
+  static void wait(AsyncTask* task);
+
+  /**
+   * Wait for all tasks to complete.
+   */
+  static void drain();
+
+  /**
+   * Is a task submitted and not yet complete? Takes the mutex, so may be
+   * called from any thread, but not while holding it.
+   */
+  static bool isPending(const AsyncTask* task);
+
+  /**
+   * Maximum number of tasks waiting in the queue, zero if the writer is
+   * disabled.
+   */
+  static int getDepth();
+
+  /**
+   * Backpressure policy.
+   */
+  static Backpressure getPolicy();
+
+  /**
+   * Number of times that a submitting thread has met a full queue.
+   */
+  static long getFullCount();
+
+private:
+  /**
+   * Entry point of the writer thread.
+   */
+  static void* main(void* arg);
+
+  /**
+   * Queue.
+   */
+  static std::deque<AsyncTask*> queue;
+
+  /**
+   * Writer thread.
+   */
+  static pthread_t thread;
+
+  /**
+   * Mutex guarding the queue and pending flags of tasks.
+   */
+  static pthread_mutex_t mutex;
+
+  /**
+   * Signalled when a task is submitted, or on termination.
+   */
+  static pthread_cond_t submitted;
+
+  /**
+   * Signalled when a task is completed.
+   */
+  static pthread_cond_t completed;
+
+  /**
+   * Maximum length of queue.
+   */
+  static int depth;
+
+  /**
+   * Backpressure policy.
+   */
+  static Backpressure policy;
+
+  /**
+   * Is the writer thread running?
+   */
+  static bool running;
+
+  /**
+   * Has termination been requested?
+   */
+  static bool stopping;
+
+  /**
+   * Number of times a submitting thread has met a full queue.
+   */
+  static long fulls;
+};
+}
+
+#endif
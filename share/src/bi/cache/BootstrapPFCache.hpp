@@ -85,6 +85,12 @@ public:
   template<class M1>
   void readPath(const int p, M1 X) const;
 
+  /**
+   * @copydoc AncestryCache::readPaths()
+   */
+  template<class V1, class M1>
+  void readPaths(const V1 ps, M1 X) const;
+
   /**
    * Swap the contents of the cache with that of another.
    */
@@ -214,6 +220,12 @@ void bi::BootstrapPFCache<CL,IO1>::readPath(const int p, M1 X) const {
   ancestryCache.readPath(p, X);
 }
 
+template<bi::Location CL, class IO1>
+template<class V1, class M1>
+void bi::BootstrapPFCache<CL,IO1>::readPaths(const V1 ps, M1 X) const {
+  ancestryCache.readPaths(ps, X);
+}
+
 template<bi::Location CL, class IO1>
 void bi::BootstrapPFCache<CL,IO1>::swap(BootstrapPFCache<CL,IO1>& o) {
   parent_type::swap(o);
@@ -11,6 +11,7 @@
 #include "SimulatorCache.hpp"
 #include "Cache1D.hpp"
 #include "CacheCross.hpp"
+#include "AsyncWriter.hpp"
 #include "../model/Model.hpp"
 #include "../null/MCMCNullBuffer.hpp"
 
@@ -22,6 +23,11 @@ namespace bi {
  *
  * @tparam IO1 Output type.
  * @tparam CL Location.
+ *
+ * The cache is multiple-buffered: #flush hands the filled page to
+ * AsyncWriter and continues into a fresh page. Up to the queue depth of
+ * AsyncWriter, filled pages may wait to be written at once, each in its own
+ * buffer, so that #flush waits only when all are still pending.
  */
 template<Location CL = ON_HOST, class IO1 = MCMCNullBuffer>
 class MCMCCache: public SimulatorCache<CL,IO1> {
@@ -149,17 +155,83 @@ public:
   void empty();
 
   /**
-   * Flush to output buffer.
+   * Flush to output buffer. The write completes in the background, and the
+   * cache is cleared.
    */
   void flush();
 
+  /**
+   * Wait for all background writes to complete.
+   */
+  void sync() const;
+
 protected:
+  /**
+   * Background write of a filled page of the cache.
+   */
+  class FlushTask: public AsyncTask {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param cache Owning cache.
+     */
+    FlushTask(MCMCCache<CL,IO1>& cache);
+
+    /**
+     * Destructor.
+     */
+    virtual ~FlushTask();
+
+    /**
+     * Swap the page with the current page of the owning cache.
+     */
+    void swap();
+
+    virtual void run();
+
+    /**
+     * Owning cache.
+     */
+    MCMCCache<CL,IO1>& cache;
+
+    /*
+     * Page, as for the owning cache.
+     */
+    Cache1D<real,CL> llCache;
+    Cache1D<real,CL> lpCache;
+    CacheCross<real,CL> parameterCache;
+    std::vector<CacheCross<real,CL>*> pathCache;
+    int first;
+    int len;
+  };
+
+  /**
+   * Write a page to the output buffer.
+   *
+   * @param llCache Log-likelihoods cache.
+   * @param lpCache Log-prior densities cache.
+   * @param parameterCache Parameters cache.
+   * @param pathCache Trajectories cache.
+   * @param first1 Id of first sample in page.
+   * @param len1 Number of samples in page.
+   */
+  void flushPage(Cache1D<real,CL>& llCache, Cache1D<real,CL>& lpCache,
+      CacheCross<real,CL>& parameterCache,
+      std::vector<CacheCross<real,CL>*>& pathCache, const int first1,
+      const int len1);
+
   /**
    * Flush state trajectories to disk.
    *
    * @param type Variable type.
+   * @param pathCache Trajectories cache.
+   * @param first1 Id of first sample in page.
+   * @param len1 Number of samples in page.
    */
-  void flushPaths(const VarType type);
+  void flushPaths(const VarType type,
+      std::vector<CacheCross<real,CL>*>& pathCache, const int first1,
+      const int len1);
 
   /**
    * Model.
@@ -196,6 +268,18 @@ protected:
    */
   int len;
 
+  /**
+   * Pages being written in the background, created as needed, up to the
+   * queue depth of AsyncWriter.
+   */
+  std::vector<FlushTask*> tasks;
+
+  /**
+   * Index into #tasks of the oldest page, the next to reuse once all pages
+   * are created.
+   */
+  int next;
+
   /**
    * Maximum number of samples to store in cache.
    */
@@ -228,7 +312,7 @@ bi::MCMCCache<CL,IO1>::MCMCCache(const Model& m, const size_t P,
     const SchemaMode schema) :
     parent_type(m, P, T, file, mode, schema), m(m), llCache(NUM_SAMPLES), lpCache(
         NUM_SAMPLES), parameterCache(NUM_SAMPLES, m.getNetSize(P_VAR)), first(
-        0), len(0) {
+        0), len(0), next(0) {
   const int N = m.getNetSize(R_VAR) + m.getNetSize(D_VAR);
   pathCache.resize(T);
   for (int i = 0; i < pathCache.size(); ++i) {
@@ -239,7 +323,7 @@ bi::MCMCCache<CL,IO1>::MCMCCache(const Model& m, const size_t P,
 template<bi::Location CL, class IO1>
 bi::MCMCCache<CL,IO1>::MCMCCache(const MCMCCache<CL,IO1>& o) :
     parent_type(o), m(o.m), llCache(o.llCache), lpCache(o.lpCache), parameterCache(
-        o.parameterCache), first(o.first), len(o.len) {
+        o.parameterCache), first(o.first), len(o.len), next(0) {
   pathCache.resize(o.pathCache.size());
   for (int i = 0; i < pathCache.size(); ++i) {
     pathCache[i] = new CacheCross<real,CL>(*o.pathCache[i]);
@@ -248,6 +332,10 @@ bi::MCMCCache<CL,IO1>::MCMCCache(const MCMCCache<CL,IO1>& o) :
 
 template<bi::Location CL, class IO1>
 bi::MCMCCache<CL,IO1>::~MCMCCache() {
+  sync();
+  for (int i = 0; i < int(tasks.size()); ++i) {
+    delete tasks[i];
+  }
   for (int i = 0; i < int(pathCache.size()); ++i) {
     delete pathCache[i];
   }
@@ -256,6 +344,8 @@ bi::MCMCCache<CL,IO1>::~MCMCCache() {
 template<bi::Location CL, class IO1>
 bi::MCMCCache<CL,IO1>& bi::MCMCCache<CL,IO1>::operator=(
     const MCMCCache<CL,IO1>& o) {
+  sync();
+  o.sync();
   parent_type::operator=(o);
 
   llCache = o.llCache;
@@ -377,6 +467,8 @@ bool bi::MCMCCache<CL,IO1>::isFull() const {
 
 template<bi::Location CL, class IO1>
 void bi::MCMCCache<CL,IO1>::swap(MCMCCache<CL,IO1>& o) {
+  sync();
+  o.sync();
   parent_type::swap(o);
   llCache.swap(o.llCache);
   lpCache.swap(o.lpCache);
@@ -401,6 +493,13 @@ void bi::MCMCCache<CL,IO1>::clear() {
 
 template<bi::Location CL, class IO1>
 void bi::MCMCCache<CL,IO1>::empty() {
+  sync();
+  for (int k = 0; k < int(tasks.size()); ++k) {
+    delete tasks[k];
+  }
+  tasks.resize(0);
+  next = 0;
+
   llCache.empty();
   lpCache.empty();
   parameterCache.empty();
@@ -416,31 +515,77 @@ void bi::MCMCCache<CL,IO1>::empty() {
 
 template<bi::Location CL, class IO1>
 void bi::MCMCCache<CL,IO1>::flush() {
-  parent_type::writeLogLikelihoods(first, llCache.get(0, len));
-  parent_type::writeLogPriors(first, lpCache.get(0, len));
-  parent_type::writeParameters(first, parameterCache.get(0, len));
+  /* take a fresh page while fewer than the queue depth exist, otherwise
+   * the oldest, which must be written before it can take the place of the
+   * current page */
+  FlushTask* task = NULL;
+  if (int(tasks.size()) < bi::max(1, AsyncWriter::getDepth())) {
+    task = new FlushTask(*this);
+    tasks.push_back(task);
+  } else if (tasks[next]->isPending() &&
+      AsyncWriter::getPolicy() == AsyncWriter::SYNC) {
+    /* all pages are queued, write the current page on this thread */
+    flushPage(llCache, lpCache, parameterCache, pathCache, first, len);
+  } else {
+    task = tasks[next];
+    next = (next + 1) % tasks.size();
+    AsyncWriter::wait(task);
+  }
+  if (task != NULL) {
+    task->swap();
+    AsyncWriter::submit(task);
+  }
+
+  llCache.clear();
+  lpCache.clear();
+  parameterCache.clear();
+  for (int t = 0; t < int(pathCache.size()); ++t) {
+    pathCache[t]->clear();
+  }
+  first = 0;
+  len = 0;
+
+  parent_type::flush();
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::sync() const {
+  for (int i = 0; i < int(tasks.size()); ++i) {
+    AsyncWriter::wait(tasks[i]);
+  }
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::flushPage(Cache1D<real,CL>& llCache,
+    Cache1D<real,CL>& lpCache, CacheCross<real,CL>& parameterCache,
+    std::vector<CacheCross<real,CL>*>& pathCache, const int first1,
+    const int len1) {
+  parent_type::writeLogLikelihoods(first1, llCache.get(0, len1));
+  parent_type::writeLogPriors(first1, lpCache.get(0, len1));
+  parent_type::writeParameters(first1, parameterCache.get(0, len1));
 
   llCache.flush();
   lpCache.flush();
   parameterCache.flush();
 
-  flushPaths(R_VAR);
-  flushPaths(D_VAR);
-  parent_type::flush();
+  flushPaths(R_VAR, pathCache, first1, len1);
+  flushPaths(D_VAR, pathCache, first1, len1);
 }
 
 template<bi::Location CL, class IO1>
-void bi::MCMCCache<CL,IO1>::flushPaths(const VarType type) {
+void bi::MCMCCache<CL,IO1>::flushPaths(const VarType type,
+    std::vector<CacheCross<real,CL>*>& pathCache, const int first1,
+    const int len1) {
   /* don't do it time-by-time, too much seeking in looping over variables
    * several times... */
   //for (int k = 0; k < int(pathCache.size()); ++k) {
-  //  IO1::writeState(k, first, pathCache[k]->get(0, len));
+  //  IO1::writeState(k, first1, pathCache[k]->get(0, len1));
   //  pathCache[k]->flush();
   //}
   /* ...do it variable-by-variable instead, and loop over times several
    * times */
   Var* var;
-  int id, i, k, start, size;
+  int id, k, start, size;
 
   for (id = 0; id < m.getNumVars(type); ++id) {
     var = m.getVar(type, id);
@@ -448,15 +593,49 @@ void bi::MCMCCache<CL,IO1>::flushPaths(const VarType type) {
     size = var->getSize();
 
     for (k = 0; k < int(pathCache.size()); ++k) {
-      IO1::writeStateVar(type, id, k, first,
-          columns(pathCache[k]->get(0, len), start, size));
+      IO1::writeStateVar(type, id, k, first1,
+          columns(pathCache[k]->get(0, len1), start, size));
     }
   }
 }
 
+template<bi::Location CL, class IO1>
+bi::MCMCCache<CL,IO1>::FlushTask::FlushTask(MCMCCache<CL,IO1>& cache) :
+    cache(cache), llCache(NUM_SAMPLES), lpCache(NUM_SAMPLES),
+    parameterCache(NUM_SAMPLES, cache.m.getNetSize(P_VAR)), first(0), len(0) {
+  const int N = cache.m.getNetSize(R_VAR) + cache.m.getNetSize(D_VAR);
+  pathCache.resize(cache.pathCache.size());
+  for (int i = 0; i < int(pathCache.size()); ++i) {
+    pathCache[i] = new CacheCross<real,CL>(NUM_SAMPLES, N);
+  }
+}
+
+template<bi::Location CL, class IO1>
+bi::MCMCCache<CL,IO1>::FlushTask::~FlushTask() {
+  for (int i = 0; i < int(pathCache.size()); ++i) {
+    delete pathCache[i];
+  }
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::FlushTask::swap() {
+  llCache.swap(cache.llCache);
+  lpCache.swap(cache.lpCache);
+  parameterCache.swap(cache.parameterCache);
+  pathCache.swap(cache.pathCache);
+  std::swap(first, cache.first);
+  std::swap(len, cache.len);
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::FlushTask::run() {
+  cache.flushPage(llCache, lpCache, parameterCache, pathCache, first, len);
+}
+
 template<bi::Location CL, class IO1>
 template<class Archive>
 void bi::MCMCCache<CL,IO1>::save(Archive& ar, const unsigned version) const {
+  sync();
   ar & boost::serialization::base_object < parent_type > (*this);
   ar & llCache;
   ar & lpCache;
@@ -469,6 +648,7 @@ void bi::MCMCCache<CL,IO1>::save(Archive& ar, const unsigned version) const {
 template<bi::Location CL, class IO1>
 template<class Archive>
 void bi::MCMCCache<CL,IO1>::load(Archive& ar, const unsigned version) {
+  sync();
   ar & boost::serialization::base_object < parent_type > (*this);
   ar & llCache;
   ar & lpCache;
@@ -19,6 +19,10 @@ namespace bi {
  *
  * @tparam CL Location.
  * @tparam IO1 Buffer type.
+ *
+ * Only times are cached; states are written to the output buffer as they
+ * are produced, and #flush writes synchronously. Output is written in the
+ * background only by MCMCCache and its derived caches.
  */
 template<Location CL = ON_HOST, class IO1 = SimulatorNullBuffer>
 class SimulatorCache: public IO1 {
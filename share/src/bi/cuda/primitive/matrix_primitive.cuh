@@ -18,6 +18,15 @@ struct gather_rows_impl<ON_DEVICE> {
   static void func(const V1 map, const M1 X, M2 Y);
 };
 
+/**
+ * @internal
+ */
+template<>
+struct gather_rows_permuted_impl<ON_DEVICE> {
+  template<class V1, class M1>
+  static void func(const V1 map, M1 X);
+};
+
 /**
  * @internal
  */
@@ -79,6 +88,14 @@ void bi::gather_rows_impl<bi::ON_DEVICE>::func(const V1 map, const M1 X,
   CUDA_CHECK;
 }
 
+template<class V1, class M1>
+void bi::gather_rows_permuted_impl<bi::ON_DEVICE>::func(const V1 map,
+    M1 X) {
+  /* each thread reads only rows that are not written, so the aliased
+   * gather is deterministic under a permuted map */
+  gather_rows_impl<ON_DEVICE>::func(map, X, X);
+}
+
 template<class V1, class M1, class M2>
 void bi::gather_columns_impl<bi::ON_DEVICE>::func(const V1 map, const M1 X,
     M2 Y) {
@@ -12,6 +12,8 @@
 #include "curand_kernel.h"
 #endif
 
+#include "../../math/scalar.hpp"
+
 namespace bi {
 /**
  * Pseudorandom number generator, on device.
@@ -20,6 +22,11 @@ namespace bi {
  */
 class RngGPU {
 public:
+  /**
+   * Variate type.
+   */
+  typedef real value_type;
+
   /**
    * @copydoc Random::seed
    */
@@ -75,6 +75,24 @@ public:
    */
   template<class S1, class IO1>
   void samplePath(Random& rng, S1& s, IO1& out);
+
+  /**
+   * Sample multiple paths from filter output.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param[out] X Paths. Rows index variables, columns index times, with
+   * each path in a block of <tt>out.len</tt> columns, as for
+   * AncestryCache::readPaths().
+   * @param out Output buffer.
+   *
+   * Sample <tt>X.size2()/out.len</tt> paths from the smooth distribution,
+   * reading them from the ancestry in a single pass.
+   */
+  template<class M1, class IO1>
+  void samplePaths(Random& rng, M1 X, IO1& out);
   //@}
 
   /**
@@ -96,6 +114,30 @@ public:
   template<class S1>
   void correct(Random& rng, const ScheduleElement now, S1& s);
 
+  /**
+   * Predict and correct over several steps of the schedule at once, one
+   * particle at a time.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of steps.
+   * @param last End of steps.
+   * @param[in,out] s State.
+   *
+   * Each particle is propagated through all steps, and weighted against
+   * the observation at the last step, if any, within one parallel region,
+   * using FusedSampler. Use #fusable to check that this is possible.
+   *
+   * Random variates of the transition are drawn from one stream per
+   * particle across all steps, rather than one per step, so that results
+   * agree with those of #predict and #correct in distribution, but not
+   * draw for draw, unless the transition is deterministic.
+   */
+  template<class S1>
+  void fuse(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s);
+
   /**
    * Resample.
    *
@@ -117,6 +159,33 @@ public:
   //@}
 
 protected:
+  /**
+   * Can steps of the schedule be predicted and corrected by #fuse?
+   *
+   * @tparam S1 State type.
+   *
+   * @param first Start of steps.
+   * @param last End of steps.
+   *
+   * @return True if the model supports it, the state is on host, SIMD is
+   * not enabled, and no steps, except the first, update inputs, and none,
+   * except the last, output or require a bridge weighting.
+   */
+  template<class S1>
+  static bool fusable(const ScheduleIterator first,
+      const ScheduleIterator last);
+
+  /**
+   * Update log-likelihood and effective sample size after weighting.
+   *
+   * @tparam S1 State type.
+   *
+   * @param now Current step in time schedule.
+   * @param s State.
+   */
+  template<class S1>
+  void reduce(const ScheduleElement now, S1& s);
+
   /**
    * Compute the maximum log-weight of a particle at the current time.
    *
@@ -136,9 +205,13 @@ protected:
 };
 }
 
+#include "../math/temp_vector.hpp"
 #include "../primitive/vector_primitive.hpp"
 #include "../primitive/matrix_primitive.hpp"
+#include "../primitive/arena_allocator.hpp"
 #include "../traits/resampler_traits.hpp"
+#include "../updater/FusedSampler.hpp"
+#include "../misc/Profiler.hpp"
 
 template<class B, class F, class O, class R>
 bi::BootstrapPF<B,F,O,R>::BootstrapPF(B& m, F& in, O& obs, R& resam) :
@@ -156,17 +229,50 @@ void bi::BootstrapPF<B,F,O,R>::samplePath(Random& rng, S1& s, IO1& out) {
   }
 }
 
+template<class B, class F, class O, class R>
+template<class M1, class IO1>
+void bi::BootstrapPF<B,F,O,R>::samplePaths(Random& rng, M1 X, IO1& out) {
+  /* pre-condition */
+  BI_ASSERT(out.len > 0 && X.size2() % out.len == 0);
+
+  if (out.size() > 0) {
+    BOOST_AUTO(lws1, out.getLogWeights());
+    typename temp_host_vector<real>::type lws(lws1.size());
+    typename temp_host_vector<int>::type ps(X.size2()/out.len);
+    lws = lws1;
+    synchronize(lws1.on_device);
+
+    rng.multinomials(lws, ps);
+    out.readPaths(ps, X);
+  }
+}
+
 template<class B, class F, class O, class R>
 template<class S1, class IO1>
 void bi::BootstrapPF<B,F,O,R>::step(Random& rng, ScheduleIterator& iter,
     const ScheduleIterator last, S1& s, IO1& out) {
-  do {
+  /* end of steps to the next observation */
+  ScheduleIterator end = iter + 1;
+  while (end + 1 != last && !end->isObserved()) {
+    ++end;
+  }
+  ++end;
+
+  if (fusable<S1>(iter + 1, end)) {
     this->resample(rng, *iter, s);
-    ++iter;
-    this->predict(rng, *iter, s);
-    this->correct(rng, *iter, s);
+    this->fuse(rng, iter + 1, end, s);
+    iter = end - 1;
     this->output(*iter, s, out);
-  } while (iter + 1 != last && !iter->isObserved());
+  } else {
+    do {
+      this->resample(rng, *iter, s);
+      ++iter;
+      this->predict(rng, *iter, s);
+      this->correct(rng, *iter, s);
+      this->output(*iter, s, out);
+    } while (iter + 1 != last && !iter->isObserved());
+  }
+  arena::step();
 }
 
 template<class B, class F, class O, class R>
@@ -174,20 +280,52 @@ template<class S1>
 void bi::BootstrapPF<B,F,O,R>::correct(Random& rng, const ScheduleElement now,
     S1& s) {
   if (now.isObserved()) {
+    ProfileScope scope(PROFILE_CORRECT);
     this->m.observationLogDensities(s, this->obs.getMask(now.indexObs()),
         s.logWeights());
-    double lW;
-    s.ess = resam.reduce(s.logWeights(), &lW);
-    s.logIncrements(now.indexObs()) = lW - s.logLikelihood;
-    s.logLikelihood = lW;
+    this->reduce(now, s);
   }
 }
 
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::BootstrapPF<B,F,O,R>::fuse(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s) {
+  /* pre-condition */
+  BI_ASSERT(fusable<S1>(first, last));
+
+  /* prediction and correction are not separable when fused, so that the
+   * whole counts as prediction */
+  ProfileScope scope(PROFILE_PREDICT);
+  const ScheduleElement now = *(last - 1);
+  ScheduleIterator iter;
+
+  /* the transition may not reference observations, so all updates may
+   * precede it */
+  for (iter = first; iter != last; ++iter) {
+    if (iter->hasInput()) {
+      this->in.update(iter->indexInput(), s);
+    }
+    if (iter->hasObs()) {
+      this->obs.update(iter->indexObs(), s);
+    }
+  }
+  if (now.isObserved()) {
+    FusedSampler<B>::samples(rng, first, last, s,
+        this->obs.getHostMask(now.indexObs()), s.logWeights());
+    this->reduce(now, s);
+  } else {
+    FusedSampler<B>::samples(rng, first, last, s);
+  }
+  s.setTime(now.getTime());
+}
+
 template<class B, class F, class O, class R>
 template<class S1>
 void bi::BootstrapPF<B,F,O,R>::resample(Random& rng,
     const ScheduleElement now, S1& s)
         throw (ParticleFilterDegeneratedException) {
+  ProfileScope scope(PROFILE_RESAMPLE);
   resam.resample(rng, now, s);
 }
 
@@ -199,6 +337,35 @@ void bi::BootstrapPF<B,F,O,R>::term(S1& s) {
   Simulator<B,F,O>::term(s);
 }
 
+template<class B, class F, class O, class R>
+template<class S1>
+bool bi::BootstrapPF<B,F,O,R>::fusable(const ScheduleIterator first,
+    const ScheduleIterator last) {
+  ScheduleIterator iter;
+  #ifdef ENABLE_SSE
+  /* the unfused updaters vectorise across particles, which outweighs the
+   * locality of fusing, as FusedSampler is scalar */
+  bool result = false;
+  #else
+  bool result = B::FUSED && !S1::on_device;
+  #endif
+
+  for (iter = first; result && iter != last; ++iter) {
+    result = !(iter != first && iter->hasInput())
+        && !(iter + 1 != last && (iter->hasOutput() || iter->hasBridge()));
+  }
+  return result;
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::BootstrapPF<B,F,O,R>::reduce(const ScheduleElement now, S1& s) {
+  double lW;
+  s.ess = resam.reduce(s.logWeights(), &lW);
+  s.logIncrements(now.indexObs()) = lW - s.logLikelihood;
+  s.logLikelihood = lW;
+}
+
 template<class B, class F, class O, class R>
 template<class S1>
 double bi::BootstrapPF<B,F,O,R>::getMaxLogWeight(const ScheduleElement now,
@@ -12,6 +12,7 @@
 #include "../state/ExtendedKFState.hpp"
 #include "../misc/location.hpp"
 #include "../misc/exception.hpp"
+#include "../misc/Profiler.hpp"
 
 namespace bi {
 /**
@@ -172,6 +173,8 @@ void bi::ExtendedKF<B,F,O>::predict(Random& rng, const ScheduleElement next,
     S1& s) throw (CholeskyException) {
   typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
 
+  ProfileScope scope(PROFILE_PREDICT);
+
   /* predict */
   Simulator<B,F,O>::predict(rng, next, s);
 
@@ -219,6 +222,7 @@ void bi::ExtendedKF<B,F,O>::correct(Random& rng, const ScheduleElement now,
   s.U2 = s.U1;
 
   if (now.isObserved()) {
+    ProfileScope scope(PROFILE_CORRECT);
     BOOST_AUTO(mask, this->obs.getMask(now.indexObs()));
     const int W = mask.size();
 
@@ -12,6 +12,7 @@
 #include "../state/Schedule.hpp"
 #include "../misc/TicToc.hpp"
 #include "../misc/macro.hpp"
+#include "../math/constant.hpp"
 
 namespace bi {
 /**
@@ -52,6 +53,42 @@ public:
   void filter(Random& rng, const ScheduleIterator first,
       const ScheduleIterator last, S1& s, IO1& out, TicToc& clock,
       const long deadline);
+
+  /**
+   * %Filter, with early rejection.
+   *
+   * @param threshold Log-likelihood below which the result is of no
+   * interest.
+   * @param bound Upper bound on the log-likelihood increment of each
+   * observation.
+   *
+   * @return Was the filter run to the end? If not, the log-likelihood of
+   * @p s is set to \f$-\infty\f$.
+   *
+   * Stops as soon as the log-likelihood so far, plus @p bound for each
+   * observation remaining, falls below @p threshold, so that the
+   * log-likelihood at the end could not reach it. The result of the test
+   * is then the same as if the filter had been run to the end.
+   */
+  template<class S1, class IO1>
+  bool filter(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s, IO1& out, const double threshold,
+      const double bound);
+
+private:
+  /**
+   * Could the log-likelihood still reach a threshold?
+   *
+   * @param iter Current position in time schedule.
+   * @param last End of time schedule.
+   * @param ll Log-likelihood so far.
+   * @param threshold Threshold.
+   * @param bound Upper bound on log-likelihood increment of each
+   * observation.
+   */
+  static bool reachable(const ScheduleIterator iter,
+      const ScheduleIterator last, const double ll, const double threshold,
+      const double bound);
 };
 }
 
@@ -93,4 +130,45 @@ void bi::Filter<F>::filter(Random& rng, const ScheduleIterator first,
   }
 }
 
+template<class F>
+template<class S1, class IO1>
+bool bi::Filter<F>::filter(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s, IO1& out, const double threshold,
+    const double bound) {
+  TicToc clock;
+  ScheduleIterator iter = first;
+  bool alive;
+
+  this->output0(s, out);
+  this->correct(rng, *iter, s);
+  this->output(*iter, s, out);
+  alive = reachable(iter, last, s.logLikelihood, threshold, bound);
+  while (alive && iter + 1 != last) {
+    this->step(rng, iter, last, s, out);
+    alive = reachable(iter, last, s.logLikelihood, threshold, bound);
+  }
+  if (alive) {
+    this->term(s);
+    s.clock = clock.toc();
+    this->outputT(s, out);
+  } else {
+    s.logLikelihood = -BI_INF;
+  }
+  return alive;
+}
+
+template<class F>
+inline bool bi::Filter<F>::reachable(const ScheduleIterator iter,
+    const ScheduleIterator last, const double ll, const double threshold,
+    const double bound) {
+  /* the observation at iter, if any, has already been corrected for */
+  const int remaining = last->indexObs() - iter->indexObs()
+      - (iter->isObserved() ? 1 : 0);
+  if (remaining > 0) {
+    return ll + remaining * bound >= threshold;
+  } else {
+    return ll >= threshold;
+  }
+}
+
 #endif
@@ -374,9 +374,15 @@ void bi::host_matrix_handle<T,size1_value,size2_value,lead_value,inc_value>::loa
   ar & rows & cols;
   BI_ASSERT(this->size1() == rows && this->size2() == cols);
 
+  /* columns as arrays where possible, which archives may copy as blocks */
   for (j = 0; j < cols; ++j) {
-    for (i = 0; i < rows; ++i) {
-      ar & (*this)(i, j);
+    if (this->inc() == 1) {
+      ar & boost::serialization::make_array(this->buf() + j*this->lead(),
+          rows);
+    } else {
+      for (i = 0; i < rows; ++i) {
+        ar & (*this)(i, j);
+      }
     }
   }
 }
@@ -390,8 +396,13 @@ void bi::host_matrix_handle<T,size1_value,size2_value,lead_value,inc_value>::sav
   ar & rows & cols;
 
   for (j = 0; j < cols; ++j) {
-    for (i = 0; i < rows; ++i) {
-      ar & (*this)(i, j);
+    if (this->inc() == 1) {
+      ar & boost::serialization::make_array(this->buf() + j*this->lead(),
+          rows);
+    } else {
+      for (i = 0; i < rows; ++i) {
+        ar & (*this)(i, j);
+      }
     }
   }
 }
@@ -95,6 +95,7 @@ struct multi_potrf_impl<ON_HOST,T1> {
 #include "cblas.hpp"
 #include "lapack.hpp"
 #include "qrupdate.hpp"
+#include "../../math/function.hpp"
 
 template<class T1>
 template<class M1, class V1, class V2>
@@ -126,22 +127,57 @@ template<class T1>
 template<class M1, class V1, class V2>
 void bi::multi_gemv_impl<bi::ON_HOST,T1>::func(const int P, const T1 alpha,
     const M1 As, const V1 xs, const T1 beta, V2 ys, const char transA) {
-  #pragma omp parallel
-  {
-    typename sim_temp_matrix<M1>::type A(As.size1()/P, As.size2());
-    typename sim_temp_vector<V1>::type x(xs.size()/P);
-    typename sim_temp_vector<V2>::type y(ys.size()/P);
-    int p;
-
-    #pragma omp for
-    for (p = 0; p < P; ++p) {
-      multi_get_matrix(P, As, p, A);
-      multi_get_vector(P, xs, p, x);
-      multi_get_vector(P, ys, p, y);
-
-      gemv(alpha, A, x, beta, y, transA);
-
-      multi_set_vector(P, ys, p, y);
+  if (transA == 'N' && As.inc() == 1 && xs.inc() == 1 && ys.inc() == 1) {
+    /* the interleaved layout puts the same element of all matrices and
+     * vectors contiguously, so loop over particles innermost, a chunk at a
+     * time, rather than gather each matrix for gemv */
+    const int M = ys.size()/P;
+    const int N = xs.size()/P;
+    const int chunk = 256;
+
+    #pragma omp parallel
+    {
+      int first, last, p, i, j;
+
+      #pragma omp for
+      for (first = 0; first < P; first += chunk) {
+        last = bi::min(P, first + chunk);
+        for (i = 0; i < M; ++i) {
+          T1* y = ys.buf() + i*P;
+          for (p = first; p < last; ++p) {
+            y[p] = (beta == static_cast<T1>(0.0)) ? static_cast<T1>(0.0) : beta*y[p];
+          }
+        }
+        for (j = 0; j < N; ++j) {
+          const T1* x = xs.buf() + j*P;
+          for (i = 0; i < M; ++i) {
+            const T1* a = As.buf() + j*As.lead() + i*P;
+            T1* y = ys.buf() + i*P;
+            for (p = first; p < last; ++p) {
+              y[p] += alpha*a[p]*x[p];
+            }
+          }
+        }
+      }
+    }
+  } else {
+    #pragma omp parallel
+    {
+      typename sim_temp_matrix<M1>::type A(As.size1()/P, As.size2());
+      typename sim_temp_vector<V1>::type x(xs.size()/P);
+      typename sim_temp_vector<V2>::type y(ys.size()/P);
+      int p;
+
+      #pragma omp for
+      for (p = 0; p < P; ++p) {
+        multi_get_matrix(P, As, p, A);
+        multi_get_vector(P, xs, p, x);
+        multi_get_vector(P, ys, p, y);
+
+        gemv(alpha, A, x, beta, y, transA);
+
+        multi_set_vector(P, ys, p, y);
+      }
     }
   }
 }
@@ -152,25 +188,62 @@ void bi::multi_gemm_impl<bi::ON_HOST,T1>::func(const int P,
     const typename M1::value_type alpha, const M1 As, const M2 Xs,
     const typename M3::value_type beta, M3 Ys, const char transA,
     const char transX) {
-  #pragma omp parallel
-  {
-    typename sim_temp_matrix<M1>::type A(As.size1()/P, As.size2());
-    typename sim_temp_matrix<M2>::type X(Xs.size1()/P, Xs.size2());
-    typename sim_temp_matrix<M2>::type Y(Ys.size1()/P, Ys.size2());
-    int p;
-
-    #pragma omp for
-    for (p = 0; p < P; ++p) {
-      multi_get_matrix(P, As, p, A);
-      multi_get_matrix(P, Xs, p, X);
-      multi_get_matrix(P, Ys, p, Y);
-
-      gemm(alpha, A, X, beta, Y, transA, transX);
-
-      multi_set_matrix(P, Ys, p, Y);
+  if (transA == 'N' && transX == 'N' && As.inc() == 1 && Xs.inc() == 1 &&
+      Ys.inc() == 1) {
+    /* as for multi_gemv, particles innermost */
+    const int M = Ys.size1()/P;
+    const int N = Xs.size1()/P;
+    const int K = Ys.size2();
+    const int chunk = 256;
+
+    #pragma omp parallel
+    {
+      int first, last, p, i, j, k;
+
+      #pragma omp for
+      for (first = 0; first < P; first += chunk) {
+        last = bi::min(P, first + chunk);
+        for (k = 0; k < K; ++k) {
+          for (i = 0; i < M; ++i) {
+            T1* y = Ys.buf() + k*Ys.lead() + i*P;
+            for (p = first; p < last; ++p) {
+              y[p] = (beta == static_cast<T1>(0.0)) ? static_cast<T1>(0.0) : beta*y[p];
+            }
+          }
+          for (j = 0; j < N; ++j) {
+            const T1* x = Xs.buf() + k*Xs.lead() + j*P;
+            for (i = 0; i < M; ++i) {
+              const T1* a = As.buf() + j*As.lead() + i*P;
+              T1* y = Ys.buf() + k*Ys.lead() + i*P;
+              for (p = first; p < last; ++p) {
+                y[p] += alpha*a[p]*x[p];
+              }
+            }
+          }
+        }
+      }
+    }
+  } else {
+    #pragma omp parallel
+    {
+      typename sim_temp_matrix<M1>::type A(As.size1()/P, As.size2());
+      typename sim_temp_matrix<M2>::type X(Xs.size1()/P, Xs.size2());
+      typename sim_temp_matrix<M2>::type Y(Ys.size1()/P, Ys.size2());
+      int p;
+
+      #pragma omp for
+      for (p = 0; p < P; ++p) {
+        multi_get_matrix(P, As, p, A);
+        multi_get_matrix(P, Xs, p, X);
+        multi_get_matrix(P, Ys, p, Y);
+
+        gemm(alpha, A, X, beta, Y, transA, transX);
+
+        multi_set_matrix(P, Ys, p, Y);
+      }
     }
   }
-};
+}
 
 template<class T1>
 template<class M1, class M2>
@@ -10,7 +10,7 @@
 
 #include "matrix.hpp"
 #include "../../primitive/pinned_allocator.hpp"
-#include "../../primitive/aligned_allocator.hpp"
+#include "../../primitive/arena_allocator.hpp"
 #include "../../primitive/pooled_allocator.hpp"
 #include "../../primitive/pipelined_allocator.hpp"
 
@@ -28,8 +28,9 @@ namespace bi {
  *
  * temp_host_matrix is a convenience class for producing matrices in main
  * memory that are suitable for short-term use before destruction. It uses
- * pooled_allocator to reuse allocated buffers, and when GPU devices
- * are enabled, pinned_allocator for faster copying between host and device.
+ * arena_allocator to reuse allocated buffers from thread-local free lists,
+ * and when GPU devices are enabled, pinned_allocator for faster copying
+ * between host and device.
  */
 template<class T, int size1_value = -1, int size2_value = -1, int lead_value =
     -1, int inc_value = 1>
@@ -37,14 +38,14 @@ struct temp_host_matrix {
   /**
    * Allocator type.
    *
-   * Note that, on host, pooled_allocator is slower than std::allocator. It
-   * is in avoiding calls to pinned_allocator (which internally calls
-   * cudaMallocHost) where there are some performance gains.
+   * With GPU devices, pooled_allocator avoids calls to pinned_allocator
+   * (which internally calls cudaMallocHost). Otherwise, arena_allocator
+   * serves each allocation in constant time without locks.
    */
   #ifdef ENABLE_CUDA
   typedef pipelined_allocator<pooled_allocator<pinned_allocator<T> > > allocator_type;
   #else
-  typedef pooled_allocator<aligned_allocator<T> > allocator_type;
+  typedef arena_allocator<T> allocator_type;
   #endif
 
   /**
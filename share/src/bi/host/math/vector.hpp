@@ -350,8 +350,12 @@ void bi::host_vector_handle<T,size_value,inc_value>::save(Archive& ar,
     const unsigned version) const {
   size_type size = this->size(), i;
   ar & size;
-  for (i = 0; i < size; ++i) {
-    ar & (*this)(i);
+  if (this->inc() == 1) {
+    ar & boost::serialization::make_array(this->buf(), size);
+  } else {
+    for (i = 0; i < size; ++i) {
+      ar & (*this)(i);
+    }
   }
 }
 
@@ -362,8 +366,14 @@ void bi::host_vector_handle<T,size_value,inc_value>::load(Archive& ar,
   size_type size, i;
   ar & size;
   BI_ASSERT(this->size() == size);
-  for (i = 0; i < size; ++i) {
-    ar & (*this)(i);
+
+  /* as an array where possible, which archives may copy as a block */
+  if (this->inc() == 1) {
+    ar & boost::serialization::make_array(this->buf(), size);
+  } else {
+    for (i = 0; i < size; ++i) {
+      ar & (*this)(i);
+    }
   }
 }
 
@@ -40,6 +40,8 @@ public:
 #include "../../typelist/pop_front.hpp"
 #include "../../traits/block_traits.hpp"
 #include "../../math/view.hpp"
+#include "../../misc/ParticleScheduler.hpp"
+#include "../../misc/Profiler.hpp"
 
 template<class B, class S, class T1>
 void bi::DOPRI5IntegratorHost<B,S,T1>::update(const T1 t1, const T1 t2,
@@ -54,92 +56,121 @@ void bi::DOPRI5IntegratorHost<B,S,T1>::update(const T1 t1, const T1 t2,
   static const int N = block_size<S>::value;
   const int P = s.size();
 
+  ParticleScheduler sched(P);
+
 #pragma omp parallel
   {
     vector_type x0(N), x1(N), x2(N), x3(N), x4(N), x5(N), x6(N), err(N), k1(
         N), k7(N);
     real t, h, e, e2, logfacold, logfac11, fac;
-    int n, id, p;
+    int n, id, p, first, last;
+    long nsteps = 0, nrejects = 0;
     bool k1in;
     PX pax;
-
-#pragma omp for
-    for (p = 0; p < P; ++p) {
-      t = t1;
-      h = h_h0;
-      logfacold = bi::log(BI_REAL(1.0e-4));
-      k1in = false;
-      n = 0;
-      host_load<B,S>(s, p, x0);
-
-      /* integrate */
-      while (t < t2 && n < h_nsteps) {
-        if (BI_REAL(0.1)*bi::abs(h) <= bi::abs(t)*h_uround) {
-          // step size too small
-        }
-        if (t + BI_REAL(1.01)*h - t2 > BI_REAL(0.0)) {
-          h = t2 - t;
-          if (h <= BI_REAL(0.0)) {
-            t = t2;
-            break;
+    #ifdef ENABLE_AOSOA
+    /* contiguous copy of the particles being integrated */
+    State<B,ON_HOST> tile(1);
+    tile.loadCommons(s);
+    #endif
+
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        #ifdef ENABLE_AOSOA
+        tile.loadTile(s, p);
+        State<B,ON_HOST>& s1 = tile;
+        const int p1 = 0;
+        #else
+        State<B,ON_HOST>& s1 = s;
+        const int p1 = p;
+        #endif
+
+        t = t1;
+        h = h_h0;
+        logfacold = bi::log(BI_REAL(1.0e-4));
+        k1in = false;
+        n = 0;
+        host_load<B,S>(s1, p1, x0);
+
+        /* integrate */
+        while (t < t2 && n < h_nsteps) {
+          if (BI_REAL(0.1)*bi::abs(h) <= bi::abs(t)*h_uround) {
+            // step size too small
+          }
+          if (t + BI_REAL(1.01)*h - t2 > BI_REAL(0.0)) {
+            h = t2 - t;
+            if (h <= BI_REAL(0.0)) {
+              t = t2;
+              break;
+            }
           }
-        }
 
-        /* stages */
-        Visitor::stage1(t, h, s, p, pax, x0.buf(), x1.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), k1.buf(), err.buf(), k1in);
-        k1in = true;  // can reuse from previous iteration in future
-        host_store<B,S>(s, p, x1);
+          /* stages */
+          Visitor::stage1(t, h, s1, p1, pax, x0.buf(), x1.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), k1.buf(), err.buf(), k1in);
+          k1in = true;  // can reuse from previous iteration in future
+          host_store<B,S>(s1, p1, x1);
 
-        Visitor::stage2(t, h, s, p, pax, x0.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
-        host_store<B,S>(s, p, x2);
+          Visitor::stage2(t, h, s1, p1, pax, x0.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
+          host_store<B,S>(s1, p1, x2);
 
-        Visitor::stage3(t, h, s, p, pax, x0.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
-        host_store<B,S>(s, p, x3);
+          Visitor::stage3(t, h, s1, p1, pax, x0.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
+          host_store<B,S>(s1, p1, x3);
 
-        Visitor::stage4(t, h, s, p, pax, x0.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
-        host_store<B,S>(s, p, x4);
+          Visitor::stage4(t, h, s1, p1, pax, x0.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
+          host_store<B,S>(s1, p1, x4);
 
-        Visitor::stage5(t, h, s, p, pax, x0.buf(), x5.buf(), x6.buf(), err.buf());
-        host_store<B,S>(s, p, x5);
+          Visitor::stage5(t, h, s1, p1, pax, x0.buf(), x5.buf(), x6.buf(), err.buf());
+          host_store<B,S>(s1, p1, x5);
 
-        Visitor::stage6(t, h, s, p, pax, x0.buf(), x6.buf(), err.buf());
+          Visitor::stage6(t, h, s1, p1, pax, x0.buf(), x6.buf(), err.buf());
 
-        /* compute error */
-        Visitor::stageErr(t, h, s, p, pax, x0.buf(), x6.buf(), k7.buf(), err.buf());
-        e2 = 0.0;
-        for (id = 0; id < N; ++id) {
-          e = err(id)*h/(h_atoler + h_rtoler*bi::max(bi::abs(x0(id)), bi::abs(x6(id))));
-          e2 += e*e;
-        }
-        e2 /= N;
-
-        /* accept/reject */
-        if (e2 <= BI_REAL(1.0)) {
-          /* accept */
-          t += h;
-          x0.swap(x6);
-          k1.swap(k7);
-        }
-        host_store<B,S>(s, p, x0);
-
-        /* compute next step size */
-        if (t < t2) {
-          logfac11 = h_expo*bi::log(e2);
-          if (e2 > BI_REAL(1.0)) {
-            /* step was rejected */
-            h *= bi::max(h_facl, bi::exp(h_logsafe - logfac11));
+          /* compute error */
+          Visitor::stageErr(t, h, s1, p1, pax, x0.buf(), x6.buf(), k7.buf(), err.buf());
+          e2 = 0.0;
+          for (id = 0; id < N; ++id) {
+            e = err(id)*h/(h_atoler + h_rtoler*bi::max(bi::abs(x0(id)), bi::abs(x6(id))));
+            e2 += e*e;
+          }
+          e2 /= N;
+
+          /* accept/reject */
+          if (e2 <= BI_REAL(1.0)) {
+            /* accept */
+            t += h;
+            x0.swap(x6);
+            k1.swap(k7);
           } else {
-            /* step was accepted */
-            fac = bi::exp(h_beta*logfacold + h_logsafe - logfac11);  // Lund-stabilization
-            fac = bi::min(h_facr, bi::max(h_facl, fac));// bound
-            h *= fac;
-            logfacold = BI_REAL(0.5)*bi::log(bi::max(e2, BI_REAL(1.0e-8)));
+            ++nrejects;
           }
+          host_store<B,S>(s1, p1, x0);
+
+          /* compute next step size */
+          if (t < t2) {
+            logfac11 = h_expo*bi::log(e2);
+            if (e2 > BI_REAL(1.0)) {
+              /* step was rejected */
+              h *= bi::max(h_facl, bi::exp(h_logsafe - logfac11));
+            } else {
+              /* step was accepted */
+              fac = bi::exp(h_beta*logfacold + h_logsafe - logfac11);  // Lund-stabilization
+              fac = bi::min(h_facr, bi::max(h_facl, fac));// bound
+              h *= fac;
+              logfacold = BI_REAL(0.5)*bi::log(bi::max(e2, BI_REAL(1.0e-8)));
+            }
+          }
+
+          ++n;
         }
+        nsteps += n;
 
-        ++n;
+        #ifdef ENABLE_AOSOA
+        /* write back only the variables updated */
+        host_load<B,S>(tile, 0, x0);
+        host_store<B,S>(s, p, x0);
+        #endif
       }
     }
+    Profiler::count(PROFILE_ODE_STEPS, nsteps);
+    Profiler::count(PROFILE_ODE_REJECTS, nrejects);
   }
 }
 
@@ -44,6 +44,8 @@ public:
 #include "../../typelist/pop_front.hpp"
 #include "../../traits/block_traits.hpp"
 #include "../../math/view.hpp"
+#include "../../misc/ParticleScheduler.hpp"
+#include "../../misc/Profiler.hpp"
 #include "../../math/temp_vector.hpp"
 
 template<class B, class S, class T1>
@@ -59,89 +61,117 @@ void bi::RK43IntegratorHost<B,S,T1>::update(const T1 t1, const T1 t2,
   static const int N = block_size<S>::value;
   const int P = s.size();
 
+  ParticleScheduler sched(P);
+
   #pragma omp parallel
   {
     vector_type r1(N), r2(N), err(N), old(N);
     real t, h, e, e2, logfacold, logfac11, fac;
-    int n, id, p;
+    int n, id, p, first, last;
+    long nsteps = 0, nrejects = 0;
     PX pax;
-
-    #pragma omp for
-    for (p = 0; p < P; ++p) {
-      t = t1;
-      h = h_h0;
-      logfacold = bi::log(BI_REAL(1.0e-4));
-      n = 0;
-      host_load<B,S>(s, p, old);
-      r1 = old;
-
-      /* integrate */
-      while (t < t2 && n < h_nsteps) {
-        if (BI_REAL(0.1)*bi::abs(h) <= bi::abs(t)*h_uround) {
-          // step size too small
-        }
-        if (t + BI_REAL(1.01)*h - t2 > BI_REAL(0.0)) {
-          h = t2 - t;
-          if (h <= BI_REAL(0.0)) {
-            t = t2;
-            break;
+    #ifdef ENABLE_AOSOA
+    /* contiguous copy of the particles being integrated */
+    State<B,ON_HOST> tile(1);
+    tile.loadCommons(s);
+    #endif
+
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        #ifdef ENABLE_AOSOA
+        tile.loadTile(s, p);
+        State<B,ON_HOST>& s1 = tile;
+        const int p1 = 0;
+        #else
+        State<B,ON_HOST>& s1 = s;
+        const int p1 = p;
+        #endif
+
+        t = t1;
+        h = h_h0;
+        logfacold = bi::log(BI_REAL(1.0e-4));
+        n = 0;
+        host_load<B,S>(s1, p1, old);
+        r1 = old;
+
+        /* integrate */
+        while (t < t2 && n < h_nsteps) {
+          if (BI_REAL(0.1)*bi::abs(h) <= bi::abs(t)*h_uround) {
+            // step size too small
+          }
+          if (t + BI_REAL(1.01)*h - t2 > BI_REAL(0.0)) {
+            h = t2 - t;
+            if (h <= BI_REAL(0.0)) {
+              t = t2;
+              break;
+            }
           }
-        }
 
-        /* stages */
-        Visitor::stage1(t, h, s, p, pax, r1.buf(), r2.buf(), err.buf());
-        host_store<B,S>(s, p, r1);
+          /* stages */
+          Visitor::stage1(t, h, s1, p1, pax, r1.buf(), r2.buf(), err.buf());
+          host_store<B,S>(s1, p1, r1);
 
-        Visitor::stage2(t, h, s, p, pax, r1.buf(), r2.buf(), err.buf());
-        host_store<B,S>(s, p, r2);
+          Visitor::stage2(t, h, s1, p1, pax, r1.buf(), r2.buf(), err.buf());
+          host_store<B,S>(s1, p1, r2);
 
-        Visitor::stage3(t, h, s, p, pax, r1.buf(), r2.buf(), err.buf());
-        host_store<B,S>(s, p, r1);
+          Visitor::stage3(t, h, s1, p1, pax, r1.buf(), r2.buf(), err.buf());
+          host_store<B,S>(s1, p1, r1);
 
-        Visitor::stage4(t, h, s, p, pax, r1.buf(), r2.buf(), err.buf());
-        host_store<B,S>(s, p, r2);
+          Visitor::stage4(t, h, s1, p1, pax, r1.buf(), r2.buf(), err.buf());
+          host_store<B,S>(s1, p1, r2);
 
-        Visitor::stage5(t, h, s, p, pax, r1.buf(), r2.buf(), err.buf());
-        host_store<B,S>(s, p, r1);
+          Visitor::stage5(t, h, s1, p1, pax, r1.buf(), r2.buf(), err.buf());
+          host_store<B,S>(s1, p1, r1);
 
-        /* compute error */
-        e2 = BI_REAL(0.0);
-        for (id = 0; id < N; ++id) {
-          e = err(id)*h/(h_atoler + h_rtoler*bi::max(bi::abs(old(id)), bi::abs(r1(id))));
-          e2 += e*e;
-        }
-        e2 /= N;
+          /* compute error */
+          e2 = BI_REAL(0.0);
+          for (id = 0; id < N; ++id) {
+            e = err(id)*h/(h_atoler + h_rtoler*bi::max(bi::abs(old(id)), bi::abs(r1(id))));
+            e2 += e*e;
+          }
+          e2 /= N;
+
+          if (e2 <= BI_REAL(1.0)) {
+            /* accept */
+            t += h;
+            if (t < t2) {
+              old = r1;
+            }
+          } else {
+            /* reject */
+            r1 = old;
+            host_store<B,S>(s1, p1, old);
+            ++nrejects;
+          }
 
-        if (e2 <= BI_REAL(1.0)) {
-          /* accept */
-          t += h;
+          /* compute next step size */
           if (t < t2) {
-            old = r1;
+            logfac11 = h_expo*bi::log(e2);
+            if (e2 > BI_REAL(1.0)) {
+              /* step was rejected */
+              h *= bi::max(h_facl, bi::exp(h_logsafe - logfac11));
+            } else {
+              /* step was accepted */
+              fac = bi::exp(h_beta*logfacold + h_logsafe - logfac11); // Lund-stabilization
+              fac = bi::min(h_facr, bi::max(h_facl, fac)); // bound
+              h *= fac;
+              logfacold = BI_REAL(0.5)*bi::log(bi::max(e2, BI_REAL(1.0e-8)));
+            }
           }
-        } else {
-          /* reject */
-          r1 = old;
-          host_store<B,S>(s, p, old);
-        }
 
-        /* compute next step size */
-        if (t < t2) {
-          logfac11 = h_expo*bi::log(e2);
-          if (e2 > BI_REAL(1.0)) {
-            /* step was rejected */
-            h *= bi::max(h_facl, bi::exp(h_logsafe - logfac11));
-          } else {
-            /* step was accepted */
-            fac = bi::exp(h_beta*logfacold + h_logsafe - logfac11); // Lund-stabilization
-            fac = bi::min(h_facr, bi::max(h_facl, fac)); // bound
-            h *= fac;
-            logfacold = BI_REAL(0.5)*bi::log(bi::max(e2, BI_REAL(1.0e-8)));
-          }
+          ++n;
         }
+        nsteps += n;
 
-        ++n;
+        #ifdef ENABLE_AOSOA
+        /* write back only the variables updated */
+        host_load<B,S>(tile, 0, x0);
+        host_store<B,S>(s, p, x0);
+        #endif
       }
     }
+    Profiler::count(PROFILE_ODE_STEPS, nsteps);
+    Profiler::count(PROFILE_ODE_REJECTS, nrejects);
   }
 }
 
@@ -17,7 +17,7 @@ namespace bi {
  * @tparam B Model type.
  * @tparam S1 Action type list.
  * @tparam S2 Action type list.
- * @tparam T1 Scalar type.
+ * @tparam T1 Type of time and step size, scalar or SIMD.
  * @tparam PX Parents type.
  * @tparam T2 Scalar type.
  */
@@ -40,6 +40,8 @@ public:
 #include "../../typelist/pop_front.hpp"
 #include "../../traits/block_traits.hpp"
 #include "../../math/view.hpp"
+#include "../../misc/ParticleScheduler.hpp"
+#include "../../misc/Profiler.hpp"
 
 template<class B, class S, class T1>
 void bi::RK4IntegratorHost<B,S,T1>::update(const T1 t1, const T1 t2,
@@ -54,50 +56,76 @@ void bi::RK4IntegratorHost<B,S,T1>::update(const T1 t1, const T1 t2,
   static const int N = block_size<S>::value;
   const int P = s.size();
 
+  ParticleScheduler sched(P);
+
   #pragma omp parallel
   {
     vector_type x0(N), x1(N), x2(N), x3(N), x4(N);
     real t, h;
-    int p;
+    int p, first, last;
+    long nsteps = 0;
     PX pax;
+    #ifdef ENABLE_AOSOA
+    /* contiguous copy of the particles being integrated */
+    State<B,ON_HOST> tile(1);
+    tile.loadCommons(s);
+    #endif
 
-    #pragma omp for
-    for (p = 0; p < P; ++p) {
-      t = t1;
-      h = h_h0;
-      host_load<B,S>(s, p, x0);
-
-      /* integrate */
-      while (t < t2) {
-        /* initialise */
-        if (BI_REAL(0.1)*bi::abs(h) <= bi::abs(t)*h_uround) {
-          // step size too small
-        }
-        if (t + BI_REAL(1.01)*h - t2 > BI_REAL(0.0)) {
-          h = t2 - t;
-          if (h <= BI_REAL(0.0)) {
-            t = t2;
-            break;
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        #ifdef ENABLE_AOSOA
+        tile.loadTile(s, p);
+        State<B,ON_HOST>& s1 = tile;
+        const int p1 = 0;
+        #else
+        State<B,ON_HOST>& s1 = s;
+        const int p1 = p;
+        #endif
+
+        t = t1;
+        h = h_h0;
+        host_load<B,S>(s1, p1, x0);
+
+        /* integrate */
+        while (t < t2) {
+          /* initialise */
+          if (BI_REAL(0.1)*bi::abs(h) <= bi::abs(t)*h_uround) {
+            // step size too small
+          }
+          if (t + BI_REAL(1.01)*h - t2 > BI_REAL(0.0)) {
+            h = t2 - t;
+            if (h <= BI_REAL(0.0)) {
+              t = t2;
+              break;
+            }
           }
-        }
 
-        /* stages */
-        Visitor::stage1(t, h, s, p, pax, x0.buf(), x1.buf(), x2.buf(), x3.buf(), x4.buf());
-        host_store<B,S>(s, p, x1);
+          /* stages */
+          Visitor::stage1(t, h, s1, p1, pax, x0.buf(), x1.buf(), x2.buf(), x3.buf(), x4.buf());
+          host_store<B,S>(s1, p1, x1);
 
-        Visitor::stage2(t, h, s, p, pax, x0.buf(), x2.buf(), x3.buf(), x4.buf());
-        host_store<B,S>(s, p, x2);
+          Visitor::stage2(t, h, s1, p1, pax, x0.buf(), x2.buf(), x3.buf(), x4.buf());
+          host_store<B,S>(s1, p1, x2);
 
-        Visitor::stage3(t, h, s, p, pax, x0.buf(), x3.buf(), x4.buf());
-        host_store<B,S>(s, p, x3);
+          Visitor::stage3(t, h, s1, p1, pax, x0.buf(), x3.buf(), x4.buf());
+          host_store<B,S>(s1, p1, x3);
 
-        Visitor::stage4(t, h, s, p, pax, x0.buf(), x4.buf());
-        host_store<B,S>(s, p, x4);
+          Visitor::stage4(t, h, s1, p1, pax, x0.buf(), x4.buf());
+          host_store<B,S>(s1, p1, x4);
+
+          x0.swap(x4);
+          t += h;
+          ++nsteps;
+        }
 
-        x0.swap(x4);
-        t += h;
+        #ifdef ENABLE_AOSOA
+        /* write back only the variables updated */
+        host_load<B,S>(tile, 0, x0);
+        host_store<B,S>(s, p, x0);
+        #endif
       }
     }
+    Profiler::count(PROFILE_ODE_STEPS, nsteps);
   }
 }
 
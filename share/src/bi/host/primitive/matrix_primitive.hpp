@@ -18,6 +18,15 @@ struct gather_rows_impl<ON_HOST> {
   static void func(const V1 map, const M1 X, M2 Y);
 };
 
+/**
+ * @internal
+ */
+template<>
+struct gather_rows_permuted_impl<ON_HOST> {
+  template<class V1, class M1>
+  static void func(const V1 map, M1 X);
+};
+
 /**
  * @internal
  */
@@ -76,6 +85,51 @@ void bi::gather_rows_impl<bi::ON_HOST>::func(const V1 map, const M1 X, M2 Y) {
   }
 }
 
+template<class V1, class M1>
+void bi::gather_rows_permuted_impl<bi::ON_HOST>::func(const V1 map, M1 X) {
+  typedef typename M1::value_type T1;
+
+  /* tile size, rows by columns, chosen so that a tile of a few thousand
+   * state variables stays in L1/L2 */
+  static const int R = 1024;
+  static const int C = 16;
+
+  const int P = map.size();
+  const int N = X.size2();
+  const int ld = X.lead();
+  const int inc = X.inc();
+  T1* buf = X.buf();
+
+  /* rows to replace; the others keep their own particle */
+  typename temp_host_vector<int>::type is(P);
+  int i, n = 0;
+  for (i = 0; i < P; ++i) {
+    if (map(i) != i) {
+      is(n++) = i;
+    }
+  }
+
+  if (n > 0) {
+    const int nr = (n + R - 1)/R;
+    const int nc = (N + C - 1)/C;
+    int tile;
+
+    #pragma omp parallel for schedule(static)
+    for (tile = 0; tile < nr*nc; ++tile) {
+      const int k1 = (tile % nr)*R, k2 = bi::min(k1 + R, n);
+      const int j1 = (tile / nr)*C, j2 = bi::min(j1 + C, N);
+      int j, k;
+
+      for (j = j1; j < j2; ++j) {
+        T1* col = buf + j*ld;
+        for (k = k1; k < k2; ++k) {
+          col[is(k)*inc] = col[map(is(k))*inc];
+        }
+      }
+    }
+  }
+}
+
 template<class V1, class M1, class M2>
 void bi::gather_columns_impl<bi::ON_HOST>::func(const V1 map, const M1 X,
     M2 Y) {
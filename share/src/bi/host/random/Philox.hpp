@@ -0,0 +1,176 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_HOST_RANDOM_PHILOX_HPP
+#define BI_HOST_RANDOM_PHILOX_HPP
+
+#include "boost/cstdint.hpp"
+
+namespace bi {
+/**
+ * Counter-based pseudorandom number generator, on host.
+ *
+ * @ingroup math_rng
+ *
+ * Implements the Philox4x32-10 algorithm of @ref Salmon2011 "Salmon et al.
+ * (2011)". Each 128-bit counter is mapped, under a 64-bit key, to four
+ * 32-bit outputs by ten rounds of a bijection, so that any position in any
+ * stream can be reached in constant time. The counter is laid out as
+ * <tt>(block, c1, c2, c3)</tt>, where @c block is incremented as variates
+ * are drawn, and the remaining three words identify the stream (see
+ * #setCounter).
+ *
+ * Models the uniform random number generator concept of Boost.Random, so
+ * may be used in place of boost::mt19937 with the Boost distributions.
+ *
+ * @section Philox_references References
+ *
+ * @anchor Salmon2011 Salmon, J. K.; Moraes, M. A.; Dror, R. O. and Shaw,
+ * D. E. Parallel random numbers: As easy as 1, 2, 3. <i>Proceedings of
+ * the International Conference for High Performance Computing, Networking,
+ * Storage and Analysis (SC11)</i>, <b>2011</b>.
+ */
+class Philox4x32 {
+public:
+  typedef boost::uint32_t result_type;
+
+  static const bool has_fixed_range = false;
+
+  /**
+   * Constructor.
+   *
+   * @param seed Seed value.
+   */
+  Philox4x32(const unsigned seed = 0);
+
+  /**
+   * Seed, resetting the counter.
+   *
+   * @param seed Seed value, used as the first word of the key.
+   * @param seed2 Second word of the key.
+   */
+  void seed(const unsigned seed, const unsigned seed2 = 0);
+
+  /**
+   * Set the stream, resetting the block counter.
+   *
+   * @param c1 Second word of the counter.
+   * @param c2 Third word of the counter.
+   * @param c3 Fourth word of the counter.
+   */
+  void setCounter(const unsigned c1, const unsigned c2, const unsigned c3);
+
+  /**
+   * Generate a variate.
+   */
+  result_type operator()();
+
+  /**
+   * Minimum variate.
+   */
+  static result_type min();
+
+  /**
+   * Maximum variate.
+   */
+  static result_type max();
+
+  /**
+   * Apply the Philox4x32-10 bijection.
+   *
+   * @param ctr Counter.
+   * @param key Key.
+   * @param[out] out Output.
+   */
+  static void block(const result_type ctr[4], const result_type key[2],
+      result_type out[4]);
+
+private:
+  /**
+   * Key.
+   */
+  result_type key[2];
+
+  /**
+   * Counter.
+   */
+  result_type ctr[4];
+
+  /**
+   * Output of the bijection for the current counter.
+   */
+  result_type buf[4];
+
+  /**
+   * Position of the next variate in #buf.
+   */
+  int pos;
+};
+}
+
+inline bi::Philox4x32::Philox4x32(const unsigned seed) {
+  this->seed(seed);
+}
+
+inline void bi::Philox4x32::seed(const unsigned seed, const unsigned seed2) {
+  key[0] = seed;
+  key[1] = seed2;
+  setCounter(0, 0, 0);
+}
+
+inline void bi::Philox4x32::setCounter(const unsigned c1, const unsigned c2,
+    const unsigned c3) {
+  ctr[0] = 0;
+  ctr[1] = c1;
+  ctr[2] = c2;
+  ctr[3] = c3;
+  pos = 4;
+}
+
+inline bi::Philox4x32::result_type bi::Philox4x32::operator()() {
+  if (pos == 4) {
+    block(ctr, key, buf);
+    ++ctr[0];
+    pos = 0;
+  }
+  return buf[pos++];
+}
+
+inline bi::Philox4x32::result_type bi::Philox4x32::min() {
+  return 0;
+}
+
+inline bi::Philox4x32::result_type bi::Philox4x32::max() {
+  return 0xFFFFFFFFu;
+}
+
+inline void bi::Philox4x32::block(const result_type ctr[4],
+    const result_type key[2], result_type out[4]) {
+  static const boost::uint64_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+  static const result_type W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+
+  result_type x0 = ctr[0], x1 = ctr[1], x2 = ctr[2], x3 = ctr[3];
+  result_type k0 = key[0], k1 = key[1];
+  boost::uint64_t p0, p1;
+
+  for (int i = 0; i < 10; ++i) {
+    p0 = M0*x0;
+    p1 = M1*x2;
+    x0 = static_cast<result_type>(p1 >> 32) ^ x1 ^ k0;
+    x2 = static_cast<result_type>(p0 >> 32) ^ x3 ^ k1;
+    x1 = static_cast<result_type>(p1);
+    x3 = static_cast<result_type>(p0);
+    k0 += W0;
+    k1 += W1;
+  }
+  out[0] = x0;
+  out[1] = x1;
+  out[2] = x2;
+  out[3] = x3;
+}
+
+#endif
@@ -17,13 +17,20 @@ void bi::RandomHost::seeds(Random& rng, const unsigned seed) {
     #ifdef ENABLE_MPI
     boost::mpi::communicator world;
     const int rank = world.rank();
-    const int size = world.size();
-
-    int s = seed*size*bi_omp_max_threads + rank*bi_omp_max_threads + bi_omp_tid;
     #else
-    int s = seed*bi_omp_max_threads + bi_omp_tid;
+    const int rank = 0;
     #endif
 
+    #ifdef ENABLE_PHILOX
+    rng.getHostRng().seed(seed, rank, bi_omp_thread_id());
+    #else
+    #ifdef ENABLE_MPI
+    const int size = world.size();
+    #else
+    const int size = 1;
+    #endif
+    int s = seed*size*bi_omp_max_threads + rank*bi_omp_max_threads + bi_omp_thread_id();
     rng.getHostRng().seed(s);
+    #endif
   }
 }
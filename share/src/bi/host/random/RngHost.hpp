@@ -8,7 +8,15 @@
 #ifndef BI_HOST_RANDOM_RNG_HPP
 #define BI_HOST_RANDOM_RNG_HPP
 
+#ifdef ENABLE_PHILOX
+#include "Philox.hpp"
+#else
 #include "boost/random/mersenne_twister.hpp"
+#endif
+
+#include "../../math/scalar.hpp"
+
+#include "boost/cstdint.hpp"
 
 namespace bi {
 /**
@@ -17,7 +25,20 @@ namespace bi {
  * @ingroup math_rng
  *
  * Uses the Mersenne Twister algorithm for generating pseudorandom variates,
- * as implemented in Boost.Random.
+ * as implemented in Boost.Random, or, when compiled with ENABLE_PHILOX, the
+ * counter-based Philox4x32 generator.
+ *
+ * With Philox4x32, variates drawn between #setStream and #unsetStream are
+ * a function of only the seed, the particle index and the step key.
+ * Samplers position the stream before each particle (or pack of
+ * particles, with SSE), and the stratified and multinomial resamplers
+ * before each stratum or block of ancestors, so that results are
+ * bit-identical regardless of the number of threads, or of which thread
+ * handles which particle. Likewise, MarginalSIR positions the thread's own
+ * stream before the filter of each \f$\theta\f$-particle with
+ * #setTaskStream, so that results do not depend on which group of threads
+ * runs which filter. With the Mersenne Twister, these calls do nothing, and
+ * each thread draws from its own sequence.
  *
  * @section RngHost_references References
  *
@@ -28,6 +49,16 @@ namespace bi {
  */
 class RngHost {
 public:
+  /**
+   * Variate type.
+   */
+  typedef real value_type;
+
+  /**
+   * Constructor.
+   */
+  RngHost();
+
   /**
    * Seed random number generator.
    *
@@ -35,6 +66,62 @@ public:
    */
   void seed(const unsigned seed);
 
+  #ifdef ENABLE_PHILOX
+  /**
+   * Seed random number generator.
+   *
+   * @param seed Seed value.
+   * @param rank Process rank.
+   * @param tid Thread id.
+   *
+   * The key is formed from @p seed and @p rank only, and @p tid selects
+   * this thread's own stream, so that particle streams are shared by all
+   * threads.
+   */
+  void seed(const unsigned seed, const unsigned rank, const int tid);
+  #endif
+
+  /**
+   * Start a new step of particle streams. Call outside of #setStream.
+   *
+   * @return Step key, to pass to #setStream.
+   *
+   * The key is drawn from this thread's own stream, so that threads
+   * running separate filters concurrently do not share particle streams.
+   * From serial code, the key does not depend on the number of threads.
+   */
+  boost::uint64_t nextStep();
+
+  /**
+   * Switch to the stream of a particle.
+   *
+   * @param p Particle index.
+   * @param k Step key, from #nextStep.
+   */
+  void setStream(const int p, const boost::uint64_t k);
+
+  /**
+   * Switch back to this thread's own stream after #setStream.
+   */
+  void unsetStream();
+
+  /**
+   * Replace this thread's own stream with that of a task, such as the
+   * filter of one \f$\theta\f$-particle. Call outside of #setStream.
+   *
+   * @param p Task index.
+   * @param k Step key, from #nextStep.
+   *
+   * Within the task, #nextStep, #setStream and #unsetStream behave as
+   * usual, but on the stream of the task.
+   */
+  void setTaskStream(const int p, const boost::uint64_t k);
+
+  /**
+   * Restore this thread's own stream after #setTaskStream.
+   */
+  void unsetTaskStream();
+
   /**
    * @copydoc Random::uniformInt
    */
@@ -80,12 +167,39 @@ public:
   /**
    * Random number generator type.
    */
+  #ifdef ENABLE_PHILOX
+  typedef Philox4x32 rng_type;
+  #else
   typedef boost::mt19937 rng_type;
+  #endif
 
   /**
    * Random number generator.
    */
   rng_type rng;
+
+#ifdef ENABLE_PHILOX
+private:
+  /**
+   * This thread's own stream, saved while in a particle stream.
+   */
+  rng_type own;
+
+  /**
+   * Is a particle stream in use?
+   */
+  bool inStream;
+
+  /**
+   * This thread's own stream, saved while in a task stream.
+   */
+  rng_type base;
+
+  /**
+   * Is a task stream in use?
+   */
+  bool inTask;
+#endif
 };
 }
 
@@ -102,8 +216,96 @@ public:
 
 #include "thrust/binary_search.h"
 
+inline bi::RngHost::RngHost() {
+  #ifdef ENABLE_PHILOX
+  inStream = false;
+  inTask = false;
+  #endif
+}
+
 inline void bi::RngHost::seed(const unsigned seed) {
+  #ifdef ENABLE_PHILOX
+  this->seed(seed, 0, 0);
+  #else
   rng.seed(seed);
+  #endif
+}
+
+#ifdef ENABLE_PHILOX
+inline void bi::RngHost::seed(const unsigned seed, const unsigned rank,
+    const int tid) {
+  rng.seed(seed, rank);
+  rng.setCounter(0, 0, tid + 1);
+  inStream = false;
+  inTask = false;
+}
+#endif
+
+inline boost::uint64_t bi::RngHost::nextStep() {
+  #ifdef ENABLE_PHILOX
+  /* pre-condition */
+  BI_ASSERT(!inStream);
+
+  boost::uint64_t k = rng();
+  return (k << 32) | rng();
+  #else
+  return 0;
+  #endif
+}
+
+inline void bi::RngHost::setStream(const int p, const boost::uint64_t k) {
+  #ifdef ENABLE_PHILOX
+  /* pre-condition */
+  BI_ASSERT(p >= 0);
+
+  if (!inStream) {
+    own = rng;
+    inStream = true;
+  }
+
+  /* thread streams have zero in the second and third words of the
+   * counter, so overlap a particle stream with probability 2^-64 */
+  rng.setCounter(p, static_cast<unsigned>(k), static_cast<unsigned>(k >> 32));
+  #endif
+}
+
+inline void bi::RngHost::unsetStream() {
+  #ifdef ENABLE_PHILOX
+  if (inStream) {
+    rng = own;
+    inStream = false;
+  }
+  #endif
+}
+
+inline void bi::RngHost::setTaskStream(const int p,
+    const boost::uint64_t k) {
+  #ifdef ENABLE_PHILOX
+  /* pre-conditions */
+  BI_ASSERT(p >= 0);
+  BI_ASSERT(!inStream);
+
+  if (!inTask) {
+    base = rng;
+    inTask = true;
+  }
+
+  /* as for a particle stream; the particle streams of the task have keys
+   * drawn from this one, so overlap it with probability 2^-64 */
+  rng.setCounter(p, static_cast<unsigned>(k), static_cast<unsigned>(k >> 32));
+  #endif
+}
+
+inline void bi::RngHost::unsetTaskStream() {
+  #ifdef ENABLE_PHILOX
+  /* pre-condition */
+  BI_ASSERT(!inStream);
+
+  if (inTask) {
+    rng = base;
+    inTask = false;
+  }
+  #endif
 }
 
 template<class T1>
@@ -18,47 +18,101 @@ class MultinomialResamplerHost: public ResamplerHost {
 public:
   /**
    * Select ancestors, sorted in ascending order by construction. The basis
-   * of this implementation is the generation of sorted random variates
-   * using the method of @ref Bentley1979 "Bentley & Saxe (1979)".
+   * of this implementation is the generation of sorted random variates as
+   * the normalised partial sums of exponential variates
+   * (@ref Devroye1986 "Devroye, 1986", ch. 5).
+   *
+   * Ancestors are selected in blocks of fixed size. Each block draws its
+   * exponential variates from its own stream (see RngHost::setStream),
+   * twice: once for the sum of the block, and again, after a prefix sum
+   * over blocks, to select its ancestors. With ENABLE_PHILOX, results
+   * therefore do not depend on the number of threads.
    */
   template<class V1, class V2>
   static void ancestors(Random& rng, const V1 lws, V2 as,
       ScanResamplerPrecompute<ON_HOST>& pre)
           throw (ParticleFilterDegeneratedException);
+
+private:
+  /**
+   * Number of ancestors in each block.
+   */
+  static const int BLOCK = 1024;
 };
 }
 
+#include "../../math/function.hpp"
+
+#include "thrust/binary_search.h"
+
+#include <vector>
+
 template<class V1, class V2>
 void bi::MultinomialResamplerHost::ancestors(Random& rng, const V1 lws, V2 as,
     ScanResamplerPrecompute<ON_HOST>& pre)
     throw (ParticleFilterDegeneratedException) {
-  typedef typename V1::value_type T1;
-
   const int P = as.size();
   const int lwsSize = lws.size();
+  const int B = (P + BLOCK - 1)/BLOCK;
 
   if (pre.W > 0) {
-    const T1 lW = bi::log(pre.W);
+    const boost::uint64_t step = rng.getHostRng().nextStep();
+
+    /* sum of exponential variates of each block, then, after the prefix
+     * sum, the sum of those of all preceding blocks, with the sum of all
+     * last; the extra variate of the last block normalises */
+    std::vector<double> sums(B + 1);
 
     #pragma omp parallel
     {
-      int Q = P/bi_omp_max_threads;
-      int start = bi_omp_tid*Q + bi::min(bi_omp_tid, P % bi_omp_max_threads); // min() handles leftovers
-      if (bi_omp_tid < P % bi_omp_max_threads) {
-        ++Q; // pick up a leftover
+      RngHost& rng1 = rng.getHostRng();
+      int b, i, j, start, end;
+      double S, u;
+
+      #pragma omp for
+      for (b = 0; b < B; ++b) {
+        start = b*BLOCK;
+        end = bi::min(start + BLOCK, P);
+        rng1.setStream(b, step);
+        S = 0.0;
+        for (i = start; i < end; ++i) {
+          S -= bi::log(1.0 - rng1.uniform<double>());
+        }
+        if (b == B - 1) {
+          S -= bi::log(1.0 - rng1.uniform<double>());
+        }
+        sums[b + 1] = S;
       }
 
-      int i, j = lwsSize;
-      T1 lMax = 0.0, lu;
-      for (i = Q; i > 0; --i) {
-        lMax += bi::log(rng.uniform<T1>())/i;
-        lu = lW + lMax;
+      #pragma omp single
+      {
+        sums[0] = 0.0;
+        for (b = 1; b <= B; ++b) {
+          sums[b] += sums[b - 1];
+        }
+      }
 
-        while (j > 0 && lu < bi::log(pre.Ws(j - 1))) {
-          --j;
+      #pragma omp for
+      for (b = 0; b < B; ++b) {
+        start = b*BLOCK;
+        end = bi::min(start + BLOCK, P);
+        rng1.setStream(b, step);
+        S = sums[b];
+        j = -1;
+        for (i = start; i < end; ++i) {
+          S -= bi::log(1.0 - rng1.uniform<double>());
+          u = pre.W*(S/sums[B]);
+          if (j < 0) {
+            j = thrust::upper_bound(pre.Ws.begin(), pre.Ws.end(), u) -
+                pre.Ws.begin();
+          }
+          while (j < lwsSize - 1 && pre.Ws(j) <= u) {
+            ++j;
+          }
+          as(i) = bi::min(j, lwsSize - 1);
         }
-        as(start + i - 1) = j;
       }
+      rng1.unsetStream();
     }
   } else {
     throw ParticleFilterDegeneratedException();
@@ -0,0 +1,292 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_HOST_RESAMPLER_SCANRESAMPLERHOST_HPP
+#define BI_HOST_RESAMPLER_SCANRESAMPLERHOST_HPP
+
+#include "ResamplerHost.hpp"
+#include "../random/RngHost.hpp"
+#include "../../random/Random.hpp"
+#include "../../misc/exception.hpp"
+
+#include <vector>
+
+namespace bi {
+/**
+ * @internal
+ *
+ * Writes cumulative offspring for ScanResamplerHost.
+ */
+template<class V1>
+struct resample_cumulative_offspring_emitter {
+  V1 Os;
+
+  resample_cumulative_offspring_emitter(V1 Os) :
+      Os(Os) {
+    //
+  }
+
+  void operator()(const int i, const int O1, const int O2) {
+    Os(i) = O2;
+  }
+};
+
+/**
+ * @internal
+ *
+ * Writes offspring for ScanResamplerHost.
+ */
+template<class V1>
+struct resample_offspring_emitter {
+  V1 os;
+
+  resample_offspring_emitter(V1 os) :
+      os(os) {
+    //
+  }
+
+  void operator()(const int i, const int O1, const int O2) {
+    os(i) = O2 - O1;
+  }
+};
+
+/**
+ * @internal
+ *
+ * Writes ancestors for ScanResamplerHost.
+ */
+template<class V1>
+struct resample_ancestors_emitter {
+  V1 as;
+
+  resample_ancestors_emitter(V1 as) :
+      as(as) {
+    //
+  }
+
+  void operator()(const int i, const int O1, const int O2) {
+    for (int j = O1; j < O2; ++j) {
+      as(j) = i;
+    }
+  }
+};
+
+/**
+ * SystematicResampler and StratifiedResampler implementation on host.
+ *
+ * Normalisation of the weights, their prefix sum, selection of offspring and
+ * emission of results are fused into a single parallel region that makes
+ * three passes over the log-weights, without temporary vectors: the first
+ * finds the maximum log-weight, the second the sum of weights in the share
+ * of each thread, and, after a prefix sum across threads, the third selects
+ * and emits offspring. The offsets into strata of stratified resampling are
+ * drawn as needed, each from the stream of its stratum, so that, with
+ * ENABLE_PHILOX, results do not depend on the number of threads.
+ */
+class ScanResamplerHost: public ResamplerHost {
+public:
+  /**
+   * Select offspring.
+   *
+   * @tparam V1 Vector type.
+   * @tparam E1 Emitter type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param lws Log-weights.
+   * @param n Total number of offspring to select.
+   * @param stratified Use an offset for each stratum (stratified
+   * resampling), rather than one for all (systematic resampling)?
+   * @param emit Emitter, called as <tt>emit(i, O1, O2)</tt> for each
+   * particle @c i, where @c O1 and @c O2 are the cumulative offspring of
+   * particles <tt>i - 1</tt> and @c i. Calls are concurrent.
+   * @param[in,out] work Scratch, resized as needed.
+   */
+  template<class V1, class E1>
+  static void op(Random& rng, const V1 lws, const int n,
+      const bool stratified, E1 emit, std::vector<double>& work)
+          throw (ParticleFilterDegeneratedException);
+
+private:
+  /**
+   * Cumulative offspring for prefix sum of weights.
+   *
+   * @param Ws Prefix sum of weights.
+   * @param W Sum of weights.
+   * @param n Total number of offspring.
+   * @param stratified Stratified resampling?
+   * @param step Step key of stratum streams.
+   * @param rng Random number generator of this thread.
+   * @param gen Variate generator of this thread.
+   * @param k2 Stratum of @p alpha2.
+   * @param alpha2 Offset into stratum to use for @p k2 rather than drawing
+   * one.
+   * @param[in,out] k Stratum of @p alpha.
+   * @param[in,out] alpha Offset into stratum.
+   */
+  template<class G1>
+  static int select(const double Ws, const double W, const int n,
+      const bool stratified, const boost::uint64_t step, RngHost& rng,
+      G1& gen, const int k2, const double alpha2, int& k, double& alpha);
+};
+}
+
+#include "../../math/constant.hpp"
+#include "../../math/function.hpp"
+
+#include "boost/random/uniform_real.hpp"
+#include "boost/random/variate_generator.hpp"
+
+template<class V1, class E1>
+void bi::ScanResamplerHost::op(Random& rng, const V1 lws, const int n,
+    const bool stratified, E1 emit, std::vector<double>& work)
+        throw (ParticleFilterDegeneratedException) {
+  /* pre-condition */
+  BI_ASSERT(!V1::on_device);
+
+  typedef typename V1::value_type T1;
+  typedef boost::uniform_real<T1> dist_type;
+
+  const int P = lws.size();
+  boost::uint64_t step = 0;
+  double a = 0.0, mx = -BI_INF, W = 0.0;
+
+  if (stratified) {
+    step = rng.getHostRng().nextStep();
+  } else {
+    a = rng.uniform((T1)0.0, (T1)1.0);  // offset into strata
+  }
+
+  #pragma omp parallel
+  {
+    /* team may be an inner team of nested parallelism, so query it */
+#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+    const int T = omp_get_num_threads(), t = omp_get_thread_num();
+#else
+    const int T = 1, t = 0;
+#endif
+    int Q = P/T;
+    int start = t*Q + bi::min(t, P % T); // min() handles leftovers
+    if (t < P % T) {
+      ++Q; // pick up a leftover
+    }
+    const int end = start + Q;
+
+    RngHost& rng1 = rng.getHostRng();
+    dist_type dist(0.0, 1.0);
+    boost::variate_generator<RngHost::rng_type&,dist_type> gen(rng1.rng,
+        dist);
+
+    double mx1 = -BI_INF, sum1 = 0.0, alpha = a, alpha2 = a;
+    int i, k = -1, k2 = -1, O1, O2;
+
+    /* work holds the maximum of each thread in [0,T), the offset of each
+     * thread into the prefix sum in [T,2T], with the sum of weights last,
+     * and, for stratified resampling, the stratum at each offset in
+     * [2T+1,3T+1] and its offset into the stratum in [3T+2,4T+2] */
+    #pragma omp single
+    {
+      if (int(work.size()) < 4*T + 3) {
+        work.resize(4*T + 3);
+      }
+    }
+
+    /* maximum log-weight, ignoring NaN */
+    for (i = start; i < end; ++i) {
+      mx1 = bi::max(mx1, static_cast<double>(lws(i)));
+    }
+    work[t] = mx1;
+    #pragma omp barrier
+    #pragma omp single
+    {
+      for (i = 0; i < T; ++i) {
+        mx = bi::max(mx, work[i]);
+      }
+    }
+
+    /* sum of weights, NaN giving zero */
+    for (i = start; i < end; ++i) {
+      sum1 += bi::nanexp(static_cast<double>(lws(i)) - mx);
+    }
+    work[T + t + 1] = sum1;
+    #pragma omp barrier
+    #pragma omp single
+    {
+      work[T] = 0.0;
+      for (i = 0; i < T; ++i) {
+        work[T + i + 1] += work[T + i];
+      }
+      W = work[2*T];
+
+      /* strata at boundaries between threads, drawn here so that
+       * neighbouring threads agree on them even where particle streams are
+       * unavailable */
+      if (stratified && W > 0.0) {
+        for (i = 0; i <= T; ++i) {
+          select(work[T + i], W, n, true, step, rng1, gen, -1, 0.0, k,
+              alpha);
+          work[2*T + 1 + i] = k;
+          work[3*T + 2 + i] = alpha;
+        }
+      }
+    }
+
+    /* select and emit offspring; the last particle of each thread takes the
+     * offset of the next thread as its prefix sum, so that cumulative
+     * offspring agree exactly at the boundaries between threads */
+    if (W > 0.0 && Q > 0) {
+      if (stratified) {
+        k = static_cast<int>(work[2*T + 1 + t]);
+        alpha = work[3*T + 2 + t];
+        k2 = static_cast<int>(work[2*T + 2 + t]);
+        alpha2 = work[3*T + 3 + t];
+      }
+      sum1 = 0.0;
+      O1 = select(work[T + t], W, n, stratified, step, rng1, gen, k2, alpha2,
+          k, alpha);
+      for (i = start; i < end - 1; ++i) {
+        sum1 += bi::nanexp(static_cast<double>(lws(i)) - mx);
+        O2 = select(work[T + t] + sum1, W, n, stratified, step, rng1, gen, k2,
+            alpha2, k, alpha);
+        emit(i, O1, O2);
+        O1 = O2;
+      }
+      O2 = select(work[T + t + 1], W, n, stratified, step, rng1, gen, k2,
+          alpha2, k, alpha);
+      emit(end - 1, O1, O2);
+    }
+    if (stratified) {
+      rng1.unsetStream();
+    }
+  }
+
+  if (!(W > 0.0)) {
+    throw ParticleFilterDegeneratedException();
+  }
+}
+
+template<class G1>
+inline int bi::ScanResamplerHost::select(const double Ws, const double W,
+    const int n, const bool stratified, const boost::uint64_t step,
+    RngHost& rng, G1& gen, const int k2, const double alpha2, int& k,
+    double& alpha) {
+  const double reach = Ws/W*n;
+  if (stratified) {
+    const int k1 = bi::min(n - 1, static_cast<int>(reach));
+    if (k1 != k) {
+      k = k1;
+      if (k == k2) {
+        alpha = alpha2;
+      } else {
+        rng.setStream(k, step);
+        alpha = gen();
+      }
+    }
+  }
+  return bi::min(n, static_cast<int>(reach + alpha));
+}
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_HOST_UPDATER_COMMONLOGDENSITYHOST_HPP
+#define BI_HOST_UPDATER_COMMONLOGDENSITYHOST_HPP
+
+#include "../../traits/action_traits.hpp"
+
+namespace bi {
+/**
+ * Log-density of a single action element, with particle-invariant terms
+ * evaluated once and shared across particles, on host.
+ *
+ * @ingroup method_updater
+ *
+ * @tparam A Action type.
+ * @tparam common Does the action have particle-invariant terms?
+ *
+ * Actions with particle-invariant terms (those for which
+ * action_common_size is positive) provide a @c commons() function that
+ * writes the terms for one element to a buffer, and an overload of
+ * @c logDensities() that reads them back. Other actions are evaluated as
+ * usual, and use no space in the buffer.
+ */
+template<class A, bool common = (action_common_size<A>::value > 0)>
+class CommonLogDensityHost {
+public:
+  /**
+   * Evaluate particle-invariant terms of element.
+   *
+   * @param s State.
+   * @param ix Serial index of element.
+   * @param cox Coordinate of element.
+   * @param pax Parents.
+   * @param[out] c Particle-invariant terms of element.
+   */
+  template<class B, class CX, class PX>
+  static void commons(State<B,ON_HOST>& s, const int ix, const CX& cox,
+      const PX& pax, real* c) {
+    //
+  }
+
+  /**
+   * Evaluate log-density of element for a single particle.
+   *
+   * @param s State.
+   * @param p Trajectory id.
+   * @param ix Serial index of element.
+   * @param cox Coordinate of element.
+   * @param pax Parents.
+   * @param[out] x Output.
+   * @param c Particle-invariant terms of element, as output by commons().
+   * @param[in,out] lp Log-density.
+   */
+  template<class B, class CX, class PX, class OX, class T1>
+  static void logDensities(State<B,ON_HOST>& s, const int p, const int ix,
+      const CX& cox, const PX& pax, OX& x, const real* c, T1& lp) {
+    A::logDensities(s, p, ix, cox, pax, x, lp);
+  }
+};
+
+/**
+ * @internal
+ *
+ * Specialisation of CommonLogDensityHost for actions with
+ * particle-invariant terms.
+ */
+template<class A>
+class CommonLogDensityHost<A,true> {
+public:
+  template<class B, class CX, class PX>
+  static void commons(State<B,ON_HOST>& s, const int ix, const CX& cox,
+      const PX& pax, real* c) {
+    A::commons(s, ix, cox, pax, c);
+  }
+
+  template<class B, class CX, class PX, class OX, class T1>
+  static void logDensities(State<B,ON_HOST>& s, const int p, const int ix,
+      const CX& cox, const PX& pax, OX& x, const real* c, T1& lp) {
+    A::logDensities(s, p, ix, cox, pax, x, c, lp);
+  }
+};
+}
+
+#endif
@@ -10,6 +10,7 @@
 
 #include "../../random/Random.hpp"
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 namespace bi {
 /**
@@ -58,17 +59,24 @@ void bi::DynamicSamplerHost<B,S>::samples(Random& rng, const T1 t1,
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  const boost::uint64_t k = rng.getHostRng().nextStep();
+
+  ParticleScheduler sched(s.size());
+
   #pragma omp parallel
   {
     PX pax;
     OX x;
     R1& rng1 = rng.getHostRng();
-    int p;
+    int p, first, last;
 
-    #pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(rng1, t1, t2, s, p, pax, x);
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        rng1.setStream(p, k);
+        Visitor::accept(rng1, t1, t2, s, p, pax, x);
+      }
     }
+    rng1.unsetStream();
   }
 }
 
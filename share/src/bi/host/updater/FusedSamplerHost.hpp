@@ -0,0 +1,111 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_HOST_UPDATER_FUSEDSAMPLERHOST_HPP
+#define BI_HOST_UPDATER_FUSEDSAMPLERHOST_HPP
+
+#include "../../random/Random.hpp"
+#include "../../state/State.hpp"
+#include "../../state/ScheduleIterator.hpp"
+#include "../../state/Mask.hpp"
+#include "../../misc/ParticleScheduler.hpp"
+#include "../../math/temp_vector.hpp"
+
+namespace bi {
+/**
+ * Fused sampler, on host.
+ *
+ * @ingroup method_updater
+ *
+ * @tparam B Model type.
+ */
+template<class B>
+class FusedSamplerHost {
+public:
+  /**
+   * @copydoc FusedSampler::samples(Random&, const ScheduleIterator, const ScheduleIterator, State<B,ON_HOST>&)
+   */
+  static void samples(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, State<B,ON_HOST>& s);
+
+  /**
+   * @copydoc FusedSampler::samples(Random&, const ScheduleIterator, const ScheduleIterator, State<B,ON_HOST>&, const Mask<ON_HOST>&, V1)
+   */
+  template<class V1>
+  static void samples(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, State<B,ON_HOST>& s,
+      const Mask<ON_HOST>& mask, V1 lp);
+};
+}
+
+template<class B>
+void bi::FusedSamplerHost<B>::samples(Random& rng,
+    const ScheduleIterator first, const ScheduleIterator last,
+    State<B,ON_HOST>& s) {
+  typedef RngHost R1;
+
+  const boost::uint64_t k = rng.getHostRng().nextStep();
+
+  ParticleScheduler sched(s.size());
+
+  #pragma omp parallel
+  {
+    R1& rng1 = rng.getHostRng();
+    ScheduleIterator iter;
+    int p, p1, p2;
+
+    while (sched.next(p1, p2)) {
+      for (p = p1; p < p2; ++p) {
+        rng1.setStream(p, k);
+        for (iter = first; iter != last; ++iter) {
+          B::transitionFusedSample(rng, iter->getFrom(), iter->getTo(),
+              iter->hasDelta(), s, p);
+        }
+      }
+    }
+    rng1.unsetStream();
+  }
+}
+
+template<class B>
+template<class V1>
+void bi::FusedSamplerHost<B>::samples(Random& rng,
+    const ScheduleIterator first, const ScheduleIterator last,
+    State<B,ON_HOST>& s, const Mask<ON_HOST>& mask, V1 lp) {
+  typedef RngHost R1;
+
+  const boost::uint64_t k = rng.getHostRng().nextStep();
+
+  /* particle-invariant terms of the observation log-density, once for all
+   * particles; these depend only on parameters, inputs and observations,
+   * which the transition does not change */
+  typename temp_host_vector<real>::type c(B::observationFusedCommonSize() + 1);
+  B::observationFusedCommons(s, mask, c.buf());
+
+  ParticleScheduler sched(s.size());
+
+  #pragma omp parallel
+  {
+    R1& rng1 = rng.getHostRng();
+    ScheduleIterator iter;
+    int p, p1, p2;
+
+    while (sched.next(p1, p2)) {
+      for (p = p1; p < p2; ++p) {
+        rng1.setStream(p, k);
+        for (iter = first; iter != last; ++iter) {
+          B::transitionFusedSample(rng, iter->getFrom(), iter->getTo(),
+              iter->hasDelta(), s, p);
+        }
+        B::observationFusedLogDensity(s, mask, p, c.buf(), lp);
+      }
+    }
+    rng1.unsetStream();
+  }
+}
+
+#endif
@@ -9,6 +9,7 @@
 #define BI_HOST_UPDATER_SPARSESTATICLOGDENSITYHOST_HPP
 
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 namespace bi {
 /**
@@ -35,6 +36,19 @@ public:
   template<class V1>
   static void logDensities(State<B,ON_HOST>& s, const int p,
       const Mask<ON_HOST>& mask, V1 lp);
+
+  /**
+   * @copydoc SparseStaticLogDensity::commons()
+   */
+  static void commons(State<B,ON_HOST>& s, const Mask<ON_HOST>& mask,
+      real* c);
+
+  /**
+   * @copydoc SparseStaticLogDensity::logDensities(State<B,ON_HOST>&, const int, const Mask<ON_HOST>&, const real*, V1)
+   */
+  template<class V1>
+  static void logDensities(State<B,ON_HOST>& s, const int p,
+      const Mask<ON_HOST>& mask, const real* c, V1 lp);
 };
 }
 
@@ -44,6 +58,7 @@ public:
 #include "../../state/Pa.hpp"
 #include "../../state/Ou.hpp"
 #include "../../traits/block_traits.hpp"
+#include "../../math/temp_vector.hpp"
 
 template<class B, class S>
 template<class V1>
@@ -56,15 +71,23 @@ void bi::SparseStaticLogDensityHost<B,S>::logDensities(State<B,ON_HOST>& s,
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  /* particle-invariant terms, once for all particles */
+  PX pax0;
+  typename temp_host_vector<real>::type c(block_common_size<S>::value + 1);
+  Visitor::commons(mask, s, pax0, c.buf());
+
+  ParticleScheduler sched(s.size());
+
   #pragma omp parallel
   {
     PX pax;
     OX x;
-    int p;
+    int p, first, last;
 
-    #pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(mask, s, p, pax, x, lp(p));
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        Visitor::accept(mask, s, p, pax, x, c.buf(), lp(p));
+      }
     }
   }
 }
@@ -85,4 +108,34 @@ void bi::SparseStaticLogDensityHost<B,S>::logDensities(State<B,ON_HOST>& s,
   Visitor::accept(mask, s, p, pax, x, lp(p));
 }
 
+template<class B, class S>
+void bi::SparseStaticLogDensityHost<B,S>::commons(State<B,ON_HOST>& s,
+    const Mask<ON_HOST>& mask, real* c) {
+  typedef Pa<ON_HOST,B,host,host,host,host> PX;
+  typedef Ou<ON_HOST,B,host> OX;
+  typedef SparseStaticLogDensityMatrixVisitorHost<B,S,PX,OX> MatrixVisitor;
+  typedef SparseStaticLogDensityVisitorHost<B,S,PX,OX> ElementVisitor;
+  typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
+      ElementVisitor>::type Visitor;
+
+  PX pax;
+  Visitor::commons(mask, s, pax, c);
+}
+
+template<class B, class S>
+template<class V1>
+void bi::SparseStaticLogDensityHost<B,S>::logDensities(State<B,ON_HOST>& s,
+    const int p, const Mask<ON_HOST>& mask, const real* c, V1 lp) {
+  typedef Pa<ON_HOST,B,host,host,host,host> PX;
+  typedef Ou<ON_HOST,B,host> OX;
+  typedef SparseStaticLogDensityMatrixVisitorHost<B,S,PX,OX> MatrixVisitor;
+  typedef SparseStaticLogDensityVisitorHost<B,S,PX,OX> ElementVisitor;
+  typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
+      ElementVisitor>::type Visitor;
+
+  PX pax;
+  OX x;
+  Visitor::accept(mask, s, p, pax, x, c, lp(p));
+}
+
 #endif
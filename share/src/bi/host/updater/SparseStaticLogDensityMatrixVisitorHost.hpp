@@ -18,6 +18,20 @@ public:
   template<class T1>
   static void accept(State<B,ON_HOST>& s, const Mask<ON_HOST>& mask,
       const int p, const PX& pax, OX& x, T1& lp);
+
+  /**
+   * Matrix actions have no particle-invariant terms.
+   */
+  static void commons(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const PX& pax, real* c) {
+    //
+  }
+
+  template<class T1>
+  static void accept(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const int p, const PX& pax, OX& x, const real* c, T1& lp) {
+    accept(s, mask, p, pax, x, lp);
+  }
 };
 
 /**
@@ -33,6 +47,17 @@ public:
       const int p, const PX& pax, OX& x, T1& lp) {
     //
   }
+
+  static void commons(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const PX& pax, real* c) {
+    //
+  }
+
+  template<class T1>
+  static void accept(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const int p, const PX& pax, OX& x, const real* c, T1& lp) {
+    //
+  }
 };
 }
 
@@ -18,6 +18,20 @@ public:
   template<class T1>
   static void accept(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
       const int p, const PX& pax, OX& x, T1& lp);
+
+  /**
+   * Evaluate particle-invariant terms of all actions, into a buffer of
+   * length block_common_size<S>::value.
+   */
+  static void commons(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const PX& pax, real* c);
+
+  /**
+   * As accept(), reusing particle-invariant terms output by commons().
+   */
+  template<class T1>
+  static void accept(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const int p, const PX& pax, OX& x, const real* c, T1& lp);
 };
 
 /**
@@ -33,12 +47,24 @@ public:
       const int p, const PX& pax, OX& x, T1& lp) {
     //
   }
+
+  static void commons(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const PX& pax, real* c) {
+    //
+  }
+
+  template<class T1>
+  static void accept(const Mask<ON_HOST>& mask, State<B,ON_HOST>& s,
+      const int p, const PX& pax, OX& x, const real* c, T1& lp) {
+    //
+  }
 };
 }
 
 #include "../../typelist/front.hpp"
 #include "../../typelist/pop_front.hpp"
 #include "../../traits/action_traits.hpp"
+#include "CommonLogDensityHost.hpp"
 
 template<class B, class S, class PX, class OX>
 template<class T1>
@@ -72,4 +98,74 @@ void bi::SparseStaticLogDensityVisitorHost<B,S,PX,OX>::accept(
       pax, x, lp);
 }
 
+template<class B, class S, class PX, class OX>
+void bi::SparseStaticLogDensityVisitorHost<B,S,PX,OX>::commons(
+    const Mask<ON_HOST>& mask, State<B,ON_HOST>& s, const PX& pax,
+    real* c) {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+  typedef typename front::target_type target_type;
+  typedef typename front::coord_type coord_type;
+  typedef CommonLogDensityHost<front> helper;
+
+  const int id = var_id<target_type>::value;
+  const int N = action_common_size<front>::value;
+  int ix = 0;
+  coord_type cox;
+
+  if (N > 0) {
+    if (mask.isDense(id)) {
+      while (ix < action_size<front>::value) {
+        helper::commons(s, ix, cox, pax, c + ix*N);
+        ++cox;
+        ++ix;
+      }
+    } else if (mask.isSparse(id)) {
+      BI_ASSERT(mask.getSize(id) <= action_size<front>::value);
+      while (ix < mask.getSize(id)) {
+        cox.setIndex(mask.getIndex(id, ix));
+        helper::commons(s, ix, cox, pax, c + ix*N);
+        ++ix;
+      }
+    }
+  }
+
+  SparseStaticLogDensityVisitorHost<B,pop_front,PX,OX>::commons(mask, s, pax,
+      c + action_size<front>::value*N);
+}
+
+template<class B, class S, class PX, class OX>
+template<class T1>
+void bi::SparseStaticLogDensityVisitorHost<B,S,PX,OX>::accept(
+    const Mask<ON_HOST>& mask, State<B,ON_HOST>& s, const int p,
+    const PX& pax, OX& x, const real* c, T1& lp) {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+  typedef typename front::target_type target_type;
+  typedef typename front::coord_type coord_type;
+  typedef CommonLogDensityHost<front> helper;
+
+  const int id = var_id<target_type>::value;
+  const int N = action_common_size<front>::value;
+  int ix = 0;
+  coord_type cox;
+
+  if (mask.isDense(id)) {
+    while (ix < action_size<front>::value) {
+      helper::logDensities(s, p, ix, cox, pax, x, c + ix*N, lp);
+      ++cox;
+      ++ix;
+    }
+  } else if (mask.isSparse(id)) {
+    while (ix < mask.getSize(id)) {
+      cox.setIndex(mask.getIndex(id, ix));
+      helper::logDensities(s, p, ix, cox, pax, x, c + ix*N, lp);
+      ++ix;
+    }
+  }
+
+  SparseStaticLogDensityVisitorHost<B,pop_front,PX,OX>::accept(mask, s, p,
+      pax, x, c + action_size<front>::value*N, lp);
+}
+
 #endif
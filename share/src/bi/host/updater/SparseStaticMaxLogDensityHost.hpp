@@ -9,6 +9,7 @@
 #define BI_HOST_UPDATER_SPARSESTATICMAXLOGDENSITYHOST_HPP
 
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 namespace bi {
 /**
@@ -56,15 +57,18 @@ void bi::SparseStaticMaxLogDensityHost<B,S>::maxLogDensities(
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  ParticleScheduler sched(s.size());
+
 #pragma omp parallel
   {
     PX pax;
     OX x;
-    int p;
+    int p, first, last;
 
-#pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(s, mask, p, pax, x, lp(p));
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        Visitor::accept(s, mask, p, pax, x, lp(p));
+      }
     }
   }
 }
@@ -10,6 +10,7 @@
 
 #include "../../random/Random.hpp"
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 namespace bi {
 /**
@@ -55,17 +56,24 @@ void bi::SparseStaticSamplerHost<B,S>::samples(Random& rng,
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  const boost::uint64_t k = rng.getHostRng().nextStep();
+
+  ParticleScheduler sched(s.size());
+
 #pragma omp parallel
   {
     PX pax;
     OX x;
     R1& rng1 = rng.getHostRng();
-    int p;
+    int p, first, last;
 
-#pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(rng, s, mask, p, pax, x);
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        rng1.setStream(p, k);
+        Visitor::accept(rng, s, mask, p, pax, x);
+      }
     }
+    rng1.unsetStream();
   }
 }
 
@@ -9,6 +9,7 @@
 #define BI_HOST_UPDATER_SPARSESTATICUPDATERHOST_HPP
 
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 #include "../../state/Mask.hpp"
 
 namespace bi {
@@ -47,15 +48,18 @@ void bi::SparseStaticUpdaterHost<B,S>::update(State<B,ON_HOST>& s,
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  ParticleScheduler sched(s.size());
+
 #pragma omp parallel
   {
     PX pax;
     OX x;
-    int p;
+    int p, first, last;
 
-#pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(s, mask, p, pax, x);
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        Visitor::accept(s, mask, p, pax, x);
+      }
     }
   }
 }
@@ -9,6 +9,7 @@
 #define BI_HOST_UPDATER_STATICLOGDENSITYHOST_HPP
 
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 namespace bi {
 /**
@@ -42,6 +43,7 @@ public:
 #include "../../state/Pa.hpp"
 #include "../../state/Ou.hpp"
 #include "../../traits/block_traits.hpp"
+#include "../../math/temp_vector.hpp"
 
 template<class B, class S>
 template<class V1>
@@ -53,15 +55,23 @@ void bi::StaticLogDensityHost<B,S>::logDensities(State<B,ON_HOST>& s, V1 lp) {
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  /* particle-invariant terms, once for all particles */
+  PX pax0;
+  typename temp_host_vector<real>::type c(block_common_size<S>::value + 1);
+  Visitor::commons(s, pax0, c.buf());
+
+  ParticleScheduler sched(s.size());
+
 #pragma omp parallel
   {
     PX pax;
     OX x;
-    int p;
+    int p, first, last;
 
-#pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(s, p, pax, x, lp(p));
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        Visitor::accept(s, p, pax, x, c.buf(), lp(p));
+      }
     }
   }
 }
@@ -18,6 +18,19 @@ public:
   template<class T1>
   static void accept(State<B,ON_HOST>& s, const int p, const PX& pax, OX& x,
       T1& lp);
+
+  /**
+   * Matrix actions have no particle-invariant terms.
+   */
+  static void commons(State<B,ON_HOST>& s, const PX& pax, real* c) {
+    //
+  }
+
+  template<class T1>
+  static void accept(State<B,ON_HOST>& s, const int p, const PX& pax, OX& x,
+      const real* c, T1& lp) {
+    accept(s, p, pax, x, lp);
+  }
 };
 
 /**
@@ -33,6 +46,16 @@ public:
       T1& lp) {
     //
   }
+
+  static void commons(State<B,ON_HOST>& s, const PX& pax, real* c) {
+    //
+  }
+
+  template<class T1>
+  static void accept(State<B,ON_HOST>& s, const int p, const PX& pax, OX& x,
+      const real* c, T1& lp) {
+    //
+  }
 };
 }
 
@@ -18,6 +18,19 @@ public:
   template<class T1>
   static void accept(State<B,ON_HOST>& s, const int p, const PX& pax, OX& x,
       T1& lp);
+
+  /**
+   * Evaluate particle-invariant terms of all actions, into a buffer of
+   * length block_common_size<S>::value.
+   */
+  static void commons(State<B,ON_HOST>& s, const PX& pax, real* c);
+
+  /**
+   * As accept(), reusing particle-invariant terms output by commons().
+   */
+  template<class T1>
+  static void accept(State<B,ON_HOST>& s, const int p, const PX& pax, OX& x,
+      const real* c, T1& lp);
 };
 
 /**
@@ -33,12 +46,23 @@ public:
       T1& lp) {
     //
   }
+
+  static void commons(State<B,ON_HOST>& s, const PX& pax, real* c) {
+    //
+  }
+
+  template<class T1>
+  static void accept(State<B,ON_HOST>& s, const int p, const PX& pax, OX& x,
+      const real* c, T1& lp) {
+    //
+  }
 };
 }
 
 #include "../../typelist/front.hpp"
 #include "../../typelist/pop_front.hpp"
 #include "../../traits/action_traits.hpp"
+#include "CommonLogDensityHost.hpp"
 
 template<class B, class S, class PX, class OX>
 template<class T1>
@@ -58,4 +82,47 @@ void bi::StaticLogDensityVisitorHost<B,S,PX,OX>::accept(State<B,ON_HOST>& s,
   StaticLogDensityVisitorHost<B,pop_front,PX,OX>::accept(s, p, pax, x, lp);
 }
 
+template<class B, class S, class PX, class OX>
+void bi::StaticLogDensityVisitorHost<B,S,PX,OX>::commons(State<B,ON_HOST>& s,
+    const PX& pax, real* c) {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+  typedef typename front::coord_type coord_type;
+  typedef CommonLogDensityHost<front> helper;
+
+  const int N = action_common_size<front>::value;
+  int ix = 0;
+  coord_type cox;
+  if (N > 0) {
+    while (ix < action_size<front>::value) {
+      helper::commons(s, ix, cox, pax, c + ix*N);
+      ++cox;
+      ++ix;
+    }
+  }
+  StaticLogDensityVisitorHost<B,pop_front,PX,OX>::commons(s, pax,
+      c + action_size<front>::value*N);
+}
+
+template<class B, class S, class PX, class OX>
+template<class T1>
+void bi::StaticLogDensityVisitorHost<B,S,PX,OX>::accept(State<B,ON_HOST>& s,
+    const int p, const PX& pax, OX& x, const real* c, T1& lp) {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+  typedef typename front::coord_type coord_type;
+  typedef CommonLogDensityHost<front> helper;
+
+  const int N = action_common_size<front>::value;
+  int ix = 0;
+  coord_type cox;
+  while (ix < action_size<front>::value) {
+    helper::logDensities(s, p, ix, cox, pax, x, c + ix*N, lp);
+    ++cox;
+    ++ix;
+  }
+  StaticLogDensityVisitorHost<B,pop_front,PX,OX>::accept(s, p, pax, x,
+      c + action_size<front>::value*N, lp);
+}
+
 #endif
@@ -9,6 +9,7 @@
 #define BI_HOST_UPDATER_STATICMAXLOGDENSITYHOST_HPP
 
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 namespace bi {
 /**
@@ -54,15 +55,18 @@ void bi::StaticMaxLogDensityHost<B,S>::maxLogDensities(State<B,ON_HOST>& s,
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  ParticleScheduler sched(s.size());
+
 #pragma omp parallel
   {
     PX pax;
     OX x;
-    int p;
+    int p, first, last;
 
-#pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(s, p, pax, x, lp(p));
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        Visitor::accept(s, p, pax, x, lp(p));
+      }
     }
   }
 }
@@ -9,6 +9,7 @@
 #define BI_HOST_UPDATER_STATICUPDATERHOST_HPP
 
 #include "../../state/State.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 namespace bi {
 /**
@@ -44,15 +45,18 @@ void bi::StaticUpdaterHost<B,S>::update(State<B,ON_HOST>& s) {
   typedef typename boost::mpl::if_c<
       block_is_matrix<S>::value,MatrixVisitor,ElementVisitor>::type Visitor;
 
+  ParticleScheduler sched(s.size());
+
   #pragma omp parallel
   {
     PX pax;
     OX x;
-    int p;
+    int p, first, last;
 
-    #pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(s, p, pax, x);
+    while (sched.next(first, last)) {
+      for (p = first; p < last; ++p) {
+        Visitor::accept(s, p, pax, x);
+      }
     }
   }
 }
@@ -15,8 +15,9 @@ namespace bi {
  * Initialise LibBi.
  *
  * @param threads Number of threads.
+ * @param steal Use work stealing in loops over particles?
  */
-void bi_init(const int threads = 0);
+void bi_init(const int threads = 0, const bool steal = false);
 }
 
 #include "misc/omp.hpp"
@@ -32,8 +33,8 @@ void bi_init(const int threads = 0);
 #endif
 
 // need to keep in same compilation unit as caller for bi_ode_init()
-inline void bi::bi_init(const int threads) {
-  bi_omp_init(threads);
+inline void bi::bi_init(const int threads, const bool steal) {
+  bi_omp_init(threads, steal);
 
   #ifdef ENABLE_CUDA
   #ifdef ENABLE_MPI
@@ -70,6 +70,22 @@ public:
   template<class V1>
   typename V1::value_type operator()(const V1 x) const;
 
+  /**
+   * Evaluate the kernel at a point, given its squared 2-norm.
+   *
+   * @tparam T1 Scalar or SIMD type.
+   *
+   * @param d \f$\|\mathbf{x}\|_2^2\f$; squared 2-norm of the point.
+   *
+   * @return \f$\log \mathcal{K}(\mathbf{x})\f$; log-density of the kernel
+   * at the point.
+   *
+   * This is used by the SIMD leaf kernel of dualTreeDensity(), which
+   * accumulates squared differences itself.
+   */
+  template<class T1>
+  T1 logDensityOfSquaredNorm(const T1 d) const;
+
 private:
   /**
    * \f$h\f$; bandwidth.
@@ -116,6 +132,11 @@ inline typename V1::value_type bi::FastGaussianKernel::density(const V1 x) const
   return ZI*bi::exp(E*d);
 }
 
+template<class T1>
+inline T1 bi::FastGaussianKernel::logDensityOfSquaredNorm(const T1 d) const {
+  return E*d - logZ;
+}
+
 template<class V1>
 inline typename V1::value_type bi::FastGaussianKernel::operator()(const V1 x) const {
   return density(x);
@@ -10,10 +10,15 @@
 #ifndef BI_KD_KDTREE_HPP
 #define BI_KD_KDTREE_HPP
 
-#include "KDTreeNode.hpp"
 #include "MedianPartitioner.hpp"
+#include "../sse/math/scalar.hpp"
 
+#include <vector>
+
+#ifndef __CUDACC__
 #include "boost/serialization/split_member.hpp"
+#include "boost/serialization/vector.hpp"
+#endif
 
 namespace bi {
 /**
@@ -21,15 +26,38 @@ namespace bi {
  *
  * @ingroup kd
  *
- * @tparam M1 Vector type.
+ * @tparam V1 Vector type.
+ * @tparam M1 Matrix type.
+ *
+ * The tree is flat: nodes are numbered breadth first from the root, zero,
+ * and held in arrays rather than allocated individually, the children of an
+ * internal node @c k being getLeft(k) and <tt>getLeft(k) + 1</tt>. The
+ * samples are copied into the tree and reordered so that those of each node
+ * are contiguous, the samples of each leaf starting on a multiple of
+ * #BI_SIMD_SIZE and padded to a multiple of it with zero-weight samples
+ * (index -1, log-weight \f$-\infty\f$). Each variable of the samples is
+ * stored contiguously, so that a leaf may be loaded with aligned SIMD
+ * loads. A node is a leaf if it holds no more than the leaf size given on
+ * construction, or if its samples cannot be partitioned, e.g. because they
+ * are identical.
+ *
+ * @section KDTree_serialization Serialization
+ *
+ * This class supports serialization through the Boost.Serialization
+ * library.
  */
 template <class V1 = host_vector<>, class M1 = host_matrix<> >
 class KDTree {
 public:
   /**
-   * Node type.
+   * Vector reference type.
+   */
+  typedef typename M1::vector_reference_type vector_reference_type;
+
+  /**
+   * Matrix reference type.
    */
-  typedef KDTreeNode<V1,M1> var_type;
+  typedef typename M1::matrix_reference_type matrix_reference_type;
 
   /**
    * Default constructor.
@@ -43,26 +71,31 @@ public:
    * Constructor.
    *
    * @tparam M2 Matrix type.
+   * @tparam V2 Vector type.
    * @tparam S1 #concept::Partitioner type.
    *
-   * @param X Samples.
+   * @param X Samples. Rows index samples, columns index variables.
    * @param lw Log-weights.
    * @param partitioner Partitioner.
+   * @param leafSize Maximum number of samples in a leaf.
    */
   template<class M2, class V2, class S1>
-  KDTree(const M2 X, const V2 lw, S1 partitioner);
+  KDTree(const M2 X, const V2 lw, S1 partitioner,
+      const int leafSize = 8*BI_SIMD_SIZE);
 
   /**
-   * Constructor.
+   * Constructor, for uniformly weighted samples.
    *
    * @tparam M2 Matrix type.
    * @tparam S1 #concept::Partitioner type.
    *
-   * @param X Samples.
+   * @param X Samples. Rows index samples, columns index variables.
    * @param partitioner Partitioner.
+   * @param leafSize Maximum number of samples in a leaf.
    */
   template<class M2, class S1>
-  KDTree(const M2 X, S1 partitioner);
+  KDTree(const M2 X, S1 partitioner,
+      const int leafSize = 8*BI_SIMD_SIZE);
 
   /**
    * Copy constructor.
@@ -70,58 +103,166 @@ public:
   KDTree(const KDTree<V1,M1>& o);
 
   /**
-   * Destructor.
+   * Assignment operator.
    */
-  ~KDTree();
+  KDTree<V1,M1>& operator=(const KDTree<V1,M1>& o);
 
   /**
-   * Assignment operator.
+   * Size of the tree (number of variables).
    */
-  KDTree<V1,M1>& operator=(const KDTree<V1,M1>& o);
+  int getSize() const;
 
   /**
-   * Get root node.
+   * Number of samples in the tree, including padding.
+   */
+  int getCount() const;
+
+  /**
+   * Number of nodes in the tree. Zero if the tree is empty, otherwise the
+   * root is node zero.
+   */
+  int getNodes() const;
+
+  /**
+   * Is a node a leaf?
    *
-   * @return Root node.
+   * @param k Node.
    */
-  var_type* getRoot();
+  bool isLeaf(const int k) const;
 
   /**
-   * Get size.
+   * Is a node internal?
    *
-   * @return Size.
+   * @param k Node.
    */
-  int getSize();
+  bool isInternal(const int k) const;
 
   /**
-   * Set root node.
+   * Left child of an internal node, the right child being the next node.
    *
-   * @param root Root node.
+   * @param k Node.
    */
-  void setRoot(var_type* root);
+  int getLeft(const int k) const;
+
+  /**
+   * First sample of a node.
+   *
+   * @param k Node.
+   */
+  int getBegin(const int k) const;
+
+  /**
+   * One past the last sample of a node, including padding.
+   *
+   * @param k Node.
+   */
+  int getEnd(const int k) const;
+
+  /**
+   * Lower bound on a node.
+   *
+   * @param k Node.
+   */
+  const vector_reference_type getLower(const int k) const;
 
-private:
   /**
-   * Root node of the tree.
+   * Upper bound on a node.
+   *
+   * @param k Node.
+   */
+  const vector_reference_type getUpper(const int k) const;
+
+  /**
+   * Reordered samples. Rows index samples, columns index variables.
+   */
+  const M1& getValues() const;
+
+  /**
+   * Reordered log-weights.
+   */
+  const V1& getLogWeights() const;
+
+  /**
+   * Index of a reordered sample into the original sample set, -1 for
+   * padding.
+   *
+   * @param i Sample.
    */
-  var_type* root;
+  int getIndex(const int i) const;
 
   /**
-   * Build \f$kd\f$ tree node.
+   * Find the coordinate difference between two nodes.
    *
+   * @tparam V2 Vector type.
    * @tparam M2 Matrix type.
+   * @tparam V3 Vector type.
+   *
+   * @param k Node of this tree.
+   * @param tree Other tree.
+   * @param l Node of other tree.
+   * @param[out] result Difference between the closest two points in the
+   * volumes contained by the nodes.
+   *
+   * Note that the difference may contain negative values. Usually a norm
+   * would subsequently be applied to obtain a scalar distance.
+   */
+  template<class V2, class M2, class V3>
+  void difference(const int k, const KDTree<V2,M2>& tree, const int l,
+      V3 result) const;
+
+private:
+  /**
+   * Build tree.
+   *
+   * @tparam M2 Matrix type.
+   * @tparam V2 Vector type.
+   * @tparam S1 #concept::Partitioner type.
    *
    * @param X Samples.
-   * @param is Indices of the subset of components in @p X over which to build
-   * the node.
-   * @param depth Depth of the node in the tree. Zero for the root node.
-   * 
-   * @return The node. Caller has ownership.
+   * @param lw Log-weights.
+   * @param partitioner Partitioner.
+   * @param leafSize Maximum number of samples in a leaf.
    */
   template<class M2, class V2, class S1>
-  static var_type* build(const M2 X, const V2 lw, S1 partitioner,
-      const std::vector<int>& is, const int depth = 0);
+  void build(const M2 X, const V2 lw, S1 partitioner, const int leafSize);
+
+  /**
+   * Reordered samples.
+   */
+  M1 X;
+
+  /**
+   * Reordered log-weights.
+   */
+  V1 lw;
+
+  /**
+   * Bounds of nodes, lower bound of node @c k in column <tt>2*k</tt>,
+   * upper bound in column <tt>2*k + 1</tt>.
+   */
+  M1 bounds;
+
+  /**
+   * Indices of reordered samples into the original sample set.
+   */
+  std::vector<int> is;
+
+  /**
+   * First sample of each node.
+   */
+  std::vector<int> begins;
+
+  /**
+   * One past the last sample of each node.
+   */
+  std::vector<int> ends;
 
+  /**
+   * Left child of each node, -1 for leaves.
+   */
+  std::vector<int> lefts;
+
+  #ifndef __CUDACC__
   /**
    * Serialize.
    */
@@ -139,150 +280,301 @@ private:
    */
   BOOST_SERIALIZATION_SPLIT_MEMBER()
   friend class boost::serialization::access;
+  #endif
 };
 }
 
 #include "partition.hpp"
+#include "../math/view.hpp"
+#include "../math/constant.hpp"
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>::KDTree() : root(NULL) {
+bi::KDTree<V1,M1>::KDTree() {
   //
 }
 
 template<class V1, class M1>
 template<class M2, class V2, class S1>
-bi::KDTree<V1,M1>::KDTree(const M2 X, const V2 lw, const S1 partitioner) {
-  host_vector<int> is(X.size1());
-  seq_elements(is, 0);
-
-  root = (is.size() > 0) ? build(X, lw, partitioner, is) : NULL;
+bi::KDTree<V1,M1>::KDTree(const M2 X, const V2 lw, S1 partitioner,
+    const int leafSize) {
+  build(X, lw, partitioner, leafSize);
 }
 
 template<class V1, class M1>
 template<class M2, class S1>
-bi::KDTree<V1,M1>::KDTree(const M2 X, const S1 partitioner) {
+bi::KDTree<V1,M1>::KDTree(const M2 X, S1 partitioner, const int leafSize) {
   V1 lw(X.size1());
   lw.clear();
-  host_vector<int> is(X.size1());
-  seq_elements(is, 0);
+  build(X, lw, partitioner, leafSize);
+}
 
-  root = (is.size() > 0) ? build(X, lw, partitioner, is) : NULL;
+template<class V1, class M1>
+bi::KDTree<V1,M1>::KDTree(const KDTree<V1,M1>& o) :
+    X(o.X.size1(), o.X.size2()), lw(o.lw.size()),
+    bounds(o.bounds.size1(), o.bounds.size2()) {
+  this->operator=(o);
 }
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>::KDTree(const KDTree<V1,M1>& o) {
-  root = (o.root == NULL) ? NULL : new KDTreeNode<V1,M1>(o.root);
+bi::KDTree<V1,M1>& bi::KDTree<V1,M1>::operator=(const KDTree<V1,M1>& o) {
+  X.resize(o.X.size1(), o.X.size2());
+  lw.resize(o.lw.size());
+  bounds.resize(o.bounds.size1(), o.bounds.size2());
+  X = o.X;
+  lw = o.lw;
+  bounds = o.bounds;
+  is = o.is;
+  begins = o.begins;
+  ends = o.ends;
+  lefts = o.lefts;
+
+  return *this;
 }
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>::~KDTree() {
-  delete root;
+inline int bi::KDTree<V1,M1>::getSize() const {
+  return X.size2();
 }
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>& bi::KDTree<V1,M1>::operator=(const KDTree<V1,M1>& o) {
-  delete root;
-  root = (o.root == NULL) ? NULL : new var_type(o.root);
-  
-  return *this;
+inline int bi::KDTree<V1,M1>::getCount() const {
+  return X.size1();
 }
 
 template<class V1, class M1>
-inline bi::KDTreeNode<V1,M1>* bi::KDTree<V1,M1>::getRoot() {
-  return root;
+inline int bi::KDTree<V1,M1>::getNodes() const {
+  return lefts.size();
 }
 
 template<class V1, class M1>
-inline void bi::KDTree<V1,M1>::setRoot(var_type* root) {
-  this->root = root;
+inline bool bi::KDTree<V1,M1>::isLeaf(const int k) const {
+  return lefts[k] < 0;
 }
 
 template<class V1, class M1>
-inline int bi::KDTree<V1,M1>::getSize() {
-  return this->root->getSize();
+inline bool bi::KDTree<V1,M1>::isInternal(const int k) const {
+  return lefts[k] >= 0;
 }
 
 template<class V1, class M1>
-template<class M2, class V2, class S1>
-typename bi::KDTree<V1,M1>::var_type* bi::KDTree<V1,M1>::build(const M2 X,
-    const V2 lw, S1 partitioner, const std::vector<int>& is, const int depth) {
+inline int bi::KDTree<V1,M1>::getLeft(const int k) const {
   /* pre-condition */
-  BI_ASSERT(is.size() > 0);
-
-  var_type* result;
-  int i;
-  
-  if (is.size() == 1) {
-    /* leaf node */
-    result = new var_type(X, lw, is.front(), depth);
-  } else if (is.size() <= 4) {
-    /* prune node */
-    result = new var_type(X, lw, is, depth);
-  } else {
-    /* internal node */
-    if (partitioner.init(X, is)) {
-      var_type *left, *right; // child nodes
-      std::vector<int> ls, rs; // indices of left, right components
-      ls.reserve(is.size()/2 + 1);
-      rs.reserve(is.size()/2 + 1);
-      
-      for (i = 0; i < (int)is.size(); ++i) {
-        if (partitioner.assign(row(X,is[i])) == LEFT) {
-          ls.push_back(is[i]);
-        } else {
-          rs.push_back(is[i]);
+  BI_ASSERT(isInternal(k));
+
+  return lefts[k];
+}
+
+template<class V1, class M1>
+inline int bi::KDTree<V1,M1>::getBegin(const int k) const {
+  return begins[k];
+}
+
+template<class V1, class M1>
+inline int bi::KDTree<V1,M1>::getEnd(const int k) const {
+  return ends[k];
+}
+
+template<class V1, class M1>
+inline const typename bi::KDTree<V1,M1>::vector_reference_type bi::KDTree<
+    V1,M1>::getLower(const int k) const {
+  return column(bounds, 2*k);
+}
+
+template<class V1, class M1>
+inline const typename bi::KDTree<V1,M1>::vector_reference_type bi::KDTree<
+    V1,M1>::getUpper(const int k) const {
+  return column(bounds, 2*k + 1);
+}
+
+template<class V1, class M1>
+inline const M1& bi::KDTree<V1,M1>::getValues() const {
+  return X;
+}
+
+template<class V1, class M1>
+inline const V1& bi::KDTree<V1,M1>::getLogWeights() const {
+  return lw;
+}
+
+template<class V1, class M1>
+inline int bi::KDTree<V1,M1>::getIndex(const int i) const {
+  return is[i];
+}
+
+template<class V1, class M1>
+template<class V2, class M2, class V3>
+inline void bi::KDTree<V1,M1>::difference(const int k,
+    const KDTree<V2,M2>& tree, const int l, V3 result) const {
+  /* pre-conditions */
+  BI_ASSERT(tree.getSize() == getSize());
+  BI_ASSERT(result.size() == getSize());
+
+  BOOST_AUTO(lower, getLower(k));
+  BOOST_AUTO(upper, getUpper(k));
+  BOOST_AUTO(treeLower, tree.getLower(l));
+  BOOST_AUTO(treeUpper, tree.getUpper(l));
+  real high, low;
+
+  for (int i = 0; i < lower.size(); ++i) {
+    high = treeUpper(i);
+    low = lower(i);
+    if (high < low) {
+      result(i) = low - high;
+    } else {
+      high = upper(i);
+      low = treeLower(i);
+      if (low > high) {
+        result(i) = low - high;
+      } else {
+        result(i) = 0.0;
+      }
+    }
+  }
+}
+
+template<class V1, class M1>
+template<class M2, class V2, class S1>
+void bi::KDTree<V1,M1>::build(const M2 X, const V2 lw, S1 partitioner,
+    const int leafSize) {
+  /* pre-conditions */
+  BI_ASSERT(lw.size() == X.size1());
+  BI_ASSERT(leafSize > 0);
+
+  const int P = X.size1();
+  const int N = X.size2();
+  const int W = BI_SIMD_SIZE;
+
+  std::vector<int> ps(P), leaves(P, -1), firsts;
+  int i, j, k, l, a, b, mid, begin;
+
+  begins.clear();
+  ends.clear();
+  lefts.clear();
+  for (i = 0; i < P; ++i) {
+    ps[i] = i;
+  }
+
+  /* split nodes breadth first, the node arrays themselves serving as the
+   * queue; samples of each node are partitioned in place in ps, so that
+   * those of its children are contiguous */
+  if (P > 0) {
+    begins.push_back(0);
+    ends.push_back(P);
+  }
+  for (k = 0; k < (int)begins.size(); ++k) {
+    a = begins[k];
+    b = ends[k];
+    l = -1;
+    if (b - a > leafSize) {
+      std::vector<int> is1(ps.begin() + a, ps.begin() + b);
+      if (partitioner.init(X, is1)) {
+        mid = a;
+        for (i = a; i < b; ++i) {
+          if (partitioner.assign(row(X, ps[i])) == LEFT) {
+            std::swap(ps[i], ps[mid]);
+            ++mid;
+          }
+        }
+        if (mid > a && mid < b) {
+          l = begins.size();
+          begins.push_back(a);
+          ends.push_back(mid);
+          begins.push_back(mid);
+          ends.push_back(b);
         }
       }
+      /* otherwise degenerate, usually because all points are identical or
+       * one has negligible weight, so that they cannot be partitioned
+       * spatially; put them all into one leaf */
+    }
+    lefts.push_back(l);
+    if (l < 0) {
+      leaves[a] = k;
+    }
+  }
 
-      if (ls.size() == 0) {
-        /* degenerate case left child, make prune node from right */
-        result = new var_type(X, lw, rs, depth);
-      } else if (rs.size() == 0) {
-        /* degenerate right child, make prune node from left*/
-        result = new var_type(X, lw, ls, depth);
-      } else {
-        /* internal node */
-        left = build(X, lw, partitioner, ls, depth + 1);
-        right = build(X, lw, partitioner, rs, depth + 1);
-      
-        result = new var_type(left, right, depth);
+  /* pad leaves, in order of their samples, to a multiple of the SIMD
+   * width; internal nodes then span the samples of their children, and
+   * are reached after them in reverse breadth first order */
+  firsts.resize(lefts.size());
+  begin = 0;
+  for (i = 0; i < P; ++i) {
+    k = leaves[i];
+    if (k >= 0) {
+      a = begins[k];
+      b = ends[k];
+      begins[k] = begin;
+      ends[k] = begin + b - a;
+      firsts[k] = a;
+      begin += W*((b - a + W - 1)/W);
+    }
+  }
+
+  this->X.resize(begin, N);
+  this->lw.resize(begin);
+  this->bounds.resize(N, 2*lefts.size());
+  this->X.clear();
+  is.resize(begin);
+  std::fill(is.begin(), is.end(), -1);
+  set_elements(this->lw, -BI_INF);
+
+  for (k = lefts.size() - 1; k >= 0; --k) {
+    BOOST_AUTO(lower, getLower(k));
+    BOOST_AUTO(upper, getUpper(k));
+    if (isLeaf(k)) {
+      a = begins[k];
+      b = ends[k];
+      for (i = a; i < b; ++i) {
+        j = ps[firsts[k] + i - a];
+        is[i] = j;
+        row(this->X, i) = row(X, j);
+        this->lw(i) = lw(j);
       }
+      lower = row(this->X, a);
+      upper = lower;
+      for (i = a + 1; i < b; ++i) {
+        for (j = 0; j < N; ++j) {
+          lower(j) = bi::min(lower(j), this->X(i, j));
+          upper(j) = bi::max(upper(j), this->X(i, j));
+        }
+      }
+      ends[k] = a + W*((b - a + W - 1)/W);
     } else {
-      /* Degenerate case, usually occurs when all points are identical or
-         one has negligible weight, so that they cannot be partitioned
-         spatially. Put them all into one prune node... */
-      result = new var_type(X, lw, is, depth);
+      l = lefts[k];
+      begins[k] = begins[l];
+      ends[k] = ends[l + 1];
+      for (j = 0; j < N; ++j) {
+        lower(j) = bi::min(getLower(l)(j), getLower(l + 1)(j));
+        upper(j) = bi::max(getUpper(l)(j), getUpper(l + 1)(j));
+      }
     }
   }
-
-  return result;
 }
 
 #ifndef __CUDACC__
 template<class V1, class M1>
 template<class Archive>
 void bi::KDTree<V1,M1>::save(Archive& ar, const int version) const {
-  const bool haveRoot = (root != NULL);
-  ar & haveRoot;
-  if (haveRoot) {
-    ar & root;
-  }
+  ar & X;
+  ar & lw;
+  ar & bounds;
+  ar & is;
+  ar & begins;
+  ar & ends;
+  ar & lefts;
 }
 
 template<class V1, class M1>
 template<class Archive>
 void bi::KDTree<V1,M1>::load(Archive& ar, const int version) {
-  bool haveRoot = false;
-  
-  if (root != NULL) {
-    delete root;
-    root = NULL;
-  }
-  
-  ar & haveRoot;
-  if (haveRoot) {
-    ar & root;
-  }
+  ar & X;
+  ar & lw;
+  ar & bounds;
+  ar & is;
+  ar & begins;
+  ar & ends;
+  ar & lefts;
 }
 #endif
+
 #endif
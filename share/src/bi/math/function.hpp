@@ -30,6 +30,10 @@ CUDA_FUNC_BOTH double nanlog(const double x);
 CUDA_FUNC_BOTH float nanlog(const float x);
 CUDA_FUNC_BOTH double exp(const double x);
 CUDA_FUNC_BOTH float exp(const float x);
+CUDA_FUNC_BOTH double expm1(const double x);
+CUDA_FUNC_BOTH float expm1(const float x);
+CUDA_FUNC_BOTH double log1p(const double x);
+CUDA_FUNC_BOTH float log1p(const float x);
 CUDA_FUNC_BOTH double nanexp(const double x);
 CUDA_FUNC_BOTH float nanexp(const float x);
 CUDA_FUNC_BOTH double max(const double x, const double y);
@@ -147,6 +151,22 @@ inline float bi::exp(const float x) {
   return ::expf(x);
 }
 
+inline double bi::expm1(const double x) {
+  return ::expm1(x);
+}
+
+inline float bi::expm1(const float x) {
+  return ::expm1f(x);
+}
+
+inline double bi::log1p(const double x) {
+  return ::log1p(x);
+}
+
+inline float bi::log1p(const float x) {
+  return ::log1pf(x);
+}
+
 inline double bi::nanexp(const double x) {
   return bi::isnan(x) ? 0.0 : bi::exp(x);
 }
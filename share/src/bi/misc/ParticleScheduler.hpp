@@ -0,0 +1,233 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MISC_PARTICLESCHEDULER_HPP
+#define BI_MISC_PARTICLESCHEDULER_HPP
+
+#include "omp.hpp"
+#include "compile.hpp"
+
+namespace bi {
+/**
+ * Scheduler for loops over particles within an OpenMP parallel region.
+ *
+ * @ingroup misc
+ *
+ * Construct in serial code, before the parallel region, then call #next
+ * from each thread of the region until it returns false:
+ *
+ * @code
+ * ParticleScheduler sched(P);
+ * #pragma omp parallel
+ * {
+ *   int p, first, last;
+ *   while (sched.next(first, last)) {
+ *     for (p = first; p < last; ++p) {
+ *       ...
+ *     }
+ *   }
+ * }
+ * @endcode
+ *
+ * Each thread begins with the contiguous block of particles that the
+ * static schedule would give it. Without work stealing, it takes that
+ * block whole. With work stealing, it takes the block a chunk at a time
+ * from the front, and, once it is exhausted, steals the back half of the
+ * remaining particles of another thread, so that threads finishing early,
+ * for example because their particles needed fewer steps of an adaptive
+ * ODE integrator, relieve those that are behind. With ENABLE_PHILOX,
+ * random number streams are tied to particles, not threads (see
+ * RngHost::setStream()), so results do not depend on which thread takes
+ * which particle. Without it, streams are tied to threads, and results
+ * with work stealing are not reproducible from run to run.
+ *
+ * Unlike <tt>omp for</tt>, there is no barrier on completion, other than
+ * that at the end of the parallel region.
+ */
+class ParticleScheduler {
+public:
+  /**
+   * Constructor.
+   *
+   * @param P Number of particles.
+   * @param steal Use work stealing?
+   */
+  ParticleScheduler(const int P, const bool steal = bi_omp_steal);
+
+  /**
+   * Destructor.
+   */
+  ~ParticleScheduler();
+
+  /**
+   * Take the next chunk of particles for the calling thread.
+   *
+   * @param[out] first First particle of chunk.
+   * @param[out] last One past the last particle of chunk.
+   *
+   * @return Was a chunk taken? False when no particles remain.
+   */
+  bool next(int& first, int& last);
+
+private:
+  /**
+   * Particles of one thread, padded to a cache line to avoid false
+   * sharing.
+   */
+  struct Deque {
+    int first;
+    int last;
+    #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+    omp_lock_t lock;
+    #endif
+  } BI_ALIGN(64);
+
+  /**
+   * Take particles from the back of the deque of another thread.
+   *
+   * @param victim Thread id of other thread.
+   * @param[out] first First particle taken.
+   * @param[out] last One past the last particle taken.
+   * @param whole Take all remaining particles, rather than half?
+   *
+   * @return Were any particles taken?
+   */
+  bool steal(const int victim, int& first, int& last, const bool whole);
+
+  /**
+   * Deques, one per thread.
+   */
+  Deque* deques;
+
+  /**
+   * Number of deques.
+   */
+  int T;
+
+  /**
+   * Chunk size.
+   */
+  int chunk;
+
+  /**
+   * Use work stealing?
+   */
+  bool stealing;
+};
+}
+
+#include <algorithm>
+
+inline bi::ParticleScheduler::ParticleScheduler(const int P,
+    const bool steal) :
+    stealing(steal) {
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  T = omp_get_max_threads();
+  #else
+  T = 1;
+  #endif
+
+  /* blocks as for the static schedule, chunks small enough for several
+   * steals per thread */
+  const int block = (P + T - 1)/T;
+  chunk = stealing ? std::max(1, P/(16*T)) : std::max(1, block);
+  deques = new Deque[T];
+  for (int i = 0; i < T; ++i) {
+    deques[i].first = std::min(P, i*block);
+    deques[i].last = std::min(P, (i + 1)*block);
+    #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+    omp_init_lock(&deques[i].lock);
+    #endif
+  }
+}
+
+inline bi::ParticleScheduler::~ParticleScheduler() {
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  for (int i = 0; i < T; ++i) {
+    omp_destroy_lock(&deques[i].lock);
+  }
+  #endif
+  delete[] deques;
+}
+
+inline bool bi::ParticleScheduler::next(int& first, int& last) {
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  const int tid = std::min(omp_get_thread_num(), T - 1);
+  const int size = std::min(omp_get_num_threads(), T);
+  #else
+  const int tid = 0;
+  const int size = 1;
+  #endif
+  Deque& own = deques[tid];
+  int i, victim;
+
+  /* own particles, from the front */
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  omp_set_lock(&own.lock);
+  #endif
+  first = own.first;
+  last = std::min(own.last, own.first + chunk);
+  own.first = last;
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  omp_unset_lock(&own.lock);
+  #endif
+  if (first < last) {
+    return true;
+  }
+
+  /* particles of threads not in this team, which would otherwise be left
+   * undone, whole */
+  for (victim = size; victim < T; ++victim) {
+    if (steal(victim, first, last, true)) {
+      return true;
+    }
+  }
+
+  /* particles of other threads in the team, half at a time */
+  if (stealing) {
+    for (i = 1; i < size; ++i) {
+      victim = (tid + i) % size;
+      if (steal(victim, first, last, false)) {
+        /* keep all but the first chunk in own deque, for others to steal */
+        #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+        omp_set_lock(&own.lock);
+        #endif
+        own.first = std::min(last, first + chunk);
+        own.last = last;
+        last = own.first;
+        #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+        omp_unset_lock(&own.lock);
+        #endif
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+inline bool bi::ParticleScheduler::steal(const int victim, int& first,
+    int& last, const bool whole) {
+  Deque& other = deques[victim];
+
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  omp_set_lock(&other.lock);
+  #endif
+  last = other.last;
+  if (whole) {
+    first = other.first;
+  } else {
+    first = other.last - (other.last - other.first + 1)/2;
+  }
+  other.last = first;
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  omp_unset_lock(&other.lock);
+  #endif
+
+  return first < last;
+}
+
+#endif
@@ -0,0 +1,460 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "Profiler.hpp"
+
+#include "compile.hpp"
+#include "assert.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace bi {
+/**
+ * @internal
+ *
+ * Node of a tree of regions, for Profiler.
+ */
+struct ProfileNode {
+  /**
+   * Constructor.
+   */
+  ProfileNode(const int region, const int parent);
+
+  /**
+   * Region, -1 for the root.
+   */
+  int region;
+
+  /**
+   * Index of parent node, -1 for the root.
+   */
+  int parent;
+
+  /**
+   * Index of child node for each region, -1 if none.
+   */
+  int children[NUM_PROFILE_REGIONS];
+
+  /**
+   * Number of entries.
+   */
+  long count;
+
+  /**
+   * Total time, in nanoseconds.
+   */
+  long long nsecs;
+};
+
+/**
+ * @internal
+ *
+ * Entry into a region, for Profiler.
+ */
+struct ProfileEvent {
+  /**
+   * Region.
+   */
+  int region;
+
+  /**
+   * Time of entry, in nanoseconds.
+   */
+  long long start;
+
+  /**
+   * Time in region, in nanoseconds.
+   */
+  long long nsecs;
+};
+
+/**
+ * @internal
+ *
+ * Tree of regions, for Profiler.
+ */
+class ProfileTree {
+public:
+  /**
+   * Constructor. Creates root.
+   */
+  ProfileTree();
+
+  /**
+   * Find or create child of node.
+   *
+   * @param node Index of node.
+   * @param region Region of child.
+   *
+   * @return Index of child.
+   */
+  int child(const int node, const int region);
+
+  /**
+   * Add subtree of another tree to subtree of this.
+   *
+   * @param o The other tree.
+   * @param from Index of node in @p o.
+   * @param to Index of node in this tree.
+   */
+  void merge(const ProfileTree& o, const int from, const int to);
+
+  /**
+   * Nodes, root first.
+   */
+  std::vector<ProfileNode> nodes;
+};
+
+/**
+ * @internal
+ *
+ * Record of one thread, for Profiler.
+ */
+class ProfileThread {
+public:
+  /**
+   * Constructor.
+   *
+   * @param id Thread id, in order of first use of the profiler.
+   */
+  ProfileThread(const int id);
+
+  /**
+   * Thread id.
+   */
+  int id;
+
+  /**
+   * Tree of regions.
+   */
+  ProfileTree tree;
+
+  /**
+   * Index of node of innermost region entered.
+   */
+  int current;
+
+  /**
+   * Time of entry into each region entered, innermost last.
+   */
+  std::vector<long long> starts;
+
+  /**
+   * Counters.
+   */
+  long counters[NUM_PROFILE_COUNTERS];
+
+  /**
+   * Events, if traced.
+   */
+  std::vector<ProfileEvent> events;
+};
+}
+
+/**
+ * Record of the calling thread.
+ */
+static BI_THREAD bi::ProfileThread* profile_self = NULL;
+
+/**
+ * Generation of the profiler in which #profile_self was created.
+ */
+static BI_THREAD int profile_generation = -1;
+
+/**
+ * Write nodes of a tree, as a JSON array.
+ */
+static void write_nodes(std::ostream& out, const bi::ProfileTree& tree,
+    const int node, const std::string& indent) {
+  const bi::ProfileNode& n = tree.nodes[node];
+  bool first = true;
+  int r;
+
+  out << '[';
+  for (r = 0; r < bi::NUM_PROFILE_REGIONS; ++r) {
+    if (n.children[r] >= 0) {
+      const bi::ProfileNode& c = tree.nodes[n.children[r]];
+      long long self = c.nsecs;
+      for (int r1 = 0; r1 < bi::NUM_PROFILE_REGIONS; ++r1) {
+        if (c.children[r1] >= 0) {
+          self -= tree.nodes[c.children[r1]].nsecs;
+        }
+      }
+
+      out << (first ? "\n" : ",\n") << indent << "  {";
+      out << "\"name\": \"" << bi::Profiler::name(bi::ProfileRegion(r));
+      out << "\", \"count\": " << c.count;
+      out << ", \"total_us\": " << c.nsecs/1.0e3;
+      out << ", \"self_us\": " << self/1.0e3;
+      out << ", \"children\": ";
+      write_nodes(out, tree, n.children[r], indent + "  ");
+      out << '}';
+      first = false;
+    }
+  }
+  if (!first) {
+    out << '\n' << indent;
+  }
+  out << ']';
+}
+
+/**
+ * Sum counts and times of each region over a tree. Regions entered within
+ * themselves count once, at the outermost entry.
+ */
+static void sum_nodes(const bi::ProfileTree& tree, const int node,
+    const unsigned open, long* counts, long long* nsecs) {
+  const bi::ProfileNode& n = tree.nodes[node];
+  unsigned open1 = open;
+
+  if (n.region >= 0 && !(open & (1u << n.region))) {
+    counts[n.region] += n.count;
+    nsecs[n.region] += n.nsecs;
+    open1 |= 1u << n.region;
+  }
+  for (int r = 0; r < bi::NUM_PROFILE_REGIONS; ++r) {
+    if (n.children[r] >= 0) {
+      sum_nodes(tree, n.children[r], open1, counts, nsecs);
+    }
+  }
+}
+
+/**
+ * Write counters, as a JSON object.
+ */
+static void write_counters(std::ostream& out, const long* counters) {
+  out << '{';
+  for (int c = 0; c < bi::NUM_PROFILE_COUNTERS; ++c) {
+    out << (c > 0 ? ", \"" : "\"");
+    out << bi::Profiler::name(bi::ProfileCounter(c)) << "\": " << counters[c];
+  }
+  out << '}';
+}
+
+std::vector<bi::ProfileThread*> bi::Profiler::threads;
+pthread_mutex_t bi::Profiler::mutex = PTHREAD_MUTEX_INITIALIZER;
+long long bi::Profiler::origin = 0;
+int bi::Profiler::generation = 0;
+bool bi::Profiler::enabled = false;
+bool bi::Profiler::tracing = false;
+
+bi::ProfileNode::ProfileNode(const int region, const int parent) :
+    region(region), parent(parent), count(0), nsecs(0) {
+  std::fill(children, children + NUM_PROFILE_REGIONS, -1);
+}
+
+bi::ProfileTree::ProfileTree() {
+  nodes.push_back(ProfileNode(-1, -1));
+}
+
+int bi::ProfileTree::child(const int node, const int region) {
+  int c = nodes[node].children[region];
+  if (c < 0) {
+    c = nodes.size();
+    nodes.push_back(ProfileNode(region, node));
+    nodes[node].children[region] = c;
+  }
+  return c;
+}
+
+void bi::ProfileTree::merge(const ProfileTree& o, const int from,
+    const int to) {
+  for (int r = 0; r < NUM_PROFILE_REGIONS; ++r) {
+    const int from1 = o.nodes[from].children[r];
+    if (from1 >= 0) {
+      const int to1 = child(to, r);
+      nodes[to1].count += o.nodes[from1].count;
+      nodes[to1].nsecs += o.nodes[from1].nsecs;
+      merge(o, from1, to1);
+    }
+  }
+}
+
+bi::ProfileThread::ProfileThread(const int id) : id(id), current(0) {
+  std::fill(counters, counters + NUM_PROFILE_COUNTERS, 0);
+}
+
+void bi::Profiler::init(const bool enable, const bool trace) {
+  term();
+
+  origin = now();
+  tracing = enable && trace;
+  enabled = enable;
+}
+
+void bi::Profiler::term() {
+  enabled = false;
+  tracing = false;
+
+  pthread_mutex_lock(&mutex);
+  for (int i = 0; i < (int)threads.size(); ++i) {
+    delete threads[i];
+  }
+  threads.clear();
+  ++generation;
+  pthread_mutex_unlock(&mutex);
+}
+
+void bi::Profiler::writeJSON(const std::string& file, const int rank) {
+  ProfileTree all;
+  long counters[NUM_PROFILE_COUNTERS];
+  long counts[NUM_PROFILE_REGIONS];
+  long long nsecs[NUM_PROFILE_REGIONS];
+  int i, c, r;
+
+  std::fill(counters, counters + NUM_PROFILE_COUNTERS, 0);
+  std::fill(counts, counts + NUM_PROFILE_REGIONS, 0);
+  std::fill(nsecs, nsecs + NUM_PROFILE_REGIONS, 0);
+
+  pthread_mutex_lock(&mutex);
+  for (i = 0; i < (int)threads.size(); ++i) {
+    all.merge(threads[i]->tree, 0, 0);
+    for (c = 0; c < NUM_PROFILE_COUNTERS; ++c) {
+      counters[c] += threads[i]->counters[c];
+    }
+  }
+  sum_nodes(all, 0, 0u, counts, nsecs);
+
+  std::ofstream out(file.c_str());
+  BI_ERROR_MSG(out.good(), "Could not open profile file " << file);
+  out << std::fixed << std::setprecision(3);
+  out << "{\n";
+  out << "  \"rank\": " << rank << ",\n";
+  out << "  \"threads\": " << threads.size() << ",\n";
+  out << "  \"elapsed_us\": " << (now() - origin)/1.0e3 << ",\n";
+  out << "  \"counters\": ";
+  write_counters(out, counters);
+  out << ",\n";
+
+  /* flat totals of each region */
+  out << "  \"summary\": {";
+  for (r = 0; r < NUM_PROFILE_REGIONS; ++r) {
+    out << (r > 0 ? ",\n" : "\n") << "    \"" << name(ProfileRegion(r));
+    out << "\": {\"count\": " << counts[r];
+    out << ", \"total_us\": " << nsecs[r]/1.0e3 << '}';
+  }
+  out << "\n  },\n";
+
+  /* tree of regions, aggregated over threads */
+  out << "  \"regions\": ";
+  write_nodes(out, all, 0, "  ");
+  out << ",\n";
+
+  /* trees of regions and counters of each thread */
+  out << "  \"per_thread\": [";
+  for (i = 0; i < (int)threads.size(); ++i) {
+    out << (i > 0 ? ",\n" : "\n") << "    {\"thread\": " << threads[i]->id;
+    out << ", \"counters\": ";
+    write_counters(out, threads[i]->counters);
+    out << ", \"regions\": ";
+    write_nodes(out, threads[i]->tree, 0, "    ");
+    out << '}';
+  }
+  out << "\n  ]\n";
+  out << "}\n";
+  pthread_mutex_unlock(&mutex);
+}
+
+void bi::Profiler::writeTrace(const std::string& file, const int rank) {
+  const double end = (now() - origin)/1.0e3;
+  bool first = true;
+  int i, j, c;
+
+  std::ofstream out(file.c_str());
+  BI_ERROR_MSG(out.good(), "Could not open trace file " << file);
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+  pthread_mutex_lock(&mutex);
+  for (i = 0; i < (int)threads.size(); ++i) {
+    const ProfileThread& t = *threads[i];
+
+    out << (first ? "\n" : ",\n");
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << rank;
+    out << ", \"tid\": " << t.id << ", \"args\": {\"name\": \"thread ";
+    out << t.id << "\"}}";
+    first = false;
+
+    for (j = 0; j < (int)t.events.size(); ++j) {
+      const ProfileEvent& e = t.events[j];
+      out << ",\n{\"name\": \"" << name(ProfileRegion(e.region));
+      out << "\", \"cat\": \"libbi\", \"ph\": \"X\", \"ts\": ";
+      out << (e.start - origin)/1.0e3 << ", \"dur\": " << e.nsecs/1.0e3;
+      out << ", \"pid\": " << rank << ", \"tid\": " << t.id << '}';
+    }
+
+    /* counters have no times, so appear once, at the end */
+    for (c = 0; c < NUM_PROFILE_COUNTERS; ++c) {
+      if (t.counters[c] > 0) {
+        out << ",\n{\"name\": \"" << name(ProfileCounter(c));
+        out << "\", \"ph\": \"C\", \"ts\": " << end << ", \"pid\": " << rank;
+        out << ", \"tid\": " << t.id << ", \"args\": {\"value\": ";
+        out << t.counters[c] << "}}";
+      }
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+  out << "\n]}\n";
+}
+
+const char* bi::Profiler::name(const ProfileRegion r) {
+  static const char* names[] = { "predict", "correct", "resample", "gather",
+      "redistribute", "output", "ancestry", "mpi_wait", "interact", "move",
+      "step" };
+  return names[r];
+}
+
+const char* bi::Profiler::name(const ProfileCounter c) {
+  static const char* names[] = { "ode_steps", "ode_rejects" };
+  return names[c];
+}
+
+void bi::Profiler::enter(const ProfileRegion r) {
+  ProfileThread* t = self();
+  t->current = t->tree.child(t->current, r);
+  t->starts.push_back(now());
+}
+
+void bi::Profiler::leave(const ProfileRegion r) {
+  const long long end = now();
+  ProfileThread* t = self();
+  ProfileNode& node = t->tree.nodes[t->current];
+
+  /* pre-condition */
+  BI_ASSERT(node.region == r && !t->starts.empty());
+
+  const long long start = t->starts.back();
+  t->starts.pop_back();
+  ++node.count;
+  node.nsecs += end - start;
+  t->current = node.parent;
+
+  if (tracing) {
+    ProfileEvent e;
+    e.region = r;
+    e.start = start;
+    e.nsecs = end - start;
+    t->events.push_back(e);
+  }
+}
+
+void bi::Profiler::add(const ProfileCounter c, const long n) {
+  self()->counters[c] += n;
+}
+
+bi::ProfileThread* bi::Profiler::self() {
+  if (profile_self == NULL || profile_generation != generation) {
+    pthread_mutex_lock(&mutex);
+    profile_self = new ProfileThread(threads.size());
+    profile_generation = generation;
+    threads.push_back(profile_self);
+    pthread_mutex_unlock(&mutex);
+  }
+  return profile_self;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MISC_PROFILER_HPP
+#define BI_MISC_PROFILER_HPP
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <pthread.h>
+
+namespace bi {
+/**
+ * Regions timed by Profiler.
+ *
+ * @ingroup misc
+ */
+enum ProfileRegion {
+  /**
+   * Propagation of particles to the next time in the schedule.
+   */
+  PROFILE_PREDICT,
+
+  /**
+   * Weighting of particles against observations.
+   */
+  PROFILE_CORRECT,
+
+  /**
+   * Resampling of particles, including gather.
+   */
+  PROFILE_RESAMPLE,
+
+  /**
+   * Copy of resampled particles into place.
+   */
+  PROFILE_GATHER,
+
+  /**
+   * Transfer of resampled particles between processes.
+   */
+  PROFILE_REDISTRIBUTE,
+
+  /**
+   * Write of output.
+   */
+  PROFILE_OUTPUT,
+
+  /**
+   * Write of the ancestry tree of particles.
+   */
+  PROFILE_ANCESTRY,
+
+  /**
+   * Wait on messages or barriers of other processes.
+   */
+  PROFILE_MPI_WAIT,
+
+  /**
+   * Marginal SIR: interaction of \f$\theta\f$-particles.
+   */
+  PROFILE_INTERACT,
+
+  /**
+   * Marginal SIR: PMMH moves of \f$\theta\f$-particles.
+   */
+  PROFILE_MOVE,
+
+  /**
+   * Marginal SIR: step of \f$\theta\f$-particles to the next observation.
+   */
+  PROFILE_STEP,
+
+  /**
+   * Number of regions.
+   */
+  NUM_PROFILE_REGIONS
+};
+
+/**
+ * Counters kept by Profiler.
+ *
+ * @ingroup misc
+ */
+enum ProfileCounter {
+  /**
+   * ODE steps attempted, including rejected steps.
+   */
+  PROFILE_ODE_STEPS,
+
+  /**
+   * ODE steps rejected by error control.
+   */
+  PROFILE_ODE_REJECTS,
+
+  /**
+   * Number of counters.
+   */
+  NUM_PROFILE_COUNTERS
+};
+
+class ProfileThread;
+
+/**
+ * Instrumentation of regions of a run.
+ *
+ * @ingroup misc
+ *
+ * Regions are timed with ProfileScope, on the monotonic clock, and may
+ * nest, so that each thread builds a tree of regions, accumulating the
+ * number of entries and total time of each node. Counters are kept per
+ * thread also. Trees and counters are aggregated over threads at the end
+ * of the run by #writeJSON, and each entry into a region may be recorded
+ * as an event for #writeTrace, in the trace event format read by Chrome
+ * (@c chrome://tracing) and similar viewers.
+ *
+ * The profiler is disabled until #init is called with @p enable true. When
+ * disabled, each region and counter costs only the test of a flag, so that
+ * instrumentation may remain in place in production builds.
+ *
+ * Regions must be entered and left on the same thread, in last-in
+ * first-out order.
+ */
+class Profiler {
+public:
+  /**
+   * Initialise the profiler, discarding anything recorded so far.
+   *
+   * @param enable Enable the profiler?
+   * @param trace Record events for #writeTrace?
+   */
+  static void init(const bool enable, const bool trace = false);
+
+  /**
+   * Disable the profiler and release all that has been recorded.
+   */
+  static void term();
+
+  /**
+   * Is the profiler enabled?
+   */
+  static bool isEnabled();
+
+  /**
+   * Monotonic time.
+   *
+   * @return Number of nanoseconds since an arbitrary, fixed point.
+   */
+  static long long now();
+
+  /**
+   * Add to a counter of the calling thread.
+   *
+   * @param c Counter.
+   * @param n Amount to add.
+   */
+  static void count(const ProfileCounter c, const long n = 1);
+
+  /**
+   * Write aggregate times and counters, in JSON.
+   *
+   * @param file File name.
+   * @param rank Process rank, recorded in the output.
+   */
+  static void writeJSON(const std::string& file, const int rank = 0);
+
+  /**
+   * Write recorded events, in the trace event format.
+   *
+   * @param file File name.
+   * @param rank Process rank, used as the process id of events.
+   */
+  static void writeTrace(const std::string& file, const int rank = 0);
+
+  /**
+   * Name of region.
+   */
+  static const char* name(const ProfileRegion r);
+
+  /**
+   * Name of counter.
+   */
+  static const char* name(const ProfileCounter c);
+
+private:
+  /**
+   * Enter region on the calling thread.
+   */
+  static void enter(const ProfileRegion r);
+
+  /**
+   * Leave region on the calling thread.
+   */
+  static void leave(const ProfileRegion r);
+
+  /**
+   * Add to counter of the calling thread.
+   */
+  static void add(const ProfileCounter c, const long n);
+
+  /**
+   * Record of the calling thread, created on first use.
+   */
+  static ProfileThread* self();
+
+  /**
+   * Records of all threads.
+   */
+  static std::vector<ProfileThread*> threads;
+
+  /**
+   * Mutex guarding #threads.
+   */
+  static pthread_mutex_t mutex;
+
+  /**
+   * Time of #init.
+   */
+  static long long origin;
+
+  /**
+   * Incremented by #init and #term, so that threads discard stale records.
+   */
+  static int generation;
+
+  /**
+   * Is the profiler enabled?
+   */
+  static bool enabled;
+
+  /**
+   * Are events recorded?
+   */
+  static bool tracing;
+
+  friend class ProfileScope;
+};
+
+/**
+ * Time a region for Profiler, from construction to destruction.
+ *
+ * @ingroup misc
+ */
+class ProfileScope {
+public:
+  /**
+   * Constructor. Enters region.
+   *
+   * @param r Region.
+   */
+  ProfileScope(const ProfileRegion r);
+
+  /**
+   * Destructor. Leaves region.
+   */
+  ~ProfileScope();
+
+private:
+  /**
+   * Region.
+   */
+  const ProfileRegion r;
+
+  /**
+   * Was the profiler enabled on entry?
+   */
+  const bool on;
+};
+}
+
+inline bool bi::Profiler::isEnabled() {
+  return enabled;
+}
+
+inline long long bi::Profiler::now() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+inline void bi::Profiler::count(const ProfileCounter c, const long n) {
+  if (enabled) {
+    add(c, n);
+  }
+}
+
+inline bi::ProfileScope::ProfileScope(const ProfileRegion r) : r(r),
+    on(Profiler::isEnabled()) {
+  if (on) {
+    Profiler::enter(r);
+  }
+}
+
+inline bi::ProfileScope::~ProfileScope() {
+  if (on) {
+    Profiler::leave(r);
+  }
+}
+
+#endif
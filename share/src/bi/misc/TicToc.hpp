@@ -8,13 +8,16 @@
 #ifndef BI_MISC_TICTOC_HPP
 #define BI_MISC_TICTOC_HPP
 
-#include <sys/time.h>
+#include <ctime>
 
 namespace bi {
 /**
  * Timing class.
  *
  * @ingroup misc
+ *
+ * Reads the monotonic clock, so that times are unaffected by adjustments
+ * to the system clock. See Profiler for instrumentation of whole runs.
  */
 class TicToc {
 public:
@@ -37,6 +40,8 @@ public:
 
   /**
    * Return absolute time.
+   *
+   * @return Number of microseconds since an arbitrary, fixed point.
    */
   long time();
 
@@ -44,7 +49,7 @@ private:
   /**
    * Time of last call to tic().
    */
-  timeval start;
+  timespec start;
 };
 
 }
@@ -54,21 +59,22 @@ inline bi::TicToc::TicToc() {
 }
 
 inline void bi::TicToc::tic() {
-  gettimeofday(&start, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &start);
 }
 
 inline long bi::TicToc::toc() {
-  timeval end;
-  gettimeofday(&end, NULL);
+  timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
 
-  return (end.tv_sec - start.tv_sec)*1e6 + (end.tv_usec - start.tv_usec);
+  return (end.tv_sec - start.tv_sec)*1000000L
+      + (end.tv_nsec - start.tv_nsec)/1000L;
 }
 
 inline long bi::TicToc::time() {
-  timeval now;
-  gettimeofday(&now, NULL);
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
 
-  return now.tv_sec*1e6 + now.tv_usec;
+  return now.tv_sec*1000000L + now.tv_nsec/1000L;
 }
 
 #endif
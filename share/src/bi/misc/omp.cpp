@@ -8,16 +8,23 @@
 #include "omp.hpp"
 
 #include "../cuda/cuda.hpp"
+#include "../primitive/arena_allocator.hpp"
+
+#include <algorithm>
 
 BI_THREAD int bi_omp_tid;
+BI_THREAD int bi_omp_inner = 1;
 int bi_omp_max_threads;
+bool bi_omp_steal = false;
 
 #ifdef ENABLE_CUDA
 BI_THREAD cublasHandle_t bi_omp_cublas_handle;
 BI_THREAD cudaStream_t bi_omp_cuda_stream;
 #endif
 
-void bi_omp_init(const int threads) {
+void bi_omp_init(const int threads, const bool steal) {
+  bi_omp_steal = steal;
+
   #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
   /* explicitly turn off dynamic threads, required for threadprivate
    * guarantees */
@@ -26,7 +33,8 @@ void bi_omp_init(const int threads) {
   /* allow nested parallelism */
   //omp_set_nested(1);
 
-  /* use static scheduling for pseudorandom sequence reproducibility */
+  /* use static scheduling, except where bi_omp_steal selects work stealing
+   * in loops over particles (see ParticleScheduler) */
   omp_set_schedule(omp_sched_static, 0);
 
   /* set number of threads */
@@ -51,6 +59,7 @@ void bi_omp_init(const int threads) {
   CUDA_CHECKED_CALL(cudaStreamCreate(&bi_omp_cuda_stream));
   #endif
 #endif
+  bi::arena::init(bi_omp_max_threads);
 }
 
 void bi_omp_term() {
@@ -62,3 +71,27 @@ void bi_omp_term() {
     #endif
   }
 }
+
+void bi_omp_split(const int P, const int N, int& outer, int& inner) {
+  inner = std::max(1, std::min(bi_omp_max_threads, N/BI_OMP_GRAIN));
+  outer = std::max(1, std::min(P, bi_omp_max_threads/inner));
+  inner = std::max(1, bi_omp_max_threads/outer);
+
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  if (outer > 1 && inner > 1) {
+    omp_set_nested(1);
+    omp_set_max_active_levels(2);
+  }
+  #endif
+}
+
+void bi_omp_nest(const int inner) {
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  omp_set_num_threads(inner);
+  bi_omp_inner = inner;
+  #endif
+}
+
+void bi_omp_unnest() {
+  bi_omp_inner = 1;
+}
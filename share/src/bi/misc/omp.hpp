@@ -25,11 +25,22 @@
  */
 extern BI_THREAD int bi_omp_tid;
 
+/**
+ * Number of threads at the inner level of nested parallelism entered by
+ * this thread with bi_omp_nest(), one if none.
+ */
+extern BI_THREAD int bi_omp_inner;
+
 /**
  * Maximum number of threads. Saves function calls to omp_get_max_threads().
  */
 extern int bi_omp_max_threads;
 
+/**
+ * Use work stealing in loops over particles? See bi::ParticleScheduler.
+ */
+extern bool bi_omp_steal;
+
 #ifdef ENABLE_CUDA
 /**
  * CUBLAS context handle for CUBLAS function calls (API v2).
@@ -45,6 +56,7 @@ extern BI_THREAD cudaStream_t bi_omp_cuda_stream;
 
 #ifdef __ICC
 #pragma omp threadprivate(bi_omp_tid)
+#pragma omp threadprivate(bi_omp_inner)
 #ifdef ENABLE_CUDA
 #pragma omp threadprivate(bi_omp_cublas_handle)
 #pragma omp threadprivate(bi_omp_cuda_stream)
@@ -55,12 +67,81 @@ extern BI_THREAD cudaStream_t bi_omp_cuda_stream;
  * Initialise OpenMP environment.
  *
  * @param threads Number of threads. Zero for the default.
+ * @param steal Use work stealing in loops over particles?
  */
-void bi_omp_init(const int threads = 0);
+void bi_omp_init(const int threads = 0, const bool steal = false);
 
 /**
  * Terminate OpenMP environment.
  */
 void bi_omp_term();
 
+/**
+ * @def BI_OMP_GRAIN
+ *
+ * Minimum units of work (e.g. particles) per thread at the inner level of
+ * nested parallelism.
+ */
+#define BI_OMP_GRAIN 256
+
+/**
+ * Split threads between the outer and inner levels of nested parallelism.
+ *
+ * @param P Number of outer tasks.
+ * @param N Units of work in each outer task, e.g. number of particles.
+ * @param[out] outer Number of threads at the outer level.
+ * @param[out] inner Number of threads at the inner level.
+ *
+ * Gives each inner thread at least #BI_OMP_GRAIN units of work, then
+ * spreads the remaining threads over as many outer tasks as possible, so
+ * that <tt>outer*inner <= bi_omp_max_threads</tt>. If both levels have more
+ * than one thread, enables nested parallelism; call from serial code only.
+ */
+void bi_omp_split(const int P, const int N, int& outer, int& inner);
+
+/**
+ * Enter the inner level of nested parallelism. Call from each thread of
+ * an outer parallel region.
+ *
+ * @param inner Number of threads at the inner level.
+ *
+ * Sets the number of threads for parallel regions started by this thread,
+ * and reserves for them a block of @p inner ids from bi_omp_thread_id(),
+ * the first of which is used by this thread outside of them.
+ */
+void bi_omp_nest(const int inner);
+
+/**
+ * Leave the inner level of nested parallelism. Call from each thread of an
+ * outer parallel region.
+ */
+void bi_omp_unnest();
+
+/**
+ * Thread id, distinct across all threads, including those of nested
+ * parallel regions. Use to index per-thread resources such as random
+ * number generators and memory pools.
+ *
+ * The runtime may move threads between teams and positions after nested
+ * parallel regions, so this is computed from the position of the thread in
+ * each enclosing team, rather than kept in thread-local storage as for
+ * #bi_omp_tid.
+ */
+inline int bi_omp_thread_id() {
+  #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+  const int level = omp_get_level();
+  if (level <= 1) {
+    return omp_get_thread_num()*bi_omp_inner;
+  } else {
+    int tid = 0;
+    for (int l = 1; l <= level; ++l) {
+      tid = tid*omp_get_team_size(l) + omp_get_ancestor_thread_num(l);
+    }
+    return tid;
+  }
+  #else
+  return 0;
+  #endif
+}
+
 #endif
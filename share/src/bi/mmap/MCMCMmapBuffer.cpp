@@ -0,0 +1,36 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "MCMCMmapBuffer.hpp"
+
+bi::MCMCMmapBuffer::MCMCMmapBuffer(const Model& m, const size_t P,
+    const size_t T, const std::string& file, const FileMode mode,
+    const SchemaMode schema) :
+    SimulatorMmapBuffer(m, P, T, file, mode, schema), llVar(-1), lpVar(-1) {
+  if (mode == NEW || mode == REPLACE) {
+    create();
+  } else {
+    map();
+  }
+}
+
+void bi::MCMCMmapBuffer::create() {
+  std::vector<std::string> dimnames(1, "np");
+  std::vector<size_t> dimlens(1, P);
+
+  setSchema("MCMC", 1);
+
+  llVar = defVar("loglikelihood", MMAP_REAL, dimnames, dimlens);
+  lpVar = defVar("logprior", MMAP_REAL, dimnames, dimlens);
+}
+
+void bi::MCMCMmapBuffer::map() {
+  llVar = inqVar("loglikelihood");
+  BI_ERROR_MSG(llVar >= 0, "No variable loglikelihood in file " << file);
+  lpVar = inqVar("logprior");
+  BI_ERROR_MSG(lpVar >= 0, "No variable logprior in file " << file);
+}
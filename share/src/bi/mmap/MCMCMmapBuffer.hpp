@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MMAP_MCMCMMAPBUFFER_HPP
+#define BI_MMAP_MCMCMMAPBUFFER_HPP
+
+#include "SimulatorMmapBuffer.hpp"
+
+namespace bi {
+/**
+ * Memory-mapped buffer for writing results of marginal MH.
+ *
+ * @ingroup io_mmap
+ */
+class MCMCMmapBuffer: public SimulatorMmapBuffer {
+public:
+  /**
+   * @copydoc MCMCNetCDFBuffer::MCMCNetCDFBuffer()
+   */
+  MCMCMmapBuffer(const Model& m, const size_t P = 0, const size_t T = 0,
+      const std::string& file = "", const FileMode mode = READ_ONLY,
+      const SchemaMode schema = MULTI);
+
+  /**
+   * @copydoc MCMCNetCDFBuffer::writeLogLikelihoods()
+   */
+  template<class V1>
+  void writeLogLikelihoods(const size_t p, const V1 ll);
+
+  /**
+   * @copydoc MCMCNetCDFBuffer::writeLogPriors()
+   */
+  template<class V1>
+  void writeLogPriors(const size_t p, const V1 lp);
+
+protected:
+  /**
+   * Set up structure of new file.
+   */
+  void create();
+
+  /**
+   * Map structure of existing file.
+   */
+  void map();
+
+  /**
+   * Log-likelihoods variable.
+   */
+  int llVar;
+
+  /**
+   * Prior log-densities variable.
+   */
+  int lpVar;
+};
+}
+
+template<class V1>
+void bi::MCMCMmapBuffer::writeLogLikelihoods(const size_t p, const V1 ll) {
+  writeRange(llVar, p, ll);
+}
+
+template<class V1>
+void bi::MCMCMmapBuffer::writeLogPriors(const size_t p, const V1 lp) {
+  writeRange(lpVar, p, lp);
+}
+
+#endif
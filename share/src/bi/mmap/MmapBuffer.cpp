@@ -0,0 +1,198 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "MmapBuffer.hpp"
+
+#include "../misc/assert.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Round up to a multiple of MmapBuffer::ALIGN.
+ */
+static size_t align(const size_t offset) {
+  const size_t a = bi::MmapBuffer::ALIGN;
+  return ((offset + a - 1)/a)*a;
+}
+
+bi::MmapBuffer::MmapBuffer(const std::string& file, const FileMode mode) :
+    file(file), fd(-1), base(NULL), size(0), writable(false) {
+  BI_ERROR_MSG(!file.empty(), "No file specified");
+  switch (mode) {
+  case WRITE:
+    fd = open(file.c_str(), O_RDWR);
+    break;
+  case NEW:
+    fd = open(file.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    break;
+  case REPLACE:
+    fd = open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    break;
+  default:
+    fd = open(file.c_str(), O_RDONLY);
+  }
+  BI_ERROR_MSG(fd >= 0, "Could not open " << file);
+
+  if (mode == NEW || mode == REPLACE) {
+    extend(align(sizeof(MmapFileHeader)));
+
+    MmapFileHeader& header = *reinterpret_cast<MmapFileHeader*>(base);
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "LIBBIMM", 8);
+    header.version = 1;
+    header.byteOrder = 0x01020304;
+    header.first = align(sizeof(MmapFileHeader));
+  } else {
+    map(mode == WRITE);
+    BI_ERROR_MSG(size >= sizeof(MmapFileHeader) &&
+        memcmp(getHeader().magic, "LIBBIMM", 8) == 0,
+        "File " << file << " is not a memory-mapped output file");
+    BI_ERROR_MSG(getHeader().byteOrder == 0x01020304,
+        "File " << file << " has different byte order");
+    BI_ERROR_MSG(getHeader().version == 1,
+        "File " << file << " has unsupported version " << getHeader().version);
+
+    size_t offset = getHeader().first;
+    for (int i = 0; i < (int)getHeader().nvars; ++i) {
+      BI_ERROR_MSG(offset + sizeof(MmapVarHeader) <= size,
+          "File " << file << " is truncated");
+      offsets.push_back(offset);
+      const MmapVarHeader& var = getVar(i);
+      BI_ERROR_MSG(var.data + var.bytes <= size,
+          "File " << file << " is truncated");
+      offset = align(var.data + var.bytes);
+    }
+  }
+}
+
+bi::MmapBuffer::MmapBuffer(const MmapBuffer& o) :
+    file(o.file), fd(-1), base(NULL), size(0), writable(false),
+    offsets(o.offsets) {
+  fd = open(file.c_str(), O_RDONLY);
+  BI_ERROR_MSG(fd >= 0, "Could not open " << file);
+  map(false);
+}
+
+bi::MmapBuffer::~MmapBuffer() {
+  if (writable) {
+    msync(base, size, MS_SYNC);
+  }
+  unmap();
+  close(fd);
+}
+
+void bi::MmapBuffer::clear() {
+  //
+}
+
+int bi::MmapBuffer::inqVar(const std::string& name) const {
+  for (int i = 0; i < getNumVars(); ++i) {
+    if (name.compare(getVar(i).name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void bi::MmapBuffer::setSchema(const std::string& schema,
+    const int version) {
+  BI_ERROR_MSG(schema.length() < sizeof(getHeader().schema),
+      "Schema name " << schema << " is too long");
+
+  MmapFileHeader& header = *reinterpret_cast<MmapFileHeader*>(base);
+  memset(header.schema, 0, sizeof(header.schema));
+  strncpy(header.schema, schema.c_str(), sizeof(header.schema) - 1);
+  header.schemaVersion = version;
+}
+
+int bi::MmapBuffer::defVar(const std::string& name, const MmapType type,
+    const std::vector<std::string>& dimnames,
+    const std::vector<size_t>& dimlens) {
+  /* pre-condition */
+  BI_ASSERT(dimnames.size() == dimlens.size());
+
+  const int ndims = dimnames.size();
+  BI_ERROR_MSG((int)name.length() < MmapVarHeader::MAX_NAME,
+      "Variable name " << name << " is too long");
+  BI_ERROR_MSG(ndims <= MmapVarHeader::MAX_DIMS,
+      "Variable " << name << " has too many dimensions");
+
+  size_t offset, data, bytes = (type == MMAP_FLOAT) ? 4 : 8;
+  int i;
+
+  for (i = 0; i < ndims; ++i) {
+    BI_ERROR_MSG((int)dimnames[i].length() < MmapVarHeader::MAX_NAME,
+        "Dimension name " << dimnames[i] << " is too long");
+    BI_ERROR_MSG(dimlens[i] > 0, "Dimension " << dimnames[i] <<
+        " of variable " << name << " must have fixed length in file " <<
+        file);
+    bytes *= dimlens[i];
+  }
+  if (offsets.empty()) {
+    offset = getHeader().first;
+  } else {
+    offset = align(getVar(offsets.size() - 1).data +
+        getVar(offsets.size() - 1).bytes);
+  }
+  data = align(offset + sizeof(MmapVarHeader));
+  extend(data + bytes);
+
+  MmapVarHeader& var = *reinterpret_cast<MmapVarHeader*>(base + offset);
+  memset(&var, 0, sizeof(var));
+  strncpy(var.name, name.c_str(), MmapVarHeader::MAX_NAME - 1);
+  var.type = type;
+  var.ndims = ndims;
+  for (i = 0; i < ndims; ++i) {
+    strncpy(var.dimnames[i], dimnames[i].c_str(), MmapVarHeader::MAX_NAME - 1);
+    var.dimlens[i] = dimlens[i];
+  }
+  var.data = data;
+  var.bytes = bytes;
+
+  offsets.push_back(offset);
+  ++reinterpret_cast<MmapFileHeader*>(base)->nvars;
+
+  return offsets.size() - 1;
+}
+
+void bi::MmapBuffer::map(const bool writable) {
+  struct stat st;
+  int status = fstat(fd, &st);
+  BI_ERROR_MSG(status == 0, "Could not stat " << file);
+
+  this->size = st.st_size;
+  this->writable = writable;
+  if (size > 0) {
+    void* addr = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE :
+        PROT_READ, MAP_SHARED, fd, 0);
+    BI_ERROR_MSG(addr != MAP_FAILED, "Could not map " << file);
+    base = static_cast<char*>(addr);
+  }
+}
+
+void bi::MmapBuffer::unmap() {
+  if (base != NULL) {
+    munmap(base, size);
+    base = NULL;
+    size = 0;
+  }
+}
+
+void bi::MmapBuffer::extend(const size_t size) {
+  /* allocate blocks up front where the file system supports it, so that a
+   * full disk is reported here rather than as a fault on write */
+  if (posix_fallocate(fd, 0, size) != 0) {
+    int status = ftruncate(fd, size);
+    BI_ERROR_MSG(status == 0, "Could not extend " << file);
+  }
+  unmap();
+  map(true);
+}
@@ -0,0 +1,326 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MMAP_MMAPBUFFER_HPP
+#define BI_MMAP_MMAPBUFFER_HPP
+
+#include "../buffer/buffer.hpp"
+
+#include "boost/cstdint.hpp"
+
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_SINGLE
+#define MMAP_REAL MMAP_FLOAT
+#else
+#define MMAP_REAL MMAP_DOUBLE
+#endif
+
+namespace bi {
+/**
+ * Element types of variables in memory-mapped files. Values are those of
+ * the corresponding @c nc_type in NetCDF.
+ */
+enum MmapType {
+  /**
+   * Single precision floating point.
+   */
+  MMAP_FLOAT = 5,
+
+  /**
+   * Double precision floating point.
+   */
+  MMAP_DOUBLE = 6,
+
+  /**
+   * 64-bit integer.
+   */
+  MMAP_INT64 = 10
+};
+
+/**
+ * Header at the start of a memory-mapped file.
+ *
+ * @ingroup io_mmap
+ */
+struct MmapFileHeader {
+  /**
+   * Magic string, @c LIBBIMM followed by a null character.
+   */
+  char magic[8];
+
+  /**
+   * Version of the layout, currently 1.
+   */
+  boost::uint32_t version;
+
+  /**
+   * The value 0x01020304, in the byte order of the writer.
+   */
+  boost::uint32_t byteOrder;
+
+  /**
+   * Schema of the equivalent NetCDF file, as for its @c libbi_schema
+   * attribute, null terminated.
+   */
+  char schema[32];
+
+  /**
+   * Version of the schema, as for the @c libbi_schema_version attribute.
+   */
+  boost::uint32_t schemaVersion;
+
+  /**
+   * Number of variables.
+   */
+  boost::uint32_t nvars;
+
+  /**
+   * Offset of the first variable record, in bytes from the start of the
+   * file.
+   */
+  boost::uint64_t first;
+};
+
+/**
+ * Header at the start of each variable record of a memory-mapped file.
+ *
+ * @ingroup io_mmap
+ */
+struct MmapVarHeader {
+  /**
+   * Maximum number of dimensions of a variable.
+   */
+  static const int MAX_DIMS = 8;
+
+  /**
+   * Maximum length of a name, including the null terminator.
+   */
+  static const int MAX_NAME = 64;
+
+  /**
+   * Name of variable, null terminated.
+   */
+  char name[MAX_NAME];
+
+  /**
+   * Element type, an MmapType.
+   */
+  boost::int32_t type;
+
+  /**
+   * Number of dimensions.
+   */
+  boost::int32_t ndims;
+
+  /**
+   * Names of dimensions, null terminated, outermost first.
+   */
+  char dimnames[MAX_DIMS][MAX_NAME];
+
+  /**
+   * Lengths of dimensions, outermost first.
+   */
+  boost::uint64_t dimlens[MAX_DIMS];
+
+  /**
+   * Offset of the data, in bytes from the start of the file.
+   */
+  boost::uint64_t data;
+
+  /**
+   * Size of the data, in bytes.
+   */
+  boost::uint64_t bytes;
+};
+
+/**
+ * Memory-mapped flat binary output file.
+ *
+ * @ingroup io_mmap
+ *
+ * The file is written through a shared memory mapping, with the extent of
+ * each variable allocated in full when it is defined, so that writes are
+ * plain memory copies, free of the per-call overhead of NetCDF and HDF5.
+ * It is converted to NetCDF with MmapConverter, or the @c convert command,
+ * for use with downstream tools.
+ *
+ * The layout is self-describing, and in the byte order of the writer:
+ *
+ * @li an MmapFileHeader,
+ * @li for each variable, at the offset given by MmapFileHeader::first for
+ * the first, then at the end of the data of the previous rounded up to a
+ * multiple of #ALIGN bytes for each subsequent, an MmapVarHeader,
+ * @li the data of the variable at MmapVarHeader::data, aligned to #ALIGN
+ * bytes, in row-major order over its dimensions, as for a NetCDF variable
+ * of the same dimensions.
+ *
+ * Variables, dimensions and schema are named as in the NetCDF files of the
+ * equivalent buffers, so that conversion is a straight copy.
+ */
+class MmapBuffer {
+public:
+  /**
+   * Constructor.
+   *
+   * @param file File name.
+   * @param mode File open mode.
+   */
+  MmapBuffer(const std::string& file = "", const FileMode mode = READ_ONLY);
+
+  /**
+   * Copy constructor.
+   *
+   * Maps the file of the argument anew, in read only mode.
+   */
+  MmapBuffer(const MmapBuffer& o);
+
+  /**
+   * Destructor.
+   */
+  ~MmapBuffer();
+
+  /**
+   * Does nothing but maintain interface with caches.
+   */
+  void clear();
+
+  /**
+   * Get file header.
+   */
+  const MmapFileHeader& getHeader() const;
+
+  /**
+   * Get number of variables.
+   */
+  int getNumVars() const;
+
+  /**
+   * Get variable header.
+   *
+   * @param varid Variable id.
+   */
+  const MmapVarHeader& getVar(const int varid) const;
+
+  /**
+   * Get id of variable.
+   *
+   * @param name Name of variable.
+   *
+   * @return Variable id, or -1 if there is no variable of that name.
+   */
+  int inqVar(const std::string& name) const;
+
+  /**
+   * Get data of variable.
+   *
+   * @tparam T Element type.
+   *
+   * @param varid Variable id.
+   */
+  template<class T>
+  T* getBuf(const int varid) const;
+
+  /**
+   * Alignment of variable records and data, in bytes.
+   */
+  static const size_t ALIGN = 64;
+
+protected:
+  /**
+   * Set schema.
+   *
+   * @param schema Schema name.
+   * @param version Schema version.
+   */
+  void setSchema(const std::string& schema, const int version);
+
+  /**
+   * Define variable, allocating its extent in the file.
+   *
+   * @param name Name of variable.
+   * @param type Element type.
+   * @param dimnames Names of dimensions, outermost first.
+   * @param dimlens Lengths of dimensions, outermost first.
+   *
+   * @return Variable id.
+   */
+  int defVar(const std::string& name, const MmapType type,
+      const std::vector<std::string>& dimnames,
+      const std::vector<size_t>& dimlens);
+
+  /**
+   * File name.
+   */
+  std::string file;
+
+private:
+  /**
+   * Map the whole of the file, at its current size.
+   *
+   * @param writable Map for writing?
+   */
+  void map(const bool writable);
+
+  /**
+   * Unmap the file.
+   */
+  void unmap();
+
+  /**
+   * Extend the file, allocating its blocks, and remap.
+   *
+   * @param size New size of file, in bytes.
+   */
+  void extend(const size_t size);
+
+  /**
+   * File descriptor.
+   */
+  int fd;
+
+  /**
+   * Start of mapping.
+   */
+  char* base;
+
+  /**
+   * Size of mapping, in bytes.
+   */
+  size_t size;
+
+  /**
+   * Is the mapping writable?
+   */
+  bool writable;
+
+  /**
+   * Offsets of variable records, in bytes from the start of the file.
+   */
+  std::vector<size_t> offsets;
+};
+}
+
+inline const bi::MmapFileHeader& bi::MmapBuffer::getHeader() const {
+  return *reinterpret_cast<const MmapFileHeader*>(base);
+}
+
+inline int bi::MmapBuffer::getNumVars() const {
+  return static_cast<int>(offsets.size());
+}
+
+inline const bi::MmapVarHeader& bi::MmapBuffer::getVar(const int varid) const {
+  return *reinterpret_cast<const MmapVarHeader*>(base + offsets[varid]);
+}
+
+template<class T>
+inline T* bi::MmapBuffer::getBuf(const int varid) const {
+  return reinterpret_cast<T*>(base + getVar(varid).data);
+}
+
+#endif
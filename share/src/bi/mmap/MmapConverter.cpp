@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "MmapConverter.hpp"
+
+#include "../misc/assert.hpp"
+
+#include "boost/cstdint.hpp"
+
+#include <map>
+
+bi::MmapConverter::MmapConverter(const std::string& file,
+    const NetCDFStorage& storage) :
+    NetCDFBuffer(file, REPLACE, storage) {
+  //
+}
+
+void bi::MmapConverter::convert(const MmapBuffer& in) {
+  std::map<std::string,int> dims;
+  std::map<std::string,int>::iterator iter;
+  std::vector<int> dimids, varids(in.getNumVars());
+  int i, j;
+
+  /* schema */
+  nc_put_att(ncid, "libbi_schema", in.getHeader().schema);
+  nc_put_att(ncid, "libbi_schema_version",
+      static_cast<int>(in.getHeader().schemaVersion));
+  nc_put_att(ncid, "libbi_version", PACKAGE_VERSION);
+
+  /* dimensions and variables */
+  for (i = 0; i < in.getNumVars(); ++i) {
+    const MmapVarHeader& var = in.getVar(i);
+    dimids.resize(var.ndims);
+    for (j = 0; j < var.ndims; ++j) {
+      iter = dims.find(var.dimnames[j]);
+      if (iter == dims.end()) {
+        dimids[j] = nc_def_dim(ncid, var.dimnames[j], var.dimlens[j]);
+        dims.insert(std::make_pair(std::string(var.dimnames[j]), dimids[j]));
+      } else {
+        dimids[j] = iter->second;
+        BI_ERROR_MSG(nc_inq_dimlen(ncid, dimids[j]) == var.dimlens[j],
+            "Dimension " << var.dimnames[j] << " of variable " << var.name <<
+            " has inconsistent length");
+      }
+    }
+    varids[i] = defVar(var.name, static_cast<nc_type>(var.type), dimids);
+  }
+  nc_enddef(ncid);
+
+  /* data */
+  for (i = 0; i < in.getNumVars(); ++i) {
+    switch (in.getVar(i).type) {
+    case MMAP_FLOAT:
+      nc_put_var(ncid, varids[i], in.getBuf<float>(i));
+      break;
+    case MMAP_DOUBLE:
+      nc_put_var(ncid, varids[i], in.getBuf<double>(i));
+      break;
+    case MMAP_INT64:
+      BI_ASSERT(sizeof(long) == sizeof(boost::int64_t));
+      nc_put_var(ncid, varids[i], reinterpret_cast<const long*>(
+          in.getBuf<boost::int64_t>(i)));
+      break;
+    default:
+      BI_ERROR_MSG(false, "Variable " << in.getVar(i).name <<
+          " has unknown type " << in.getVar(i).type);
+    }
+  }
+}
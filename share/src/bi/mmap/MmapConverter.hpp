@@ -0,0 +1,45 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MMAP_MMAPCONVERTER_HPP
+#define BI_MMAP_MMAPCONVERTER_HPP
+
+#include "MmapBuffer.hpp"
+#include "../netcdf/NetCDFBuffer.hpp"
+
+namespace bi {
+/**
+ * Converter from memory-mapped output file to NetCDF.
+ *
+ * @ingroup io_mmap
+ *
+ * The NetCDF file has the same variables, dimensions and schema attributes
+ * as would have been written by the equivalent NetCDF buffer, so may be
+ * used with downstream tools as usual. Storage options apply as for other
+ * NetCDF buffers.
+ */
+class MmapConverter: public NetCDFBuffer {
+public:
+  /**
+   * Constructor.
+   *
+   * @param file NetCDF file name. Replaced if it exists.
+   * @param storage Storage options.
+   */
+  MmapConverter(const std::string& file,
+      const NetCDFStorage& storage = NetCDFBuffer::defaults);
+
+  /**
+   * Convert.
+   *
+   * @param in Memory-mapped file.
+   */
+  void convert(const MmapBuffer& in);
+};
+}
+
+#endif
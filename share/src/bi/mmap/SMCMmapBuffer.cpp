@@ -0,0 +1,31 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "SMCMmapBuffer.hpp"
+
+bi::SMCMmapBuffer::SMCMmapBuffer(const Model& m, const size_t P,
+    const size_t T, const std::string& file, const FileMode mode,
+    const SchemaMode schema) :
+    MCMCMmapBuffer(m, P, T, file, mode, schema), lwVar(-1) {
+  if (mode == NEW || mode == REPLACE) {
+    create();
+  } else {
+    map();
+  }
+}
+
+void bi::SMCMmapBuffer::create() {
+  setSchema("SMC", 1);
+
+  lwVar = defVar("logweight", MMAP_REAL, std::vector<std::string>(1, "np"),
+      std::vector<size_t>(1, P));
+}
+
+void bi::SMCMmapBuffer::map() {
+  lwVar = inqVar("logweight");
+  BI_ERROR_MSG(lwVar >= 0, "No variable logweight in file " << file);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MMAP_SMCMMAPBUFFER_HPP
+#define BI_MMAP_SMCMMAPBUFFER_HPP
+
+#include "MCMCMmapBuffer.hpp"
+
+namespace bi {
+/**
+ * Memory-mapped buffer for writing results of SMC.
+ *
+ * @ingroup io_mmap
+ */
+class SMCMmapBuffer: public MCMCMmapBuffer {
+public:
+  /**
+   * @copydoc SMCNetCDFBuffer::SMCNetCDFBuffer()
+   */
+  SMCMmapBuffer(const Model& m, const size_t P = 0, const size_t T = 0,
+      const std::string& file = "", const FileMode mode = READ_ONLY,
+      const SchemaMode schema = MULTI);
+
+  /**
+   * @copydoc SMCNetCDFBuffer::writeLogWeights()
+   */
+  template<class V1>
+  void writeLogWeights(const size_t p, const V1 lws);
+
+protected:
+  /**
+   * Set up structure of new file.
+   */
+  void create();
+
+  /**
+   * Map structure of existing file.
+   */
+  void map();
+
+  /**
+   * Log-weights variable.
+   */
+  int lwVar;
+};
+}
+
+template<class V1>
+void bi::SMCMmapBuffer::writeLogWeights(const size_t p, const V1 lws) {
+  writeRange(lwVar, p, lws);
+}
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "SimulatorMmapBuffer.hpp"
+
+bi::SimulatorMmapBuffer::SimulatorMmapBuffer(const Model& m, const size_t P,
+    const size_t T, const std::string& file, const FileMode mode,
+    const SchemaMode schema) :
+    MmapBuffer(file, mode), m(m), schema(schema), P(P), T(T), tVar(-1),
+    clockVar(-1), vars(NUM_VAR_TYPES) {
+  BI_ERROR_MSG(schema != FLEXI,
+      "Flexi schema is not supported by memory-mapped buffers");
+  if (mode == NEW || mode == REPLACE) {
+    BI_ERROR_MSG(P > 0 && T > 0,
+        "Memory-mapped buffers need numbers of samples and times");
+    create();
+  } else {
+    map();
+  }
+}
+
+void bi::SimulatorMmapBuffer::create() {
+  std::vector<std::string> dimnames;
+  std::vector<size_t> dimlens;
+  VarType type;
+  Var* var;
+  Dim* dim;
+  int id, i, j;
+
+  setSchema("Simulator", 1);
+
+  /* time variable */
+  if (schema != PARAM_ONLY) {
+    tVar = defVar("time", MMAP_REAL, std::vector<std::string>(1, "nr"),
+        std::vector<size_t>(1, T));
+  }
+
+  /* other variables, dimensions as in SimulatorNetCDFBuffer::createVar() */
+  for (i = 0; i < NUM_VAR_TYPES; ++i) {
+    type = static_cast<VarType>(i);
+    vars[type].resize(m.getNumVars(type), -1);
+
+    if (((type == D_VAR || type == R_VAR) && schema != PARAM_ONLY)
+        || type == P_VAR) {
+      for (id = 0; id < (int)vars[type].size(); ++id) {
+        var = m.getVar(type, id);
+        if (var->hasOutput()) {
+          dimnames.clear();
+          dimlens.clear();
+          if (!var->getOutputOnce()) {
+            dimnames.push_back("nr");
+            dimlens.push_back(T);
+          }
+          for (j = var->getNumDims() - 1; j >= 0; --j) {
+            dim = var->getDim(j);
+            dimnames.push_back(dim->getName());
+            dimlens.push_back(dim->getSize());
+          }
+          if (hasSamples(var)) {
+            dimnames.push_back("np");
+            dimlens.push_back(P);
+          }
+          vars[type][id] = defVar(var->getOutputName(), MMAP_REAL, dimnames,
+              dimlens);
+        }
+      }
+    }
+  }
+
+  /* execution time variable */
+  clockVar = defVar("clock", MMAP_INT64, std::vector<std::string>(),
+      std::vector<size_t>());
+}
+
+void bi::SimulatorMmapBuffer::map() {
+  VarType type;
+  Var* var;
+  int id, i;
+
+  if (schema != PARAM_ONLY) {
+    tVar = inqVar("time");
+    BI_ERROR_MSG(tVar >= 0, "No variable time in file " << file);
+  }
+  for (i = 0; i < NUM_VAR_TYPES; ++i) {
+    type = static_cast<VarType>(i);
+    vars[type].resize(m.getNumVars(type), -1);
+
+    if (((type == D_VAR || type == R_VAR) && schema != PARAM_ONLY)
+        || type == P_VAR) {
+      for (id = 0; id < (int)vars[type].size(); ++id) {
+        var = m.getVar(type, id);
+        if (var->hasOutput()) {
+          vars[type][id] = inqVar(var->getOutputName());
+          BI_ERROR_MSG(vars[type][id] >= 0, "No variable " <<
+              var->getOutputName() << " in file " << file);
+        }
+      }
+    }
+  }
+  clockVar = inqVar("clock");
+  BI_ERROR_MSG(clockVar >= 0, "No variable clock in file " << file);
+}
+
+bool bi::SimulatorMmapBuffer::hasSamples(const Var* var) const {
+  return schema != DEFAULT || var->getType() != P_VAR;
+}
+
+void bi::SimulatorMmapBuffer::writeTime(const size_t k, const real& t) {
+  getBuf<real>(tVar)[k] = t;
+}
+
+void bi::SimulatorMmapBuffer::writeStart(const size_t k, const long& start) {
+  BI_ERROR_MSG(false, "Flexi schema is not supported by memory-mapped buffers");
+}
+
+void bi::SimulatorMmapBuffer::writeLen(const size_t k, const long& len) {
+  BI_ERROR_MSG(false, "Flexi schema is not supported by memory-mapped buffers");
+}
+
+void bi::SimulatorMmapBuffer::writeClock(const long clock) {
+  *getBuf<boost::int64_t>(clockVar) = clock;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MMAP_SIMULATORMMAPBUFFER_HPP
+#define BI_MMAP_SIMULATORMMAPBUFFER_HPP
+
+#include "MmapBuffer.hpp"
+#include "../model/Model.hpp"
+#include "../math/scalar.hpp"
+
+#include <vector>
+
+namespace bi {
+/**
+ * Memory-mapped buffer for writing results of Simulator.
+ *
+ * @ingroup io_mmap
+ *
+ * Holds the same variables as SimulatorNetCDFBuffer. As extents are
+ * allocated up front, the numbers of samples and times must be given, and
+ * the flexi schema is not supported.
+ */
+class SimulatorMmapBuffer: public MmapBuffer {
+public:
+  /**
+   * @copydoc SimulatorNetCDFBuffer::SimulatorNetCDFBuffer()
+   */
+  SimulatorMmapBuffer(const Model& m, const size_t P = 0, const size_t T = 0,
+      const std::string& file = "", const FileMode mode = READ_ONLY,
+      const SchemaMode schema = DEFAULT);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeTime()
+   */
+  void writeTime(const size_t k, const real& t);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeTimes()
+   */
+  template<class V1>
+  void writeTimes(const size_t k, const V1 ts);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeParameters()
+   */
+  template<class M1>
+  void writeParameters(const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeParameters()
+   */
+  template<class M1>
+  void writeParameters(const size_t p, const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeState()
+   */
+  template<class M1>
+  void writeState(const size_t k, const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeState()
+   */
+  template<class M1>
+  void writeState(const size_t k, const size_t p, const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeState()
+   */
+  template<class M1>
+  void writeState(const VarType type, const size_t k, const size_t p,
+      const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeStateVar()
+   */
+  template<class M1>
+  void writeStateVar(const VarType type, const int id, const size_t k,
+      const size_t p, const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeStart()
+   */
+  void writeStart(const size_t k, const long& start);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeLen()
+   */
+  void writeLen(const size_t k, const long& len);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeClock()
+   */
+  void writeClock(const long clock);
+
+protected:
+  /**
+   * Set up structure of new file.
+   */
+  void create();
+
+  /**
+   * Map structure of existing file.
+   */
+  void map();
+
+  /**
+   * Does variable have a sample dimension?
+   *
+   * @param var Variable.
+   */
+  bool hasSamples(const Var* var) const;
+
+  /**
+   * Write range of vector variable.
+   *
+   * @tparam V1 Vector type.
+   *
+   * @param varid Variable id.
+   * @param k Starting index.
+   * @param x Vector.
+   */
+  template<class V1>
+  void writeRange(const int varid, const size_t k, const V1 x);
+
+  /**
+   * Model.
+   */
+  const Model& m;
+
+  /**
+   * Schema mode.
+   */
+  SchemaMode schema;
+
+  /**
+   * Number of samples.
+   */
+  size_t P;
+
+  /**
+   * Number of times.
+   */
+  size_t T;
+
+  /**
+   * Time variable.
+   */
+  int tVar;
+
+  /**
+   * Execution time variable.
+   */
+  int clockVar;
+
+  /**
+   * Model variables, indexed by type.
+   */
+  std::vector<std::vector<int> > vars;
+};
+}
+
+#include "../math/view.hpp"
+
+template<class V1>
+void bi::SimulatorMmapBuffer::writeTimes(const size_t k, const V1 ts) {
+  writeRange(tVar, k, ts);
+}
+
+template<class M1>
+void bi::SimulatorMmapBuffer::writeParameters(const M1 X) {
+  writeState(P_VAR, 0, 0, X);
+}
+
+template<class M1>
+void bi::SimulatorMmapBuffer::writeParameters(const size_t p, const M1 X) {
+  writeState(P_VAR, 0, p, X);
+}
+
+template<class M1>
+void bi::SimulatorMmapBuffer::writeState(const size_t k, const M1 X) {
+  writeState(R_VAR, k, 0, columns(X, 0, m.getNetSize(R_VAR)));
+  writeState(D_VAR, k, 0,
+      columns(X, m.getNetSize(R_VAR), m.getNetSize(D_VAR)));
+}
+
+template<class M1>
+void bi::SimulatorMmapBuffer::writeState(const size_t k, const size_t p,
+    const M1 X) {
+  writeState(R_VAR, k, p, columns(X, 0, m.getNetSize(R_VAR)));
+  writeState(D_VAR, k, p,
+      columns(X, m.getNetSize(R_VAR), m.getNetSize(D_VAR)));
+}
+
+template<class M1>
+void bi::SimulatorMmapBuffer::writeState(const VarType type, const size_t k,
+    const size_t p, const M1 X) {
+  Var* var;
+  int id;
+
+  for (id = 0; id < m.getNumVars(type); ++id) {
+    var = m.getVar(type, id);
+    writeStateVar(type, id, k, p, columns(X, var->getStart(),
+        var->getSize()));
+  }
+}
+
+template<class M1>
+void bi::SimulatorMmapBuffer::writeStateVar(const VarType type,
+    const int id, const size_t k, const size_t p, const M1 X) {
+  Var* var = m.getVar(type, id);
+
+  if (var->hasOutput()) {
+    const int varid = vars[type][id];
+    BI_ASSERT(varid >= 0);
+
+    /* the extent for one time is a matrix with samples along rows and
+     * variable elements along columns, as for the state */
+    const int size = var->getSize();
+    const int P1 = hasSamples(var) ? P : 1;
+    const size_t k1 = var->getOutputOnce() ? 0 : k;
+    host_matrix_reference<real> Y(getBuf<real>(varid) + k1*size*P1, P1,
+        size, P1);
+
+    BI_ASSERT(p + X.size1() <= (size_t)P1);
+    rows(Y, p, X.size1()) = X;
+    synchronize(M1::on_device);
+  }
+}
+
+template<class V1>
+void bi::SimulatorMmapBuffer::writeRange(const int varid, const size_t k,
+    const V1 x) {
+  host_vector_reference<real> y(getBuf<real>(varid),
+      getVar(varid).bytes/sizeof(real));
+
+  BI_ASSERT(k + x.size() <= (size_t)y.size());
+  subrange(y, k, x.size()) = x;
+  synchronize(V1::on_device);
+}
+
+#endif
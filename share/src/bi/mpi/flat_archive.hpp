@@ -0,0 +1,335 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MPI_FLATARCHIVE_HPP
+#define BI_MPI_FLATARCHIVE_HPP
+
+#include "../misc/location.hpp"
+#include "../misc/assert.hpp"
+
+#include "boost/serialization/serialization.hpp"
+#include "boost/serialization/split_member.hpp"
+#include "boost/serialization/array.hpp"
+#include "boost/type_traits/is_arithmetic.hpp"
+#include "boost/type_traits/remove_const.hpp"
+#include "boost/mpl/bool.hpp"
+
+#include <vector>
+#include <cstring>
+
+namespace bi {
+template<class B, Location L>
+class State;
+
+/**
+ * @internal
+ */
+namespace flat_detail {
+template<class B, Location L>
+char test(const State<B,L>*);
+
+long test(...);
+}
+
+/**
+ * Can objects of a type be written to and read from a flat archive?
+ *
+ * @ingroup mpi
+ *
+ * @tparam T Type.
+ *
+ * Arithmetic types, and states derived from State, which hold only scalars,
+ * vectors and matrices, are flat. Other types, such as caches, with
+ * standard containers and pointers among their members, are not.
+ */
+template<class T>
+struct is_flat {
+  static const bool value = boost::is_arithmetic<T>::value
+      || sizeof(flat_detail::test(static_cast<T*>(0))) == sizeof(char);
+};
+
+/**
+ * Output archive writing the raw bytes of objects into a contiguous buffer.
+ *
+ * @ingroup mpi
+ *
+ * The archive reuses the save() and load() member functions written for
+ * Boost.Serialization, but none of its archive machinery: there is no
+ * header, no class information, and no object tracking, and arrays of
+ * arithmetic types, such as the columns of vectors and matrices, are copied
+ * as blocks. Only types satisfying is_flat should be written. The buffer is
+ * appended to, so that the same buffer may be reused across many transfers
+ * without reallocation.
+ */
+class flat_oarchive {
+public:
+  typedef boost::mpl::bool_<false> is_loading;
+  typedef boost::mpl::bool_<true> is_saving;
+
+  /**
+   * Arrays of arithmetic types are copied as blocks.
+   */
+  struct use_array_optimization {
+    template<class T>
+    struct apply: public boost::mpl::bool_<boost::is_arithmetic<T>::value> {
+      //
+    };
+  };
+
+  /**
+   * Constructor.
+   *
+   * @param buf Buffer to append to.
+   */
+  flat_oarchive(std::vector<char>& buf);
+
+  /**
+   * Write object.
+   */
+  template<class T>
+  flat_oarchive& operator&(const T& o);
+
+  /**
+   * Write object.
+   */
+  template<class T>
+  flat_oarchive& operator<<(const T& o);
+
+  /**
+   * Write array.
+   */
+  template<class T, std::size_t N>
+  flat_oarchive& operator<<(const T (&o)[N]);
+
+  /**
+   * Write array wrapper, as created by boost::serialization::make_array().
+   */
+  template<class A>
+  void save_array(const A& a, const unsigned version);
+
+  /**
+   * Write raw bytes.
+   */
+  void save_binary(const void* ptr, const std::size_t n);
+
+private:
+  /**
+   * Write arithmetic object.
+   */
+  template<class T>
+  void save(const T& o, const boost::mpl::true_);
+
+  /**
+   * Write class object.
+   */
+  template<class T>
+  void save(const T& o, const boost::mpl::false_);
+
+  /**
+   * Buffer.
+   */
+  std::vector<char>& buf;
+};
+
+/**
+ * Input archive reading objects written by flat_oarchive.
+ *
+ * @ingroup mpi
+ */
+class flat_iarchive {
+public:
+  typedef boost::mpl::bool_<true> is_loading;
+  typedef boost::mpl::bool_<false> is_saving;
+
+  /**
+   * @copydoc flat_oarchive::use_array_optimization
+   */
+  struct use_array_optimization {
+    template<class T>
+    struct apply: public boost::mpl::bool_<boost::is_arithmetic<T>::value> {
+      //
+    };
+  };
+
+  /**
+   * Constructor.
+   *
+   * @param buf Buffer.
+   * @param n Size of buffer, in bytes.
+   */
+  flat_iarchive(const char* buf, const std::size_t n);
+
+  /**
+   * Read object.
+   */
+  template<class T>
+  flat_iarchive& operator&(T& o);
+
+  /**
+   * Read object.
+   */
+  template<class T>
+  flat_iarchive& operator>>(T& o);
+
+  /**
+   * Read array.
+   */
+  template<class T, std::size_t N>
+  flat_iarchive& operator>>(T (&o)[N]);
+
+  /**
+   * Read array wrapper, as created by boost::serialization::make_array().
+   */
+  template<class A>
+  void load_array(A& a, const unsigned version);
+
+  /**
+   * Read raw bytes.
+   */
+  void load_binary(void* ptr, const std::size_t n);
+
+  /**
+   * Have all bytes been read?
+   */
+  bool done() const;
+
+private:
+  /**
+   * Read arithmetic object.
+   */
+  template<class T>
+  void load(T& o, const boost::mpl::true_);
+
+  /**
+   * Read class object.
+   */
+  template<class T>
+  void load(T& o, const boost::mpl::false_);
+
+  /**
+   * Buffer.
+   */
+  const char* buf;
+
+  /**
+   * Size of buffer.
+   */
+  std::size_t n;
+
+  /**
+   * Position in buffer.
+   */
+  std::size_t pos;
+};
+}
+
+BOOST_SERIALIZATION_USE_ARRAY_OPTIMIZATION(bi::flat_oarchive)
+BOOST_SERIALIZATION_USE_ARRAY_OPTIMIZATION(bi::flat_iarchive)
+
+inline bi::flat_oarchive::flat_oarchive(std::vector<char>& buf) :
+    buf(buf) {
+  //
+}
+
+template<class T>
+inline bi::flat_oarchive& bi::flat_oarchive::operator&(const T& o) {
+  return *this << o;
+}
+
+template<class T>
+inline bi::flat_oarchive& bi::flat_oarchive::operator<<(const T& o) {
+  save(o, boost::mpl::bool_<boost::is_arithmetic<T>::value>());
+  return *this;
+}
+
+template<class T, std::size_t N>
+inline bi::flat_oarchive& bi::flat_oarchive::operator<<(const T (&o)[N]) {
+  for (std::size_t i = 0; i < N; ++i) {
+    *this << o[i];
+  }
+  return *this;
+}
+
+template<class A>
+inline void bi::flat_oarchive::save_array(const A& a,
+    const unsigned version) {
+  /* only arrays of arithmetic types get here, see use_array_optimization */
+  save_binary(a.address(), a.count()*sizeof(*a.address()));
+}
+
+inline void bi::flat_oarchive::save_binary(const void* ptr,
+    const std::size_t n) {
+  const char* begin = static_cast<const char*>(ptr);
+  buf.insert(buf.end(), begin, begin + n);
+}
+
+template<class T>
+inline void bi::flat_oarchive::save(const T& o, const boost::mpl::true_) {
+  save_binary(&o, sizeof(T));
+}
+
+template<class T>
+inline void bi::flat_oarchive::save(const T& o, const boost::mpl::false_) {
+  boost::serialization::serialize_adl(*this, const_cast<T&>(o), 0u);
+}
+
+inline bi::flat_iarchive::flat_iarchive(const char* buf,
+    const std::size_t n) :
+    buf(buf), n(n), pos(0) {
+  //
+}
+
+template<class T>
+inline bi::flat_iarchive& bi::flat_iarchive::operator&(T& o) {
+  return *this >> o;
+}
+
+template<class T>
+inline bi::flat_iarchive& bi::flat_iarchive::operator>>(T& o) {
+  load(o, boost::mpl::bool_<boost::is_arithmetic<T>::value>());
+  return *this;
+}
+
+template<class T, std::size_t N>
+inline bi::flat_iarchive& bi::flat_iarchive::operator>>(T (&o)[N]) {
+  for (std::size_t i = 0; i < N; ++i) {
+    *this >> o[i];
+  }
+  return *this;
+}
+
+template<class A>
+inline void bi::flat_iarchive::load_array(A& a, const unsigned version) {
+  /* only arrays of arithmetic types get here, see use_array_optimization */
+  load_binary(a.address(), a.count()*sizeof(*a.address()));
+}
+
+inline void bi::flat_iarchive::load_binary(void* ptr, const std::size_t n) {
+  /* pre-condition */
+  BI_ASSERT(pos + n <= this->n);
+
+  std::memcpy(ptr, buf + pos, n);
+  pos += n;
+}
+
+inline bool bi::flat_iarchive::done() const {
+  return pos == n;
+}
+
+template<class T>
+inline void bi::flat_iarchive::load(T& o, const boost::mpl::true_) {
+  load_binary(&o, sizeof(T));
+}
+
+template<class T>
+inline void bi::flat_iarchive::load(T& o, const boost::mpl::false_) {
+  /* const for wrappers such as those of boost::serialization::make_array() */
+  boost::serialization::serialize_adl(*this,
+      const_cast<typename boost::remove_const<T>::type&>(o), 0u);
+}
+
+#endif
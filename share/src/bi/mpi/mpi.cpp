@@ -6,6 +6,7 @@
  * $Date$
  */
 #include "mpi.hpp"
+#include "../misc/Profiler.hpp"
 
 #include <sstream>
 
@@ -42,6 +43,7 @@ int bi::mpi_size() {
 
 void bi::mpi_barrier() {
 #ifdef ENABLE_MPI
+  ProfileScope scope(PROFILE_MPI_WAIT);
   boost::mpi::communicator world;
   world.barrier();
 #endif
@@ -64,6 +64,12 @@ enum MPITag {
   MPI_TAG_ADAPTER_PROPOSAL,
   MPI_TAG_ADAPTER_SAMPLES,
 
+  /*
+   * Resampler tags.
+   */
+  MPI_TAG_RESAMPLER_OFFSPRING,
+  MPI_TAG_RESAMPLER_SENT,
+
   /*
    * Base tag index when redistributing particles.
    */
@@ -0,0 +1,273 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MPI_RESAMPLER_DECENTRALISEDRESAMPLER_HPP
+#define BI_MPI_RESAMPLER_DECENTRALISEDRESAMPLER_HPP
+
+#include "DistributedResampler.hpp"
+#include "../../resampler/SystematicResampler.hpp"
+
+namespace bi {
+/**
+ * Systematic resampler for particle filter, distributed using MPI without
+ * gathering weights to any one process.
+ *
+ * @ingroup method_resampler
+ *
+ * DistributedResampler gathers the weights of all processes to the root,
+ * which selects offspring for all particles and broadcasts them, so that
+ * time and memory on the root grow with the total number of particles.
+ * Here, each process instead contributes only the sum of its weights to an
+ * exclusive prefix sum (@c MPI_Exscan) and, with a uniform variate shared
+ * by all processes, selects systematic offspring for its own particles.
+ * Offspring are ordered across processes, the first @c P belonging to
+ * process 0, the next @c P to process 1, and so on, so that those of
+ * particles falling outside the share of their own process are sent to
+ * the process that owns them. Where no process is more than @c P offspring
+ * out of balance, as is usual, particles move only between neighbouring
+ * processes.
+ *
+ * Apart from the particles themselves, the messages of each process are of
+ * constant size, except for one all-gather of the first offspring of each
+ * process, and time and memory on each process are
+ * \f$O(P + \mathrm{size})\f$. Pipelined mode (see
+ * DistributedResampler::setPipeline()) is not supported, and is ignored.
+ */
+class DecentralisedResampler: public DistributedResampler<SystematicResampler> {
+public:
+  /**
+   * @copydoc DistributedResampler::DistributedResampler()
+   */
+  DecentralisedResampler(const double essRel = 0.5,
+      const bool anytime = false);
+
+  /**
+   * @copydoc DistributedResampler::resample()
+   */
+  template<class S1>
+  bool resample(Random& rng, const ScheduleElement now, S1& s)
+      throw (ParticleFilterDegeneratedException);
+
+private:
+  /**
+   * Select offspring for particles of this process.
+   *
+   * @tparam V1 Vector type.
+   * @tparam V2 Integer vector type.
+   *
+   * @param rng Random number generator.
+   * @param lws Log-weights of particles of this process.
+   * @param[out] Os Cumulative offspring of particles of this process, in
+   * the global ordering of offspring.
+   * @param[out] bs First offspring of each process, in the global ordering,
+   * with the total number of offspring last.
+   */
+  template<class V1, class V2>
+  static void offspring(Random& rng, const V1 lws, V2 Os, V2 bs)
+      throw (ParticleFilterDegeneratedException);
+};
+}
+
+#include "../mpi.hpp"
+#include "../../math/temp_vector.hpp"
+#include "../../math/function.hpp"
+
+inline bi::DecentralisedResampler::DecentralisedResampler(
+    const double essRel, const bool anytime) :
+    DistributedResampler<SystematicResampler>(essRel, anytime) {
+  //
+}
+
+template<class S1>
+bool bi::DecentralisedResampler::resample(Random& rng,
+    const ScheduleElement now, S1& s)
+        throw (ParticleFilterDegeneratedException) {
+  typedef temp_host_vector<real>::type vector_type;
+  typedef temp_host_vector<int>::type int_vector_type;
+
+  boost::mpi::communicator world;
+  const int rank = world.rank();
+  const int size = world.size();
+  const int P = s.size();
+
+  bool r = (now.isObserved() || now.hasBridge())
+      && s.ess < this->essRel * size * P;
+  if (r) {
+    vector_type lws(P);
+    int_vector_type Os(P), os(P), as1(P), bs(size + 1);
+    std::vector<std::vector<int> > is(size), ns(size), ks(size);
+    std::list<boost::mpi::request> recvs;
+    int i, j, k, d, n, first, last;
+
+    lws = s.logWeights();
+    synchronize();
+    offspring(rng, lws, Os, bs);
+
+    /* split the offspring of each particle between this process and those
+     * owning them */
+    first = bs(rank);
+    for (i = 0; i < P; ++i) {
+      last = Os(i);
+      os(i) = 0;
+      for (d = first/P; first < last; ++d) {
+        n = bi::min(last, (d + 1)*P) - first;
+        if (d == rank) {
+          os(i) = n;
+        } else {
+          is[d].push_back(i);
+          ns[d].push_back(n);
+          ks[d].push_back(ks[d].size());
+        }
+        first += n;
+      }
+    }
+
+    /* transfer particles to the processes owning their offspring */
+    {
+      ProfileScope scope(PROFILE_REDISTRIBUTE);
+
+      /* send particles, each with its number of offspring */
+      bufs1.resize(size);
+      bufs2.resize(size);
+      for (d = 0; d < size; ++d) {
+        if (!is[d].empty()) {
+          sends.push_back(world.isend(d, MPI_TAG_RESAMPLER_OFFSPRING, &ns[d][0],
+              ns[d].size()));
+          post(world, d, true, s.s1s, is[d], ks[d], MPI_TAG_PARTICLE,
+              bufs1[d], sends);
+          post(world, d, true, s.out1s, is[d], ks[d], MPI_TAG_PARTICLE + 1,
+              bufs2[d], sends);
+        }
+      }
+
+      /* receive numbers of offspring from processes whose offspring overlap
+       * with those of this process, and choose positions for the particles
+       * among those left without offspring here */
+      for (d = 0, j = 0; d < size; ++d) {
+        is[d].clear();
+        ks[d].clear();
+        if (d != rank && bs(d) < bs(d + 1) && bs(d) < (rank + 1)*P
+            && bs(d + 1) > rank*P) {
+          ProfileScope wait(PROFILE_MPI_WAIT);
+          boost::mpi::status status = world.probe(d,
+              MPI_TAG_RESAMPLER_OFFSPRING);
+          ns[d].resize(*status.count<int>());
+          world.recv(d, MPI_TAG_RESAMPLER_OFFSPRING, &ns[d][0], ns[d].size());
+          for (k = 0; k < (int)ns[d].size(); ++k) {
+            while (os(j) > 0) {
+              ++j;
+            }
+            os(j) = ns[d][k];
+            is[d].push_back(j);
+            ks[d].push_back(k);
+            ++j;
+          }
+        }
+      }
+
+      /* positions chosen for received particles may still be being sent,
+       * so sends must complete first; particles only move toward the
+       * process owning their offspring, so this cannot deadlock */
+      {
+        ProfileScope wait(PROFILE_MPI_WAIT);
+        boost::mpi::wait_all(sends.begin(), sends.end());
+      }
+      sends.clear();
+      for (d = 0; d < size; ++d) {
+        if (!is[d].empty()) {
+          post(world, d, false, s.s1s, is[d], ks[d], MPI_TAG_PARTICLE,
+              bufs1[d], recvs);
+          post(world, d, false, s.out1s, is[d], ks[d], MPI_TAG_PARTICLE + 1,
+              bufs2[d], recvs);
+        }
+      }
+      {
+        ProfileScope wait(PROFILE_MPI_WAIT);
+        boost::mpi::wait_all(recvs.begin(), recvs.end());
+      }
+      for (d = 0; d < size; ++d) {
+        if (!is[d].empty()) {
+          unpack(s.s1s, is[d], bufs1[d]);
+          unpack(s.out1s, is[d], bufs2[d]);
+        }
+      }
+    }
+
+    offspringToAncestors(os, as1);
+    permute(as1);
+    {
+      ProfileScope scope(PROFILE_GATHER);
+      s.gather(now, as1);
+    }
+    set_elements(s.logWeights(), s.logLikelihood);
+    this->shuffle(rng, s);
+    this->rotate(s);
+  } else if (now.hasOutput()) {
+    seq_elements(s.ancestors(), 0);
+  }
+  return r;
+}
+
+template<class V1, class V2>
+void bi::DecentralisedResampler::offspring(Random& rng, const V1 lws, V2 Os,
+    V2 bs) throw (ParticleFilterDegeneratedException) {
+  /* pre-conditions */
+  BI_ASSERT(!V1::on_device);
+  BI_ASSERT(!V2::on_device);
+  BI_ASSERT(lws.size() == Os.size());
+
+  boost::mpi::communicator world;
+  const int rank = world.rank();
+  const int size = world.size();
+  const int P = lws.size();
+  const int N = P*size;
+
+  double in[2], out[2], mx, u, W, W1 = 0.0, Ws = 0.0;
+  int i, first, last;
+
+  /* maximum log-weight, and the uniform variate of the root, in one
+   * reduction */
+  in[0] = max_reduce(lws);
+  in[1] = (rank == 0) ? rng.uniform(0.0, 1.0) : -1.0;
+  boost::mpi::all_reduce(world, in, 2, out, boost::mpi::maximum<double>());
+  mx = out[0];
+  u = out[1];
+
+  /* sum of weights of this process, those before it, and all */
+  for (i = 0; i < P; ++i) {
+    W1 += bi::nanexp(static_cast<double>(lws(i)) - mx);
+  }
+  MPI_Exscan(&W1, &Ws, 1, MPI_DOUBLE, MPI_SUM, world);
+  if (rank == 0) {
+    Ws = 0.0;  // undefined on the first process
+  }
+  W = boost::mpi::all_reduce(world, W1, std::plus<double>());
+  if (!(W > 0.0)) {
+    throw ParticleFilterDegeneratedException();
+  }
+
+  /* first offspring of each process */
+  first = (rank == 0) ? 0 : bi::min(N, static_cast<int>(Ws/W*N + u));
+  {
+    ProfileScope scope(PROFILE_MPI_WAIT);
+    boost::mpi::all_gather(world, first, bs.buf());
+  }
+  bs(size) = N;
+  last = bs(rank + 1);
+
+  /* cumulative offspring, clamped to the first offspring of the next
+   * process, which that process computed from its own prefix sum, so that
+   * processes agree exactly at their boundaries */
+  for (i = 0; i < P - 1; ++i) {
+    Ws += bi::nanexp(static_cast<double>(lws(i)) - mx);
+    first = bi::max(first, bi::min(last, static_cast<int>(Ws/W*N + u)));
+    Os(i) = first;
+  }
+  Os(P - 1) = last;
+}
+
+#endif
@@ -9,16 +9,71 @@
 #define BI_MPI_RESAMPLER_DISTRIBUTEDRESAMPLER_HPP
 
 #include "../../resampler/Resampler.hpp"
+#include "../mpi.hpp"
+#include "../../misc/Profiler.hpp"
 
 #include <vector>
+#include <list>
 
 namespace bi {
+/**
+ * @internal
+ *
+ * Summary of the log-weights of one or more processes, reduced across
+ * processes by DistributedResampler::reduce() in one collective.
+ */
+struct resample_summary {
+  /**
+   * Number of particles.
+   */
+  double P;
+
+  /**
+   * Maximum log-weight.
+   */
+  double mx;
+
+  /**
+   * Sum of weights, relative to the maximum.
+   */
+  double sum1;
+
+  /**
+   * Sum of squared weights, relative to the maximum.
+   */
+  double sum2;
+
+  /**
+   * Merge summary of other processes into this one.
+   */
+  void merge(const resample_summary& o);
+
+  /**
+   * MPI datatype.
+   */
+  static MPI_Datatype type();
+
+  /**
+   * MPI operation, calling merge().
+   */
+  static MPI_Op op();
+};
+
 /**
  * Resampler for particle filter, distributed using MPI.
  *
  * @ingroup method_resampler
  *
  * @tparam R Resampler type.
+ *
+ * In pipelined mode (see setPipeline()), resample() returns once transfers
+ * of particles between processes have been posted, and next() gives
+ * particles to propagate in turn: first those neither received from
+ * another process nor copied from one that is, then those of each other
+ * process as they arrive, blocking until the next has sent them. Rotation
+ * of particles around processes is deferred until all have been
+ * propagated. Pipelined mode is ignored in anytime mode, where the order of
+ * particles matters.
  */
 template<class R>
 class DistributedResampler: public Resampler<R> {
@@ -33,6 +88,11 @@ public:
    */
   DistributedResampler(const double essRel = 0.5, const bool anytime = false);
 
+  /**
+   * Use pipelined mode?
+   */
+  void setPipeline(const bool pipeline);
+
   /**
    * @copydoc Resampler::reduce(const V1, double*)
    */
@@ -46,7 +106,13 @@ public:
   bool resample(Random& rng, const ScheduleElement now, S1& s)
       throw (ParticleFilterDegeneratedException);
 
-private:
+  /**
+   * @copydoc Resampler::next()
+   */
+  template<class S1>
+  bool next(Random& rng, S1& s, std::vector<int>& ps);
+
+protected:
   /**
    * Redistribute offspring around processes so that all processes have same
    * number of particles.
@@ -57,50 +123,237 @@ private:
    * @param[in,out] O Offspring matrix. Rows index particles, columns index
    * processes.
    * @param[in,out] s State.
+   *
+   * All particles passing between the same pair of processes are packed
+   * into one buffer, with flat_oarchive, and sent as one message. Particle
+   * types that are not flat (see is_flat), such as output caches, are sent
+   * one message per particle, with Boost.MPI.
    */
   template<class M1, class S1>
   void redistribute(M1 O, S1& s);
 
   /**
-   * Rotate particles around process so that all processes have a random
-   * sample.
+   * Post transfers of particles between this process and one other.
    *
-   * @tparam S1 State type.
+   * @tparam T1 Particle type.
    *
-   * @param[in,out] s State.
+   * @param world Communicator, which must outlive the requests.
+   * @param peer Rank of the other process.
+   * @param send Send, rather than receive?
+   * @param xs Particles.
+   * @param is Indices of particles to send, or to receive into, in order.
+   * @param ks Transfer numbers of particles, for tags.
+   * @param tag Base tag.
+   * @param buf Buffer.
+   * @param[in,out] reqs Requests.
    */
-  template<class S1>
-  void rotate(S1& s);
+  template<class T1>
+  static void post(boost::mpi::communicator& world, const int peer,
+      const bool send, std::vector<T1*>& xs,
+      const std::vector<int>& is, const std::vector<int>& ks, const int tag,
+      std::vector<char>& buf, std::list<boost::mpi::request>& reqs);
+
+  /**
+   * Complete transfers of particles received from one other process, once
+   * requests have completed.
+   *
+   * @tparam T1 Particle type.
+   *
+   * @param xs Particles.
+   * @param is Indices of particles to receive into, in order.
+   * @param buf Buffer.
+   */
+  template<class T1>
+  static void unpack(std::vector<T1*>& xs, const std::vector<int>& is,
+      const std::vector<char>& buf);
+
+  /**
+   * Post transfers of flat particles, as one message.
+   */
+  template<class T1>
+  static void post(boost::mpi::communicator& world, const int peer,
+      const bool send, std::vector<T1*>& xs,
+      const std::vector<int>& is, const std::vector<int>& ks, const int tag,
+      std::vector<char>& buf, std::list<boost::mpi::request>& reqs,
+      const boost::mpl::true_);
+
+  /**
+   * Post transfers of other particles, one message each.
+   */
+  template<class T1>
+  static void post(boost::mpi::communicator& world, const int peer,
+      const bool send, std::vector<T1*>& xs,
+      const std::vector<int>& is, const std::vector<int>& ks, const int tag,
+      std::vector<char>& buf, std::list<boost::mpi::request>& reqs,
+      const boost::mpl::false_);
+
+  /**
+   * Complete transfers of flat particles.
+   */
+  template<class T1>
+  static void unpack(std::vector<T1*>& xs, const std::vector<int>& is,
+      const std::vector<char>& buf, const boost::mpl::true_);
 
   /**
-   * @name Timing
+   * Complete transfers of other particles, which is a no-op.
    */
-  //@{
+  template<class T1>
+  static void unpack(std::vector<T1*>& xs, const std::vector<int>& is,
+      const std::vector<char>& buf, const boost::mpl::false_);
+
+  /**
+   * Buffers for particle states, indexed by rank of the other process, kept
+   * between calls to avoid reallocation.
+   */
+  std::vector<std::vector<char> > bufs1;
+
+  /**
+   * Buffers for output, indexed by rank of the other process.
+   */
+  std::vector<std::vector<char> > bufs2;
+
+  /**
+   * Stage of a pipelined resample.
+   */
+  enum Stage {
+    /**
+     * No resample pending.
+     */
+    DONE,
+
+    /**
+     * Particles of this process are yet to be given by next().
+     */
+    LOCAL,
+
+    /**
+     * Particles of other processes are yet to be given by next().
+     */
+    REMOTE
+  };
+
+  /**
+   * Use pipelined mode?
+   */
+  bool pipeline;
+
   /**
-   * Report resample timings to stderr.
+   * Stage of pending resample.
    */
-  static void reportResample(int timestep, int rank, long usecs);
+  Stage stage;
 
   /**
-   * Report redistribution timings to stderr.
+   * Ancestors of pending resample.
    */
-  static void reportRedistribute(int timestep, int rank, long usecs);
-  //@}
+  std::vector<int> as;
+
+  /**
+   * For each particle of pending resample, the rank of the process it is
+   * being received from, -1 if none.
+   */
+  std::vector<int> from;
+
+  /**
+   * Receives of the notices of processes yet to be received from, which
+   * each sends once it has posted its particles.
+   */
+  std::list<boost::mpi::request> notices;
+
+  /**
+   * Particles to receive into, and their transfer numbers, indexed by rank
+   * of the other process.
+   */
+  std::vector<std::vector<int> > recvIs, recvKs;
+
+  /**
+   * Pending sends.
+   */
+  std::list<boost::mpi::request> sends;
+
+  /**
+   * Rotate particles around process so that all processes have a random
+   * sample.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] s State.
+   */
+  template<class S1>
+  void rotate(S1& s);
 };
 }
 
-#include "../mpi.hpp"
+#include "../flat_archive.hpp"
+#include "../../math/function.hpp"
 #include "../../math/temp_vector.hpp"
 #include "../../math/temp_matrix.hpp"
 #include "../../math/view.hpp"
 
+inline void bi::resample_summary::merge(const resample_summary& o) {
+  const double mx1 = bi::max(mx, o.mx);
+
+  /* zero sums are tested for, as a maximum of -inf gives NaN scales */
+  sum1 = ((sum1 > 0.0) ? sum1*bi::exp(mx - mx1) : 0.0)
+      + ((o.sum1 > 0.0) ? o.sum1*bi::exp(o.mx - mx1) : 0.0);
+  sum2 = ((sum2 > 0.0) ? sum2*bi::exp(2.0*(mx - mx1)) : 0.0)
+      + ((o.sum2 > 0.0) ? o.sum2*bi::exp(2.0*(o.mx - mx1)) : 0.0);
+  mx = mx1;
+  P += o.P;
+}
+
+namespace bi {
+/**
+ * @internal
+ *
+ * MPI user function for resample_summary::op().
+ */
+inline void resample_summary_merge(void* in, void* inout, int* len,
+    MPI_Datatype* type) {
+  resample_summary* x = static_cast<resample_summary*>(in);
+  resample_summary* y = static_cast<resample_summary*>(inout);
+  for (int i = 0; i < *len; ++i) {
+    y[i].merge(x[i]);
+  }
+}
+}
+
+inline MPI_Datatype bi::resample_summary::type() {
+  static MPI_Datatype type = MPI_DATATYPE_NULL;
+  if (type == MPI_DATATYPE_NULL) {
+    int err = MPI_Type_contiguous(4, MPI_DOUBLE, &type);
+    if (err == MPI_SUCCESS) {
+      err = MPI_Type_commit(&type);
+    }
+    if (err != MPI_SUCCESS) {
+      boost::throw_exception(boost::mpi::exception("MPI_Type_commit", err));
+    }
+  }
+  return type;
+}
+
+inline MPI_Op bi::resample_summary::op() {
+  static MPI_Op op = MPI_OP_NULL;
+  if (op == MPI_OP_NULL) {
+    int err = MPI_Op_create(&resample_summary_merge, 1, &op);
+    if (err != MPI_SUCCESS) {
+      boost::throw_exception(boost::mpi::exception("MPI_Op_create", err));
+    }
+  }
+  return op;
+}
+
 template<class R>
 bi::DistributedResampler<R>::DistributedResampler(const double essRel,
     const bool anytime) :
-    Resampler<R>(essRel, anytime) {
+    Resampler<R>(essRel, anytime), pipeline(false), stage(DONE) {
   //
 }
 
+template<class R>
+void bi::DistributedResampler<R>::setPipeline(const bool pipeline) {
+  this->pipeline = pipeline;
+}
+
 template<class R>
 template<class V1>
 double bi::DistributedResampler<R>::reduce(const V1 lws, double* lW) {
@@ -108,31 +361,33 @@ double bi::DistributedResampler<R>::reduce(const V1 lws, double* lW) {
 
   boost::mpi::communicator world;
   const int size = world.size();
-  T1 mx, sum1, sum2;
-  int P;
-
-  P = lws.size();
-  P = boost::mpi::all_reduce(world, P, std::plus<int>());
-  mx = max_reduce(lws);
-  mx = boost::mpi::all_reduce(world, mx, boost::mpi::maximum<T1>());
-
-  sum1 = op_reduce(lws, nan_minus_and_exp_functor<T1>(mx), 0.0,
+  resample_summary local, global;
+
+  /* summarise locally, relative to the local maximum, then merge across
+   * processes in one collective, rather than one for each of the count,
+   * maximum and sums */
+  local.P = lws.size();
+  local.mx = max_reduce(lws);
+  local.sum1 = op_reduce(lws, nan_minus_and_exp_functor<T1>(local.mx), 0.0,
       thrust::plus<T1>());
-  sum1 = boost::mpi::all_reduce(world, sum1, std::plus<T1>());
+  local.sum2 = op_reduce(lws, nan_minus_exp_and_square_functor<T1>(local.mx),
+      0.0, thrust::plus<T1>());
 
-  sum2 = op_reduce(lws, nan_minus_exp_and_square_functor<T1>(mx), 0.0,
-      thrust::plus<T1>());
-  sum2 = boost::mpi::all_reduce(world, sum2, std::plus<T1>());
+  int err = MPI_Allreduce(&local, &global, 1, resample_summary::type(),
+      resample_summary::op(), world);
+  if (err != MPI_SUCCESS) {
+    boost::throw_exception(boost::mpi::exception("MPI_Allreduce", err));
+  }
 
   if (lW != NULL) {
-    *lW = mx + bi::log(sum1);
+    *lW = global.mx + bi::log(global.sum1);
     if (this->anytime) {
-      *lW -= bi::log(double(size * (P - 1)));
+      *lW -= bi::log(global.P - size);  // one active particle per process
     } else {
-      *lW -= bi::log(double(size * P));
+      *lW -= bi::log(global.P);
     }
   }
-  return (sum1 * sum1) / sum2;
+  return (global.sum1 * global.sum1) / global.sum2;
 }
 
 template<class R>
@@ -148,11 +403,6 @@ bool bi::DistributedResampler<R>::resample(Random& rng,
   bool r = (now.isObserved() || now.hasBridge())
       && s.ess < this->essRel * size * P;
   if (r) {
-#if ENABLE_DIAGNOSTICS == 2
-    synchronize();
-    TicToc clock;
-#endif
-
     typename temp_host_matrix<real>::type Lws(P, size);
     typename temp_host_matrix<int>::type O(P, size);
     typename temp_host_vector<int>::type as1(P);
@@ -163,9 +413,11 @@ bool bi::DistributedResampler<R>::resample(Random& rng,
       typename temp_host_vector<real>::type lws1(P);
       lws1 = s.logWeights();
       synchronize();
+      ProfileScope scope(PROFILE_MPI_WAIT);
       boost::mpi::gather(world, lws1.buf(), P, vec(Lws).buf(), 0);
     } else {
       /* already on host */
+      ProfileScope scope(PROFILE_MPI_WAIT);
       boost::mpi::gather(world, s.logWeights().buf(), P, vec(Lws).buf(), 0);
     }
 
@@ -176,20 +428,27 @@ bool bi::DistributedResampler<R>::resample(Random& rng,
       R::precompute(vec(Lws), pre);
       R::offspring(rng, vec(Lws), P * size, vec(O), pre);
     }
-    boost::mpi::broadcast(world, O.buf(), P * size, 0);
+    {
+      ProfileScope scope(PROFILE_MPI_WAIT);
+      boost::mpi::broadcast(world, O.buf(), P * size, 0);
+    }
 
-#if ENABLE_DIAGNOSTICS == 2
-    long usecs = clock.toc();
-    const int timesteps = s.front()->getOutput().size() - 1;
-    reportResample(timesteps, rank, usecs);
-#endif
     redistribute(O, s);
     offspringToAncestors(column(O, rank), as1);
     permute(as1);
-    s.gather(now, as1);
+    {
+      ProfileScope scope(PROFILE_GATHER);
+      s.gather(now, as1);
+    }
     set_elements(s.logWeights(), s.logLikelihood);
-    this->shuffle(rng, s);
-    rotate(s);
+    if (stage == LOCAL) {
+      /* particles copied from those still being received are copied again
+       * by next() once they arrive */
+      as.assign(as1.buf(), as1.buf() + P);
+    } else {
+      this->shuffle(rng, s);
+      rotate(s);
+    }
   } else if (now.hasOutput()) {
     seq_elements(s.ancestors(), 0);
   }
@@ -197,10 +456,67 @@ bool bi::DistributedResampler<R>::resample(Random& rng,
 }
 
 template<class R>
-void bi::DistributedResampler<R>::reportResample(int timestep, int rank,
-    long usecs) {
-  fprintf(stderr, "%d: DistributedResampler::resample proc %d %ld us\n",
-      timestep, rank, usecs);
+template<class S1>
+bool bi::DistributedResampler<R>::next(Random& rng, S1& s,
+    std::vector<int>& ps) {
+  boost::mpi::communicator world;
+  const int P = s.size();
+  std::list<boost::mpi::request> reqs;
+  std::pair<boost::mpi::status,std::list<boost::mpi::request>::iterator> notice;
+  int i, r;
+
+  ps.clear();
+  if (stage == DONE) {
+    return Resampler<R>::next(rng, s, ps);
+  } else if (stage == LOCAL) {
+    /* particles neither being received, nor copies of one that is */
+    for (i = 0; i < P; ++i) {
+      if (from[as[i]] < 0) {
+        ps.push_back(i);
+      }
+    }
+    stage = REMOTE;
+    return true;
+  } else if (!notices.empty()) {
+    /* take particles from whichever process is first to send them; notices
+     * carry no data, so that this blocks in MPI_Waitany rather than
+     * polling */
+    ProfileScope scope(PROFILE_MPI_WAIT);
+    notice = boost::mpi::wait_any(notices.begin(), notices.end());
+    r = notice.first.source();
+    notices.erase(notice.second);
+
+    post(world, r, false, s.s1s, recvIs[r], recvKs[r], MPI_TAG_PARTICLE,
+        bufs1[r], reqs);
+    post(world, r, false, s.out1s, recvIs[r], recvKs[r], MPI_TAG_PARTICLE + 1,
+        bufs2[r], reqs);
+    boost::mpi::wait_all(reqs.begin(), reqs.end());
+    unpack(s.s1s, recvIs[r], bufs1[r]);
+    unpack(s.out1s, recvIs[r], bufs2[r]);
+
+    /* the received particles, and copies of them */
+    for (i = 0; i < P; ++i) {
+      if (from[as[i]] == r) {
+        if (as[i] != i) {
+          *s.s1s[i] = *s.s1s[as[i]];
+          *s.out1s[i] = *s.out1s[as[i]];
+        }
+        ps.push_back(i);
+      }
+    }
+    return true;
+  } else {
+    /* all particles have been propagated */
+    {
+      ProfileScope scope(PROFILE_MPI_WAIT);
+      boost::mpi::wait_all(sends.begin(), sends.end());
+    }
+    sends.clear();
+    this->shuffle(rng, s);
+    rotate(s);
+    stage = DONE;
+    return false;
+  }
 }
 
 template<class R>
@@ -208,27 +524,27 @@ template<class M1, class S1>
 void bi::DistributedResampler<R>::redistribute(M1 O, S1& s) {
   typedef typename temp_host_vector<int>::type int_vector_type;
 
-#if ENABLE_DIAGNOSTICS == 2
-  synchronize();
-  TicToc clock;
-#endif
+  ProfileScope scope(PROFILE_REDISTRIBUTE);
 
   boost::mpi::communicator world;
   const int rank = world.rank();
   const int size = world.size();
   const int P = O.size1();
 
-  int sendi, recvi, sendj, recvj, sendn, recvn, n, sendr, recvr, tag = 0;
+  int sendi, recvi, sendj, recvj, sendn, recvn, n, sendr, recvr, k = 0, r;
 
   int_vector_type Ps(size);  // number of particles in each process
   int_vector_type ranks(size);  // ranks sorted by number of particles
+  std::vector<std::vector<int> > is(size);  // particles to transfer, by rank
+  std::vector<std::vector<int> > ks(size);  // transfer numbers, by rank
   std::list < boost::mpi::request > reqs;
+  bool send = false;
 
   sum_rows(O, Ps);
   seq_elements(ranks, 0);
   sort_by_key(Ps, ranks);
 
-  /* redistribute offspring */
+  /* plan redistribution of offspring */
   sendj = size - 1;
   recvj = 0;
   sendi = 0;
@@ -264,15 +580,16 @@ void bi::DistributedResampler<R>::redistribute(M1 O, S1& s) {
     BI_ASSERT(Ps(sendj) >= P);
     BI_ASSERT(Ps(recvj) <= P);
 
-    /* transfer particle */
+    /* plan transfer of particle */
     if (rank == recvr) {
-      reqs.push_back(world.irecv(sendr, tag, *s.s1s[recvi]));
-      reqs.push_back(world.irecv(sendr, tag + 1, *s.out1s[recvi]));
+      is[sendr].push_back(recvi);
+      ks[sendr].push_back(k);
     } else if (rank == sendr) {
-      reqs.push_back(world.isend(recvr, tag, *s.s1s[sendi]));
-      reqs.push_back(world.isend(recvr, tag + 1, *s.out1s[sendi]));
+      is[recvr].push_back(sendi);
+      ks[recvr].push_back(k);
+      send = true;
     }
-    tag += 2;
+    ++k;
 
     if (Ps(sendj) == P) {
       --sendj;
@@ -284,19 +601,145 @@ void bi::DistributedResampler<R>::redistribute(M1 O, S1& s) {
     }
   }
 
-  /* wait for all copies to complete */
-  boost::mpi::wait_all(reqs.begin(), reqs.end());
+  /* transfer particles, one message per pair of processes where possible;
+   * a process only sends or only receives, so that the probes of receivers
+   * in post() cannot deadlock */
+  bufs1.resize(size);
+  bufs2.resize(size);
+  if (pipeline && !this->anytime) {
+    /* post sends, which copy particles out as they go, so that particles
+     * may be propagated before sends complete; leave receives to next() */
+    from.assign(P, -1);
+    notices.clear();
+    recvIs.swap(is);
+    recvKs.swap(ks);
+    for (r = 0; r < size; ++r) {
+      if (!recvIs[r].empty()) {
+        if (send) {
+          post(world, r, true, s.s1s, recvIs[r], recvKs[r], MPI_TAG_PARTICLE,
+              bufs1[r], sends);
+          post(world, r, true, s.out1s, recvIs[r], recvKs[r],
+              MPI_TAG_PARTICLE + 1, bufs2[r], sends);
+          sends.push_back(world.isend(r, MPI_TAG_RESAMPLER_SENT));
+        } else {
+          for (n = 0; n < (int)recvIs[r].size(); ++n) {
+            from[recvIs[r][n]] = r;
+          }
+          notices.push_back(world.irecv(r, MPI_TAG_RESAMPLER_SENT));
+        }
+      }
+    }
+    stage = LOCAL;
+  } else {
+    for (r = 0; r < size; ++r) {
+      if (!is[r].empty()) {
+        post(world, r, send, s.s1s, is[r], ks[r], MPI_TAG_PARTICLE, bufs1[r],
+            reqs);
+        post(world, r, send, s.out1s, is[r], ks[r], MPI_TAG_PARTICLE + 1,
+            bufs2[r], reqs);
+      }
+    }
 
-#if ENABLE_DIAGNOSTICS == 2
-  long usecs = clock.toc();
-  const int timesteps = s.front()->getOutput().size() - 1;
-  reportRedistribute(timesteps, rank, usecs);
-#endif
+    /* wait for all copies to complete */
+    {
+      ProfileScope wait(PROFILE_MPI_WAIT);
+      boost::mpi::wait_all(reqs.begin(), reqs.end());
+    }
+
+    if (!send) {
+      for (r = 0; r < size; ++r) {
+        if (!is[r].empty()) {
+          unpack(s.s1s, is[r], bufs1[r]);
+          unpack(s.out1s, is[r], bufs2[r]);
+        }
+      }
+    }
+  }
+}
+
+template<class R>
+template<class T1>
+void bi::DistributedResampler<R>::post(boost::mpi::communicator& world,
+    const int peer, const bool send, std::vector<T1*>& xs, const std::vector<int>& is,
+    const std::vector<int>& ks, const int tag, std::vector<char>& buf,
+    std::list<boost::mpi::request>& reqs) {
+  /* pre-condition */
+  BI_ASSERT(is.size() == ks.size());
+
+  post(world, peer, send, xs, is, ks, tag, buf, reqs,
+      boost::mpl::bool_<is_flat<T1>::value>());
+}
+
+template<class R>
+template<class T1>
+void bi::DistributedResampler<R>::unpack(std::vector<T1*>& xs,
+    const std::vector<int>& is, const std::vector<char>& buf) {
+  unpack(xs, is, buf, boost::mpl::bool_<is_flat<T1>::value>());
+}
+
+template<class R>
+template<class T1>
+void bi::DistributedResampler<R>::post(boost::mpi::communicator& world,
+    const int peer, const bool send, std::vector<T1*>& xs, const std::vector<int>& is,
+    const std::vector<int>& ks, const int tag, std::vector<char>& buf,
+    std::list<boost::mpi::request>& reqs, const boost::mpl::true_) {
+  if (send) {
+    buf.clear();
+    flat_oarchive ar(buf);
+    for (int i = 0; i < (int)is.size(); ++i) {
+      ar << *xs[is[i]];
+    }
+    reqs.push_back(world.isend(peer, tag, &buf[0], buf.size()));
+  } else {
+    /* size unknown until the message arrives */
+    boost::mpi::status status = world.probe(peer, tag);
+    buf.resize(*status.count<char>());
+    reqs.push_back(world.irecv(peer, tag, &buf[0], buf.size()));
+  }
+}
+
+template<class R>
+template<class T1>
+void bi::DistributedResampler<R>::post(boost::mpi::communicator& world,
+    const int peer, const bool send, std::vector<T1*>& xs, const std::vector<int>& is,
+    const std::vector<int>& ks, const int tag, std::vector<char>& buf,
+    std::list<boost::mpi::request>& reqs, const boost::mpl::false_) {
+  /* tags above those of the single messages of flat particles, and unique
+   * to each transfer */
+  for (int i = 0; i < (int)is.size(); ++i) {
+    if (send) {
+      reqs.push_back(world.isend(peer, tag + 2*(ks[i] + 1), *xs[is[i]]));
+    } else {
+      reqs.push_back(world.irecv(peer, tag + 2*(ks[i] + 1), *xs[is[i]]));
+    }
+  }
+}
+
+template<class R>
+template<class T1>
+void bi::DistributedResampler<R>::unpack(std::vector<T1*>& xs,
+    const std::vector<int>& is, const std::vector<char>& buf,
+    const boost::mpl::true_) {
+  flat_iarchive ar(&buf[0], buf.size());
+  for (int i = 0; i < (int)is.size(); ++i) {
+    ar >> *xs[is[i]];
+  }
+  BI_ASSERT(ar.done());
+}
+
+template<class R>
+template<class T1>
+void bi::DistributedResampler<R>::unpack(std::vector<T1*>& xs,
+    const std::vector<int>& is, const std::vector<char>& buf,
+    const boost::mpl::false_) {
+  //
 }
 
 template<class R>
 template<class S1>
 void bi::DistributedResampler<R>::rotate(S1& s) {
+  ProfileScope scope(PROFILE_REDISTRIBUTE);
+
   boost::mpi::communicator world;
   const int rank = world.rank();
   const int size = world.size();
@@ -335,19 +778,12 @@ void bi::DistributedResampler<R>::rotate(S1& s) {
       recvr = (rank + p) % size;
       if (p + buf * size < P) {
         sends1[p + buf * size] = world.isend(recvr,
-            2 * rank * (p + buf * size), *s.s1s[p]);
+            2 * rank * (p + buf * size), *s.s1s[p + buf * size]);
         sends2[p + buf * size] = world.isend(recvr,
-            2 * rank * (p + buf * size) + 1, *s.out1s[p]);
+            2 * rank * (p + buf * size) + 1, *s.out1s[p + buf * size]);
       }
     }
   }
 }
 
-template<class R>
-void bi::DistributedResampler<R>::reportRedistribute(int timestep, int rank,
-    long usecs) {
-  fprintf(stderr, "%d: DistributedResampler::redistribute proc %d %ld us\n",
-      timestep, rank, usecs);
-}
-
 #endif
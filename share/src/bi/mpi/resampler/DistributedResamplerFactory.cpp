@@ -23,6 +23,11 @@ boost::shared_ptr<bi::DistributedResampler<bi::SystematicResampler> > bi::Distri
       > (essRel, anytime);
 }
 
+boost::shared_ptr<bi::DecentralisedResampler> bi::DistributedResamplerFactory::createDecentralisedResampler(
+    const double essRel, const bool anytime) {
+  return boost::make_shared < DecentralisedResampler > (essRel, anytime);
+}
+
 boost::shared_ptr<bi::DistributedResampler<bi::MetropolisResampler> > bi::DistributedResamplerFactory::createMetropolisResampler(
     const int B, const double essRel, const bool anytime) {
   BOOST_AUTO(resam,
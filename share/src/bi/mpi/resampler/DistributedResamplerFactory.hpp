@@ -7,6 +7,7 @@
 #define BI_RESAMPLER_DISTRIBUTEDRESAMPLERFACTORY_HPP
 
 #include "DistributedResampler.hpp"
+#include "DecentralisedResampler.hpp"
 #include "../../resampler/MultinomialResampler.hpp"
 #include "../../resampler/StratifiedResampler.hpp"
 #include "../../resampler/SystematicResampler.hpp"
@@ -42,6 +43,12 @@ public:
   static boost::shared_ptr<DistributedResampler<SystematicResampler> > createSystematicResampler(
       const double essRel = 0.5, const bool anytime = false);
 
+  /**
+   * Create decentralised systematic resampler.
+   */
+  static boost::shared_ptr<DecentralisedResampler> createDecentralisedResampler(
+      const double essRel = 0.5, const bool anytime = false);
+
   /**
    * Create Metropolis resampler.
    */
@@ -7,17 +7,32 @@
  */
 #include "InputNetCDFBuffer.hpp"
 
+#include <algorithm>
+
 bi::InputNetCDFBuffer::InputNetCDFBuffer(const Model& m,
-    const std::string& file, const long ns, const long np) :
+    const std::string& file, const long ns, const long np, const int window) :
     NetCDFBuffer(file), m(m), vars(NUM_VAR_TYPES), nsDim(-1), npDim(-1), ns(
-        ns), np(np) {
+        ns), np(np), window(window), masks(NUM_VAR_TYPES), masks0(
+        NUM_VAR_TYPES) {
   map();
 }
 
+bi::InputNetCDFBuffer::~InputNetCDFBuffer() {
+  /* prefetches must complete before their windows are destroyed */
+  BOOST_AUTO(iter, nexts.begin());
+  for (; iter != nexts.end(); ++iter) {
+    AsyncWriter::wait(iter->second.get());
+  }
+}
+
 void bi::InputNetCDFBuffer::readMask(const size_t k, const VarType type,
     Mask<ON_HOST>& mask) {
   typedef temp_host_matrix<real>::type temp_matrix_type;
 
+  if (window != 0 && masks[type].isValid(k)) {
+    mask = masks[type].get(k);
+    return;
+  }
   mask.resize(m.getNumVars(type), false);
 
   Var* var;
@@ -56,11 +71,19 @@ void bi::InputNetCDFBuffer::readMask(const size_t k, const VarType type,
       }
     }
   }
+  if (window != 0) {
+    masks[type].set(k, mask);
+  }
 }
 
 void bi::InputNetCDFBuffer::readMask0(const VarType type,
     Mask<ON_HOST>& mask) {
   typedef temp_host_matrix<real>::type temp_matrix_type;
+
+  if (window != 0 && masks0[type].isValid(0)) {
+    mask = masks0[type].get(0);
+    return;
+  }
   mask.resize(m.getNumVars(type), false);
 
   Var* var;
@@ -101,6 +124,9 @@ void bi::InputNetCDFBuffer::readMask0(const VarType type,
       mask.addDenseMask(var->getId(), var->getSize());
     }
   }
+  if (window != 0) {
+    masks0[type].set(0, mask);
+  }
 }
 
 void bi::InputNetCDFBuffer::map() {
@@ -186,6 +212,9 @@ void bi::InputNetCDFBuffer::map() {
 
         if (ncVar >= 0) {
           vars[type][id] = ncVar;
+          if (window != 0) {
+            mapHeld(ncVar, k);
+          }
         }
         modelVars.insert(std::make_pair(k, var));
       }
@@ -230,6 +259,16 @@ void bi::InputNetCDFBuffer::map() {
       seq.insert(std::make_pair(tnxt, k));
     }
   }
+
+  /* memory-resident variables */
+  if (window != 0) {
+    for (k = 0; k < int(recDims.size()); ++k) {
+      if (coordVars[k] >= 0) {
+        mapHeld(coordVars[k], k);
+      }
+    }
+    mapWindows();
+  }
 }
 
 std::pair<int,int> bi::InputNetCDFBuffer::mapVarDim(const Var* var) {
@@ -326,6 +365,145 @@ int bi::InputNetCDFBuffer::mapCoordDim(int ncVar) {
   return ncDim;
 }
 
+void bi::InputNetCDFBuffer::mapHeld(int ncVar, const int r) {
+  int j = -1;
+  if (r >= 0) {
+    /* position of record dimension, after optional ns dimension */
+    std::vector<int> dimids = nc_inq_vardimid(ncid, ncVar);
+    j = (nsDim >= 0 && dimids[0] == nsDim) ? 1 : 0;
+  }
+  held[ncVar] = std::make_pair(r, j);
+}
+
+void bi::InputNetCDFBuffer::mapWindows() {
+  const int K = times.size();
+  size_t first, last;
+  int r, k, k1;
+
+  for (r = -1; r < int(recDims.size()); ++r) {
+    std::vector<std::pair<size_t,size_t> >& bounds1 = bounds[r];
+    if (r >= 0 && timeVars[r] >= 0 && window > 0) {
+      /* windows of time indices */
+      for (k1 = 0; k1 < K; k1 += window) {
+        first = 0;
+        last = 0;
+        for (k = k1; k < std::min(k1 + window, K); ++k) {
+          if (recLens[k][r] > 0) {
+            if (last == 0) {
+              first = recStarts[k][r];
+            }
+            last = recStarts[k][r] + recLens[k][r];
+          }
+        }
+        bounds1.push_back(std::make_pair(first, last));
+      }
+    }
+    if (bounds1.empty()) {
+      /* one window for the whole record dimension */
+      last = (r >= 0) ? nc_inq_dimlen(ncid, recDims[r]) : 0;
+      bounds1.push_back(std::make_pair(size_t(0), last));
+    }
+    windows[r] = boost::shared_ptr<Window>(new Window(*this, r));
+    nexts[r] = boost::shared_ptr<Window>(new Window(*this, r));
+  }
+}
+
+bi::InputNetCDFBuffer::Window& bi::InputNetCDFBuffer::fetch(const int r,
+    const size_t start) {
+  boost::shared_ptr<Window>& current = windows[r];
+  boost::shared_ptr<Window>& next = nexts[r];
+
+  if (!current->holds(start)) {
+    const std::vector<std::pair<size_t,size_t> >& bounds1 = bounds[r];
+    int w = 0;
+    while (w < int(bounds1.size()) - 1 && bounds1[w].second <= start) {
+      ++w;
+    }
+
+    AsyncWriter::wait(next.get());
+    if (next->w == w) {
+      current.swap(next);
+    } else {
+      current->set(w);
+      current->run();
+    }
+    if (w + 1 < int(bounds1.size())) {
+      next->set(w + 1);
+      AsyncWriter::submit(next.get());
+    }
+  }
+  return *current;
+}
+
+bi::InputNetCDFBuffer::Window::Window(const InputNetCDFBuffer& in,
+    const int r) :
+    w(-1), in(in), r(r) {
+  //
+}
+
+void bi::InputNetCDFBuffer::Window::set(const int w) {
+  /* pre-condition */
+  BI_ASSERT(!isPending());
+
+  this->w = w;
+  starts.clear();
+  lens.clear();
+  data.clear();
+}
+
+bool bi::InputNetCDFBuffer::Window::holds(const size_t start) const {
+  if (w < 0) {
+    return false;
+  } else if (r < 0) {
+    return true;
+  } else {
+    const std::pair<size_t,size_t>& bounds1 = in.bounds.find(r)->second[w];
+    return bounds1.first <= start && start < bounds1.second;
+  }
+}
+
+void bi::InputNetCDFBuffer::Window::run() {
+  /* pre-condition */
+  BI_ASSERT(w >= 0);
+
+  const std::pair<size_t,size_t>& bounds1 = in.bounds.find(r)->second[w];
+  std::vector<int> dimids;
+  size_t size;
+  int ncVar, j;
+
+  BOOST_AUTO(iter, in.held.begin());
+  for (; iter != in.held.end(); ++iter) {
+    if (iter->second.first == r) {
+      ncVar = iter->first;
+      dimids = nc_inq_vardimid(in.ncid, ncVar);
+
+      std::vector<size_t>& starts1 = starts[ncVar];
+      std::vector<size_t>& lens1 = lens[ncVar];
+      std::vector<real>& x = data[ncVar];
+      starts1.resize(dimids.size());
+      lens1.resize(dimids.size());
+      size = 1;
+      for (j = 0; j < int(dimids.size()); ++j) {
+        if (j == 0 && in.nsDim >= 0 && dimids[j] == in.nsDim) {
+          starts1[j] = in.ns;
+          lens1[j] = 1;
+        } else if (j == iter->second.second) {
+          starts1[j] = bounds1.first;
+          lens1[j] = bounds1.second - bounds1.first;
+        } else {
+          starts1[j] = 0;
+          lens1[j] = nc_inq_dimlen(in.ncid, dimids[j]);
+        }
+        size *= lens1[j];
+      }
+      x.resize(size);
+      if (size > 0) {
+        nc_get_vara(in.ncid, ncVar, starts1, lens1, &x[0]);
+      }
+    }
+  }
+}
+
 void bi::InputNetCDFBuffer::readTime(int ncVar, const long start,
     size_t* const len, real* const t) {
   /* pre-condition */
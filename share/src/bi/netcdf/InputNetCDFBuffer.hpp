@@ -11,6 +11,10 @@
 #include "NetCDFBuffer.hpp"
 #include "../buffer/InputBuffer.hpp"
 #include "../model/Model.hpp"
+#include "../cache/CacheObject.hpp"
+#include "../cache/AsyncWriter.hpp"
+
+#include "boost/shared_ptr.hpp"
 
 #include <vector>
 #include <string>
@@ -18,10 +22,18 @@
 
 namespace bi {
 /**
- * NetCDF buffer for storin
- * g and sequentially reading input in sparse format.
+ * NetCDF buffer for storing and sequentially reading input in sparse
+ * format.
  *
  * @ingroup io_netcdf
+ *
+ * The buffer may hold the contents of the file in memory, so that repeated
+ * passes over the same schedule, as in each step of a marginal sampler, do
+ * not return to the file. Variables are held whole, other than along their
+ * record dimension, where they are held in windows of a given number of time
+ * indices. When a window is loaded, the next is prefetched as a task of
+ * AsyncWriter. Masks are computed once for each time index and variable
+ * type.
  */
 class InputNetCDFBuffer: public NetCDFBuffer {
 public:
@@ -33,9 +45,16 @@ public:
    * @param ns Index along @c ns dimension to use, if it exists.
    * @param np Index along @c np dimension to use, if it exists. -1 for whole
    * dimension.
+   * @param window Number of time indices to hold in memory. Zero to read
+   * from file each time, -1 to hold the whole file.
    */
   InputNetCDFBuffer(const Model& m, const std::string& file = "",
-      const long ns = 0, const long np = -1);
+      const long ns = 0, const long np = -1, const int window = 0);
+
+  /**
+   * Destructor.
+   */
+  ~InputNetCDFBuffer();
 
   /**
    * Get time.
@@ -88,6 +107,104 @@ public:
   void read0(const VarType type, M1 X);
 
 protected:
+  /**
+   * Window of records held in memory, for all variables along one record
+   * dimension.
+   */
+  class Window: public AsyncTask {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param in Buffer.
+     * @param r Record dimension index, -1 for variables without a record
+     * dimension.
+     */
+    Window(const InputNetCDFBuffer& in, const int r);
+
+    /**
+     * Select window to load on the next call to run().
+     *
+     * @param w Window index.
+     */
+    void set(const int w);
+
+    /**
+     * Does the window hold a record?
+     *
+     * @param start Offset along record dimension.
+     */
+    bool holds(const size_t start) const;
+
+    /**
+     * Read from variable.
+     *
+     * @return True if the window holds the whole of the request, false
+     * otherwise, in which case nothing is read.
+     *
+     * @see nc_get_vara()
+     */
+    template<class T1>
+    bool get(int ncVar, const std::vector<size_t>& offsets,
+        const std::vector<size_t>& counts, T1* buf) const;
+
+    /**
+     * Load the selected window from file.
+     */
+    virtual void run();
+
+    /**
+     * Window index, -1 if none.
+     */
+    int w;
+
+  private:
+    /**
+     * Buffer.
+     */
+    const InputNetCDFBuffer& in;
+
+    /**
+     * Record dimension index.
+     */
+    int r;
+
+    /**
+     * Offsets of held hyperslabs, by variable.
+     */
+    std::map<int,std::vector<size_t> > starts;
+
+    /**
+     * Extents of held hyperslabs, by variable.
+     */
+    std::map<int,std::vector<size_t> > lens;
+
+    /**
+     * Contents of held hyperslabs, by variable, in the order of the file.
+     */
+    std::map<int,std::vector<real> > data;
+  };
+
+  /**
+   * Read from variable, from memory if held there.
+   *
+   * @see nc_get_vara()
+   */
+  template<class T1>
+  void get(int ncVar, const std::vector<size_t>& offsets,
+      const std::vector<size_t>& counts, T1* buf);
+
+  /**
+   * Ensure that the window of a record dimension that contains a record is
+   * in memory.
+   *
+   * @param r Record dimension index.
+   * @param start Offset along record dimension.
+   *
+   * @return The window.
+   */
+  Window& fetch(const int r, const size_t start);
+
   /**
    * Read from time variable.
    *
@@ -195,6 +312,19 @@ protected:
    */
   int mapCoordDim(int ncVar);
 
+  /**
+   * Map variable to be held in memory.
+   *
+   * @param ncVar Variable.
+   * @param r Record dimension index, -1 if none.
+   */
+  void mapHeld(int ncVar, const int r);
+
+  /**
+   * Map windows of record dimensions.
+   */
+  void mapWindows();
+
   /**
    * Model.
    */
@@ -264,6 +394,43 @@ protected:
    * Index of record to read along @c np dimension.
    */
   long np;
+
+  /**
+   * Number of time indices to hold in memory, zero for none, -1 for all.
+   */
+  int window;
+
+  /**
+   * Variables held in memory, mapped to the index of their record dimension
+   * (-1 if none) and the position of that dimension among their
+   * dimensions.
+   */
+  std::map<int,std::pair<int,int> > held;
+
+  /**
+   * Record ranges of windows, by record dimension index.
+   */
+  std::map<int,std::vector<std::pair<size_t,size_t> > > bounds;
+
+  /**
+   * Current windows, by record dimension index.
+   */
+  std::map<int,boost::shared_ptr<Window> > windows;
+
+  /**
+   * Prefetched windows, by record dimension index.
+   */
+  std::map<int,boost::shared_ptr<Window> > nexts;
+
+  /**
+   * Masks of dynamic variables, by variable type and time index.
+   */
+  std::vector<CacheObject<Mask<ON_HOST> > > masks;
+
+  /**
+   * Masks of static variables, by variable type.
+   */
+  std::vector<CacheObject<Mask<ON_HOST> > > masks0;
 };
 }
 
@@ -327,9 +494,17 @@ void bi::InputNetCDFBuffer::read(const size_t k, const VarType type,
 
 template<class M1>
 void bi::InputNetCDFBuffer::read(const size_t k, const VarType type, M1 X) {
-  Mask<ON_HOST> mask;
-  readMask(k, type, mask);
-  read(k, type, mask, X);
+  if (window != 0) {
+    if (!masks[type].isValid(k)) {
+      Mask<ON_HOST> mask;
+      readMask(k, type, mask);
+    }
+    read(k, type, masks[type].get(k), X);
+  } else {
+    Mask<ON_HOST> mask;
+    readMask(k, type, mask);
+    read(k, type, mask, X);
+  }
 }
 
 template<class M1>
@@ -383,9 +558,17 @@ void bi::InputNetCDFBuffer::read0(const VarType type,
 
 template<class M1>
 void bi::InputNetCDFBuffer::read0(const VarType type, M1 X) {
-  Mask<ON_HOST> mask;
-  readMask0(type, mask);
-  read0(type, mask, X);
+  if (window != 0) {
+    if (!masks0[type].isValid(0)) {
+      Mask<ON_HOST> mask;
+      readMask0(type, mask);
+    }
+    read0(type, masks0[type].get(0), X);
+  } else {
+    Mask<ON_HOST> mask;
+    readMask0(type, mask);
+    read0(type, mask, X);
+  }
 }
 
 template<class M1>
@@ -425,10 +608,10 @@ void bi::InputNetCDFBuffer::readCoords(int ncVar, const long start,
   /* read */
   if (M1::on_device || !C.contiguous()) {
     typename sim_temp_matrix<M1>::type C1(C.size1(), C.size2());
-    nc_get_vara(ncid, ncVar, offsets, counts, C1.buf());
+    get(ncVar, offsets, counts, C1.buf());
     C = C1;
   } else {
-    nc_get_vara(ncid, ncVar, offsets, counts, C.buf());
+    get(ncVar, offsets, counts, C.buf());
   }
 }
 
@@ -491,14 +674,14 @@ void bi::InputNetCDFBuffer::readVar(int ncVar, const long start,
   /* read */
   if (!haveP && X.size1() > 1) {
     temp_vector_type x1(X.size2());
-    nc_get_vara(ncid, ncVar, offsets, counts, x1.buf());
+    get(ncVar, offsets, counts, x1.buf());
     set_rows(X, x1);
   } else if (M1::on_device || !X.contiguous()) {
     temp_matrix_type X1(X.size1(), X.size2());
-    nc_get_vara(ncid, ncVar, offsets, counts, X1.buf());
+    get(ncVar, offsets, counts, X1.buf());
     X = X1;
   } else {
-    nc_get_vara(ncid, ncVar, offsets, counts, X.buf());
+    get(ncVar, offsets, counts, X.buf());
   }
 }
 
@@ -548,13 +731,13 @@ void bi::InputNetCDFBuffer::readVar(int ncVar, const long start,
 
   if (!haveP && X.size1() > 1) {
     temp_vector_type x1(static_cast<int>(len));
-    nc_get_vara(ncid, ncVar, offsets, counts, x1.buf());
+    get(ncVar, offsets, counts, x1.buf());
     for (j = 0; j < static_cast<int>(len); ++j) {
       set_elements(column(X, ixs(j)), x1(j));
     }
   } else {
     temp_matrix_type X1(X.size1(), static_cast<int>(len));
-    nc_get_vara(ncid, ncVar, offsets, counts, X1.buf());
+    get(ncVar, offsets, counts, X1.buf());
     for (j = 0; j < static_cast<int>(len); ++j) {
       ///@todo This could be improved for contiguous columns
       column(X, ixs(j)) = column(X1, j);
@@ -562,6 +745,82 @@ void bi::InputNetCDFBuffer::readVar(int ncVar, const long start,
   }
 }
 
+template<class T1>
+void bi::InputNetCDFBuffer::get(int ncVar, const std::vector<size_t>& offsets,
+    const std::vector<size_t>& counts, T1* buf) {
+  bool hit = false;
+  if (window != 0) {
+    BOOST_AUTO(iter, held.find(ncVar));
+    if (iter != held.end()) {
+      const int r = iter->second.first;
+      const int j = iter->second.second;
+      hit = fetch(r, (j >= 0) ? offsets[j] : 0).get(ncVar, offsets, counts,
+          buf);
+    }
+  }
+  if (!hit) {
+    nc_get_vara(ncid, ncVar, offsets, counts, buf);
+  }
+}
+
+template<class T1>
+bool bi::InputNetCDFBuffer::Window::get(int ncVar,
+    const std::vector<size_t>& offsets, const std::vector<size_t>& counts,
+    T1* buf) const {
+  BOOST_AUTO(iter, data.find(ncVar));
+  if (iter == data.end()) {
+    return false;
+  }
+  const std::vector<real>& x = iter->second;
+  const std::vector<size_t>& starts1 = starts.find(ncVar)->second;
+  const std::vector<size_t>& lens1 = lens.find(ncVar)->second;
+  const int D = lens1.size();
+  int d;
+
+  /* requested hyperslab must be within held hyperslab; trailing elements of
+   * offsets and counts beyond the dimensions of the variable are ignored,
+   * as by the NetCDF library */
+  for (d = 0; d < D; ++d) {
+    if (offsets[d] < starts1[d]
+        || offsets[d] + counts[d] > starts1[d] + lens1[d]) {
+      return false;
+    }
+  }
+
+  if (D == 0) {
+    /* scalar */
+    *buf = x[0];
+  } else {
+    /* copy contiguous runs along the innermost dimension */
+    std::vector<size_t> strides(D), ixs(D, 0);
+    size_t stride = 1, src;
+    bool done = false;
+    for (d = D - 1; d >= 0; --d) {
+      strides[d] = stride;
+      stride *= lens1[d];
+      done = done || counts[d] == 0;
+    }
+    const size_t len = counts[D - 1];
+    while (!done) {
+      src = 0;
+      for (d = 0; d < D; ++d) {
+        src += (offsets[d] - starts1[d] + ixs[d])*strides[d];
+      }
+      std::copy(x.begin() + src, x.begin() + src + len, buf);
+      buf += len;
+
+      /* next run */
+      d = D - 2;
+      while (d >= 0 && ++ixs[d] == counts[d]) {
+        ixs[d] = 0;
+        --d;
+      }
+      done = d < 0;
+    }
+  }
+  return true;
+}
+
 template<class M1, class V1>
 void bi::InputNetCDFBuffer::serialiseCoords(const Var* var, const M1 C,
     V1 ixs) {
@@ -11,8 +11,9 @@
 
 bi::KalmanFilterNetCDFBuffer::KalmanFilterNetCDFBuffer(const Model& m,
     const size_t P, const size_t T, const std::string& file,
-    const FileMode mode, const SchemaMode schema) :
-    SimulatorNetCDFBuffer(m, P, T, file, mode, schema) {
+    const FileMode mode, const SchemaMode schema,
+    const NetCDFStorage& storage) :
+    SimulatorNetCDFBuffer(m, P, T, file, mode, schema, storage) {
   if (mode == NEW || mode == REPLACE) {
     create(T);  // set up structure of new file
   } else {
@@ -41,11 +42,11 @@ void bi::KalmanFilterNetCDFBuffer::create(const size_t T) {
   dimidsMat[1] = nxcolDim;
   dimidsMat[2] = nxrowDim;
 
-  mu1Var = nc_def_var(ncid, "mu1_", NC_REAL, dimidsVec);
-  U1Var = nc_def_var(ncid, "U1_", NC_REAL, dimidsMat);
-  mu2Var = nc_def_var(ncid, "mu2_", NC_REAL, dimidsVec);
-  U2Var = nc_def_var(ncid, "U2_", NC_REAL, dimidsMat);
-  CVar = nc_def_var(ncid, "C_", NC_REAL, dimidsMat);
+  mu1Var = defVar("mu1_", NC_REAL, dimidsVec);
+  U1Var = defVar("U1_", NC_REAL, dimidsMat);
+  mu2Var = defVar("mu2_", NC_REAL, dimidsVec);
+  U2Var = defVar("U2_", NC_REAL, dimidsMat);
+  CVar = defVar("C_", NC_REAL, dimidsMat);
 
   /* index variables */
   Var* var;
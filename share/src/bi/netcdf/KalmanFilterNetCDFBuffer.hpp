@@ -20,10 +20,13 @@ class KalmanFilterNetCDFBuffer: public SimulatorNetCDFBuffer {
 public:
   /**
    * @copydoc KalmanFilterBuffer::KalmanFilterBuffer()
+   *
+   * @param storage Storage options.
    */
   KalmanFilterNetCDFBuffer(const Model& m, const size_t P = 0,
       const size_t T = 0, const std::string& file = "", const FileMode mode =
-          READ_ONLY, const SchemaMode schema = DEFAULT);
+          READ_ONLY, const SchemaMode schema = DEFAULT,
+      const NetCDFStorage& storage = NetCDFBuffer::defaults);
 
   /**
    * Write predicted mean.
@@ -9,8 +9,8 @@
 
 bi::MCMCNetCDFBuffer::MCMCNetCDFBuffer(const Model& m, const size_t P,
     const size_t T, const std::string& file, const FileMode mode,
-    const SchemaMode schema) :
-    SimulatorNetCDFBuffer(m, P, T, file, mode, schema) {
+    const SchemaMode schema, const NetCDFStorage& storage) :
+    SimulatorNetCDFBuffer(m, P, T, file, mode, schema, storage) {
   if (mode == NEW || mode == REPLACE) {
     create();
   } else {
@@ -25,8 +25,9 @@ void bi::MCMCNetCDFBuffer::create() {
   nc_put_att(ncid, "libbi_schema_version", 1);
   nc_put_att(ncid, "libbi_version", PACKAGE_VERSION);
 
-  llVar = nc_def_var(ncid, "loglikelihood", NC_REAL, npDim);
-  lpVar = nc_def_var(ncid, "logprior", NC_REAL, npDim);
+  std::vector<int> dimids(1, npDim);
+  llVar = defVar("loglikelihood", NC_REAL, dimids);
+  lpVar = defVar("logprior", NC_REAL, dimids);
 
   nc_enddef(ncid);
 }
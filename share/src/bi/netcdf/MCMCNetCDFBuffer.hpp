@@ -29,10 +29,13 @@ public:
    * @param T Number of times in file.
    * @param file NetCDF file name.
    * @param mode File open mode.
+   * @param schema Schema.
+   * @param storage Storage options.
    */
   MCMCNetCDFBuffer(const Model& m, const size_t P = 0, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = MULTI);
+      const SchemaMode schema = MULTI,
+      const NetCDFStorage& storage = NetCDFBuffer::defaults);
 
   /**
    * Write log-likelihoods.
@@ -9,9 +9,24 @@
 
 #include "../misc/assert.hpp"
 
-bi::NetCDFBuffer::NetCDFBuffer(const std::string& file, const FileMode mode) :
-    file(file), ncid(-1) {
+#include <algorithm>
+
+bi::NetCDFStorage::NetCDFStorage(const ChunkMode chunk, const int deflate,
+    const bool shuffle, const size_t cache) :
+    chunk(chunk), deflate(deflate), shuffle(shuffle), cache(cache) {
+  BI_ERROR_MSG(deflate >= 0 && deflate <= 9,
+      "Deflate level must be between 0 and 9");
+}
+
+bi::NetCDFStorage bi::NetCDFBuffer::defaults;
+
+bi::NetCDFBuffer::NetCDFBuffer(const std::string& file, const FileMode mode,
+    const NetCDFStorage& storage) :
+    file(file), ncid(-1), storage(storage) {
   BI_ERROR_MSG(!file.empty(), "No file specified");
+  if (storage.cache > 0) {
+    nc_set_chunk_cache(storage.cache);
+  }
   switch (mode) {
   case WRITE:
     ncid = nc_open(file, NC_WRITE);
@@ -30,7 +45,7 @@ bi::NetCDFBuffer::NetCDFBuffer(const std::string& file, const FileMode mode) :
 }
 
 bi::NetCDFBuffer::NetCDFBuffer(const NetCDFBuffer& o) :
-    file(o.file), ncid(-1) {
+    file(o.file), ncid(-1), storage(o.storage) {
   if (!file.empty()) {
     ncid = nc_open(file, NC_NOWRITE);
   }
@@ -44,3 +59,59 @@ bi::NetCDFBuffer::~NetCDFBuffer() {
 void bi::NetCDFBuffer::clear() {
   //
 }
+
+void bi::NetCDFBuffer::init(const NetCDFStorage& storage) {
+  defaults = storage;
+}
+
+int bi::NetCDFBuffer::defVar(const std::string& name, const nc_type xtype,
+    const std::vector<int>& dimids) {
+  int varid = nc_def_var(ncid, name, xtype, dimids);
+
+  if (!dimids.empty() && storage.chunk != CHUNK_DEFAULT) {
+    /* model dimensions are held whole in each chunk, and samples (ns) one
+     * at a time; remaining space is filled by trajectories (np, nrp) when
+     * chunking by time, or by times (nr) then trajectories when chunking by
+     * particle */
+    std::vector<size_t> chunksizes(dimids.size());
+    std::string dimname;
+    size_t size = (xtype == NC_DOUBLE || xtype == NC_INT64) ? 8 : 4;
+    int timeDim = -1, particleDim = -1, i;
+
+    for (i = 0; i < (int)dimids.size(); ++i) {
+      dimname = nc_inq_dimname(ncid, dimids[i]);
+      chunksizes[i] = 1;
+      if (dimname.compare("nr") == 0) {
+        timeDim = i;
+      } else if (dimname.compare("np") == 0 || dimname.compare("nrp") == 0) {
+        particleDim = i;
+      } else if (dimname.compare("ns") != 0) {
+        chunksizes[i] = std::max(nc_inq_dimlen(ncid, dimids[i]), (size_t)1);
+        size *= chunksizes[i];
+      }
+    }
+    if (storage.chunk == CHUNK_BY_PARTICLE && timeDim >= 0) {
+      size = fill(dimids[timeDim], size, chunksizes[timeDim]);
+    }
+    if (particleDim >= 0) {
+      fill(dimids[particleDim], size, chunksizes[particleDim]);
+    }
+    nc_def_var_chunking(ncid, varid, chunksizes);
+  }
+  if (!dimids.empty() && (storage.deflate > 0 || storage.shuffle)) {
+    nc_def_var_deflate(ncid, varid, storage.shuffle, storage.deflate);
+  }
+  return varid;
+}
+
+size_t bi::NetCDFBuffer::fill(const int dimid, const size_t size,
+    size_t& chunksize) {
+  const size_t len = nc_inq_dimlen(ncid, dimid);
+
+  chunksize = std::max(CHUNK_BYTES/size, (size_t)1);
+  if (len > 0) {
+    /* otherwise unlimited, and currently empty */
+    chunksize = std::min(chunksize, len);
+  }
+  return size*chunksize;
+}
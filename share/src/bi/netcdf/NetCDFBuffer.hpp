@@ -12,6 +12,71 @@
 #include "../buffer/buffer.hpp"
 
 namespace bi {
+/**
+ * Chunk layout flags for NetCDF output.
+ */
+enum ChunkMode {
+  /**
+   * Leave chunk shapes to the NetCDF library.
+   */
+  CHUNK_DEFAULT,
+
+  /**
+   * Chunks span one time and as many trajectories as fit, for writing one
+   * time at a time.
+   */
+  CHUNK_BY_TIME,
+
+  /**
+   * Chunks span all times and as few trajectories as fit, for reading one
+   * trajectory at a time.
+   */
+  CHUNK_BY_PARTICLE
+};
+
+/**
+ * Storage options for NetCDF output.
+ *
+ * @ingroup io_netcdf
+ */
+class NetCDFStorage {
+public:
+  /**
+   * Constructor.
+   *
+   * @param chunk Chunk layout.
+   * @param deflate Deflate level, 0 for none, up to 9.
+   * @param shuffle Apply shuffle filter before deflate?
+   * @param cache Size of chunk cache for each variable, in bytes, 0 for the
+   * NetCDF library default.
+   *
+   * The chunk cache size is set in the NetCDF library when a buffer is
+   * constructed, so applies also to files opened after it.
+   */
+  NetCDFStorage(const ChunkMode chunk = CHUNK_DEFAULT, const int deflate = 0,
+      const bool shuffle = false, const size_t cache = 0);
+
+  /**
+   * Chunk layout.
+   */
+  ChunkMode chunk;
+
+  /**
+   * Deflate level.
+   */
+  int deflate;
+
+  /**
+   * Apply shuffle filter?
+   */
+  bool shuffle;
+
+  /**
+   * Size of chunk cache.
+   */
+  size_t cache;
+};
+
 /**
  * NetCDF input or output file.
  *
@@ -24,8 +89,10 @@ public:
    *
    * @param file NetCDF file name.
    * @param mode File open mode.
+   * @param storage Storage options for variables defined in the file.
    */
-  NetCDFBuffer(const std::string& file = "", const FileMode mode = READ_ONLY);
+  NetCDFBuffer(const std::string& file = "", const FileMode mode = READ_ONLY,
+      const NetCDFStorage& storage = NetCDFBuffer::defaults);
 
   /**
    * Copy constructor.
@@ -45,7 +112,50 @@ public:
    */
   void clear();
 
+  /**
+   * Set default storage options, for buffers constructed without them.
+   *
+   * @param storage Storage options.
+   */
+  static void init(const NetCDFStorage& storage);
+
+  /**
+   * Default storage options.
+   */
+  static NetCDFStorage defaults;
+
 protected:
+  /**
+   * Define variable, applying storage options.
+   *
+   * @param name Name of variable.
+   * @param xtype Type of variable.
+   * @param dimids Dimensions of variable.
+   *
+   * @return Variable id.
+   *
+   * Dimensions named @c nr and @c ns are taken to index times and samples,
+   * @c np and @c nrp trajectories, for the purposes of chunk layout.
+   */
+  int defVar(const std::string& name, const nc_type xtype,
+      const std::vector<int>& dimids);
+
+  /**
+   * Fill remaining space in a chunk along a dimension.
+   *
+   * @param dimid Dimension id.
+   * @param size Size of chunk so far, in bytes.
+   * @param[out] chunksize Chunk length along the dimension.
+   *
+   * @return Size of chunk, in bytes, including the new dimension.
+   */
+  size_t fill(const int dimid, const size_t size, size_t& chunksize);
+
+  /**
+   * Target size of a chunk, in bytes.
+   */
+  static const size_t CHUNK_BYTES = 1048576;
+
   /**
    * NetCDF file name recorded by constructor. Using this is preferred to the
    * nc_inq_path() function, as the latter requires fiddling with buffer
@@ -57,6 +167,11 @@ protected:
    * NetCDF file id.
    */
   int ncid;
+
+  /**
+   * Storage options.
+   */
+  NetCDFStorage storage;
 };
 }
 
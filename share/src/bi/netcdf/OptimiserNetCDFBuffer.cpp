@@ -11,8 +11,8 @@
 
 bi::OptimiserNetCDFBuffer::OptimiserNetCDFBuffer(const Model& m,
     const size_t T, const std::string& file, const FileMode mode,
-    const SchemaMode schema) :
-    SimulatorNetCDFBuffer(m, 0, T, file, mode, schema) {
+    const SchemaMode schema, const NetCDFStorage& storage) :
+    SimulatorNetCDFBuffer(m, 0, T, file, mode, schema, storage) {
   if (mode == NEW || mode == REPLACE) {
     create();
   } else {
@@ -27,8 +27,9 @@ void bi::OptimiserNetCDFBuffer::create() {
   nc_put_att(ncid, "libbi_schema_version", 2);
   nc_put_att(ncid, "libbi_version", PACKAGE_VERSION);
 
-  valueVar = nc_def_var(ncid, "optimiser.value", NC_REAL, npDim);
-  sizeVar = nc_def_var(ncid, "optimiser.size", NC_REAL, npDim);
+  std::vector<int> dimids(1, npDim);
+  valueVar = defVar("optimiser.value", NC_REAL, dimids);
+  sizeVar = defVar("optimiser.size", NC_REAL, dimids);
 
   nc_enddef(ncid);
 }
@@ -29,10 +29,13 @@ public:
    * @param T Number of times to hold in file.
    * @param file NetCDF file name.
    * @param mode File open mode.
+   * @param schema Schema.
+   * @param storage Storage options.
    */
   OptimiserNetCDFBuffer(const Model& m, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = PARAM_ONLY);
+      const SchemaMode schema = PARAM_ONLY,
+      const NetCDFStorage& storage = NetCDFBuffer::defaults);
 
   /**
    * @copydoc concept::OptimiserBuffer::writeValue()
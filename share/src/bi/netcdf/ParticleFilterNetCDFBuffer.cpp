@@ -9,8 +9,9 @@
 
 bi::ParticleFilterNetCDFBuffer::ParticleFilterNetCDFBuffer(const Model& m,
     const size_t P, const size_t T, const std::string& file,
-    const FileMode mode, const SchemaMode schema) :
-    SimulatorNetCDFBuffer(m, P, T, file, mode, schema) {
+    const FileMode mode, const SchemaMode schema,
+    const NetCDFStorage& storage) :
+    SimulatorNetCDFBuffer(m, P, T, file, mode, schema, storage) {
   if (mode == NEW || mode == REPLACE) {
     create();
   } else {
@@ -30,13 +31,15 @@ void bi::ParticleFilterNetCDFBuffer::create() {
   }
   nc_put_att(ncid, "libbi_version", PACKAGE_VERSION);
 
+  std::vector<int> dimids;
   if (schema == FLEXI) {
-    aVar = nc_def_var(ncid, "ancestor", NC_INT, nrpDim);
-    lwVar = nc_def_var(ncid, "logweight", NC_REAL, nrpDim);
+    dimids.push_back(nrpDim);
   } else {
-    aVar = nc_def_var(ncid, "ancestor", NC_INT, nrDim, npDim);
-    lwVar = nc_def_var(ncid, "logweight", NC_REAL, nrDim, npDim);
+    dimids.push_back(nrDim);
+    dimids.push_back(npDim);
   }
+  aVar = defVar("ancestor", NC_INT, dimids);
+  lwVar = defVar("logweight", NC_REAL, dimids);
   llVar = nc_def_var(ncid, "loglikelihood", NC_REAL);
 
   nc_enddef(ncid);
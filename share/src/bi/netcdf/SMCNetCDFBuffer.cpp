@@ -11,8 +11,8 @@
 
 bi::SMCNetCDFBuffer::SMCNetCDFBuffer(const Model& m, const size_t P,
     const size_t T, const std::string& file, const FileMode mode,
-    const SchemaMode schema) :
-    MCMCNetCDFBuffer(m, P, T, file, mode, schema) {
+    const SchemaMode schema, const NetCDFStorage& storage) :
+    MCMCNetCDFBuffer(m, P, T, file, mode, schema, storage) {
   if (mode == NEW || mode == REPLACE) {
     create();
   } else {
@@ -27,7 +27,8 @@ void bi::SMCNetCDFBuffer::create() {
   nc_put_att(ncid, "libbi_schema_version", 1);
   nc_put_att(ncid, "libbi_version", PACKAGE_VERSION);
 
-  lwVar = nc_def_var(ncid, "logweight", NC_REAL, npDim);
+  std::vector<int> dimids(1, npDim);
+  lwVar = defVar("logweight", NC_REAL, dimids);
 
   nc_enddef(ncid);
 }
@@ -11,10 +11,11 @@
 
 bi::SimulatorNetCDFBuffer::SimulatorNetCDFBuffer(const Model& m,
     const size_t P, const size_t T, const std::string& file,
-    const FileMode mode, const SchemaMode schema) :
-    NetCDFBuffer(file, mode), m(m), schema(schema), nsDim(-1), nrDim(-1), npDim(
-        -1), nrpDim(-1), tVar(-1), startVar(-1), lenVar(-1), k(-1), start(0), len(
-        0), vars(NUM_VAR_TYPES) {
+    const FileMode mode, const SchemaMode schema,
+    const NetCDFStorage& storage) :
+    NetCDFBuffer(file, mode, storage), m(m), schema(schema), nsDim(-1), nrDim(
+        -1), npDim(-1), nrpDim(-1), tVar(-1), startVar(-1), lenVar(-1), k(-1), start(
+        0), len(0), vars(NUM_VAR_TYPES) {
   if (mode == NEW || mode == REPLACE) {
     create(P, T);
   } else {
@@ -200,7 +201,7 @@ int bi::SimulatorNetCDFBuffer::createVar(Var* var) {
     }
     break;
   }
-  return nc_def_var(ncid, var->getOutputName(), NC_REAL, dims);
+  return defVar(var->getOutputName(), NC_REAL, dims);
 }
 
 int bi::SimulatorNetCDFBuffer::mapVar(Var* var) {
@@ -30,10 +30,13 @@ public:
    * @param T Number of times to hold in file.
    * @param file NetCDF file name.
    * @param mode File open mode.
+   * @param schema Schema.
+   * @param storage Storage options.
    */
   SimulatorNetCDFBuffer(const Model& m, const size_t P = 0,
       const size_t T = 0, const std::string& file = "", const FileMode mode =
-          READ_ONLY, const SchemaMode schema = DEFAULT);
+          READ_ONLY, const SchemaMode schema = DEFAULT,
+      const NetCDFStorage& storage = NetCDFBuffer::defaults);
 
   /**
    * Write time.
@@ -10,7 +10,44 @@
 #include "../misc/assert.hpp"
 #include "../misc/compile.hpp"
 
+#include <pthread.h>
+
+namespace bi {
+/**
+ * Serialises calls into the NetCDF library, which is not thread safe, so
+ * that AsyncWriter may write from its own thread. The mutex is recursive,
+ * as some wrappers call others.
+ */
+class NetCDFGuard {
+public:
+  NetCDFGuard() {
+    pthread_once(&once, init);
+    pthread_mutex_lock(&mutex);
+  }
+
+  ~NetCDFGuard() {
+    pthread_mutex_unlock(&mutex);
+  }
+
+private:
+  static void init() {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+  }
+
+  static pthread_once_t once;
+  static pthread_mutex_t mutex;
+};
+}
+
+pthread_once_t bi::NetCDFGuard::once = PTHREAD_ONCE_INIT;
+pthread_mutex_t bi::NetCDFGuard::mutex;
+
 int bi::nc_open(const std::string& path, int mode) {
+  NetCDFGuard guard;
   int ncid, status;
   status = ::nc_open(path.c_str(), mode, &ncid);
   BI_ERROR_MSG(status == NC_NOERR, "Could not open " << path);
@@ -18,6 +55,7 @@ int bi::nc_open(const std::string& path, int mode) {
 }
 
 int bi::nc_create(const std::string& path, int cmode) {
+  NetCDFGuard guard;
   int ncid, status;
   status = ::nc_create(path.c_str(), cmode, &ncid);
   BI_ERROR_MSG(status == NC_NOERR, "Could not create " << path);
@@ -25,38 +63,55 @@ int bi::nc_create(const std::string& path, int cmode) {
 }
 
 void bi::nc_set_fill(int ncid, int fillmode) {
+  NetCDFGuard guard;
   int status = ::nc_set_fill(ncid, fillmode, NULL);
   BI_WARN_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_sync(int ncid) {
+  NetCDFGuard guard;
   int status = ::nc_sync(ncid);
   BI_WARN_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_redef(int ncid) {
+  NetCDFGuard guard;
   int status = ::nc_redef(ncid);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_enddef(int ncid) {
+  NetCDFGuard guard;
   int status = ::nc_enddef(ncid);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_close(int ncid) {
+  NetCDFGuard guard;
   int status = ::nc_close(ncid);
   BI_WARN_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 int bi::nc_inq_nvars(int ncid) {
+  NetCDFGuard guard;
   int nvars, status;
   status = ::nc_inq_nvars(ncid, &nvars);
   BI_ERROR_MSG(status == NC_NOERR, "Could not determine number of variables");
   return nvars;
 }
 
+void bi::nc_set_chunk_cache(size_t size) {
+  NetCDFGuard guard;
+  size_t nelems;
+  float preemption;
+  int status = ::nc_get_chunk_cache(NULL, &nelems, &preemption);
+  BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
+  status = ::nc_set_chunk_cache(size, nelems, preemption);
+  BI_WARN_MSG(status == NC_NOERR, nc_strerror(status));
+}
+
 int bi::nc_def_dim(int ncid, const std::string& name, size_t len) {
+  NetCDFGuard guard;
   int dimid, status;
   status = ::nc_def_dim(ncid, name.c_str(), len, &dimid);
   BI_ERROR_MSG(status == NC_NOERR, "Could not define dimension " << name);
@@ -64,6 +119,7 @@ int bi::nc_def_dim(int ncid, const std::string& name, size_t len) {
 }
 
 int bi::nc_def_dim(int ncid, const std::string& name) {
+  NetCDFGuard guard;
   int dimid, status;
   status = ::nc_def_dim(ncid, name.c_str(), NC_UNLIMITED, &dimid);
   BI_ERROR_MSG(status == NC_NOERR, "Could not define dimension " << name);
@@ -71,6 +127,7 @@ int bi::nc_def_dim(int ncid, const std::string& name) {
 }
 
 int bi::nc_inq_dimid(int ncid, const std::string& name) {
+  NetCDFGuard guard;
   int dimid = -1;
   BI_UNUSED int status;
   status = ::nc_inq_dimid(ncid, name.c_str(), &dimid);
@@ -78,6 +135,7 @@ int bi::nc_inq_dimid(int ncid, const std::string& name) {
 }
 
 std::string bi::nc_inq_dimname(int ncid, int dimid) {
+  NetCDFGuard guard;
   char name[NC_MAX_NAME + 1];
   int status;
   status = ::nc_inq_dimname(ncid, dimid, name);
@@ -86,6 +144,7 @@ std::string bi::nc_inq_dimname(int ncid, int dimid) {
 }
 
 size_t bi::nc_inq_dimlen(int ncid, int dimid) {
+  NetCDFGuard guard;
   size_t len;
   int status;
   status = ::nc_inq_dimlen(ncid, dimid, &len);
@@ -95,6 +154,7 @@ size_t bi::nc_inq_dimlen(int ncid, int dimid) {
 
 int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype,
     const std::vector<int>& dimids) {
+  NetCDFGuard guard;
   int varid, status;
   status = ::nc_def_var(ncid, name.c_str(), xtype, dimids.size(),
       dimids.data(), &varid);
@@ -103,6 +163,7 @@ int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype,
 }
 
 int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype) {
+  NetCDFGuard guard;
   int varid, status;
   status = ::nc_def_var(ncid, name.c_str(), xtype, 0, NULL, &varid);
   BI_ERROR_MSG(status == NC_NOERR, "Could not define variable " << name);
@@ -111,6 +172,7 @@ int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype) {
 
 int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype,
     int dimid) {
+  NetCDFGuard guard;
   int varid, status;
   status = ::nc_def_var(ncid, name.c_str(), xtype, 1, &dimid, &varid);
   BI_ERROR_MSG(status == NC_NOERR, "Could not define variable " << name);
@@ -119,6 +181,7 @@ int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype,
 
 int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype,
     int dimid1, int dimid2) {
+  NetCDFGuard guard;
   int varid, status;
   int dims[2] = { dimid1, dimid2 };
   status = ::nc_def_var(ncid, name.c_str(), xtype, 2, dims, &varid);
@@ -126,7 +189,23 @@ int bi::nc_def_var(int ncid, const std::string& name, nc_type xtype,
   return varid;
 }
 
+void bi::nc_def_var_chunking(int ncid, int varid,
+    const std::vector<size_t>& chunksizes) {
+  NetCDFGuard guard;
+  int status = ::nc_def_var_chunking(ncid, varid, NC_CHUNKED,
+      chunksizes.data());
+  BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
+}
+
+void bi::nc_def_var_deflate(int ncid, int varid, bool shuffle, int level) {
+  NetCDFGuard guard;
+  int status = ::nc_def_var_deflate(ncid, varid, shuffle ? 1 : 0,
+      (level > 0) ? 1 : 0, level);
+  BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
+}
+
 int bi::nc_inq_varid(int ncid, const std::string& name) {
+  NetCDFGuard guard;
   int varid = -1;
   BI_UNUSED int status;
   status = ::nc_inq_varid(ncid, name.c_str(), &varid);
@@ -134,6 +213,7 @@ int bi::nc_inq_varid(int ncid, const std::string& name) {
 }
 
 std::string bi::nc_inq_varname(int ncid, int varid) {
+  NetCDFGuard guard;
   char name[NC_MAX_NAME + 1];
   int status;
   status = ::nc_inq_varname(ncid, varid, name);
@@ -142,6 +222,7 @@ std::string bi::nc_inq_varname(int ncid, int varid) {
 }
 
 int bi::nc_inq_varndims(int ncid, int varid) {
+  NetCDFGuard guard;
   int ndims, status;
   status = ::nc_inq_varndims(ncid, varid, &ndims);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -149,6 +230,7 @@ int bi::nc_inq_varndims(int ncid, int varid) {
 }
 
 std::vector<int> bi::nc_inq_vardimid(int ncid, int varid) {
+  NetCDFGuard guard;
   int ndims = nc_inq_varndims(ncid, varid);
   std::vector<int> dimids(ndims);
   if (ndims > 0) {
@@ -160,117 +242,138 @@ std::vector<int> bi::nc_inq_vardimid(int ncid, int varid) {
 
 void bi::nc_put_att(int ncid, const std::string& name,
     const std::string& value) {
+  NetCDFGuard guard;
   int status = ::nc_put_att_text(ncid, NC_GLOBAL, name.c_str(),
       value.length(), value.c_str());
   BI_ERROR_MSG(status == NC_NOERR, "Could not define attribute " << name);
 }
 
 void bi::nc_put_att(int ncid, const std::string& name, const int value) {
+  NetCDFGuard guard;
   int status = ::nc_put_att_int(ncid, NC_GLOBAL, name.c_str(), NC_INT, 1,
       &value);
   BI_ERROR_MSG(status == NC_NOERR, "Could not define attribute " << name);
 }
 
 void bi::nc_put_att(int ncid, const std::string& name, const float value) {
+  NetCDFGuard guard;
   int status = ::nc_put_att_float(ncid, NC_GLOBAL, name.c_str(), NC_FLOAT, 1,
       &value);
   BI_ERROR_MSG(status == NC_NOERR, "Could not define attribute " << name);
 }
 
 void bi::nc_put_att(int ncid, const std::string& name, const double value) {
+  NetCDFGuard guard;
   int status = ::nc_put_att_double(ncid, NC_GLOBAL, name.c_str(), NC_DOUBLE,
       1, &value);
   BI_ERROR_MSG(status == NC_NOERR, "Could not define attribute " << name);
 }
 
 void bi::nc_get_var(int ncid, int varid, int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var_int(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var(int ncid, int varid, long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var_long(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var(int ncid, int varid, float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var_float(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var(int ncid, int varid, double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var_double(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var(int ncid, int varid, const int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var_int(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var(int ncid, int varid, const long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var_long(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var(int ncid, int varid, const float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var_float(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var(int ncid, int varid, const double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var_double(ncid, varid, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var1(int ncid, int varid, const size_t index, int* ip) {
+  NetCDFGuard guard;
   int status;
   status = ::nc_get_var1_int(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var1(int ncid, int varid, const size_t index, long* ip) {
+  NetCDFGuard guard;
   int status;
   status = ::nc_get_var1_long(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var1(int ncid, int varid, const size_t index, float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var1_float(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var1(int ncid, int varid, const size_t index, double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var1_double(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const size_t index,
     const int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_int(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const size_t index,
     const long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_long(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const size_t index,
     const float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_float(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const size_t index,
     const double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_double(ncid, varid, &index, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var1(int ncid, int varid, const std::vector<size_t>& index,
     int* ip) {
+  NetCDFGuard guard;
   int status;
   status = ::nc_get_var1_int(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -278,6 +381,7 @@ void bi::nc_get_var1(int ncid, int varid, const std::vector<size_t>& index,
 
 void bi::nc_get_var1(int ncid, int varid, const std::vector<size_t>& index,
     long* ip) {
+  NetCDFGuard guard;
   int status;
   status = ::nc_get_var1_long(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -285,90 +389,105 @@ void bi::nc_get_var1(int ncid, int varid, const std::vector<size_t>& index,
 
 void bi::nc_get_var1(int ncid, int varid, const std::vector<size_t>& index,
     float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var1_float(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_var1(int ncid, int varid, const std::vector<size_t>& index,
     double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_var1_double(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const std::vector<size_t>& index,
     const int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_int(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const std::vector<size_t>& index,
     const long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_long(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const std::vector<size_t>& index,
     const float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_float(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_var1(int ncid, int varid, const std::vector<size_t>& index,
     const double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_var1_double(ncid, varid, index.data(), ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_vara(int ncid, int varid, const size_t start,
     const size_t count, int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_int(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_vara(int ncid, int varid, const size_t start,
     const size_t count, long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_long(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_vara(int ncid, int varid, const size_t start,
     const size_t count, float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_float(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_vara(int ncid, int varid, const size_t start,
     const size_t count, double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_double(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_vara(int ncid, int varid, const size_t start,
     const size_t count, const int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_int(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_vara(int ncid, int varid, const size_t start,
     const size_t count, const long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_long(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_vara(int ncid, int varid, const size_t start,
     const size_t count, const float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_float(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_put_vara(int ncid, int varid, const size_t start,
     const size_t count, const double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_double(ncid, varid, &start, &count, ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
 }
 
 void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_int(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -376,6 +495,7 @@ void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
 
 void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_long(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -383,6 +503,7 @@ void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
 
 void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_float(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -390,6 +511,7 @@ void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
 
 void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_get_vara_double(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -397,6 +519,7 @@ void bi::nc_get_vara(int ncid, int varid, const std::vector<size_t>& start,
 
 void bi::nc_put_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, const int* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_int(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -404,6 +527,7 @@ void bi::nc_put_vara(int ncid, int varid, const std::vector<size_t>& start,
 
 void bi::nc_put_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, const long* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_long(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -411,6 +535,7 @@ void bi::nc_put_vara(int ncid, int varid, const std::vector<size_t>& start,
 
 void bi::nc_put_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, const float* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_float(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -418,6 +543,7 @@ void bi::nc_put_vara(int ncid, int varid, const std::vector<size_t>& start,
 
 void bi::nc_put_vara(int ncid, int varid, const std::vector<size_t>& start,
     const std::vector<size_t>& count, const double* ip) {
+  NetCDFGuard guard;
   int status = ::nc_put_vara_double(ncid, varid, start.data(), count.data(),
       ip);
   BI_ERROR_MSG(status == NC_NOERR, nc_strerror(status));
@@ -75,6 +75,16 @@ void nc_close(int ncid);
  * @ingroup io_netcdf
  */
 int nc_inq_nvars(int ncid);
+
+/**
+ * Set size of the chunk cache for variables of files subsequently opened
+ * or created, keeping the current number of slots and preemption.
+ *
+ * @ingroup io_netcdf
+ *
+ * @param size Size of cache, in bytes.
+ */
+void nc_set_chunk_cache(size_t size);
 //@}
 
 /**
@@ -167,6 +177,30 @@ int nc_def_var(int ncid, const std::string& name, nc_type xtype, int dimid);
 int nc_def_var(int ncid, const std::string& name, nc_type xtype, int dimid1,
     int dimid2);
 
+/**
+ * Set chunk shape of variable.
+ *
+ * @ingroup io_netcdf
+ *
+ * @param ncid
+ * @param varid
+ * @param chunksizes Chunk length along each dimension of the variable.
+ */
+void nc_def_var_chunking(int ncid, int varid,
+    const std::vector<size_t>& chunksizes);
+
+/**
+ * Set compression filters of variable.
+ *
+ * @ingroup io_netcdf
+ *
+ * @param ncid
+ * @param varid
+ * @param shuffle Apply shuffle filter?
+ * @param level Deflate level, 0 for none, up to 9.
+ */
+void nc_def_var_deflate(int ncid, int varid, bool shuffle, int level);
+
 /**
  * @ingroup io_netcdf
  */
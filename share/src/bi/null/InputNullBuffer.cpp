@@ -8,7 +8,7 @@
 #include "InputNullBuffer.hpp"
 
 bi::InputNullBuffer::InputNullBuffer(const Model& m,
-    const std::string& file, const long ns, const long np) {
+    const std::string& file, const long ns, const long np, const int window) {
   //
 }
 
@@ -25,7 +25,7 @@ public:
    * @copydoc InputNetCDFBuffer::InputNetCDFBuffer()
    */
   InputNullBuffer(const Model& m, const std::string& file = "",
-      const long ns = 0, const long np = -1);
+      const long ns = 0, const long np = -1, const int window = 0);
 
   /**
    * @copydoc InputNetCDFBuffer::getTime()
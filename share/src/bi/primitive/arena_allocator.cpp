@@ -0,0 +1,107 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "arena_allocator.hpp"
+
+#include "../misc/assert.hpp"
+
+#include <algorithm>
+
+BI_THREAD bool bi_arena_detached = false;
+
+std::vector<bi::arena::pool> bi::arena::pools;
+size_t bi::arena::limit = size_t(1) << 30;
+bool bi::arena::resetting = false;
+
+bi::arena_stats::arena_stats() : allocs(0), hits(0), deallocs(0),
+    releases(0), cached(0), peak(0) {
+  //
+}
+
+bi::arena_stats& bi::arena_stats::operator+=(const arena_stats& o) {
+  allocs += o.allocs;
+  hits += o.hits;
+  deallocs += o.deallocs;
+  releases += o.releases;
+  cached += o.cached;
+  peak += o.peak;
+
+  return *this;
+}
+
+bi::arena::pool::pool() {
+  std::fill(heads, heads + NCLASSES, (void*)NULL);
+}
+
+void bi::arena::init(const int threads) {
+  reset();
+  pools.resize(threads);
+}
+
+void bi::arena::detach() {
+  bi_arena_detached = true;
+}
+
+void bi::arena::reset() {
+  for (int i = 0; i < (int)pools.size(); ++i) {
+    empty(pools[i]);
+  }
+}
+
+void bi::arena::step() {
+  if (resetting) {
+    int first = 0, last = pools.size();
+    #if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
+    if (omp_get_level() > 0) {
+      /* only the team nested under this thread, see bi_omp_thread_id() */
+      first = bi_omp_thread_id();
+      last = std::min(last, first + bi_omp_inner);
+    }
+    #endif
+    for (int i = first; i < last; ++i) {
+      empty(pools[i]);
+    }
+  }
+}
+
+void bi::arena::setLimit(const size_t limit) {
+  arena::limit = limit;
+}
+
+void bi::arena::setReset(const bool reset) {
+  resetting = reset;
+}
+
+bi::arena_stats bi::arena::stats() {
+  arena_stats res;
+  for (int i = 0; i < (int)pools.size(); ++i) {
+    res += pools[i].stats;
+  }
+  return res;
+}
+
+void* bi::arena::allocateSystem(const int k) {
+  void* ptr;
+  int err = posix_memalign(&ptr, 32, size_t(1) << k);
+  BI_ERROR_MSG(err == 0, "Arena memory allocation failed");
+  return ptr;
+}
+
+void bi::arena::empty(pool& o) {
+  void *ptr, *next;
+  for (int k = 0; k < NCLASSES; ++k) {
+    ptr = o.heads[k];
+    while (ptr != NULL) {
+      next = *static_cast<void**>(ptr);
+      free(ptr);
+      ++o.stats.releases;
+      ptr = next;
+    }
+    o.heads[k] = NULL;
+  }
+  o.stats.cached = 0;
+}
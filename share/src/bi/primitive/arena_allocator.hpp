@@ -0,0 +1,358 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_PRIMITIVE_ARENAALLOCATOR_HPP
+#define BI_PRIMITIVE_ARENAALLOCATOR_HPP
+
+#include "../misc/omp.hpp"
+
+#include <vector>
+#include <cstdlib>
+
+/**
+ * Is this thread detached from the arena? See bi::arena::detach().
+ */
+extern BI_THREAD bool bi_arena_detached;
+
+namespace bi {
+/**
+ * Statistics of arena use.
+ *
+ * @ingroup primitive_allocator
+ */
+struct arena_stats {
+  /**
+   * Constructor.
+   */
+  arena_stats();
+
+  /**
+   * Accumulate statistics of another thread.
+   */
+  arena_stats& operator+=(const arena_stats& o);
+
+  /**
+   * Number of allocations.
+   */
+  long allocs;
+
+  /**
+   * Number of allocations served from a free list.
+   */
+  long hits;
+
+  /**
+   * Number of deallocations.
+   */
+  long deallocs;
+
+  /**
+   * Number of blocks returned to the system, rather than a free list, as
+   * the limit had been reached, or on reset.
+   */
+  long releases;
+
+  /**
+   * Bytes currently held in free lists.
+   */
+  size_t cached;
+
+  /**
+   * Maximum bytes held in free lists.
+   */
+  size_t peak;
+};
+
+/**
+ * Thread-local arena of host memory blocks, shared by all instantiations of
+ * arena_allocator.
+ *
+ * @ingroup primitive_allocator
+ *
+ * Requests are rounded up to size classes of powers of two bytes, from one
+ * cache line. Each thread keeps one free list per class, threaded through
+ * the free blocks themselves, so that allocation and deallocation are
+ * constant time, without locks or any allocation of their own. Threads are
+ * identified by bi_omp_thread_id(), and free lists are created by
+ * bi_omp_init(). Before then, blocks are taken from and returned to the
+ * system directly.
+ *
+ * The bytes held in the free lists of each thread are bounded by #setLimit.
+ * In reset mode (see #setReset), #step returns all free blocks to the
+ * system, so that memory held never exceeds that needed for one time step.
+ *
+ * Blocks are aligned to 32 bytes.
+ */
+class arena {
+public:
+  /**
+   * Create free lists.
+   *
+   * @param threads Number of threads.
+   */
+  static void init(const int threads);
+
+  /**
+   * Detach the calling thread, which is not an OpenMP thread, from the
+   * arena, so that it takes blocks from and returns blocks to the system
+   * directly, rather than sharing the free lists of another thread. Where
+   * thread local storage is unavailable, this detaches all threads.
+   */
+  static void detach();
+
+  /**
+   * Allocate block.
+   *
+   * @param bytes Number of bytes.
+   */
+  static void* allocate(const size_t bytes);
+
+  /**
+   * Deallocate block.
+   *
+   * @param ptr Block.
+   * @param bytes Number of bytes, as given to #allocate.
+   */
+  static void deallocate(void* ptr, const size_t bytes);
+
+  /**
+   * Return all free blocks of all threads to the system. Must be called
+   * outside of any parallel region.
+   */
+  static void reset();
+
+  /**
+   * Mark the end of a time step. In reset mode, returns all free blocks of
+   * the calling thread, and those of any threads in its nested team, to the
+   * system. Otherwise does nothing.
+   */
+  static void step();
+
+  /**
+   * Set the maximum number of bytes held in the free lists of each thread.
+   */
+  static void setLimit(const size_t limit);
+
+  /**
+   * Set reset mode.
+   */
+  static void setReset(const bool reset);
+
+  /**
+   * Statistics, summed over threads. Must be called outside of any parallel
+   * region.
+   */
+  static arena_stats stats();
+
+private:
+  /**
+   * Number of size classes.
+   */
+  static const int NCLASSES = 48;
+
+  /**
+   * Smallest size class, as a power of two.
+   */
+  static const int MINCLASS = 6;
+
+  /**
+   * Free lists and statistics of one thread.
+   */
+  struct pool {
+    /**
+     * Constructor.
+     */
+    pool();
+
+    /**
+     * Heads of free lists, indexed by size class.
+     */
+    void* heads[NCLASSES];
+
+    /**
+     * Statistics.
+     */
+    arena_stats stats;
+
+    /**
+     * Padding to keep pools of different threads on separate cache lines.
+     */
+    char pad[64];
+  };
+
+  /**
+   * Size class of a request.
+   */
+  static int sizeClass(const size_t bytes);
+
+  /**
+   * Allocate block of a size class from the system.
+   */
+  static void* allocateSystem(const int k);
+
+  /**
+   * Return all free blocks in a pool to the system.
+   */
+  static void empty(pool& o);
+
+  /**
+   * Pools, indexed by thread.
+   */
+  static std::vector<pool> pools;
+
+  /**
+   * Limit on bytes held by each pool.
+   */
+  static size_t limit;
+
+  /**
+   * Reset mode?
+   */
+  static bool resetting;
+};
+
+/**
+ * Allocator drawing from the thread-local arena.
+ *
+ * @ingroup primitive_allocator
+ *
+ * @tparam T Value type.
+ *
+ * This class is thread safe. Buffers may be deallocated by a different
+ * thread to that which allocated them, in which case they join the free
+ * lists of the deallocating thread.
+ */
+template<class T>
+class arena_allocator {
+public:
+  typedef size_t size_type;
+  typedef size_t difference_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T value_type;
+
+  template <class U>
+  struct rebind {
+    typedef arena_allocator<U> other;
+  };
+
+  arena_allocator() {
+    //
+  }
+
+  template<class U>
+  arena_allocator(const arena_allocator<U>& o) {
+    //
+  }
+
+  pointer address(reference value) const {
+    return &value;
+  };
+
+  const_pointer address(const_reference value) const {
+    return &value;
+  };
+
+  size_type max_size() const {
+    return size_type(-1) / sizeof(T);
+  };
+
+  pointer allocate(size_type num, const_pointer *hint = 0) {
+    return (num > 0) ? static_cast<pointer>(arena::allocate(num*sizeof(T))) : NULL;
+  }
+
+  void construct(pointer p, const T& t) {
+    new ((void*)p) T(t);
+  }
+
+  void destroy(pointer p) {
+    ((T*)p)->~T();
+  }
+
+  void deallocate(pointer p, size_type num) {
+    if (p != NULL) {
+      arena::deallocate(p, num*sizeof(T));
+    }
+  }
+
+  template<class U>
+  bool operator==(const arena_allocator<U>& o) const {
+    return true;
+  }
+
+  template<class U>
+  bool operator!=(const arena_allocator<U>& o) const {
+    return false;
+  }
+};
+
+}
+
+inline int bi::arena::sizeClass(const size_t bytes) {
+  if (bytes <= (size_t(1) << MINCLASS)) {
+    return MINCLASS;
+  } else {
+    #ifdef __GNUC__
+    return 8*sizeof(unsigned long) - __builtin_clzl((unsigned long)(bytes - 1));
+    #else
+    int k = MINCLASS;
+    while ((size_t(1) << k) < bytes) {
+      ++k;
+    }
+    return k;
+    #endif
+  }
+}
+
+inline void* bi::arena::allocate(const size_t bytes) {
+  const int k = sizeClass(bytes);
+  const int tid = bi_omp_thread_id();
+  void* ptr;
+
+  if (!bi_arena_detached && tid < (int)pools.size()) {
+    pool& o = pools[tid];
+    ++o.stats.allocs;
+    ptr = o.heads[k];
+    if (ptr != NULL) {
+      o.heads[k] = *static_cast<void**>(ptr);
+      o.stats.cached -= size_t(1) << k;
+      ++o.stats.hits;
+    } else {
+      ptr = allocateSystem(k);
+    }
+  } else {
+    ptr = allocateSystem(k);
+  }
+  return ptr;
+}
+
+inline void bi::arena::deallocate(void* ptr, const size_t bytes) {
+  const int k = sizeClass(bytes);
+  const int tid = bi_omp_thread_id();
+  const size_t size = size_t(1) << k;
+
+  if (bi_arena_detached || tid >= (int)pools.size()) {
+    free(ptr);
+  } else if (pools[tid].stats.cached + size <= limit) {
+    pool& o = pools[tid];
+    *static_cast<void**>(ptr) = o.heads[k];
+    o.heads[k] = ptr;
+    o.stats.cached += size;
+    if (o.stats.cached > o.stats.peak) {
+      o.stats.peak = o.stats.cached;
+    }
+    ++o.stats.deallocs;
+  } else {
+    ++pools[tid].stats.deallocs;
+    ++pools[tid].stats.releases;
+    free(ptr);
+  }
+}
+
+#endif
@@ -265,6 +265,35 @@ struct gather_rows_impl {
   void func(const V1 map, const M1 X, M2 Y);
 };
 
+/**
+ * Gather rows of matrix in place, under a permuted map.
+ *
+ * @ingroup primitive_matrix
+ *
+ * @tparam V1 Integer vector type.
+ * @tparam M1 Matrix type.
+ *
+ * @param map Map, permuted so that <tt>map[map[i]] == map[i]</tt> for all
+ * @c i, as from Resampler::ancestorsPermute().
+ * @param[in,out] X Matrix.
+ *
+ * Equivalent to <tt>gather_rows(map, X, X)</tt>, but deterministic: rows
+ * that are the source of another are never overwritten. Only rows with
+ * <tt>map[i] != i</tt> are copied, which, after resampling, is typically a
+ * minority of them.
+ */
+template<class V1, class M1>
+void gather_rows_permuted(const V1 map, M1 X);
+
+/**
+ * @internal
+ */
+template<Location L>
+struct gather_rows_permuted_impl {
+  template<class V1, class M1>
+  void func(const V1 map, M1 X);
+};
+
 /**
  * Gather columns of matrix.
  *
@@ -639,6 +668,15 @@ void bi::gather_rows(const V1 map, const M1 X, M2 Y) {
   gather_rows_impl<M2::location>::func(map, X, Y);
 }
 
+template<class V1, class M1>
+void bi::gather_rows_permuted(const V1 map, M1 X) {
+  /* pre-conditions */
+  BI_ASSERT(map.size() <= X.size1());
+  BI_ASSERT(V1::location == M1::location);
+
+  gather_rows_permuted_impl<M1::location>::func(map, X);
+}
+
 template<class V1, class M1, class M2>
 void bi::gather_columns(const V1 map, const M1 X, M2 Y) {
   /* pre-conditions */
@@ -170,17 +170,18 @@ inline typename bi::pooled_allocator<A>::pointer bi::pooled_allocator<A>::alloca
 
   /* check available items to reuse */
   if (num > 0) {
-    BOOST_AUTO(iter, available[bi_omp_tid].find(num));
+    const int tid = bi_omp_thread_id();
+    BOOST_AUTO(iter, available[tid].find(num));
     /* ^ can use lower_bound() to get buffer of *at least* size num, but will
      * be returned to pool as if size num, not >= num, so find() is used to get
      * buffers only of exactly size num instead. */
-    if (iter != available[bi_omp_tid].end()) {
+    if (iter != available[tid].end()) {
       /* existing item */
       BI_ASSERT(!iter->second.empty());
       p = iter->second.back();
       iter->second.pop_back();
       if (iter->second.empty()) {
-        available[bi_omp_tid].erase(iter);
+        available[tid].erase(iter);
       }
     } else {
       /* new item */
@@ -208,7 +209,8 @@ inline void bi::pooled_allocator<A>::deallocate(pointer p, size_type num) {
   if (p != NULL) {
     /* return to pool for reuse; note insert won't insert if key already
      * exists, but in either case returns iterator for that key */
-    available[bi_omp_tid].insert(std::make_pair(num,
+    const int tid = bi_omp_thread_id();
+    available[tid].insert(std::make_pair(num,
         std::list<pointer>())).first->second.push_back(p);
   } else {
     alloc.deallocate(p, num);
@@ -217,14 +219,15 @@ inline void bi::pooled_allocator<A>::deallocate(pointer p, size_type num) {
 
 template<class A>
 inline void bi::pooled_allocator<A>::empty() {
-  BOOST_AUTO(iter1, available[bi_omp_tid].begin());
-  for (; iter1 != available[bi_omp_tid].end(); ++iter1) {
+  const int tid = bi_omp_thread_id();
+  BOOST_AUTO(iter1, available[tid].begin());
+  for (; iter1 != available[tid].end(); ++iter1) {
     BOOST_AUTO(iter2, iter1->second.begin());
     for (; iter2 != iter1->second.end(); ++iter2) {
       alloc.deallocate(*iter2, iter1->first);
     }
   }
-  available[bi_omp_tid].clear();
+  available[tid].clear();
 }
 
 #endif
@@ -370,7 +370,7 @@ void bi::Random::multinomials(const V1 lps, V2 xs) {
 }
 
 inline bi::RngHost& bi::Random::getHostRng() {
-  return hostRngs[bi_omp_tid];
+  return hostRngs[bi_omp_thread_id()];
 }
 
 #ifdef ENABLE_CUDA
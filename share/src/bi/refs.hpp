@@ -31,6 +31,10 @@
  * Del Moral, P. & Murray L. M. Sequential Monte Carlo with highly informative
  * observations. <b>2014</b>. http://arxiv.org/abs/1405.4081.
  *
+ * @anchor Devroye1986
+ * Devroye, L. <i>Non-Uniform Random Variate Generation</i>. Springer,
+ * <b>1986</b>.
+ *
  * @anchor Gray2001
  * Gray, A. G. & Moore, A. W. `N-Body' Problems in Statistical
  * Learning. <i>Advances in Neural Information Processing Systems</i>,
@@ -14,6 +14,7 @@
 #include "../random/Random.hpp"
 #include "../misc/exception.hpp"
 #include "../misc/location.hpp"
+#include "../misc/Profiler.hpp"
 #include "../traits/resampler_traits.hpp"
 
 namespace bi {
@@ -100,6 +101,25 @@ public:
    */
   template<class S1>
   void shuffle(Random& rng, S1& s);
+
+  /**
+   * Get particles that are ready to propagate after resampling.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param[in,out] s State.
+   * @param[out] ps Indices of particles that are ready.
+   *
+   * @return Are there further particles to come? If so, call again once
+   * those in @p ps have been propagated.
+   *
+   * Resampling is complete on return from resample(), so this gives all
+   * particles at once. DistributedResampler may instead give them in turn,
+   * as transfers between processes complete.
+   */
+  template<class S1>
+  bool next(Random& rng, S1& s, std::vector<int>& ps);
   //@}
 
 protected:
@@ -125,6 +145,8 @@ protected:
 
 #include "boost/mpl/if.hpp"
 
+#include <vector>
+
 template<class R>
 inline bi::Resampler<R>::Resampler(const double essRel, const bool anytime) :
     essRel(essRel), maxLogWeight(0.0), anytime(anytime) {
@@ -177,6 +199,7 @@ bool bi::Resampler<R>::resample(Random& rng, const ScheduleElement now, S1& s)
     R::precompute(s.logWeights(), pre);
     R::ancestorsPermute(rng, s.logWeights(), as1, pre);
 
+    ProfileScope scope(PROFILE_GATHER);
     s.gather(now, as1);
     set_elements(s.logWeights(), s.logLikelihood);
   } else if (now.hasOutput()) {
@@ -198,4 +221,14 @@ void bi::Resampler<R>::shuffle(Random& rng, S1& s) {
   }
 }
 
+template<class R>
+template<class S1>
+bool bi::Resampler<R>::next(Random& rng, S1& s, std::vector<int>& ps) {
+  ps.resize(s.size());
+  for (int i = 0; i < s.size(); ++i) {
+    ps[i] = i;
+  }
+  return false;
+}
+
 #endif
@@ -8,6 +8,11 @@
 #ifndef BI_RESAMPLER_SCANRESAMPLER_HPP
 #define BI_RESAMPLER_SCANRESAMPLER_HPP
 
+#include "../misc/omp.hpp"
+
+#include <vector>
+#include <algorithm>
+
 namespace bi {
 /**
  * Precomputed results for ScanResampler.
@@ -25,14 +30,37 @@ struct ScanResamplerPrecompute {
  */
 class ScanResampler {
 public:
+  /**
+   * Constructor.
+   */
+  ScanResampler();
+
   /**
    * @copydoc Resampler::precompute
    */
   template<class V1, Location L>
   void precompute(const V1 lws, ScanResamplerPrecompute<L>& pre);
+
+protected:
+  /**
+   * Scratch of the calling thread, for kernels on host.
+   */
+  std::vector<double>& scratch();
+
+private:
+  /**
+   * Scratch, by thread. Filters may run concurrently on separate threads
+   * with the same resampler (see MarginalSIR), so each thread has its own.
+   */
+  std::vector<std::vector<double> > work;
 };
 }
 
+inline bi::ScanResampler::ScanResampler() :
+    work(std::max(1, bi_omp_max_threads)) {
+  //
+}
+
 template<class V1, bi::Location L>
 void bi::ScanResampler::precompute(const V1 lws,
     ScanResamplerPrecompute<L>& pre) {
@@ -41,4 +69,11 @@ void bi::ScanResampler::precompute(const V1 lws,
   pre.W = *(pre.Ws.end() - 1);  // sum of weights
 }
 
+inline std::vector<double>& bi::ScanResampler::scratch() {
+  /* pre-condition */
+  BI_ASSERT(bi_omp_thread_id() < int(work.size()));
+
+  return work[bi_omp_thread_id()];
+}
+
 #endif
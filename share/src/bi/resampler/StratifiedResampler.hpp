@@ -25,6 +25,15 @@ namespace bi {
  */
 class StratifiedResampler: public ScanResampler {
 public:
+  /**
+   * @copydoc Resampler::precompute
+   *
+   * On host, does nothing, as the prefix sum is fused into each of the
+   * operations below (see ScanResamplerHost).
+   */
+  template<class V1, Location L>
+  void precompute(const V1 lws, ScanResamplerPrecompute<L>& pre);
+
   /**
    * Select cumulative offspring.
    *
@@ -75,7 +84,7 @@ struct precompute_type<StratifiedResampler,L> {
 };
 }
 
-#include "../host/resampler/StratifiedResamplerHost.hpp"
+#include "../host/resampler/ScanResamplerHost.hpp"
 #ifdef __CUDACC__
 #include "../cuda/resampler/StratifiedResamplerGPU.cuh"
 #endif
@@ -86,6 +95,14 @@ struct precompute_type<StratifiedResampler,L> {
 #include "../math/temp_vector.hpp"
 #include "../math/sim_temp_vector.hpp"
 
+template<class V1, bi::Location L>
+void bi::StratifiedResampler::precompute(const V1 lws,
+    ScanResamplerPrecompute<L>& pre) {
+  if (V1::on_device) {
+    ScanResampler::precompute(lws, pre);
+  }
+}
+
 template<class V1, class V2, bi::Location L>
 void bi::StratifiedResampler::cumulativeOffspring(Random& rng, const V1 lws, const int P,
     V2 Os, ScanResamplerPrecompute<L>& pre)
@@ -93,52 +110,67 @@ void bi::StratifiedResampler::cumulativeOffspring(Random& rng, const V1 lws, con
   /* pre-condition */
   BI_ASSERT(lws.size() == Os.size());
 
-  if (pre.W > 0) {
+  if (V1::on_device) {
 #ifdef __CUDACC__
-    typedef typename boost::mpl::if_c<V1::on_device,StratifiedResamplerGPU,
-    StratifiedResamplerHost>::type impl;
-#else
-    typedef StratifiedResamplerHost impl;
+    if (pre.W > 0) {
+      StratifiedResamplerGPU::op(rng, pre.Ws, Os, P);
+    } else {
+      throw ParticleFilterDegeneratedException();
+    }
 #endif
-    impl::op(rng, pre.Ws, Os, P);
+  } else {
+    ScanResamplerHost::op(rng, lws, P, true,
+        resample_cumulative_offspring_emitter<V2>(Os), scratch());
+  }
 
 #ifndef NDEBUG
-    int m = *(Os.end() - 1);
-    BI_ASSERT_MSG(m == P,
-        "Stratified resampler gives " << m << " offspring, should give " << P);
+  int m = *(Os.end() - 1);
+  BI_ASSERT_MSG(m == P,
+      "Stratified resampler gives " << m << " offspring, should give " << P);
 #endif
-  } else {
-    throw ParticleFilterDegeneratedException();
-  }
 }
 
 template<class V1, class V2, bi::Location L>
 void bi::StratifiedResampler::ancestors(Random& rng, const V1 lws, V2 as,
     ScanResamplerPrecompute<L>& pre)
         throw (ParticleFilterDegeneratedException) {
-  typename sim_temp_vector<V2>::type Os(lws.size());
-
-  cumulativeOffspring(rng, lws, as.size(), Os, pre);
-  cumulativeOffspringToAncestors(Os, as);
+  if (V1::on_device) {
+    typename sim_temp_vector<V2>::type Os(lws.size());
+    cumulativeOffspring(rng, lws, as.size(), Os, pre);
+    cumulativeOffspringToAncestors(Os, as);
+  } else {
+    ScanResamplerHost::op(rng, lws, as.size(), true,
+        resample_ancestors_emitter<V2>(as), scratch());
+  }
 }
 
 template<class V1, class V2, bi::Location L>
 void bi::StratifiedResampler::ancestorsPermute(Random& rng, const V1 lws,
     V2 as, ScanResamplerPrecompute<L>& pre)
         throw (ParticleFilterDegeneratedException) {
-  typename sim_temp_vector<V2>::type Os(lws.size());
-
-  cumulativeOffspring(rng, lws, as.size(), Os, pre);
-  cumulativeOffspringToAncestorsPermute(Os, as);
+  if (V1::on_device) {
+    typename sim_temp_vector<V2>::type Os(lws.size());
+    cumulativeOffspring(rng, lws, as.size(), Os, pre);
+    cumulativeOffspringToAncestorsPermute(Os, as);
+  } else {
+    ScanResamplerHost::op(rng, lws, as.size(), true,
+        resample_ancestors_emitter<V2>(as), scratch());
+    permute(as);
+  }
 }
 
 template<class V1, class V2, bi::Location L>
 void bi::StratifiedResampler::offspring(Random& rng, const V1 lws, const int P, V2 os,
     ScanResamplerPrecompute<L>& pre)
         throw (ParticleFilterDegeneratedException) {
-  typename sim_temp_vector<V1>::type Os(os.size());
-  cumulativeOffspring(rng, lws, P, Os, pre);
-  cumulativeOffspringToOffspring(Os, os);
+  if (V1::on_device) {
+    typename sim_temp_vector<V1>::type Os(os.size());
+    cumulativeOffspring(rng, lws, P, Os, pre);
+    cumulativeOffspringToOffspring(Os, os);
+  } else {
+    ScanResamplerHost::op(rng, lws, P, true,
+        resample_offspring_emitter<V2>(os), scratch());
+  }
 }
 
 #endif
@@ -66,6 +66,12 @@ public:
    * @name Low-level interface
    */
   //@{
+  /**
+   * @copydoc StratifiedResampler::precompute
+   */
+  template<class V1, Location L>
+  void precompute(const V1 lws, ScanResamplerPrecompute<L>& pre);
+
   /**
    * @copydoc StratifiedResampler::cumulativeOffspring
    */
@@ -109,10 +115,19 @@ struct precompute_type<SystematicResampler,L> {
 };
 }
 
+#include "../host/resampler/ScanResamplerHost.hpp"
 #include "../primitive/vector_primitive.hpp"
 #include "../misc/location.hpp"
 #include "../math/sim_temp_vector.hpp"
 
+template<class V1, bi::Location L>
+void bi::SystematicResampler::precompute(const V1 lws,
+    ScanResamplerPrecompute<L>& pre) {
+  if (V1::on_device) {
+    ScanResampler::precompute(lws, pre);
+  }
+}
+
 template<class V1, class V2, bi::Location L>
 void bi::SystematicResampler::cumulativeOffspring(Random& rng, const V1 lws,
     const int P, V2 Os, ScanResamplerPrecompute<L>& pre)
@@ -122,47 +137,66 @@ void bi::SystematicResampler::cumulativeOffspring(Random& rng, const V1 lws,
 
   typedef typename V1::value_type T1;
 
-  if (pre.W > 0) {
-    T1 a = rng.uniform((T1)0.0, (T1)1.0);  // offset into strata
-    op_elements(pre.Ws, Os, resample_cumulative_offspring<T1>(a, pre.W, P));
+  if (V1::on_device) {
+    if (pre.W > 0) {
+      T1 a = rng.uniform((T1)0.0, (T1)1.0);  // offset into strata
+      op_elements(pre.Ws, Os, resample_cumulative_offspring<T1>(a, pre.W, P));
+    } else {
+      throw ParticleFilterDegeneratedException();
+    }
+  } else {
+    ScanResamplerHost::op(rng, lws, P, false,
+        resample_cumulative_offspring_emitter<V2>(Os), scratch());
+  }
 
 #ifndef NDEBUG
-    int m = *(Os.end() - 1);
-    BI_ASSERT_MSG(m == P,
-        "Systematic resampler gives " << m << " offspring, should give " << P);
+  int m = *(Os.end() - 1);
+  BI_ASSERT_MSG(m == P,
+      "Systematic resampler gives " << m << " offspring, should give " << P);
 #endif
-  } else {
-    throw ParticleFilterDegeneratedException();
-  }
 }
 
 template<class V1, class V2, bi::Location L>
 void bi::SystematicResampler::ancestors(Random& rng, const V1 lws,
     V2 as, ScanResamplerPrecompute<L>& pre)
         throw (ParticleFilterDegeneratedException) {
-  typename sim_temp_vector<V2>::type Os(lws.size());
-
-  cumulativeOffspring(rng, lws, as.size(), Os, pre);
-  cumulativeOffspringToAncestors(Os, as);
+  if (V1::on_device) {
+    typename sim_temp_vector<V2>::type Os(lws.size());
+    cumulativeOffspring(rng, lws, as.size(), Os, pre);
+    cumulativeOffspringToAncestors(Os, as);
+  } else {
+    ScanResamplerHost::op(rng, lws, as.size(), false,
+        resample_ancestors_emitter<V2>(as), scratch());
+  }
 }
 
 template<class V1, class V2, bi::Location L>
 void bi::SystematicResampler::ancestorsPermute(Random& rng, const V1 lws,
     V2 as, ScanResamplerPrecompute<L>& pre)
         throw (ParticleFilterDegeneratedException) {
-  typename sim_temp_vector<V2>::type Os(lws.size());
-
-  cumulativeOffspring(rng, lws, as.size(), Os, pre);
-  cumulativeOffspringToAncestorsPermute(Os, as);
+  if (V1::on_device) {
+    typename sim_temp_vector<V2>::type Os(lws.size());
+    cumulativeOffspring(rng, lws, as.size(), Os, pre);
+    cumulativeOffspringToAncestorsPermute(Os, as);
+  } else {
+    ScanResamplerHost::op(rng, lws, as.size(), false,
+        resample_ancestors_emitter<V2>(as), scratch());
+    permute(as);
+  }
 }
 
 template<class V1, class V2, bi::Location L>
 void bi::SystematicResampler::offspring(Random& rng, const V1 lws, const int P, V2 os,
     ScanResamplerPrecompute<L>& pre)
         throw (ParticleFilterDegeneratedException) {
-  typename sim_temp_vector<V1>::type Os(os.size());
-  cumulativeOffspring(rng, lws, P, Os, pre);
-  cumulativeOffspringToOffspring(Os, os);
+  if (V1::on_device) {
+    typename sim_temp_vector<V1>::type Os(os.size());
+    cumulativeOffspring(rng, lws, P, Os, pre);
+    cumulativeOffspringToOffspring(Os, os);
+  } else {
+    ScanResamplerHost::op(rng, lws, P, false,
+        resample_offspring_emitter<V2>(os), scratch());
+  }
 }
 
 #endif
@@ -10,6 +10,9 @@
 
 #include "../state/Schedule.hpp"
 #include "../misc/exception.hpp"
+#include "../math/constant.hpp"
+
+#include <vector>
 
 namespace bi {
 /**
@@ -24,6 +27,26 @@ namespace bi {
  * with a particle filter, gives the particle marginal Metropolis--Hastings
  * sampler described in @ref Andrieu2010 "Andrieu, Doucet \& Holenstein (2010)".
  *
+ * Several chains may be run in one process, sharing the model, inputs and
+ * observations of the filter, by passing one state per chain to #sample.
+ * Each round, the filters of the proposals of all chains run concurrently,
+ * each on its own group of threads (see bi_omp_split() and bi_omp_nest()),
+ * and so draw from the random number generators of those threads. As for
+ * MarginalSIR, this requires a filter that does not modify the state of its
+ * resampler, so excludes AdaptivePF and RejectionResampler.
+ *
+ * The uniform variate of the acceptance test is drawn before the filter is
+ * run on a proposal, so that the test becomes a threshold on its
+ * log-likelihood. Given an upper bound on the log-likelihood increment of
+ * each observation (@p bound), such as zero for observations with a
+ * probability mass function, the filter stops as soon as the threshold can
+ * no longer be reached, and the proposal is rejected early. The decision is
+ * the same as that of the full filter, so the sampler is unchanged. This
+ * requires a filter whose log-likelihood so far is the sum of the increments
+ * of the observations so far, such as BootstrapPF or ExtendedKF, and
+ * excludes BridgePF and LookaheadPF, whose weights at bridge and lookahead
+ * points include densities that are divided out later.
+ *
  * @todo Add proposal adaptation using adapter classes.
  */
 template<class B, class F>
@@ -34,8 +57,10 @@ public:
    *
    * @param m Model.
    * @param filter Filter.
+   * @param bound Upper bound on the log-likelihood increment of each
+   * observation, for early rejection. Infinity to disable.
    */
-  MarginalMH(B& m, F& filter);
+  MarginalMH(B& m, F& filter, const double bound = BI_INF);
 
   /**
    * @name High-level interface
@@ -61,6 +86,29 @@ public:
   template<class S1, class IO1, class IO2>
   void sample(Random& rng, const ScheduleIterator first,
       const ScheduleIterator last, S1& s, const int C, IO1& out, IO2& inInit);
+
+  /**
+   * Sample with several chains.
+   *
+   * @tparam S1 State type.
+   * @tparam IO1 Output type.
+   * @tparam IO2 Input type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param ss States, one per chain.
+   * @param C Number of samples to draw, over all chains.
+   * @param out Output buffer.
+   * @param inInit Initialisation file.
+   *
+   * With @c K chains, sample @c c of chain @c k is output at index
+   * <tt>c*K + k</tt>, so that the samples of each round are contiguous.
+   */
+  template<class S1, class IO1, class IO2>
+  void sample(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, std::vector<S1*>& ss, const int C,
+      IO1& out, IO2& inInit);
   //@}
 
   /**
@@ -101,10 +149,12 @@ public:
    * @param[in,out] s1 Current state.
    * @param[out] s2 Proposed state.
    * @param[in,out] out Output buffer.
+   * @param[out] logu Logarithm of the uniform variate for the acceptance
+   * test.
    */
   template<class S1, class S2, class IO1>
   void propose(Random& rng, const ScheduleIterator first,
-      const ScheduleIterator last, S1& s1, S2& s2, IO1& out);
+      const ScheduleIterator last, S1& s1, S2& s2, IO1& out, double& logu);
 
   /**
    * Accept or reject proposed state.
@@ -115,11 +165,14 @@ public:
    * @param[in,out] rng Random number generator.
    * @param s1 Current state.
    * @param s2 Proposed state.
+   * @param logu Logarithm of the uniform variate for the acceptance test,
+   * from #propose.
    *
    * @return Was proposal accepted?
    */
   template<class S1, class S2, class IO1>
-  bool acceptReject(Random& rng, S1& s1, S2& s2, IO1& out);
+  bool acceptReject(Random& rng, S1& s1, S2& s2, IO1& out,
+      const double logu);
 
   /**
    * Output.
@@ -153,6 +206,18 @@ public:
   template<class S1, class S2>
   void report(const int c, const S1& s1, const S2& s2);
 
+  /**
+   * Report acceptance rates and throughput of chains on stderr.
+   *
+   * @param accepts Number of accepted proposals of each chain.
+   * @param totals Number of proposals of each chain.
+   * @param usecs Time spent filtering by each chain, in microseconds.
+   * @param usecsAll Total time, in microseconds.
+   */
+  void reportChains(const std::vector<int>& accepts,
+      const std::vector<int>& totals, const std::vector<long>& usecs,
+      const long usecsAll);
+
   /**
    * Terminate.
    */
@@ -170,6 +235,11 @@ private:
    */
   F& filter;
 
+  /**
+   * Upper bound on log-likelihood increment of each observation.
+   */
+  double bound;
+
   /**
    * Was the last proposal accepted?
    */
@@ -188,10 +258,12 @@ private:
 }
 
 #include "../misc/TicToc.hpp"
+#include "../misc/omp.hpp"
 
 template<class B, class F>
-bi::MarginalMH<B,F>::MarginalMH(B& m, F& filter) :
-    m(m), filter(filter), lastAccepted(false), accepted(0), total(0) {
+bi::MarginalMH<B,F>::MarginalMH(B& m, F& filter, const double bound) :
+    m(m), filter(filter), bound(bound), lastAccepted(false), accepted(0), total(
+        0) {
   //
 }
 
@@ -203,11 +275,12 @@ void bi::MarginalMH<B,F>::sample(Random& rng, const ScheduleIterator first,
   BI_ERROR(C > 0);
 
   TicToc clock;
+  double logu;
   init(rng, first, last, s.s1, s.out, inInit);
   output(0, s.s1, out);
   for (int c = 1; c < C; ++c) {
-    propose(rng, first, last, s.s1, s.s2, s.out);
-    acceptReject(rng, s.s1, s.s2, s.out);
+    propose(rng, first, last, s.s1, s.s2, s.out, logu);
+    acceptReject(rng, s.s1, s.s2, s.out, logu);
     report(c, s.s1, s.s2);
     output(c, s.s1, out);
   }
@@ -216,6 +289,93 @@ void bi::MarginalMH<B,F>::sample(Random& rng, const ScheduleIterator first,
   term();
 }
 
+template<class B, class F>
+template<class S1, class IO1, class IO2>
+void bi::MarginalMH<B,F>::sample(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, std::vector<S1*>& ss, const int C,
+    IO1& out, IO2& inInit) {
+  /* pre-conditions */
+  BI_ERROR(C > 0);
+  BI_ERROR(ss.size() > 0);
+
+  const int K = ss.size();
+  std::vector<int> accepts(K, 1), totals(K, 1);
+  std::vector<long> usecs(K, 0);
+  std::vector<double> logus(K);
+  int outer, inner, c, k, n;
+  TicToc clock;
+
+  bi_omp_split(K, 0, outer, inner);
+
+  /* initialise, one at a time, as reads of the init file are not
+   * serialised */
+  for (k = 0; k < K; ++k) {
+    filter.init(rng, *first, ss[k]->s1, ss[k]->out, inInit);
+  }
+  #pragma omp parallel num_threads(outer) if(outer > 1)
+  {
+    if (outer > 1) {
+      bi_omp_nest(inner);
+    }
+
+    #pragma omp for schedule(static)
+    for (k = 0; k < K; ++k) {
+      TicToc clock1;
+      filter.filter(rng, first, last, ss[k]->s1, ss[k]->out);
+      usecs[k] += clock1.toc();
+    }
+
+    if (outer > 1) {
+      bi_omp_unnest();
+    }
+  }
+  n = bi::min(K, C);
+  for (k = 0; k < n; ++k) {
+    filter.samplePath(rng, ss[k]->s1, ss[k]->out);
+    output(k, ss[k]->s1, out);
+  }
+  lastAccepted = true;
+  accepted = n;
+  total = n;
+
+  /* rounds */
+  for (c = 1; c * K < C; ++c) {
+    n = bi::min(K, C - c * K);
+
+    #pragma omp parallel num_threads(outer) if(outer > 1)
+    {
+      if (outer > 1) {
+        bi_omp_nest(inner);
+      }
+
+      #pragma omp for schedule(static)
+      for (k = 0; k < n; ++k) {
+        TicToc clock1;
+        propose(rng, first, last, ss[k]->s1, ss[k]->s2, ss[k]->out,
+            logus[k]);
+        usecs[k] += clock1.toc();
+      }
+
+      if (outer > 1) {
+        bi_omp_unnest();
+      }
+    }
+
+    for (k = 0; k < n; ++k) {
+      if (acceptReject(rng, ss[k]->s1, ss[k]->s2, ss[k]->out, logus[k])) {
+        ++accepts[k];
+      }
+      ++totals[k];
+      report(c * K + k, ss[k]->s1, ss[k]->s2);
+      output(c * K + k, ss[k]->s1, out);
+    }
+  }
+  ss[0]->clock = clock.toc();
+  outputT(*ss[0], out);
+  reportChains(accepts, totals, usecs, ss[0]->clock);
+  term();
+}
+
 template<class B, class F>
 template<class S1, class IO1, class IO2>
 void bi::MarginalMH<B,F>::init(Random& rng, const ScheduleIterator first,
@@ -231,13 +391,21 @@ void bi::MarginalMH<B,F>::init(Random& rng, const ScheduleIterator first,
 template<class B, class F>
 template<class S1, class S2, class IO1>
 void bi::MarginalMH<B,F>::propose(Random& rng, const ScheduleIterator first,
-    const ScheduleIterator last, S1& s1, S2& s2, IO1& out) {
+    const ScheduleIterator last, S1& s1, S2& s2, IO1& out, double& logu) {
+  logu = bi::log(rng.uniform<double>());
   try {
     filter.propose(rng, *first, s1, s2, out);
-    if (bi::is_finite(s2.logPrior)) {
-      filter.filter(rng, first, last, s2, out);
-    } else {
+    if (!bi::is_finite(s2.logPrior)) {
       s2.logLikelihood = -BI_INF;
+    } else if (bi::is_finite(bound) && bi::is_finite(s1.logLikelihood)) {
+      /* the proposal is accepted only if its log-likelihood exceeds this */
+      double logpr = s2.logPrior - s1.logPrior;
+      double logqr = s1.logProposal - s2.logProposal;
+      double threshold = s1.logLikelihood + logu - logpr - logqr;
+
+      filter.filter(rng, first, last, s2, out, threshold, bound);
+    } else {
+      filter.filter(rng, first, last, s2, out);
     }
   } catch (CholeskyException e) {
     s2.logLikelihood = -BI_INF;
@@ -248,7 +416,8 @@ void bi::MarginalMH<B,F>::propose(Random& rng, const ScheduleIterator first,
 
 template<class B, class F>
 template<class S1, class S2, class IO1>
-bool bi::MarginalMH<B,F>::acceptReject(Random& rng, S1& s1, S2& s2, IO1& out) {
+bool bi::MarginalMH<B,F>::acceptReject(Random& rng, S1& s1, S2& s2, IO1& out,
+    const double logu) {
   if (!bi::is_finite(s2.logLikelihood)) {
     lastAccepted = false;
   } else if (!bi::is_finite(s1.logLikelihood)) {
@@ -258,9 +427,8 @@ bool bi::MarginalMH<B,F>::acceptReject(Random& rng, S1& s1, S2& s2, IO1& out) {
     double logpr = s2.logPrior - s1.logPrior;
     double logqr = s1.logProposal - s2.logProposal;
     double logratio = loglr + logpr + logqr;
-    double u = rng.uniform<double>();
 
-    lastAccepted = bi::log(u) < logratio;
+    lastAccepted = logu < logratio;
   }
 
   if (lastAccepted) {
@@ -318,6 +486,23 @@ void bi::MarginalMH<B,F>::report(const int c, const S1& s1, const S2& s2) {
   std::cerr << std::endl;
 }
 
+template<class B, class F>
+void bi::MarginalMH<B,F>::reportChains(const std::vector<int>& accepts,
+    const std::vector<int>& totals, const std::vector<long>& usecs,
+    const long usecsAll) {
+  int k, acceptsAll = 0, totalsAll = 0;
+  for (k = 0; k < (int)accepts.size(); ++k) {
+    std::cerr << "chain " << k << ":\taccept=" <<
+        (double)accepts[k] / totals[k] << "\tsamples/s=" <<
+        1.0e6 * totals[k] / bi::max(usecs[k], 1L) << std::endl;
+    acceptsAll += accepts[k];
+    totalsAll += totals[k];
+  }
+  std::cerr << "all:\taccept=" << (double)acceptsAll / totalsAll <<
+      "\tsamples/s=" << 1.0e6 * totalsAll / bi::max(usecsAll, 1L) <<
+      std::endl;
+}
+
 template<class B, class F>
 void bi::MarginalMH<B,F>::term() {
   //
@@ -12,10 +12,11 @@
 #include "../state/Schedule.hpp"
 #include "../misc/exception.hpp"
 #include "../misc/TicToc.hpp"
+#include "../misc/Profiler.hpp"
+#include "../misc/omp.hpp"
 #include "../primitive/vector_primitive.hpp"
 
-#include <fstream>
-#include <sstream>
+#include <vector>
 
 namespace bi {
 /**
@@ -31,6 +32,16 @@ namespace bi {
  * Implements sequential importance resampling over parameters, which, when
  * combined with a particle filter, gives the SMC^2 method described in
  * @ref Chopin2013 "Chopin, Jacob \& Papaspiliopoulos (2013)".
+ *
+ * The filters of several \f$\theta\f$-particles may be run concurrently by
+ * #init, #step and #move, each on its own group of threads, with the
+ * threads of each group sharing the \f$x\f$-particles (see bi_omp_split()
+ * and bi_omp_nest()). Each filter draws from its own stream (see
+ * RngHost::setTaskStream()) so that, with ENABLE_PHILOX, the result does
+ * not depend on the grouping. This requires a filter that does not modify
+ * the state of its resampler, so excludes AdaptivePF and
+ * RejectionResampler. Moves under a time budget (@p tmoves) always run one
+ * at a time.
  */
 template<class B, class F, class A, class R>
 class MarginalSIR {
@@ -45,9 +56,12 @@ public:
    * @param nmoves Number of move steps per \f$\theta\f$-particle after each
    * resample.
    * @param tmoves Total real time allocated to move steps, in seconds.
+   * @param nparallel Number of \f$\theta\f$-particles to propagate
+   * concurrently. Zero to choose automatically with bi_omp_split(), one to
+   * propagate them one at a time.
    */
   MarginalSIR(B& m, F& filter, A& adapter, R& resam, const int nmoves = 1,
-      const long tmoves = 0.0);
+      const long tmoves = 0.0, const int nparallel = 1);
 
   /**
    * @name High-level interface
@@ -167,23 +181,34 @@ public:
 
 private:
   /**
-   * Step for instrumentation.
-   */
-  enum Step {
-    INIT, READY, INTERACT, MOVE, STEP, TERM
-  };
-
-  /**
-   * Profiling output.
+   * Move a single \f$\theta\f$-particle.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param iter Current position in time schedule.
+   * @param[in,out] s1 State of the \f$\theta\f$-particle.
+   * @param[in,out] out1 Output of the \f$\theta\f$-particle.
+   * @param[out] s2 Scratch state.
+   * @param[out] out2 Scratch output.
+   * @param[in,out] naccept Number of acceptances.
+   * @param[in,out] ntotal Number of moves.
    */
-  void profile(const Step step);
+  template<class S2, class IO2>
+  void moveOne(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator iter, S2& s1, IO2& out1, S2& s2, IO2& out2,
+      int& naccept, int& ntotal);
 
-#if ENABLE_DIAGNOSTICS == 4
   /**
-   * Log file.
+   * Number of threads at the outer and inner levels when propagating
+   * \f$\theta\f$-particles.
+   *
+   * @param s State.
+   * @param[out] outer Number of \f$\theta\f$-particles propagated
+   * concurrently.
+   * @param[out] inner Number of threads for each.
    */
-  std::ofstream logFile;
-#endif
+  template<class S1>
+  void split(const S1& s, int& outer, int& inner);
 
   /**
    * Model.
@@ -220,6 +245,11 @@ private:
    */
   long tmoves;
 
+  /**
+   * Number of theta-particles to propagate concurrently.
+   */
+  int nparallel;
+
   /**
    * Start time for current step.
    */
@@ -254,27 +284,10 @@ private:
 
 template<class B, class F, class A, class R>
 bi::MarginalSIR<B,F,A,R>::MarginalSIR(B& m, F& filter, A& adapter, R& resam,
-    const int nmoves, const long tmoves) :
+    const int nmoves, const long tmoves, const int nparallel) :
     m(m), filter(filter), adapter(adapter), resam(resam), nmoves(nmoves), tmoves(
-        1e6 * tmoves), tstart(0), tmilestone(0), lastResample(false), adapterReady(
+        1e6 * tmoves), nparallel(nparallel), tstart(0), tmilestone(0), lastResample(false), adapterReady(
         false), lastAccept(0), lastTotal(0) {
-#if ENABLE_DIAGNOSTICS == 4
-#ifdef ENABLE_MPI
-  boost::mpi::communicator world;
-  const int rank = world.rank();
-  const int size = world.size();
-#else
-  const int rank = 0;
-  const int size = 1;
-#endif
-  std::stringstream buf;
-  buf << "sir.log";
-  if (size > 1) {
-    buf << "." << rank;
-  }
-  logFile.open(buf.str().c_str());
-#endif
-
   if (tmoves > 0.0) {
     this->nmoves = 1;  // one move at a time only
   }
@@ -288,21 +301,16 @@ void bi::MarginalSIR<B,F,A,R>::sample(Random& rng,
   TicToc clock;
   ScheduleIterator iter = first;
   init(rng, iter, s, out, inInit);
-  profile(INIT);
-  profile(INTERACT);
+  mpi_barrier();
+  this->clock.tic();
   interact(rng, *iter, s);
   report0(*iter, s);
   while (iter + 1 != last) {
-    profile(MOVE);
     move(rng, first, iter, last, s);
-    profile(STEP);
     step(rng, first, iter, last, s);
-    profile(READY);
-    profile(INTERACT);
     interact(rng, *iter, s);
     report(*iter, s);
   }
-  profile(MOVE);
   move(rng, first, iter, last, s);
 
   #ifdef ENABLE_MPI
@@ -314,7 +322,6 @@ void bi::MarginalSIR<B,F,A,R>::sample(Random& rng,
   #endif
 
   reportT(*iter, s);
-  profile(TERM);
   term(rng, s);
 
   s.clock = clock.toc();
@@ -325,17 +332,41 @@ template<class B, class F, class A, class R>
 template<class S1, class IO1, class IO2>
 void bi::MarginalSIR<B,F,A,R>::init(Random& rng, const ScheduleIterator first,
     S1& s, IO1& out, IO2& inInit) {
-  for (int p = 0; p < s.size(); ++p) {
-    BOOST_AUTO(&s1, *s.s1s[p]);
-    BOOST_AUTO(&out1, *s.out1s[p]);
+  int outer, inner, p;
+  split(s, outer, inner);
+
+  /* one at a time, as reads of the init file are not serialised */
+  for (p = 0; p < s.size(); ++p) {
+    filter.init(rng, *first, *s.s1s[p], *s.out1s[p], inInit);
+    filter.output0(*s.s1s[p], *s.out1s[p]);
+  }
+
+  /* each theta-particle on its own stream, whichever group runs it */
+  boost::uint64_t k = rng.getHostRng().nextStep();
+
+  #pragma omp parallel num_threads(outer) if(outer > 1)
+  {
+    if (outer > 1) {
+      bi_omp_nest(inner);
+    }
+
+    #pragma omp for schedule(static)
+    for (p = 0; p < s.size(); ++p) {
+      BOOST_AUTO(&s1, *s.s1s[p]);
+      BOOST_AUTO(&out1, *s.out1s[p]);
 
-    filter.init(rng, *first, s1, out1, inInit);
-    filter.output0(s1, out1);
-    filter.correct(rng, *first, s1);
-    filter.output(*first, s1, out1);
+      rng.getHostRng().setTaskStream(p, k);
+      filter.correct(rng, *first, s1);
+      filter.output(*first, s1, out1);
+      rng.getHostRng().unsetTaskStream();
 
-    s.logWeights()(p) = s1.logLikelihood;
-    s.ancestors()(p) = p;
+      s.logWeights()(p) = s1.logLikelihood;
+      s.ancestors()(p) = p;
+    }
+
+    if (outer > 1) {
+      bi_omp_unnest();
+    }
   }
   out.clear();
 
@@ -352,17 +383,42 @@ void bi::MarginalSIR<B,F,A,R>::step(Random& rng, const ScheduleIterator first,
   /* pre-condition */
   BI_ASSERT(s.size() > 0);
 
-  ScheduleIterator iter1;
+  ProfileScope scope(PROFILE_STEP);
+
+  int outer, inner, p;
+  split(s, outer, inner);
+
+  ScheduleIterator next;
+  boost::uint64_t k;
   do {
-    for (int p = 0; p < s.size(); ++p) {
-      BOOST_AUTO(&s1, *s.s1s[p]);
-      BOOST_AUTO(&out1, *s.out1s[p]);
+    k = rng.getHostRng().nextStep();
 
-      iter1 = iter;
-      filter.step(rng, iter1, last, s1, out1);
-      s.logWeights()(p) += s1.logIncrements(iter1->indexObs());
+    #pragma omp parallel num_threads(outer) if(outer > 1)
+    {
+      if (outer > 1) {
+        bi_omp_nest(inner);
+      }
+
+      #pragma omp for schedule(static)
+      for (p = 0; p < s.size(); ++p) {
+        BOOST_AUTO(&s1, *s.s1s[p]);
+        BOOST_AUTO(&out1, *s.out1s[p]);
+
+        ScheduleIterator iter1 = iter;
+        rng.getHostRng().setTaskStream(p, k);
+        filter.step(rng, iter1, last, s1, out1);
+        rng.getHostRng().unsetTaskStream();
+        s.logWeights()(p) += s1.logIncrements(iter1->indexObs());
+        if (p == 0) {
+          next = iter1;
+        }
+      }
+
+      if (outer > 1) {
+        bi_omp_unnest();
+      }
     }
-    iter = iter1;
+    iter = next;
   } while (iter + 1 != last && !iter->isObserved());
 #if ENABLE_DIAGNOSTICS == 3
   filter.samplePath(rng, s1, out1);
@@ -373,6 +429,13 @@ template<class B, class F, class A, class R>
 template<class S1>
 void bi::MarginalSIR<B,F,A,R>::interact(Random& rng,
     const ScheduleElement now, S1& s) {
+  if (Profiler::isEnabled()) {
+    /* so that imbalance between processes counts as waiting, not
+     * interaction */
+    mpi_barrier();
+  }
+  ProfileScope scope(PROFILE_INTERACT);
+
 #ifdef ENABLE_MPI
   /* reporting requirements */
   boost::mpi::communicator world;
@@ -398,6 +461,8 @@ template<class B, class F, class A, class R>
 template<class S1>
 void bi::MarginalSIR<B,F,A,R>::move(Random& rng, const ScheduleIterator first,
     const ScheduleIterator iter, const ScheduleIterator last, S1& s) {
+  ProfileScope scope(PROFILE_MOVE);
+
   /* compute budget */
   double t0 = first->indexObs();
   double t = iter->indexObs() - t0 + 1;
@@ -409,76 +474,65 @@ void bi::MarginalSIR<B,F,A,R>::move(Random& rng, const ScheduleIterator first,
   if (lastResample) {
     int naccept = 0;
     int ntotal = 0;
-    int j = 0;
-    int p = 0;
-    bool accept = false;
-    bool complete = (tmoves <= 0 && p >= s.size())
-        || (tmoves > 0 && clock.toc() >= tmilestone);
 
     if (tmoves > 0) {
       /* serial schedule, but random order */
+      int j = 0;
+      int p = 0;
+
       resam.shuffle(rng, s);
-    }
-    while (!complete) {
-      j = p % s.size();
-      BOOST_AUTO(&s1, *s.s1s[j]);
-      BOOST_AUTO(&out1, *s.out1s[j]);
-      BOOST_AUTO(&s2, s.s2);
-      BOOST_AUTO(&out2, s.out2);
-
-      for (int move = 0; move < nmoves; ++move) {
-        /* propose replacement */
-        try {
-          if (adapterReady) {
-            filter.propose(rng, *first, s1, s2, out2, adapter);
-          } else {
-            filter.propose(rng, *first, s1, s2, out2);
-          }
-          if (tmoves > 0) {
-            filter.filter(rng, first, iter + 1, s2, out2, clock, tmilestone);
-          } else {
-            filter.filter(rng, first, iter + 1, s2, out2);
-          }
-        } catch (CholeskyException e) {
-          s2.logLikelihood = -BI_INF;
-        } catch (ParticleFilterDegeneratedException e) {
-          s2.logLikelihood = -BI_INF;
-        }
-        if (tmoves <= 0 || clock.toc() < tmilestone) {
-          /* accept or reject */
-          if (!bi::is_finite(s2.logLikelihood)) {
-            accept = false;
-          } else if (!bi::is_finite(s1.logLikelihood)) {
-            accept = true;
-          } else {
-            double loglr = s2.logLikelihood - s1.logLikelihood;
-            double logpr = s2.logPrior - s1.logPrior;
-            double logqr = s1.logProposal - s2.logProposal;
-            double logratio = loglr + logpr + logqr;
-            double u = rng.uniform<double>();
-
-            accept = bi::log(u) < logratio;
-          }
-          if (accept) {
-  #if ENABLE_DIAGNOSTICS == 3
-            filter.samplePath(rng, s2, out2);
-  #endif
-            s1.swap(s2);
-            out1.swap(out2);
-            ++naccept;
-          }
-          ++ntotal;
-        }
+      while (clock.toc() < tmilestone) {
+        j = p % s.size();
+        moveOne(rng, first, iter, *s.s1s[j], *s.out1s[j], s.s2, s.out2,
+            naccept, ntotal);
+        ++p;
       }
-      ++p;
-      complete = (tmoves <= 0 && p >= s.size())
-          || (tmoves > 0 && clock.toc() >= tmilestone);
-    }
 
-    if (tmoves > 0) {
       /* eliminate active particle, note Resampler and DistributedResampler
        * corrects the marginal likelihood estimate correctly for this */
       s.logWeights()(j) = -BI_INF;
+    } else {
+      std::vector<int> ps;
+      bool more;
+      int outer, inner;
+      boost::uint64_t k;
+      split(s, outer, inner);
+
+      /* the resampler may give particles in turn, see
+       * DistributedResampler::next(); each move is on its own stream,
+       * whichever group runs it */
+      do {
+        more = resam.next(rng, s, ps);
+        k = rng.getHostRng().nextStep();
+        if (outer > 1) {
+          #pragma omp parallel num_threads(outer) reduction(+:naccept,ntotal)
+          {
+            bi_omp_nest(inner);
+
+            /* own scratch state and output for each group of threads */
+            BOOST_AUTO(s2, s.s2);
+            BOOST_AUTO(out2, s.out2);
+            int i;
+
+            #pragma omp for schedule(static)
+            for (i = 0; i < (int)ps.size(); ++i) {
+              rng.getHostRng().setTaskStream(i, k);
+              moveOne(rng, first, iter, *s.s1s[ps[i]], *s.out1s[ps[i]], s2,
+                  out2, naccept, ntotal);
+              rng.getHostRng().unsetTaskStream();
+            }
+
+            bi_omp_unnest();
+          }
+        } else {
+          for (int i = 0; i < (int)ps.size(); ++i) {
+            rng.getHostRng().setTaskStream(i, k);
+            moveOne(rng, first, iter, *s.s1s[ps[i]], *s.out1s[ps[i]], s.s2,
+                s.out2, naccept, ntotal);
+            rng.getHostRng().unsetTaskStream();
+          }
+        }
+      } while (more);
     }
 
     lastAccept = naccept;
@@ -541,18 +595,70 @@ void bi::MarginalSIR<B,F,A,R>::term(Random& rng, S1& s) {
 }
 
 template<class B, class F, class A, class R>
-void bi::MarginalSIR<B,F,A,R>::profile(const Step step) {
-  if (step == INIT) {
-    mpi_barrier();
-    clock.tic();
-  } else if (step == INTERACT) {
-#if ENABLE_DIAGNOSTICS == 4
-    mpi_barrier();
+template<class S2, class IO2>
+void bi::MarginalSIR<B,F,A,R>::moveOne(Random& rng,
+    const ScheduleIterator first, const ScheduleIterator iter, S2& s1,
+    IO2& out1, S2& s2, IO2& out2, int& naccept, int& ntotal) {
+  bool accept = false;
+
+  for (int move = 0; move < nmoves; ++move) {
+    /* propose replacement */
+    try {
+      if (adapterReady) {
+        filter.propose(rng, *first, s1, s2, out2, adapter);
+      } else {
+        filter.propose(rng, *first, s1, s2, out2);
+      }
+      if (tmoves > 0) {
+        filter.filter(rng, first, iter + 1, s2, out2, clock, tmilestone);
+      } else {
+        filter.filter(rng, first, iter + 1, s2, out2);
+      }
+    } catch (CholeskyException e) {
+      s2.logLikelihood = -BI_INF;
+    } catch (ParticleFilterDegeneratedException e) {
+      s2.logLikelihood = -BI_INF;
+    }
+    if (tmoves <= 0 || clock.toc() < tmilestone) {
+      /* accept or reject */
+      if (!bi::is_finite(s2.logLikelihood)) {
+        accept = false;
+      } else if (!bi::is_finite(s1.logLikelihood)) {
+        accept = true;
+      } else {
+        double loglr = s2.logLikelihood - s1.logLikelihood;
+        double logpr = s2.logPrior - s1.logPrior;
+        double logqr = s1.logProposal - s2.logProposal;
+        double logratio = loglr + logpr + logqr;
+        double u = rng.uniform<double>();
+
+        accept = bi::log(u) < logratio;
+      }
+      if (accept) {
+#if ENABLE_DIAGNOSTICS == 3
+        filter.samplePath(rng, s2, out2);
 #endif
+        s1.swap(s2);
+        out1.swap(out2);
+        ++naccept;
+      }
+      ++ntotal;
+    }
+  }
+}
+
+template<class B, class F, class A, class R>
+template<class S1>
+void bi::MarginalSIR<B,F,A,R>::split(const S1& s, int& outer, int& inner) {
+  if (nparallel == 1 || s.size() <= 1) {
+    outer = 1;
+    inner = bi_omp_max_threads;
+  } else if (nparallel > 1) {
+    /* as many outer threads as requested, regardless of grain */
+    bi_omp_split(bi::min(nparallel, s.size()), 0, outer, inner);
+  } else {
+    bi_omp_split(s.size(), s.s1s[0]->size(), outer, inner);
   }
-#if ENABLE_DIAGNOSTICS == 4
-  logFile << step << ',' << clock.toc() << std::endl;
-#endif
 }
 
 #endif
@@ -27,7 +27,7 @@ public:
    */
   template<class B, class F>
   static boost::shared_ptr<MarginalMH<B,F> > createMarginalMH(B& m,
-      F& filter);
+      F& filter, const double bound = BI_INF);
 
   /**
    * Create marginal sequential importance resampling sampler.
@@ -35,7 +35,7 @@ public:
   template<class B, class F, class A, class R>
   static boost::shared_ptr<MarginalSIR<B,F,A,R> > createMarginalSIR(B& m,
       F& mmh, A& adapter, R& resam, const int nmoves = 1,
-      const double tmoves = 0.0);
+      const double tmoves = 0.0, const int nparallel = 1);
 
   /**
    * Create marginal sequential rejection sampler.
@@ -48,17 +48,18 @@ public:
 
 template<class B, class F>
 boost::shared_ptr<bi::MarginalMH<B,F> > bi::SamplerFactory::createMarginalMH(
-    B& m, F& filter) {
+    B& m, F& filter, const double bound) {
   return boost::shared_ptr < MarginalMH<B,F>
-      > (new MarginalMH<B,F>(m, filter));
+      > (new MarginalMH<B,F>(m, filter, bound));
 }
 
 template<class B, class F, class A, class R>
 boost::shared_ptr<bi::MarginalSIR<B,F,A,R> > bi::SamplerFactory::createMarginalSIR(
     B& m, F& mmh, A& adapter, R& resam, const int nmoves,
-    const double tmoves) {
+    const double tmoves, const int nparallel) {
   return boost::shared_ptr < MarginalSIR<B,F,A,R>
-      > (new MarginalSIR<B,F,A,R>(m, mmh, adapter, resam, nmoves, tmoves));
+      > (new MarginalSIR<B,F,A,R>(m, mmh, adapter, resam, nmoves, tmoves,
+          nparallel));
 }
 
 template<class B, class F, class A, class S>
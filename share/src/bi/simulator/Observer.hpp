@@ -21,6 +21,9 @@ namespace bi {
  *
  * @tparam IO1 Input type.
  * @tparam CL Location for caches.
+ *
+ * Updates are serialised with those of Forcer, so that filters may run
+ * concurrently on separate threads (see MarginalSIR).
  */
 template<class IO1 = InputNetCDFBuffer, Location CL = ON_HOST>
 class Observer {
@@ -68,6 +71,11 @@ public:
   void clear();
 
 private:
+  /**
+   * Get mask on host, without locking.
+   */
+  const Mask<ON_HOST>& hostMask(const int k);
+
   /**
    * Input.
    */
@@ -98,33 +106,53 @@ bi::Observer<IO1,CL>::Observer(IO1& in) :
 
 template<class IO1, bi::Location CL>
 const bi::Mask<bi::ON_HOST>& bi::Observer<IO1,CL>::getHostMask(const int k) {
-  if (!maskHostCache.isValid(k)) {
-    Mask<ON_HOST> mask;
-    in.readMask(k, O_VAR, mask);
-    maskHostCache.set(k, mask);
-  }
-  return maskHostCache.get(k);
+  const Mask<ON_HOST>* mask;
+
+  /* cache entries are not moved once set, so references remain valid */
+  #pragma omp critical(bi_input)
+  mask = &hostMask(k);
+
+  return *mask;
 }
 
 template<class IO1, bi::Location CL>
 const bi::Mask<CL>& bi::Observer<IO1,CL>::getMask(const int k) {
-  if (!maskCache.isValid(k)) {
-    maskCache.set(k, getHostMask(k));
+  const Mask<CL>* mask;
+
+  #pragma omp critical(bi_input)
+  {
+    if (!maskCache.isValid(k)) {
+      maskCache.set(k, hostMask(k));
+    }
+    mask = &maskCache.get(k);
   }
-  return maskCache.get(k);
+  return *mask;
 }
 
 template<class IO1, bi::Location CL>
 template<class B, bi::Location L>
 void bi::Observer<IO1,CL>::update(const int k, State<B,L>& s) {
-  if (cache.isValid(k)) {
-    vec(s.get(OY_VAR)) = cache.get(k);
-  } else {
-    in.read(k, O_VAR, getHostMask(k), s.get(OY_VAR));
-    cache.set(k, vec(s.get(OY_VAR)));
+  #pragma omp critical(bi_input)
+  {
+    if (cache.isValid(k)) {
+      vec(s.get(OY_VAR)) = cache.get(k);
+    } else {
+      in.read(k, O_VAR, hostMask(k), s.get(OY_VAR));
+      cache.set(k, vec(s.get(OY_VAR)));
+    }
+    s.setNextObsTime(in.getTime(k));
   }
   s.get(O_VAR) = s.get(OY_VAR);
-  s.setNextObsTime(in.getTime(k));
+}
+
+template<class IO1, bi::Location CL>
+const bi::Mask<bi::ON_HOST>& bi::Observer<IO1,CL>::hostMask(const int k) {
+  if (!maskHostCache.isValid(k)) {
+    Mask<ON_HOST> mask;
+    in.readMask(k, O_VAR, mask);
+    maskHostCache.set(k, mask);
+  }
+  return maskHostCache.get(k);
 }
 
 template<class IO1, bi::Location CL>
@@ -228,6 +228,7 @@ public:
 }
 
 #include "../misc/TicToc.hpp"
+#include "../misc/Profiler.hpp"
 
 template<class B, class F, class O>
 bi::Simulator<B,F,O>::Simulator(B& m, F& in, O& obs) :
@@ -409,6 +410,7 @@ template<class B, class F, class O>
 template<class S1>
 void bi::Simulator<B,F,O>::predict(Random& rng, const ScheduleElement next,
     S1& s) {
+  ProfileScope scope(PROFILE_PREDICT);
   if (next.hasInput()) {
     in.update(next.indexInput(), s);
   }
@@ -445,6 +447,7 @@ void bi::Simulator<B,F,O>::observe(Random& rng, S1& s) {
 template<class B, class F, class O>
 template<class S1, class IO1>
 void bi::Simulator<B,F,O>::output0(const S1& s, IO1& out) {
+  ProfileScope scope(PROFILE_OUTPUT);
   out.write0(s);
 }
 
@@ -453,6 +456,7 @@ template<class S1, class IO1>
 void bi::Simulator<B,F,O>::output(const ScheduleElement now, const S1& s,
     IO1& out) {
   if (now.hasOutput()) {
+    ProfileScope scope(PROFILE_OUTPUT);
     out.write(now.indexOutput(), now.getTime(), s);
   }
 }
@@ -460,6 +464,7 @@ void bi::Simulator<B,F,O>::output(const ScheduleElement now, const S1& s,
 template<class B, class F, class O>
 template<class S1, class IO1>
 void bi::Simulator<B,F,O>::outputT(const S1& s, IO1& out) {
+  ProfileScope scope(PROFILE_OUTPUT);
   out.writeT(s);
 }
 
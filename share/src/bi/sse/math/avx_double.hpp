@@ -72,6 +72,7 @@ union avx_double {
 
   avx_double& operator=(const double& o) {
     packed = _mm256_set1_pd(o);
+    return *this;
   }
 };
 
@@ -193,7 +194,7 @@ BI_FORCE_INLINE inline avx_double operator==(const avx_double& o1,
 BI_FORCE_INLINE inline avx_double operator!=(const avx_double& o1,
     const avx_double& o2) {
   avx_double res;
-  res.packed = _mm256_cmp_pd(o1.packed, o2.packed, _CMP_NEQ_OQ);
+  res.packed = _mm256_cmp_pd(o1.packed, o2.packed, _CMP_NEQ_UQ);
   return res;
 }
 
@@ -241,20 +242,197 @@ BI_FORCE_INLINE inline avx_double abs(const avx_double x) {
   return res;
 }
 
-BI_FORCE_INLINE inline avx_double log(const avx_double x) {
-  BI_AVXDOUBLE_UNIVARIATE(log, x)
+/**
+ * Bitwise and, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline avx_double operator&(const avx_double& o1,
+    const avx_double& o2) {
+  avx_double res;
+  res.packed = _mm256_and_pd(o1.packed, o2.packed);
+  return res;
 }
 
-BI_FORCE_INLINE inline avx_double nanlog(const avx_double x) {
-  BI_AVXDOUBLE_UNIVARIATE(nanlog, x)
+/**
+ * Bitwise or, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline avx_double operator|(const avx_double& o1,
+    const avx_double& o2) {
+  avx_double res;
+  res.packed = _mm256_or_pd(o1.packed, o2.packed);
+  return res;
 }
 
+/**
+ * Select elements of @p x where @p mask is set, and of @p y elsewhere.
+ */
+BI_FORCE_INLINE inline avx_double select(const avx_double mask,
+    const avx_double x, const avx_double y) {
+  avx_double res;
+  res.packed = _mm256_blendv_pd(y.packed, x.packed, mask.packed);
+  return res;
+}
+
+/**
+ * Is any element of @p mask set?
+ */
+BI_FORCE_INLINE inline bool any(const avx_double mask) {
+  return _mm256_movemask_pd(mask.packed) != 0;
+}
+
+/**
+ * Vectorised exp(), as for sse_double. AVX has no 256-bit integer
+ * arithmetic, so the exponent is assembled in two 128-bit halves. Error
+ * <= 2 ulp.
+ */
 BI_FORCE_INLINE inline avx_double exp(const avx_double x) {
-  BI_AVXDOUBLE_UNIVARIATE(exp, x)
+  const __m256d hi = _mm256_set1_pd(709.782712893383973096);
+  const __m256d lo = _mm256_set1_pd(-745.133219101941108420);
+
+  __m256d y = _mm256_min_pd(_mm256_max_pd(x.packed, lo), hi);
+  __m128i n = _mm256_cvtpd_epi32(_mm256_mul_pd(y,
+      _mm256_set1_pd(1.4426950408889634073599)));
+  __m256d fn = _mm256_cvtepi32_pd(n);
+  __m256d r = _mm256_sub_pd(y, _mm256_mul_pd(fn,
+      _mm256_set1_pd(6.93145751953125e-1)));
+  r = _mm256_sub_pd(r, _mm256_mul_pd(fn,
+      _mm256_set1_pd(1.42860682030941723212e-6)));
+
+  __m256d xx = _mm256_mul_pd(r, r);
+  __m256d px = _mm256_mul_pd(_mm256_set1_pd(1.26177193074810590878e-4), xx);
+  px = _mm256_add_pd(px, _mm256_set1_pd(3.02994407707441961300e-2));
+  px = _mm256_mul_pd(px, xx);
+  px = _mm256_add_pd(px, _mm256_set1_pd(9.99999999999999999910e-1));
+  px = _mm256_mul_pd(px, r);
+  __m256d qx = _mm256_mul_pd(_mm256_set1_pd(3.00198505138664455042e-6), xx);
+  qx = _mm256_add_pd(qx, _mm256_set1_pd(2.52448340349684104192e-3));
+  qx = _mm256_mul_pd(qx, xx);
+  qx = _mm256_add_pd(qx, _mm256_set1_pd(2.27265548208155028766e-1));
+  qx = _mm256_mul_pd(qx, xx);
+  qx = _mm256_add_pd(qx, _mm256_set1_pd(2.00000000000000000009e0));
+  r = _mm256_div_pd(px, _mm256_sub_pd(qx, px));
+  r = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_add_pd(r, r));
+
+  /* scale by 2^n in two halves, so that neither overflows the exponent */
+  __m128i n1 = _mm_srai_epi32(n, 1);
+  __m128i n2 = _mm_sub_epi32(n, n1);
+  n1 = _mm_add_epi32(n1, _mm_set1_epi32(1023));
+  n2 = _mm_add_epi32(n2, _mm_set1_epi32(1023));
+  __m256i s1 = _mm256_insertf128_si256(_mm256_castsi128_si256(
+      _mm_slli_epi64(_mm_unpacklo_epi32(n1, n1), 52)),
+      _mm_slli_epi64(_mm_unpackhi_epi32(n1, n1), 52), 1);
+  __m256i s2 = _mm256_insertf128_si256(_mm256_castsi128_si256(
+      _mm_slli_epi64(_mm_unpacklo_epi32(n2, n2), 52)),
+      _mm_slli_epi64(_mm_unpackhi_epi32(n2, n2), 52), 1);
+  r = _mm256_mul_pd(r, _mm256_castsi256_pd(s1));
+  r = _mm256_mul_pd(r, _mm256_castsi256_pd(s2));
+
+  /* overflow, underflow and NaN */
+  r = _mm256_blendv_pd(r, _mm256_set1_pd(BI_INF), _mm256_cmp_pd(x.packed, hi,
+      _CMP_GT_OQ));
+  r = _mm256_blendv_pd(r, _mm256_setzero_pd(), _mm256_cmp_pd(x.packed, lo,
+      _CMP_LT_OQ));
+  r = _mm256_blendv_pd(r, x.packed, _mm256_cmp_pd(x.packed, x.packed,
+      _CMP_UNORD_Q));
+
+  avx_double res;
+  res.packed = r;
+  return res;
+}
+
+/**
+ * Vectorised log(), as for sse_double. Error <= 1 ulp.
+ */
+BI_FORCE_INLINE inline avx_double log(const avx_double x) {
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d inf = _mm256_set1_pd(BI_INF);
+
+  /* scale subnormals into the normal range */
+  __m256d sub = _mm256_cmp_pd(x.packed,
+      _mm256_set1_pd(2.2250738585072014e-308), _CMP_LT_OQ);
+  __m256d y = _mm256_blendv_pd(x.packed, _mm256_mul_pd(x.packed,
+      _mm256_set1_pd(18014398509481984.0)), sub);  // 2^54
+
+  /* exponent and mantissa in [1/2, 1) */
+  __m256i bits = _mm256_castpd_si256(y);
+  __m128i elo = _mm_srli_epi64(_mm256_castsi256_si128(bits), 52);
+  __m128i ehi = _mm_srli_epi64(_mm256_extractf128_si256(bits, 1), 52);
+  __m128i ei = _mm_unpacklo_epi64(_mm_shuffle_epi32(elo, _MM_SHUFFLE(3,3,2,0)),
+      _mm_shuffle_epi32(ehi, _MM_SHUFFLE(3,3,2,0)));
+  ei = _mm_sub_epi32(ei, _mm_set1_epi32(1022));
+  __m256d e = _mm256_cvtepi32_pd(ei);
+  e = _mm256_sub_pd(e, _mm256_and_pd(sub, _mm256_set1_pd(54.0)));
+  __m256d m = _mm256_and_pd(y, _mm256_castsi256_pd(
+      _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)));
+  m = _mm256_or_pd(m, _mm256_set1_pd(0.5));
+
+  __m256d lt = _mm256_cmp_pd(m, _mm256_set1_pd(0.70710678118654752440),
+      _CMP_LT_OQ);
+  e = _mm256_sub_pd(e, _mm256_and_pd(lt, one));
+  __m256d z = _mm256_add_pd(_mm256_sub_pd(m, one), _mm256_and_pd(lt, m));
+
+  __m256d zz = _mm256_mul_pd(z, z);
+  __m256d p = _mm256_mul_pd(_mm256_set1_pd(1.01875663804580931796e-4), z);
+  p = _mm256_add_pd(p, _mm256_set1_pd(4.97494994976747001425e-1));
+  p = _mm256_mul_pd(p, z);
+  p = _mm256_add_pd(p, _mm256_set1_pd(4.70579119878881725854e0));
+  p = _mm256_mul_pd(p, z);
+  p = _mm256_add_pd(p, _mm256_set1_pd(1.44989225341610930846e1));
+  p = _mm256_mul_pd(p, z);
+  p = _mm256_add_pd(p, _mm256_set1_pd(1.79368678507819816313e1));
+  p = _mm256_mul_pd(p, z);
+  p = _mm256_add_pd(p, _mm256_set1_pd(7.70838733755885391666e0));
+  __m256d q = _mm256_add_pd(z, _mm256_set1_pd(1.12873587189167450590e1));
+  q = _mm256_mul_pd(q, z);
+  q = _mm256_add_pd(q, _mm256_set1_pd(4.52279145837532221105e1));
+  q = _mm256_mul_pd(q, z);
+  q = _mm256_add_pd(q, _mm256_set1_pd(8.29875266912776603211e1));
+  q = _mm256_mul_pd(q, z);
+  q = _mm256_add_pd(q, _mm256_set1_pd(7.11544750618563894466e1));
+  q = _mm256_mul_pd(q, z);
+  q = _mm256_add_pd(q, _mm256_set1_pd(2.31251620126765340583e1));
+
+  __m256d r = _mm256_mul_pd(z, _mm256_div_pd(_mm256_mul_pd(zz, p), q));
+  r = _mm256_sub_pd(r, _mm256_mul_pd(e,
+      _mm256_set1_pd(2.121944400546905827679e-4)));
+  r = _mm256_sub_pd(r, _mm256_mul_pd(_mm256_set1_pd(0.5), zz));
+  r = _mm256_add_pd(z, r);
+  r = _mm256_add_pd(r, _mm256_mul_pd(e, _mm256_set1_pd(0.693359375)));
+
+  /* zero, negative, inf and NaN */
+  r = _mm256_blendv_pd(r, _mm256_set1_pd(-BI_INF), _mm256_cmp_pd(x.packed,
+      zero, _CMP_EQ_OQ));
+  r = _mm256_blendv_pd(r, inf, _mm256_cmp_pd(x.packed, inf, _CMP_EQ_OQ));
+  r = _mm256_or_pd(r, _mm256_cmp_pd(x.packed, zero, _CMP_NGE_UQ));
+
+  avx_double res;
+  res.packed = r;
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_double nanlog(const avx_double x) {
+  avx_double res;
+  res.packed = _mm256_cmp_pd(x.packed, x.packed, _CMP_UNORD_Q);
+  return select(res, simd_set<avx_double>(-BI_INF), bi::log(x));
 }
 
 BI_FORCE_INLINE inline avx_double nanexp(const avx_double x) {
-  BI_AVXDOUBLE_UNIVARIATE(nanexp, x)
+  avx_double res;
+  res.packed = _mm256_andnot_pd(_mm256_cmp_pd(x.packed, x.packed,
+      _CMP_UNORD_Q), bi::exp(x).packed);
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_double expm1(const avx_double x) {
+  return simd_expm1(x);
+}
+
+BI_FORCE_INLINE inline avx_double log1p(const avx_double x) {
+  return simd_log1p(x);
+}
+
+BI_FORCE_INLINE inline avx_double erf(const avx_double x) {
+  return simd_erf(x);
 }
 
 BI_FORCE_INLINE inline avx_double max(const avx_double x,
@@ -279,15 +457,15 @@ BI_FORCE_INLINE inline avx_double sqrt(const avx_double x) {
 
 BI_FORCE_INLINE inline avx_double pow(const avx_double x,
     const avx_double y) {
-  BI_AVXDOUBLE_BIVARIATE(pow, x, y)
+  return simd_pow<avx_double,double>(x, y);
 }
 
 BI_FORCE_INLINE inline avx_double pow(const avx_double x, const double y) {
-  BI_AVXDOUBLE_BIVARIATE_REAL_RIGHT(pow, x, y)
+  return simd_pow<avx_double,double>(x, simd_set<avx_double>(y));
 }
 
 BI_FORCE_INLINE inline avx_double pow(const double x, const avx_double y) {
-  BI_AVXDOUBLE_BIVARIATE_REAL_LEFT(pow, x, y)
+  return simd_pow<avx_double,double>(simd_set<avx_double>(x), y);
 }
 
 BI_FORCE_INLINE inline avx_double mod(const avx_double x,
@@ -308,7 +486,7 @@ BI_FORCE_INLINE inline avx_double gamma(const avx_double x) {
 }
 
 BI_FORCE_INLINE inline avx_double lgamma(const avx_double x) {
-  BI_AVXDOUBLE_UNIVARIATE(lgamma, x)
+  return simd_lgamma<avx_double,double>(x);
 }
 
 BI_FORCE_INLINE inline avx_double sin(const avx_double x) {
@@ -9,6 +9,7 @@
 #define BI_SSE_MATH_AVXFLOAT_HPP
 
 #include "sse_float.hpp"
+#include "avx_double.hpp"
 
 #include <immintrin.h>
 
@@ -60,6 +61,42 @@
     res.unpacked.b = bi::func(x1, x2.unpacked.b); \
     return res;
 
+/**
+ * @def BI_AVXFLOAT_WIDEN
+ *
+ * Macro for creating AVX math functions that are evaluated in double
+ * precision, four elements at a time, and rounded back to single precision.
+ */
+#define BI_AVXFLOAT_WIDEN(func, x) \
+    avx_double lo, hi; \
+    lo.packed = _mm256_cvtps_pd(x.unpacked.a.packed); \
+    hi.packed = _mm256_cvtps_pd(x.unpacked.b.packed); \
+    lo = bi::func(lo); \
+    hi = bi::func(hi); \
+    avx_float res; \
+    res.packed = _mm256_insertf128_ps(_mm256_castps128_ps256( \
+        _mm256_cvtpd_ps(lo.packed)), _mm256_cvtpd_ps(hi.packed), 1); \
+    return res;
+
+/**
+ * @def BI_AVXFLOAT_WIDEN_BIVARIATE
+ *
+ * Macro for creating AVX math functions that are evaluated in double
+ * precision, four elements at a time, and rounded back to single precision.
+ */
+#define BI_AVXFLOAT_WIDEN_BIVARIATE(func, x1, x2) \
+    avx_double lo1, hi1, lo2, hi2; \
+    lo1.packed = _mm256_cvtps_pd(x1.unpacked.a.packed); \
+    hi1.packed = _mm256_cvtps_pd(x1.unpacked.b.packed); \
+    lo2.packed = _mm256_cvtps_pd(x2.unpacked.a.packed); \
+    hi2.packed = _mm256_cvtps_pd(x2.unpacked.b.packed); \
+    lo1 = bi::func(lo1, lo2); \
+    hi1 = bi::func(hi1, hi2); \
+    avx_float res; \
+    res.packed = _mm256_insertf128_ps(_mm256_castps128_ps256( \
+        _mm256_cvtpd_ps(lo1.packed)), _mm256_cvtpd_ps(hi1.packed), 1); \
+    return res;
+
 namespace bi {
 /**
  * 256-bit SIMD vector of floats.
@@ -72,6 +109,7 @@ union avx_float {
 
   avx_float& operator=(const float& o) {
     packed = _mm256_set1_ps(o);
+    return *this;
   }
 };
 
@@ -193,7 +231,7 @@ BI_FORCE_INLINE inline avx_float operator==(const avx_float& o1,
 BI_FORCE_INLINE inline avx_float operator!=(const avx_float& o1,
     const avx_float& o2) {
   avx_float res;
-  res.packed = _mm256_cmp_ps(o1.packed, o2.packed, _CMP_NEQ_OQ);
+  res.packed = _mm256_cmp_ps(o1.packed, o2.packed, _CMP_NEQ_UQ);
   return res;
 }
 
@@ -241,20 +279,192 @@ BI_FORCE_INLINE inline avx_float abs(const avx_float x) {
   return res;
 }
 
-BI_FORCE_INLINE inline avx_float log(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(log, x)
+/**
+ * Bitwise and, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline avx_float operator&(const avx_float& o1,
+    const avx_float& o2) {
+  avx_float res;
+  res.packed = _mm256_and_ps(o1.packed, o2.packed);
+  return res;
 }
 
-BI_FORCE_INLINE inline avx_float nanlog(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(nanlog, x)
+/**
+ * Bitwise or, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline avx_float operator|(const avx_float& o1,
+    const avx_float& o2) {
+  avx_float res;
+  res.packed = _mm256_or_ps(o1.packed, o2.packed);
+  return res;
+}
+
+/**
+ * Select elements of @p x where @p mask is set, and of @p y elsewhere.
+ */
+BI_FORCE_INLINE inline avx_float select(const avx_float mask,
+    const avx_float x, const avx_float y) {
+  avx_float res;
+  res.packed = _mm256_blendv_ps(y.packed, x.packed, mask.packed);
+  return res;
 }
 
+/**
+ * Is any element of @p mask set?
+ */
+BI_FORCE_INLINE inline bool any(const avx_float mask) {
+  return _mm256_movemask_ps(mask.packed) != 0;
+}
+
+/**
+ * Vectorised exp(), as for sse_float. AVX has no 256-bit integer
+ * arithmetic, so the exponent is assembled in two 128-bit halves. Error
+ * <= 1 ulp.
+ */
 BI_FORCE_INLINE inline avx_float exp(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(exp, x)
+  const __m256 hi = _mm256_set1_ps(88.7228391f);
+  const __m256 lo = _mm256_set1_ps(-103.972084f);
+
+  __m256 y = _mm256_min_ps(_mm256_max_ps(x.packed, lo), hi);
+  __m256i n = _mm256_cvtps_epi32(_mm256_mul_ps(y,
+      _mm256_set1_ps(1.44269504088896341f)));
+  __m256 fn = _mm256_cvtepi32_ps(n);
+  __m256 r = _mm256_sub_ps(y, _mm256_mul_ps(fn, _mm256_set1_ps(0.693359375f)));
+  r = _mm256_sub_ps(r, _mm256_mul_ps(fn, _mm256_set1_ps(-2.12194440e-4f)));
+
+  __m256 z = _mm256_mul_ps(r, r);
+  __m256 p = _mm256_mul_ps(_mm256_set1_ps(1.9875691500e-4f), r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_mul_ps(p, r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_mul_ps(p, r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_mul_ps(p, r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_mul_ps(p, r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.0f));
+
+  /* scale by 2^n in two halves, so that neither overflows the exponent */
+  __m128i nlo = _mm256_castsi256_si128(n);
+  __m128i nhi = _mm256_extractf128_si256(n, 1);
+  __m128i n1lo = _mm_srai_epi32(nlo, 1), n1hi = _mm_srai_epi32(nhi, 1);
+  __m128i n2lo = _mm_sub_epi32(nlo, n1lo), n2hi = _mm_sub_epi32(nhi, n1hi);
+  const __m128i bias = _mm_set1_epi32(127);
+  n1lo = _mm_slli_epi32(_mm_add_epi32(n1lo, bias), 23);
+  n1hi = _mm_slli_epi32(_mm_add_epi32(n1hi, bias), 23);
+  n2lo = _mm_slli_epi32(_mm_add_epi32(n2lo, bias), 23);
+  n2hi = _mm_slli_epi32(_mm_add_epi32(n2hi, bias), 23);
+  p = _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_insertf128_si256(
+      _mm256_castsi128_si256(n1lo), n1hi, 1)));
+  p = _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_insertf128_si256(
+      _mm256_castsi128_si256(n2lo), n2hi, 1)));
+
+  /* overflow, underflow and NaN */
+  p = _mm256_blendv_ps(p, _mm256_set1_ps(BI_INF), _mm256_cmp_ps(x.packed, hi,
+      _CMP_GT_OQ));
+  p = _mm256_blendv_ps(p, _mm256_setzero_ps(), _mm256_cmp_ps(x.packed, lo,
+      _CMP_LT_OQ));
+  p = _mm256_blendv_ps(p, x.packed, _mm256_cmp_ps(x.packed, x.packed,
+      _CMP_UNORD_Q));
+
+  avx_float res;
+  res.packed = p;
+  return res;
+}
+
+/**
+ * Vectorised log(), as for sse_float. Error <= 1 ulp.
+ */
+BI_FORCE_INLINE inline avx_float log(const avx_float x) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 inf = _mm256_set1_ps(BI_INF);
+
+  /* scale subnormals into the normal range */
+  __m256 sub = _mm256_cmp_ps(x.packed, _mm256_set1_ps(1.17549435e-38f),
+      _CMP_LT_OQ);
+  __m256 y = _mm256_blendv_ps(x.packed, _mm256_mul_ps(x.packed,
+      _mm256_set1_ps(33554432.0f)), sub);  // 2^25
+
+  /* exponent and mantissa in [1/2, 1) */
+  __m256i bits = _mm256_castps_si256(y);
+  __m128i elo = _mm_srli_epi32(_mm256_castsi256_si128(bits), 23);
+  __m128i ehi = _mm_srli_epi32(_mm256_extractf128_si256(bits, 1), 23);
+  elo = _mm_sub_epi32(elo, _mm_set1_epi32(126));
+  ehi = _mm_sub_epi32(ehi, _mm_set1_epi32(126));
+  __m256 e = _mm256_cvtepi32_ps(_mm256_insertf128_si256(
+      _mm256_castsi128_si256(elo), ehi, 1));
+  e = _mm256_sub_ps(e, _mm256_and_ps(sub, _mm256_set1_ps(25.0f)));
+  __m256 m = _mm256_and_ps(y, _mm256_castsi256_ps(
+      _mm256_set1_epi32(0x007FFFFF)));
+  m = _mm256_or_ps(m, _mm256_set1_ps(0.5f));
+
+  __m256 lt = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f),
+      _CMP_LT_OQ);
+  e = _mm256_sub_ps(e, _mm256_and_ps(lt, one));
+  __m256 z = _mm256_add_ps(_mm256_sub_ps(m, one), _mm256_and_ps(lt, m));
+
+  __m256 zz = _mm256_mul_ps(z, z);
+  __m256 p = _mm256_mul_ps(_mm256_set1_ps(7.0376836292e-2f), z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(-1.1514610310e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.1676998740e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(-1.2420140846e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.4249322787e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(-1.6668057665e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(2.0000714765e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(-2.4999993993e-1f));
+  p = _mm256_mul_ps(p, z);
+  p = _mm256_add_ps(p, _mm256_set1_ps(3.3333331174e-1f));
+  p = _mm256_mul_ps(_mm256_mul_ps(p, z), zz);
+
+  p = _mm256_add_ps(p, _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f)));
+  p = _mm256_sub_ps(p, _mm256_mul_ps(_mm256_set1_ps(0.5f), zz));
+  p = _mm256_add_ps(z, p);
+  p = _mm256_add_ps(p, _mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)));
+
+  /* zero, negative, inf and NaN */
+  p = _mm256_blendv_ps(p, _mm256_set1_ps(-BI_INF), _mm256_cmp_ps(x.packed,
+      zero, _CMP_EQ_OQ));
+  p = _mm256_blendv_ps(p, inf, _mm256_cmp_ps(x.packed, inf, _CMP_EQ_OQ));
+  p = _mm256_or_ps(p, _mm256_cmp_ps(x.packed, zero, _CMP_NGE_UQ));
+
+  avx_float res;
+  res.packed = p;
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_float nanlog(const avx_float x) {
+  avx_float res;
+  res.packed = _mm256_cmp_ps(x.packed, x.packed, _CMP_UNORD_Q);
+  return select(res, simd_set<avx_float>(-BI_INF), bi::log(x));
 }
 
 BI_FORCE_INLINE inline avx_float nanexp(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(nanexp, x)
+  avx_float res;
+  res.packed = _mm256_andnot_ps(_mm256_cmp_ps(x.packed, x.packed,
+      _CMP_UNORD_Q), bi::exp(x).packed);
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_float expm1(const avx_float x) {
+  BI_AVXFLOAT_WIDEN(expm1, x)
+}
+
+BI_FORCE_INLINE inline avx_float log1p(const avx_float x) {
+  BI_AVXFLOAT_WIDEN(log1p, x)
+}
+
+BI_FORCE_INLINE inline avx_float erf(const avx_float x) {
+  BI_AVXFLOAT_WIDEN(erf, x)
 }
 
 BI_FORCE_INLINE inline avx_float max(const avx_float x, const avx_float y) {
@@ -275,16 +485,17 @@ BI_FORCE_INLINE inline avx_float sqrt(const avx_float x) {
   return res;
 }
 
-BI_FORCE_INLINE inline avx_float pow(const avx_float x, const avx_float y) {
-  BI_AVXFLOAT_BIVARIATE(pow, x, y)
+BI_FORCE_INLINE inline avx_float pow(const avx_float x,
+    const avx_float y) {
+  BI_AVXFLOAT_WIDEN_BIVARIATE(pow, x, y)
 }
 
 BI_FORCE_INLINE inline avx_float pow(const avx_float x, const float y) {
-  BI_AVXFLOAT_BIVARIATE_REAL_RIGHT(pow, x, y)
+  return bi::pow(x, simd_set<avx_float>(y));
 }
 
 BI_FORCE_INLINE inline avx_float pow(const float x, const avx_float y) {
-  BI_AVXFLOAT_BIVARIATE_REAL_LEFT(pow, x, y)
+  return bi::pow(simd_set<avx_float>(x), y);
 }
 
 BI_FORCE_INLINE inline avx_float mod(const avx_float x, const avx_float y) {
@@ -304,7 +515,7 @@ BI_FORCE_INLINE inline avx_float gamma(const avx_float x) {
 }
 
 BI_FORCE_INLINE inline avx_float lgamma(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(lgamma, x)
+  BI_AVXFLOAT_WIDEN(lgamma, x)
 }
 
 BI_FORCE_INLINE inline avx_float sin(const avx_float x) {
@@ -0,0 +1,248 @@
+/**
+ * @file
+ *
+ * Vectorised transcendental functions shared by the double-precision SIMD
+ * types.
+ *
+ * These are written once in terms of the arithmetic operators, comparisons,
+ * select(), any(), exp() and log() of each SIMD type, and instantiated by
+ * the per-type wrappers in sse_double.hpp and avx_double.hpp. The
+ * single-precision types evaluate them in double precision and round.
+ *
+ * Error bounds, as measured against libm by the test_simd client:
+ *
+ * @li expm1: <= 4 ulp.
+ * @li log1p: <= 2 ulp.
+ * @li pow: <= 2 + 1.5|y log x| ulp for x > 0; other lanes use libm.
+ * @li lgamma: <= 4 ulp for x >= 10, the worst just above 10, and <= 3 ulp
+ * for x >= 11; absolute error < 1e-13 for 0 < x < 10, which covers its
+ * zeros at 1 and 2; x <= 0 lanes use libm.
+ * @li erf: <= 3 ulp.
+ *
+ * The single-precision versions are within 1 ulp, except lgamma, which is
+ * within 8 ulp.
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_SSE_MATH_SIMDFUNCTION_HPP
+#define BI_SSE_MATH_SIMDFUNCTION_HPP
+
+#include "../../math/function.hpp"
+#include "../../math/constant.hpp"
+
+namespace bi {
+/**
+ * Set all lanes of a SIMD vector.
+ */
+template<class V, class T>
+inline V simd_set(const T x) {
+  V res;
+  res = x;
+  return res;
+}
+
+/**
+ * Apply a scalar function to those lanes of @p x where @p mask is set,
+ * leaving the other lanes of @p res intact. Used for domains that the
+ * vectorised kernels do not cover.
+ */
+template<class V, class T>
+inline void simd_fallback(const V mask, const V x, V& res, T (*f)(const T)) {
+  const int N = sizeof(V)/sizeof(T);
+  const T* m = reinterpret_cast<const T*>(&mask);
+  const T* xs = reinterpret_cast<const T*>(&x);
+  T* rs = reinterpret_cast<T*>(&res);
+  for (int i = 0; i < N; ++i) {
+    if (m[i] != 0) {  // all bits set is NaN, so compare against zero
+      rs[i] = f(xs[i]);
+    }
+  }
+}
+
+/**
+ * Bivariate version of simd_fallback().
+ */
+template<class V, class T>
+inline void simd_fallback(const V mask, const V x, const V y, V& res,
+    T (*f)(const T, const T)) {
+  const int N = sizeof(V)/sizeof(T);
+  const T* m = reinterpret_cast<const T*>(&mask);
+  const T* xs = reinterpret_cast<const T*>(&x);
+  const T* ys = reinterpret_cast<const T*>(&y);
+  T* rs = reinterpret_cast<T*>(&res);
+  for (int i = 0; i < N; ++i) {
+    if (m[i] != 0) {
+      rs[i] = f(xs[i], ys[i]);
+    }
+  }
+}
+
+/**
+ * Vectorised exp(x) - 1.
+ *
+ * Uses the Pade form of exp() for |x| < 1/2, avoiding cancellation, and
+ * exp() elsewhere.
+ */
+template<class V>
+inline V simd_expm1(const V x) {
+  const V half = simd_set<V>(0.5);
+  const V ax = abs(x);
+  const V small = ax < half;
+
+  V xx = x*x;
+  V px = x*((1.26177193074810590878e-4*xx + 3.02994407707441961300e-2)*xx
+      + 9.99999999999999999910e-1);
+  V qx = ((3.00198505138664455042e-6*xx + 2.52448340349684104192e-3)*xx
+      + 2.27265548208155028766e-1)*xx + 2.00000000000000000009e0;
+  V rs = 2.0*px/(qx - px);
+
+  if (!any(ax >= half)) {
+    return rs;
+  } else {
+    return select(small, rs, exp(x) - 1.0);
+  }
+}
+
+/**
+ * Vectorised log(1 + x).
+ *
+ * Computes log(u)*x/(u - 1) with u = 1 + x, which corrects for the
+ * rounding error in u.
+ */
+template<class V>
+inline V simd_log1p(const V x) {
+  const V one = simd_set<V>(1.0);
+  const V inf = simd_set<V>(BI_INF);
+
+  V u = one + x;
+  V d = u - one;
+  V res = log(u)*(x/d);
+  res = select(d == simd_set<V>(0.0), x, res);
+  res = select(x == inf, inf, res);
+  return res;
+}
+
+/**
+ * Vectorised pow(x, y), for x > 0, as exp(y*log(x)).
+ *
+ * The rounding error of the product y*log(x), which exp() turns into a
+ * relative error of up to |y log x|/2 ulp, is recovered exactly by Dekker's
+ * splitting and applied to the result as a first-order correction, leaving
+ * only the error of log() to grow with |y log x|.
+ */
+template<class V, class T>
+inline V simd_pow(const V x, const V y) {
+  const V zero = simd_set<V>(0.0);
+  const V inf = simd_set<V>(BI_INF);
+  const V split = simd_set<V>(134217729.0);  // 2^27 + 1
+
+  V l = log(x);
+  V p = y*l;
+  V t = split*y;
+  V yh = t - (t - y), yl = y - yh;
+  t = split*l;
+  V lh = t - (t - l), ll = l - lh;
+  V e = ((yh*lh - p) + yh*ll + yl*lh) + yl*ll;
+
+  /* no correction where the result overflows, or the split itself does */
+  V res = exp(p);
+  V de = res*e;
+  res = select(abs(de) < inf, res + de, res);
+
+  /* zero, negative, non-finite or NaN x or y, and the exact cases x == 1 and
+   * y == 0, which must ignore NaN in the other argument */
+  V special = (x <= zero) | (x >= inf) | (abs(y) >= inf) | (x != x) |
+      (y != y) | (x == simd_set<V>(1.0)) | (y == zero);
+  if (any(special)) {
+    simd_fallback<V,T>(special, x, y, res, &bi::pow);
+  }
+  return res;
+}
+
+/**
+ * Vectorised lgamma(x), for x > 0.
+ *
+ * Shifts the argument to z >= 10 with the recurrence
+ * lgamma(x) = lgamma(x + n) - log(x(x + 1)...(x + n - 1)), then uses the
+ * Stirling series to the x^-15 term.
+ */
+template<class V, class T>
+inline V simd_lgamma(const V x) {
+  const V zero = simd_set<V>(0.0);
+  const V ten = simd_set<V>(10.0);
+  const V special = (x <= zero) | (x >= simd_set<V>(BI_INF)) | (x != x);
+
+  V z = select(special, ten, x), p = simd_set<V>(1.0), lt = z < ten;
+  while (any(lt)) {
+    p = select(lt, p*z, p);
+    z = select(lt, z + 1.0, z);
+    lt = z < ten;
+  }
+
+  V w = 1.0/z;
+  V w2 = w*w;
+  V s = w*(8.33333333333333333333e-2 + w2*(-2.77777777777777777778e-3 +
+      w2*(7.93650793650793650794e-4 + w2*(-5.95238095238095238095e-4 +
+      w2*(8.41750841750841750842e-4 + w2*(-1.91752691752691752692e-3 +
+      w2*(6.41025641025641025641e-3 + w2*-2.95506535947712418301e-2)))))));
+  /* (z - 0.5)(log z - 1) rather than z(log z - 1) - 0.5 log z, as the
+   * error of log z, which dominates, is then scaled by z - 0.5 once */
+  V lz = log(z);
+  V res = (z - 0.5)*(lz - 1.0) + (BI_HALF_LOG_TWO_PI - 0.5 + s) - log(p);
+
+  if (any(special)) {
+    simd_fallback<V,T>(special, x, res, &bi::lgamma);
+  }
+  return res;
+}
+
+/**
+ * Vectorised erf(x).
+ *
+ * Uses the rational approximations of Cephes: x*T(x^2)/U(x^2) for |x| < 1,
+ * and 1 - exp(-x^2)*P(|x|)/Q(|x|) otherwise.
+ */
+template<class V>
+inline V simd_erf(const V x) {
+  const V one = simd_set<V>(1.0);
+  V ax = abs(x);
+  V small = ax < one;
+  V res;
+
+  /* |x| < 1 */
+  V z = x*x;
+  V t = (((9.60497373987051638749e0*z + 9.00260197203842689217e1)*z +
+      2.23200534594684319226e3)*z + 7.00332514112805075473e3)*z +
+      5.55923013010394962768e4;
+  V u = ((((z + 3.35617141647503099647e1)*z + 5.21357949780152679795e2)*z +
+      4.59432382970980127987e3)*z + 2.26290000613890934246e4)*z +
+      4.92673942608635921086e4;
+  V rs = x*t/u;
+
+  if (!any(ax >= one)) {
+    res = rs;
+  } else {
+    /* |x| >= 1, erfc(|x|) < 1e-29 beyond 8 so clamp there */
+    V a = min(ax, simd_set<V>(8.0));
+    V p = (((((((2.46196981473530512524e-10*a + 5.64189564831068821977e-1)*a
+        + 7.46321056442269912687e0)*a + 4.86371970985681366614e1)*a +
+        1.96520832956077098242e2)*a + 5.26445194995477358631e2)*a +
+        9.34528527171957607540e2)*a + 1.02755188689515710272e3)*a +
+        5.57535335369399327526e2;
+    V q = (((((((a + 1.32281951154744992508e1)*a + 8.67072140885989742329e1)*a
+        + 3.54937778887819891062e2)*a + 9.75708501743205489753e2)*a +
+        1.82390916687909736289e3)*a + 2.24633760818710981792e3)*a +
+        1.65666309194161350182e3)*a + 5.57535340817727675546e2;
+    V rl = one - exp(-a*a)*p/q;
+    rl = select(x < simd_set<V>(0.0), -rl, rl);
+    res = select(small, rs, rl);
+    res = select(x != x, x, res);
+  }
+  return res;
+}
+
+}
+
+#endif
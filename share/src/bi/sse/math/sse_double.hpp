@@ -8,7 +8,9 @@
 #ifndef BI_SSE_MATH_SSEDOUBLE_HPP
 #define BI_SSE_MATH_SSEDOUBLE_HPP
 
+#include "simd_function.hpp"
 #include "../../math/scalar.hpp"
+#include "../../math/constant.hpp"
 #include "../../misc/compile.hpp"
 
 #include <pmmintrin.h>
@@ -243,20 +245,188 @@ BI_FORCE_INLINE inline sse_double abs(const sse_double x) {
   return res;
 }
 
-BI_FORCE_INLINE inline sse_double log(const sse_double x) {
-  BI_SSEDOUBLE_UNIVARIATE(log, x)
+/**
+ * Bitwise and, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline sse_double operator&(const sse_double& o1,
+    const sse_double& o2) {
+  sse_double res;
+  res.packed = _mm_and_pd(o1.packed, o2.packed);
+  return res;
 }
 
-BI_FORCE_INLINE inline sse_double nanlog(const sse_double x) {
-  BI_SSEDOUBLE_UNIVARIATE(nanlog, x)
+/**
+ * Bitwise or, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline sse_double operator|(const sse_double& o1,
+    const sse_double& o2) {
+  sse_double res;
+  res.packed = _mm_or_pd(o1.packed, o2.packed);
+  return res;
 }
 
+/**
+ * Select elements of @p x where @p mask is set, and of @p y elsewhere.
+ */
+BI_FORCE_INLINE inline sse_double select(const sse_double mask,
+    const sse_double x, const sse_double y) {
+  sse_double res;
+  res.packed = _mm_or_pd(_mm_and_pd(mask.packed, x.packed),
+      _mm_andnot_pd(mask.packed, y.packed));
+  return res;
+}
+
+/**
+ * Is any element of @p mask set?
+ */
+BI_FORCE_INLINE inline bool any(const sse_double mask) {
+  return _mm_movemask_pd(mask.packed) != 0;
+}
+
+/**
+ * Vectorised exp(), using the Cephes Pade approximation after reduction
+ * to |r| <= ln(2)/2. Error <= 2 ulp.
+ */
 BI_FORCE_INLINE inline sse_double exp(const sse_double x) {
-  BI_SSEDOUBLE_UNIVARIATE(exp, x)
+  const __m128d hi = _mm_set1_pd(709.782712893383973096);
+  const __m128d lo = _mm_set1_pd(-745.133219101941108420);
+
+  __m128d y = _mm_min_pd(_mm_max_pd(x.packed, lo), hi);
+  __m128i n = _mm_cvtpd_epi32(_mm_mul_pd(y, _mm_set1_pd(1.4426950408889634073599)));
+  __m128d fn = _mm_cvtepi32_pd(n);
+  __m128d r = _mm_sub_pd(y, _mm_mul_pd(fn, _mm_set1_pd(6.93145751953125e-1)));
+  r = _mm_sub_pd(r, _mm_mul_pd(fn, _mm_set1_pd(1.42860682030941723212e-6)));
+
+  __m128d xx = _mm_mul_pd(r, r);
+  __m128d px = _mm_mul_pd(_mm_set1_pd(1.26177193074810590878e-4), xx);
+  px = _mm_add_pd(px, _mm_set1_pd(3.02994407707441961300e-2));
+  px = _mm_mul_pd(px, xx);
+  px = _mm_add_pd(px, _mm_set1_pd(9.99999999999999999910e-1));
+  px = _mm_mul_pd(px, r);
+  __m128d qx = _mm_mul_pd(_mm_set1_pd(3.00198505138664455042e-6), xx);
+  qx = _mm_add_pd(qx, _mm_set1_pd(2.52448340349684104192e-3));
+  qx = _mm_mul_pd(qx, xx);
+  qx = _mm_add_pd(qx, _mm_set1_pd(2.27265548208155028766e-1));
+  qx = _mm_mul_pd(qx, xx);
+  qx = _mm_add_pd(qx, _mm_set1_pd(2.00000000000000000009e0));
+  r = _mm_div_pd(px, _mm_sub_pd(qx, px));
+  r = _mm_add_pd(_mm_set1_pd(1.0), _mm_add_pd(r, r));
+
+  /* scale by 2^n in two halves, so that neither overflows the exponent; the
+   * shift discards the upper 32 bits of each 64-bit lane */
+  __m128i n1 = _mm_srai_epi32(n, 1);
+  __m128i n2 = _mm_sub_epi32(n, n1);
+  n1 = _mm_add_epi32(n1, _mm_set1_epi32(1023));
+  n2 = _mm_add_epi32(n2, _mm_set1_epi32(1023));
+  n1 = _mm_slli_epi64(_mm_unpacklo_epi32(n1, n1), 52);
+  n2 = _mm_slli_epi64(_mm_unpacklo_epi32(n2, n2), 52);
+  r = _mm_mul_pd(r, _mm_castsi128_pd(n1));
+  r = _mm_mul_pd(r, _mm_castsi128_pd(n2));
+
+  /* overflow, underflow and NaN */
+  r = _mm_or_pd(_mm_andnot_pd(_mm_cmpgt_pd(x.packed, hi), r),
+      _mm_and_pd(_mm_cmpgt_pd(x.packed, hi), _mm_set1_pd(BI_INF)));
+  r = _mm_andnot_pd(_mm_cmplt_pd(x.packed, lo), r);
+  r = _mm_or_pd(r, _mm_and_pd(_mm_cmpunord_pd(x.packed, x.packed), x.packed));
+
+  sse_double res;
+  res.packed = r;
+  return res;
+}
+
+/**
+ * Vectorised log(), using the Cephes rational approximation after reduction
+ * of the mantissa to [sqrt(1/2), sqrt(2)). Error <= 1 ulp.
+ */
+BI_FORCE_INLINE inline sse_double log(const sse_double x) {
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d tiny = _mm_set1_pd(2.2250738585072014e-308);
+
+  /* scale subnormals into the normal range */
+  __m128d sub = _mm_cmplt_pd(x.packed, tiny);
+  __m128d y = _mm_or_pd(_mm_andnot_pd(sub, x.packed), _mm_and_pd(sub,
+      _mm_mul_pd(x.packed, _mm_set1_pd(18014398509481984.0))));  // 2^54
+
+  /* exponent and mantissa in [1/2, 1) */
+  __m128i bits = _mm_castpd_si128(y);
+  __m128i ei = _mm_srli_epi64(bits, 52);
+  ei = _mm_sub_epi32(_mm_shuffle_epi32(ei, _MM_SHUFFLE(3,3,2,0)),
+      _mm_set1_epi32(1022));
+  __m128d e = _mm_cvtepi32_pd(ei);
+  e = _mm_sub_pd(e, _mm_and_pd(sub, _mm_set1_pd(54.0)));
+  __m128d m = _mm_and_pd(y, _mm_castsi128_pd(_mm_set1_epi64x(0x000FFFFFFFFFFFFFLL)));
+  m = _mm_or_pd(m, _mm_set1_pd(0.5));
+
+  __m128d lt = _mm_cmplt_pd(m, _mm_set1_pd(0.70710678118654752440));
+  e = _mm_sub_pd(e, _mm_and_pd(lt, one));
+  __m128d z = _mm_add_pd(_mm_sub_pd(m, one), _mm_and_pd(lt, m));
+
+  __m128d zz = _mm_mul_pd(z, z);
+  __m128d p = _mm_mul_pd(_mm_set1_pd(1.01875663804580931796e-4), z);
+  p = _mm_add_pd(p, _mm_set1_pd(4.97494994976747001425e-1));
+  p = _mm_mul_pd(p, z);
+  p = _mm_add_pd(p, _mm_set1_pd(4.70579119878881725854e0));
+  p = _mm_mul_pd(p, z);
+  p = _mm_add_pd(p, _mm_set1_pd(1.44989225341610930846e1));
+  p = _mm_mul_pd(p, z);
+  p = _mm_add_pd(p, _mm_set1_pd(1.79368678507819816313e1));
+  p = _mm_mul_pd(p, z);
+  p = _mm_add_pd(p, _mm_set1_pd(7.70838733755885391666e0));
+  __m128d q = _mm_add_pd(z, _mm_set1_pd(1.12873587189167450590e1));
+  q = _mm_mul_pd(q, z);
+  q = _mm_add_pd(q, _mm_set1_pd(4.52279145837532221105e1));
+  q = _mm_mul_pd(q, z);
+  q = _mm_add_pd(q, _mm_set1_pd(8.29875266912776603211e1));
+  q = _mm_mul_pd(q, z);
+  q = _mm_add_pd(q, _mm_set1_pd(7.11544750618563894466e1));
+  q = _mm_mul_pd(q, z);
+  q = _mm_add_pd(q, _mm_set1_pd(2.31251620126765340583e1));
+
+  __m128d r = _mm_mul_pd(z, _mm_div_pd(_mm_mul_pd(zz, p), q));
+  r = _mm_sub_pd(r, _mm_mul_pd(e, _mm_set1_pd(2.121944400546905827679e-4)));
+  r = _mm_sub_pd(r, _mm_mul_pd(_mm_set1_pd(0.5), zz));
+  r = _mm_add_pd(z, r);
+  r = _mm_add_pd(r, _mm_mul_pd(e, _mm_set1_pd(0.693359375)));
+
+  /* zero, negative, inf and NaN */
+  __m128d inf = _mm_set1_pd(BI_INF);
+  __m128d zero = _mm_setzero_pd();
+  __m128d eq0 = _mm_cmpeq_pd(x.packed, zero);
+  __m128d isinf = _mm_cmpeq_pd(x.packed, inf);
+  __m128d nan = _mm_or_pd(_mm_cmplt_pd(x.packed, zero),
+      _mm_cmpunord_pd(x.packed, x.packed));
+  r = _mm_or_pd(_mm_andnot_pd(_mm_or_pd(eq0, isinf), r),
+      _mm_or_pd(_mm_and_pd(eq0, _mm_set1_pd(-BI_INF)), _mm_and_pd(isinf, inf)));
+  r = _mm_or_pd(r, nan);
+
+  sse_double res;
+  res.packed = r;
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_double nanlog(const sse_double x) {
+  sse_double res;
+  res.packed = _mm_cmpunord_pd(x.packed, x.packed);
+  return select(res, simd_set<sse_double>(-BI_INF), bi::log(x));
 }
 
 BI_FORCE_INLINE inline sse_double nanexp(const sse_double x) {
-  BI_SSEDOUBLE_UNIVARIATE(nanexp, x)
+  sse_double res;
+  res.packed = _mm_andnot_pd(_mm_cmpunord_pd(x.packed, x.packed),
+      bi::exp(x).packed);
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_double expm1(const sse_double x) {
+  return simd_expm1(x);
+}
+
+BI_FORCE_INLINE inline sse_double log1p(const sse_double x) {
+  return simd_log1p(x);
+}
+
+BI_FORCE_INLINE inline sse_double erf(const sse_double x) {
+  return simd_erf(x);
 }
 
 BI_FORCE_INLINE inline sse_double max(const sse_double x,
@@ -281,15 +451,15 @@ BI_FORCE_INLINE inline sse_double sqrt(const sse_double x) {
 
 BI_FORCE_INLINE inline sse_double pow(const sse_double x,
     const sse_double y) {
-  BI_SSEDOUBLE_BIVARIATE(pow, x, y)
+  return simd_pow<sse_double,double>(x, y);
 }
 
 BI_FORCE_INLINE inline sse_double pow(const sse_double x, const double y) {
-  BI_SSEDOUBLE_BIVARIATE_REAL_RIGHT(pow, x, y)
+  return simd_pow<sse_double,double>(x, simd_set<sse_double>(y));
 }
 
 BI_FORCE_INLINE inline sse_double pow(const double x, const sse_double y) {
-  BI_SSEDOUBLE_BIVARIATE_REAL_LEFT(pow, x, y)
+  return simd_pow<sse_double,double>(simd_set<sse_double>(x), y);
 }
 
 BI_FORCE_INLINE inline sse_double mod(const sse_double x,
@@ -310,7 +480,7 @@ BI_FORCE_INLINE inline sse_double gamma(const sse_double x) {
 }
 
 BI_FORCE_INLINE inline sse_double lgamma(const sse_double x) {
-  BI_SSEDOUBLE_UNIVARIATE(lgamma, x)
+  return simd_lgamma<sse_double,double>(x);
 }
 
 BI_FORCE_INLINE inline sse_double sin(const sse_double x) {
@@ -8,7 +8,9 @@
 #ifndef BI_SSE_MATH_SSEFLOAT_HPP
 #define BI_SSE_MATH_SSEFLOAT_HPP
 
+#include "sse_double.hpp"
 #include "../../math/scalar.hpp"
+#include "../../math/constant.hpp"
 #include "../../misc/compile.hpp"
 
 #include <pmmintrin.h>
@@ -69,6 +71,42 @@
     res.unpacked.d = bi::func(x1, x2.unpacked.d); \
     return res;
 
+/**
+ * @def BI_SSEFLOAT_WIDEN
+ *
+ * Macro for creating SSE math functions that are evaluated in double
+ * precision, two elements at a time, and rounded back to single precision.
+ */
+#define BI_SSEFLOAT_WIDEN(func, x) \
+    sse_double lo, hi; \
+    lo.packed = _mm_cvtps_pd(x.packed); \
+    hi.packed = _mm_cvtps_pd(_mm_movehl_ps(x.packed, x.packed)); \
+    lo = bi::func(lo); \
+    hi = bi::func(hi); \
+    sse_float res; \
+    res.packed = _mm_movelh_ps(_mm_cvtpd_ps(lo.packed), \
+        _mm_cvtpd_ps(hi.packed)); \
+    return res;
+
+/**
+ * @def BI_SSEFLOAT_WIDEN_BIVARIATE
+ *
+ * Macro for creating SSE math functions that are evaluated in double
+ * precision, two elements at a time, and rounded back to single precision.
+ */
+#define BI_SSEFLOAT_WIDEN_BIVARIATE(func, x1, x2) \
+    sse_double lo1, hi1, lo2, hi2; \
+    lo1.packed = _mm_cvtps_pd(x1.packed); \
+    hi1.packed = _mm_cvtps_pd(_mm_movehl_ps(x1.packed, x1.packed)); \
+    lo2.packed = _mm_cvtps_pd(x2.packed); \
+    hi2.packed = _mm_cvtps_pd(_mm_movehl_ps(x2.packed, x2.packed)); \
+    lo1 = bi::func(lo1, lo2); \
+    hi1 = bi::func(hi1, hi2); \
+    sse_float res; \
+    res.packed = _mm_movelh_ps(_mm_cvtpd_ps(lo1.packed), \
+        _mm_cvtpd_ps(hi1.packed)); \
+    return res;
+
 namespace bi {
 /**
  * 128-bit SIMD vector of floats.
@@ -147,7 +185,7 @@ BI_FORCE_INLINE inline sse_float operator+(const float& o1,
 BI_FORCE_INLINE inline sse_float operator-(const float& o1,
     const sse_float& o2) {
   sse_float res;
-  res.packed = _mm_add_ps(_mm_set1_ps(o1), o2.packed);
+  res.packed = _mm_sub_ps(_mm_set1_ps(o1), o2.packed);
   return res;
 }
 
@@ -251,20 +289,178 @@ BI_FORCE_INLINE inline sse_float abs(const sse_float x) {
   return res;
 }
 
-BI_FORCE_INLINE inline sse_float log(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(log, x)
+/**
+ * Bitwise and, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline sse_float operator&(const sse_float& o1,
+    const sse_float& o2) {
+  sse_float res;
+  res.packed = _mm_and_ps(o1.packed, o2.packed);
+  return res;
 }
 
-BI_FORCE_INLINE inline sse_float nanlog(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(nanlog, x)
+/**
+ * Bitwise or, for combining masks from comparisons.
+ */
+BI_FORCE_INLINE inline sse_float operator|(const sse_float& o1,
+    const sse_float& o2) {
+  sse_float res;
+  res.packed = _mm_or_ps(o1.packed, o2.packed);
+  return res;
+}
+
+/**
+ * Select elements of @p x where @p mask is set, and of @p y elsewhere.
+ */
+BI_FORCE_INLINE inline sse_float select(const sse_float mask,
+    const sse_float x, const sse_float y) {
+  sse_float res;
+  res.packed = _mm_or_ps(_mm_and_ps(mask.packed, x.packed),
+      _mm_andnot_ps(mask.packed, y.packed));
+  return res;
+}
+
+/**
+ * Is any element of @p mask set?
+ */
+BI_FORCE_INLINE inline bool any(const sse_float mask) {
+  return _mm_movemask_ps(mask.packed) != 0;
 }
 
+/**
+ * Vectorised exp(), using the Cephes polynomial after reduction to
+ * |r| <= ln(2)/2. Error <= 1 ulp.
+ */
 BI_FORCE_INLINE inline sse_float exp(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(exp, x)
+  const __m128 hi = _mm_set1_ps(88.7228391f);
+  const __m128 lo = _mm_set1_ps(-103.972084f);
+
+  __m128 y = _mm_min_ps(_mm_max_ps(x.packed, lo), hi);
+  __m128i n = _mm_cvtps_epi32(_mm_mul_ps(y, _mm_set1_ps(1.44269504088896341f)));
+  __m128 fn = _mm_cvtepi32_ps(n);
+  __m128 r = _mm_sub_ps(y, _mm_mul_ps(fn, _mm_set1_ps(0.693359375f)));
+  r = _mm_sub_ps(r, _mm_mul_ps(fn, _mm_set1_ps(-2.12194440e-4f)));
+
+  __m128 z = _mm_mul_ps(r, r);
+  __m128 p = _mm_mul_ps(_mm_set1_ps(1.9875691500e-4f), r);
+  p = _mm_add_ps(p, _mm_set1_ps(1.3981999507e-3f));
+  p = _mm_mul_ps(p, r);
+  p = _mm_add_ps(p, _mm_set1_ps(8.3334519073e-3f));
+  p = _mm_mul_ps(p, r);
+  p = _mm_add_ps(p, _mm_set1_ps(4.1665795894e-2f));
+  p = _mm_mul_ps(p, r);
+  p = _mm_add_ps(p, _mm_set1_ps(1.6666665459e-1f));
+  p = _mm_mul_ps(p, r);
+  p = _mm_add_ps(p, _mm_set1_ps(5.0000001201e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, r);
+  p = _mm_add_ps(p, _mm_set1_ps(1.0f));
+
+  /* scale by 2^n in two halves, so that neither overflows the exponent */
+  __m128i n1 = _mm_srai_epi32(n, 1);
+  __m128i n2 = _mm_sub_epi32(n, n1);
+  n1 = _mm_slli_epi32(_mm_add_epi32(n1, _mm_set1_epi32(127)), 23);
+  n2 = _mm_slli_epi32(_mm_add_epi32(n2, _mm_set1_epi32(127)), 23);
+  p = _mm_mul_ps(p, _mm_castsi128_ps(n1));
+  p = _mm_mul_ps(p, _mm_castsi128_ps(n2));
+
+  /* overflow, underflow and NaN */
+  __m128 over = _mm_cmpgt_ps(x.packed, hi);
+  p = _mm_or_ps(_mm_andnot_ps(over, p), _mm_and_ps(over,
+      _mm_set1_ps(BI_INF)));
+  p = _mm_andnot_ps(_mm_cmplt_ps(x.packed, lo), p);
+  p = _mm_or_ps(p, _mm_and_ps(_mm_cmpunord_ps(x.packed, x.packed), x.packed));
+
+  sse_float res;
+  res.packed = p;
+  return res;
+}
+
+/**
+ * Vectorised log(), using the Cephes polynomial after reduction of the
+ * mantissa to [sqrt(1/2), sqrt(2)). Error <= 1 ulp.
+ */
+BI_FORCE_INLINE inline sse_float log(const sse_float x) {
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  /* scale subnormals into the normal range */
+  __m128 sub = _mm_cmplt_ps(x.packed, _mm_set1_ps(1.17549435e-38f));
+  __m128 y = _mm_or_ps(_mm_andnot_ps(sub, x.packed), _mm_and_ps(sub,
+      _mm_mul_ps(x.packed, _mm_set1_ps(33554432.0f))));  // 2^25
+
+  /* exponent and mantissa in [1/2, 1) */
+  __m128i ei = _mm_srli_epi32(_mm_castps_si128(y), 23);
+  ei = _mm_sub_epi32(ei, _mm_set1_epi32(126));
+  __m128 e = _mm_cvtepi32_ps(ei);
+  e = _mm_sub_ps(e, _mm_and_ps(sub, _mm_set1_ps(25.0f)));
+  __m128 m = _mm_and_ps(y, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF)));
+  m = _mm_or_ps(m, _mm_set1_ps(0.5f));
+
+  __m128 lt = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+  e = _mm_sub_ps(e, _mm_and_ps(lt, one));
+  __m128 z = _mm_add_ps(_mm_sub_ps(m, one), _mm_and_ps(lt, m));
+
+  __m128 zz = _mm_mul_ps(z, z);
+  __m128 p = _mm_mul_ps(_mm_set1_ps(7.0376836292e-2f), z);
+  p = _mm_add_ps(p, _mm_set1_ps(-1.1514610310e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, _mm_set1_ps(1.1676998740e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, _mm_set1_ps(-1.2420140846e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, _mm_set1_ps(1.4249322787e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, _mm_set1_ps(-1.6668057665e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, _mm_set1_ps(2.0000714765e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, _mm_set1_ps(-2.4999993993e-1f));
+  p = _mm_mul_ps(p, z);
+  p = _mm_add_ps(p, _mm_set1_ps(3.3333331174e-1f));
+  p = _mm_mul_ps(_mm_mul_ps(p, z), zz);
+
+  p = _mm_add_ps(p, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+  p = _mm_sub_ps(p, _mm_mul_ps(_mm_set1_ps(0.5f), zz));
+  p = _mm_add_ps(z, p);
+  p = _mm_add_ps(p, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+
+  /* zero, negative, inf and NaN */
+  __m128 inf = _mm_set1_ps(BI_INF);
+  __m128 zero = _mm_setzero_ps();
+  __m128 eq0 = _mm_cmpeq_ps(x.packed, zero);
+  __m128 isinf = _mm_cmpeq_ps(x.packed, inf);
+  p = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(eq0, isinf), p),
+      _mm_or_ps(_mm_and_ps(eq0, _mm_set1_ps(-BI_INF)), _mm_and_ps(isinf, inf)));
+  p = _mm_or_ps(p, _mm_cmpnge_ps(x.packed, zero));
+
+  sse_float res;
+  res.packed = p;
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_float nanlog(const sse_float x) {
+  sse_float res;
+  res.packed = _mm_cmpunord_ps(x.packed, x.packed);
+  return select(res, simd_set<sse_float>(-BI_INF), bi::log(x));
 }
 
 BI_FORCE_INLINE inline sse_float nanexp(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(nanexp, x)
+  sse_float res;
+  res.packed = _mm_andnot_ps(_mm_cmpunord_ps(x.packed, x.packed),
+      bi::exp(x).packed);
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_float expm1(const sse_float x) {
+  BI_SSEFLOAT_WIDEN(expm1, x)
+}
+
+BI_FORCE_INLINE inline sse_float log1p(const sse_float x) {
+  BI_SSEFLOAT_WIDEN(log1p, x)
+}
+
+BI_FORCE_INLINE inline sse_float erf(const sse_float x) {
+  BI_SSEFLOAT_WIDEN(erf, x)
 }
 
 BI_FORCE_INLINE inline sse_float max(const sse_float x, const sse_float y) {
@@ -286,15 +482,15 @@ BI_FORCE_INLINE inline sse_float sqrt(const sse_float x) {
 }
 
 BI_FORCE_INLINE inline sse_float pow(const sse_float x, const sse_float y) {
-  BI_SSEFLOAT_BIVARIATE(pow, x, y)
+  BI_SSEFLOAT_WIDEN_BIVARIATE(pow, x, y)
 }
 
 BI_FORCE_INLINE inline sse_float pow(const sse_float x, const float y) {
-  BI_SSEFLOAT_BIVARIATE_REAL_RIGHT(pow, x, y)
+  return bi::pow(x, simd_set<sse_float>(y));
 }
 
 BI_FORCE_INLINE inline sse_float pow(const float x, const sse_float y) {
-  BI_SSEFLOAT_BIVARIATE_REAL_LEFT(pow, x, y)
+  return bi::pow(simd_set<sse_float>(x), y);
 }
 
 BI_FORCE_INLINE inline sse_float mod(const sse_float x, const sse_float y) {
@@ -314,7 +510,7 @@ BI_FORCE_INLINE inline sse_float gamma(const sse_float x) {
 }
 
 BI_FORCE_INLINE inline sse_float lgamma(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(lgamma, x)
+  BI_SSEFLOAT_WIDEN(lgamma, x)
 }
 
 BI_FORCE_INLINE inline sse_float sin(const sse_float x) {
@@ -11,6 +11,11 @@
 namespace bi {
 /**
  * @copydoc DOPRI5Integrator
+ *
+ * Each lane of a SIMD pack keeps its own time and step size, and accepts or
+ * rejects its own steps, so that one stiff trajectory does not force small
+ * steps on the others in its pack. The pack is finished when all of its
+ * lanes are.
  */
 template<class B, class S, class T1>
 class DOPRI5IntegratorSSE {
@@ -28,6 +33,7 @@ public:
 #include "../../state/Pa.hpp"
 #include "../../typelist/front.hpp"
 #include "../../typelist/pop_front.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 template<class B, class S, class T1>
 void bi::DOPRI5IntegratorSSE<B,S,T1>::update(const T1 t1, const T1 t2,
@@ -37,96 +43,123 @@ void bi::DOPRI5IntegratorSSE<B,S,T1>::update(const T1 t1, const T1 t2,
 
   typedef typename temp_host_vector<simd_real>::type vector_type;
   typedef Pa<ON_HOST,B,host,host,sse_host,sse_host> PX;
-  typedef DOPRI5VisitorHost<B,S,S,real,PX,simd_real> Visitor;
+  typedef DOPRI5VisitorHost<B,S,S,simd_real,PX,simd_real> Visitor;
   static const int N = block_size<S>::value;
   const int P = s.size();
 
+  /* schedule packs of particles, not particles */
+  ParticleScheduler sched((P + BI_SIMD_SIZE - 1)/BI_SIMD_SIZE);
+
   #pragma omp parallel
   {
     vector_type x0(N), x1(N), x2(N), x3(N), x4(N), x5(N), x6(N), err(N), k1(
         N), k7(N);
-    simd_real e, e2;
-    real t, h, logfacold, logfac11, fac, e2max;
-    int n, id, p;
+    simd_real t, h, hs, end, e, e2, logfacold, logfac11, fac, zero, one,
+        eps, facl, facr, active, acc;
+    int n, id, p, first, last;
     bool k1in;
     PX pax;
-
-    #pragma omp for
-    for (p = 0; p < P; p += BI_SIMD_SIZE) {
-      t = t1;
-      h = h_h0;
-      logfacold = bi::log(BI_REAL(1.0e-4));
-      k1in = false;
-      n = 0;
-      sse_host_load<B,S>(s, p, x0);
-
-      /* integrate */
-      while (t < t2 && n < h_nsteps) {
-        if (BI_REAL(0.1)*bi::abs(h) <= bi::abs(t)*h_uround) {
-          // step size too small
-        }
-        if (t + BI_REAL(1.01)*h - t2 > BI_REAL(0.0)) {
-          h = t2 - t;
-          if (h <= BI_REAL(0.0)) {
-            t = t2;
-            break;
+    #ifdef ENABLE_AOSOA
+    /* contiguous copy of the particles being integrated */
+    State<B,ON_HOST> tile(BI_SIMD_SIZE);
+    tile.loadCommons(s);
+    #endif
+
+    end = t2;
+    zero = BI_REAL(0.0);
+    one = BI_REAL(1.0);
+    eps = BI_REAL(1.0e-8);
+    facl = h_facl;
+    facr = h_facr;
+
+    while (sched.next(first, last)) {
+      for (p = first*BI_SIMD_SIZE; p < last*BI_SIMD_SIZE;
+          p += BI_SIMD_SIZE) {
+        #ifdef ENABLE_AOSOA
+        tile.loadTile(s, p);
+        State<B,ON_HOST>& s1 = tile;
+        const int p1 = 0;
+        #else
+        State<B,ON_HOST>& s1 = s;
+        const int p1 = p;
+        #endif
+
+        t = t1;
+        h = h_h0;
+        logfacold = bi::log(BI_REAL(1.0e-4));
+        k1in = false;
+        n = 0;
+        sse_host_load<B,S>(s1, p1, x0);
+        active = t < end;
+
+        /* integrate, each lane with its own time and step size */
+        while (bi::any(active) && n < h_nsteps) {
+          h = bi::select(t + BI_REAL(1.01)*h > end, end - t, h);
+          t = bi::select(h <= zero, end, t);
+          active = t < end;
+
+          /* lanes that have finished take steps of zero size, which leave
+           * them unchanged */
+          hs = bi::select(active, h, zero);
+
+          /* stages */
+          Visitor::stage1(t, hs, s1, p1, pax, x0.buf(), x1.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), k1.buf(), err.buf(), k1in);
+          k1in = true; // can reuse from previous iteration in future
+          sse_host_store<B,S>(s1, p1, x1);
+
+          Visitor::stage2(t, hs, s1, p1, pax, x0.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
+          sse_host_store<B,S>(s1, p1, x2);
+
+          Visitor::stage3(t, hs, s1, p1, pax, x0.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
+          sse_host_store<B,S>(s1, p1, x3);
+
+          Visitor::stage4(t, hs, s1, p1, pax, x0.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
+          sse_host_store<B,S>(s1, p1, x4);
+
+          Visitor::stage5(t, hs, s1, p1, pax, x0.buf(), x5.buf(), x6.buf(), err.buf());
+          sse_host_store<B,S>(s1, p1, x5);
+
+          Visitor::stage6(t, hs, s1, p1, pax, x0.buf(), x6.buf(), err.buf());
+
+          /* compute error */
+          Visitor::stageErr(t, hs, s1, p1, pax, x0.buf(), x6.buf(), k7.buf(), err.buf());
+
+          /* error of each trajectory */
+          e2 = zero;
+          for (id = 0; id < N; ++id) {
+            e = err(id)*hs/(bi::max(bi::abs(x0(id)), bi::abs(x6(id)))*h_rtoler + h_atoler);
+            e2 += e*e;
           }
-        }
-
-        /* stages */
-        Visitor::stage1(t, h, s, p, pax, x0.buf(), x1.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), k1.buf(), err.buf(), k1in);
-        k1in = true; // can reuse from previous iteration in future
-        sse_host_store<B,S>(s, p, x1);
-
-        Visitor::stage2(t, h, s, p, pax, x0.buf(), x2.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
-        sse_host_store<B,S>(s, p, x2);
-
-        Visitor::stage3(t, h, s, p, pax, x0.buf(), x3.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
-        sse_host_store<B,S>(s, p, x3);
-
-        Visitor::stage4(t, h, s, p, pax, x0.buf(), x4.buf(), x5.buf(), x6.buf(), err.buf());
-        sse_host_store<B,S>(s, p, x4);
-
-        Visitor::stage5(t, h, s, p, pax, x0.buf(), x5.buf(), x6.buf(), err.buf());
-        sse_host_store<B,S>(s, p, x5);
-
-        Visitor::stage6(t, h, s, p, pax, x0.buf(), x6.buf(), err.buf());
-
-        /* compute error */
-        Visitor::stageErr(t, h, s, p, pax, x0.buf(), x6.buf(), k7.buf(), err.buf());
-
-        /* determine largest error among trajectories */
-        e2 = BI_REAL(0.0);
-        for (id = 0; id < N; ++id) {
-          e = err[id]*h/(bi::max(bi::abs(x0(id)), bi::abs(x6(id)))*h_rtoler + h_atoler);
-          e2 += e*e;
-        }
-
-        e2max = bi::max_reduce(e2)/N;
-        if (e2max <= BI_REAL(1.0)) {
-          /* accept */
-          t += h;
-          x0.swap(x6);
-          k1.swap(k7);
-        }
-        sse_host_store<B,S>(s, p, x0);
-
-        /* compute next step size */
-        if (t < t2) {
-          logfac11 = h_expo*bi::log(e2max);
-          if (e2max > BI_REAL(1.0)) {
-            /* step was rejected */
-            h *= bi::max(h_facl, bi::exp(h_logsafe - logfac11));
-          } else {
-            /* step was accepted */
-            fac = bi::exp(h_beta*logfacold + h_logsafe - logfac11); // Lund-stabilization
-            fac = bi::min(h_facr, bi::max(h_facl, fac)); // bound
-            h *= fac;
-            logfacold = BI_REAL(0.5)*bi::log(bi::max(e2max, BI_REAL(1.0e-8)));
+          e2 = e2/BI_REAL(N);
+
+          /* accept or reject, lane by lane */
+          acc = active & (e2 <= one);
+          t = bi::select(acc, t + hs, t);
+          for (id = 0; id < N; ++id) {
+            x0(id) = bi::select(acc, x6(id), x0(id));
+            k1(id) = bi::select(acc, k7(id), k1(id));
           }
+          sse_host_store<B,S>(s1, p1, x0);
+
+          /* compute next step size, for lanes still integrating */
+          active = t < end;
+          logfac11 = h_expo*bi::log(e2);
+          fac = bi::exp(h_beta*logfacold + h_logsafe - logfac11); // Lund-stabilization
+          fac = bi::select(acc, bi::min(facr, bi::max(facl, fac)), // bound
+              bi::max(facl, bi::exp(h_logsafe - logfac11)));
+          h = bi::select(active, h*fac, h);
+          logfacold = bi::select(acc & active,
+              BI_REAL(0.5)*bi::log(bi::max(e2, eps)),
+              logfacold);
+
+          ++n;
         }
 
-        ++n;
+        #ifdef ENABLE_AOSOA
+        /* write back only the variables updated */
+        sse_host_load<B,S>(tile, 0, x0);
+        sse_host_store<B,S>(s, p, x0);
+        #endif
       }
     }
   }
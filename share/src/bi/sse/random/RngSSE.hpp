@@ -0,0 +1,174 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_SSE_RANDOM_RNGSSE_HPP
+#define BI_SSE_RANDOM_RNGSSE_HPP
+
+#include "../math/scalar.hpp"
+#include "../../host/random/RngHost.hpp"
+
+namespace bi {
+/**
+ * Vectorised variates for SSE and AVX code.
+ *
+ * @ingroup math_rng
+ *
+ * Wraps a host random number generator for the sample functions of
+ * actions, in place of RngHost, when a pack of particles is sampled at
+ * once (see StaticSamplerSSE and DynamicSamplerSSE). Each function fills
+ * all lanes of a simd_real from the raw 32-bit output of the host
+ * generator, then transforms them with the vectorised exp(), log() and
+ * sqrt() of the SIMD types. Parameters are given per lane. When the host
+ * generator is set to the stream of the first particle in the pack (see
+ * RngHost::setStream), results do not depend on the number of threads.
+ */
+class RngSSE {
+public:
+  /**
+   * Variate type.
+   */
+  typedef simd_real value_type;
+
+  /**
+   * Constructor.
+   *
+   * @param rng Host random number generator.
+   */
+  RngSSE(RngHost& rng);
+
+  /**
+   * Uniform variates on the open interval (0,1).
+   */
+  simd_real uniform();
+
+  /**
+   * Uniform variates on the open interval (@p lower, @p upper).
+   */
+  simd_real uniform(const simd_real lower, const simd_real upper);
+
+  /**
+   * Standard Gaussian variates, by the Box-Muller transform.
+   */
+  simd_real gaussian();
+
+  /**
+   * Gaussian variates with means @p mu and standard deviations @p sigma.
+   */
+  simd_real gaussian(const simd_real mu, const simd_real sigma);
+
+  /**
+   * Gamma variates with shapes @p alpha and scales @p beta, by the method
+   * of @ref Marsaglia2000 "Marsaglia & Tsang (2000)", rejecting and
+   * redrawing lanes until all are accepted.
+   *
+   * @section RngSSE_references References
+   *
+   * @anchor Marsaglia2000 Marsaglia, G. and Tsang, W. W. A simple method
+   * for generating gamma variables. <i>ACM Transactions on Mathematical
+   * Software</i>, <b>2000</b>, 26, 363-372.
+   */
+  simd_real gamma(const simd_real alpha, const simd_real beta);
+
+private:
+  /**
+   * Uniform variate on the open interval (0,1), using 24 bits of
+   * randomness in single precision and 53 bits in double.
+   */
+  real uniform01();
+
+  /**
+   * Host random number generator.
+   */
+  RngHost& rng;
+};
+}
+
+inline bi::RngSSE::RngSSE(RngHost& rng) : rng(rng) {
+  //
+}
+
+inline real bi::RngSSE::uniform01() {
+  #ifdef ENABLE_SINGLE
+  return ((rng.rng() >> 8) + 0.5f)*(1.0f/16777216.0f);
+  #else
+  double a = rng.rng() >> 5, b = rng.rng() >> 6;
+  return (a*67108864.0 + b + 0.5)*(1.0/9007199254740992.0);
+  #endif
+}
+
+inline bi::simd_real bi::RngSSE::uniform() {
+  simd_real u;
+  real* us = reinterpret_cast<real*>(&u);
+  for (int i = 0; i < BI_SIMD_SIZE; ++i) {
+    us[i] = uniform01();
+  }
+  return u;
+}
+
+inline bi::simd_real bi::RngSSE::uniform(const simd_real lower,
+    const simd_real upper) {
+  return lower + (upper - lower)*uniform();
+}
+
+inline bi::simd_real bi::RngSSE::gaussian() {
+  /* each pair of lanes shares a radius, one lane taking the cosine and the
+   * other the sine of the angle */
+  const int N = BI_SIMD_SIZE;
+  simd_real u, t;
+  real* us = reinterpret_cast<real*>(&u);
+  real* ts = reinterpret_cast<real*>(&t);
+  real theta;
+  int i;
+
+  for (i = 0; i < N/2; ++i) {
+    us[i] = uniform01();
+    us[N/2 + i] = us[i];
+    theta = BI_REAL(BI_TWO_PI)*uniform01();
+    ts[i] = bi::cos(theta);
+    ts[N/2 + i] = bi::sin(theta);
+  }
+  return sqrt(BI_REAL(-2.0)*log(u))*t;
+}
+
+inline bi::simd_real bi::RngSSE::gaussian(const simd_real mu,
+    const simd_real sigma) {
+  return mu + sigma*gaussian();
+}
+
+inline bi::simd_real bi::RngSSE::gamma(const simd_real alpha,
+    const simd_real beta) {
+  simd_real zero, one, small, a, d, c, x, v, u, ok, left, res;
+  zero = BI_REAL(0.0);
+  one = BI_REAL(1.0);
+
+  /* shapes below one are boosted by one, and the variate later scaled by
+   * u^(1/alpha) */
+  small = alpha < one;
+  a = select(small, alpha + one, alpha);
+  d = a - BI_REAL(1.0/3.0);
+  c = BI_REAL(1.0)/sqrt(BI_REAL(9.0)*d);
+
+  res = zero;
+  left = one;
+  do {
+    x = gaussian();
+    v = one + c*x;
+    v = select(v > zero, v*v*v, one);
+    u = uniform();
+    ok = (one + c*x > zero) & (left > zero) &
+        (log(u) < BI_REAL(0.5)*x*x + d - d*v + d*log(v));
+    res = select(ok, d*v, res);
+    left = select(ok, zero, left);
+  } while (any(left > zero));
+
+  if (any(small)) {
+    res = select(small, res*pow(uniform(), one/alpha), res);
+  }
+  return beta*res;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_SSE_UPDATER_DYNAMICSAMPLERSSE_HPP
+#define BI_SSE_UPDATER_DYNAMICSAMPLERSSE_HPP
+
+#include "../../random/Random.hpp"
+#include "../../state/State.hpp"
+
+namespace bi {
+/**
+ * Dynamic sampler, using SSE instructions.
+ *
+ * @ingroup method_updater
+ *
+ * @tparam B Model type.
+ * @tparam S Action type list.
+ *
+ * @see StaticSamplerSSE
+ */
+template<class B, class S>
+class DynamicSamplerSSE {
+public:
+  /**
+   * @copydoc DynamicSampler::samples()
+   */
+  template<class T1>
+  static void samples(Random& rng, const T1 t1, const T1 t2,
+      State<B,ON_HOST>& s);
+};
+}
+
+#include "../sse_host.hpp"
+#include "../random/RngSSE.hpp"
+#include "../../host/updater/DynamicSamplerVisitorHost.hpp"
+#include "../../state/Pa.hpp"
+#include "../../state/Ou.hpp"
+#include "../../misc/ParticleScheduler.hpp"
+
+template<class B, class S>
+template<class T1>
+void bi::DynamicSamplerSSE<B,S>::samples(Random& rng, const T1 t1,
+    const T1 t2, State<B,ON_HOST>& s) {
+  typedef Pa<ON_HOST,B,host,host,sse_host,sse_host> PX;
+  typedef Ou<ON_HOST,B,sse_host> OX;
+  typedef DynamicSamplerVisitorHost<B,S,RngSSE,PX,OX> Visitor;
+
+  const boost::uint64_t k = rng.getHostRng().nextStep();
+
+  /* schedule packs of particles, not particles */
+  ParticleScheduler sched((s.size() + BI_SIMD_SIZE - 1)/BI_SIMD_SIZE);
+
+  #pragma omp parallel
+  {
+    PX pax;
+    OX x;
+    RngHost& rng1 = rng.getHostRng();
+    RngSSE rng2(rng1);
+    int p, first, last;
+
+    while (sched.next(first, last)) {
+      for (p = first*BI_SIMD_SIZE; p < last*BI_SIMD_SIZE; p += BI_SIMD_SIZE) {
+        rng1.setStream(p, k);
+        Visitor::accept(rng2, t1, t2, s, p, pax, x);
+      }
+    }
+    rng1.unsetStream();
+  }
+}
+
+#endif
@@ -37,6 +37,7 @@ public:
 #include "../../state/Pa.hpp"
 #include "../../state/Ou.hpp"
 #include "../../traits/block_traits.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 template<class B, class S>
 template<class V1>
@@ -49,17 +50,21 @@ void bi::SparseStaticLogDensitySSE<B,S>::logDensities(State<B,ON_HOST>& s,
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  /* schedule packs of particles, not particles */
+  ParticleScheduler sched((s.size() + BI_SIMD_SIZE - 1)/BI_SIMD_SIZE);
+
   #pragma omp parallel
   {
-    int p;
+    int p, first, last;
     PX pax;
     OX x;
     simd_real* lp1;
 
-    #pragma omp for
-    for (p = 0; p < s.size(); p += BI_SIMD_SIZE) {
-      lp1 = reinterpret_cast<simd_real*>(&lp(p));
-      Visitor::accept(mask, s, p, pax, x, *lp1);
+    while (sched.next(first, last)) {
+      for (p = first*BI_SIMD_SIZE; p < last*BI_SIMD_SIZE; p += BI_SIMD_SIZE) {
+        lp1 = reinterpret_cast<simd_real*>(&lp(p));
+        Visitor::accept(mask, s, p, pax, x, *lp1);
+      }
     }
   }
 }
@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_SSE_UPDATER_STATICSAMPLERSSE_HPP
+#define BI_SSE_UPDATER_STATICSAMPLERSSE_HPP
+
+#include "../../random/Random.hpp"
+#include "../../state/State.hpp"
+
+namespace bi {
+/**
+ * Static sampler, using SSE instructions.
+ *
+ * @ingroup method_updater
+ *
+ * @tparam B Model type.
+ * @tparam S Action type list.
+ *
+ * Samples a pack of particles at once, with RngSSE. Each pack draws from
+ * the particle stream of its first particle, so that results differ from
+ * those of StaticSamplerHost, but not with the number of threads.
+ */
+template<class B, class S>
+class StaticSamplerSSE {
+public:
+  /**
+   * @copydoc StaticSampler::samples(Random&, State<B,ON_HOST>&)
+   */
+  static void samples(Random& rng, State<B,ON_HOST>& s);
+};
+}
+
+#include "../sse_host.hpp"
+#include "../random/RngSSE.hpp"
+#include "../../host/updater/StaticSamplerVisitorHost.hpp"
+#include "../../state/Pa.hpp"
+#include "../../state/Ou.hpp"
+#include "../../misc/ParticleScheduler.hpp"
+
+template<class B, class S>
+void bi::StaticSamplerSSE<B,S>::samples(Random& rng, State<B,ON_HOST>& s) {
+  typedef Pa<ON_HOST,B,host,host,sse_host,sse_host> PX;
+  typedef Ou<ON_HOST,B,sse_host> OX;
+  typedef StaticSamplerVisitorHost<B,S,RngSSE,PX,OX> Visitor;
+
+  const boost::uint64_t k = rng.getHostRng().nextStep();
+
+  /* schedule packs of particles, not particles */
+  ParticleScheduler sched((s.size() + BI_SIMD_SIZE - 1)/BI_SIMD_SIZE);
+
+#pragma omp parallel
+  {
+    PX pax;
+    OX x;
+    RngHost& rng1 = rng.getHostRng();
+    RngSSE rng2(rng1);
+    int p, first, last;
+
+    while (sched.next(first, last)) {
+      for (p = first*BI_SIMD_SIZE; p < last*BI_SIMD_SIZE; p += BI_SIMD_SIZE) {
+        rng1.setStream(p, k);
+        Visitor::accept(rng2, s, p, pax, x);
+      }
+    }
+    rng1.unsetStream();
+  }
+}
+
+#endif
@@ -32,6 +32,7 @@ public:
 #include "../../state/Pa.hpp"
 #include "../../state/Ou.hpp"
 #include "../../traits/block_traits.hpp"
+#include "../../misc/ParticleScheduler.hpp"
 
 template<class B, class S>
 void bi::StaticUpdaterSSE<B,S>::update(State<B,ON_HOST>& s) {
@@ -42,15 +43,19 @@ void bi::StaticUpdaterSSE<B,S>::update(State<B,ON_HOST>& s) {
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  /* schedule packs of particles, not particles */
+  ParticleScheduler sched((s.size() + BI_SIMD_SIZE - 1)/BI_SIMD_SIZE);
+
 #pragma omp parallel
   {
-    int p;
+    int p, first, last;
     PX pax;
     OX x;
 
-#pragma omp for
-    for (p = 0; p < s.size(); p += BI_SIMD_SIZE) {
-      Visitor::accept(s, p, pax, x);
+    while (sched.next(first, last)) {
+      for (p = first*BI_SIMD_SIZE; p < last*BI_SIMD_SIZE; p += BI_SIMD_SIZE) {
+        Visitor::accept(s, p, pax, x);
+      }
     }
   }
 }
@@ -84,7 +84,7 @@ public:
    * @tparam V1 Vector type.
    *
    * @param now Current step in time schedule.
-   * @param as Ancestry.
+   * @param as Ancestry, permuted (see State::gather()).
    */
   template<class V1>
   void gather(const ScheduleElement now, const V1 as);
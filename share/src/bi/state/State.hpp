@@ -188,15 +188,42 @@ public:
   vector_reference_type select(const int p);
 
   /**
-   * Gather particles.
+   * Gather particles, in place.
    *
    * @tparam V1 Vector type.
    *
-   * @param as Ancestry.
+   * @param as Ancestry, permuted so that each particle with offspring is
+   * its own ancestor (see Resampler::ancestorsPermute()).
    */
   template<class V1>
   void gather(const V1 as);
 
+  /**
+   * Load the common and built-in variables of a tile from another state.
+   *
+   * @param o Source state.
+   *
+   * Call once before a sequence of #loadTile, while the common and
+   * built-in variables of @p o do not change.
+   */
+  void loadCommons(const State<B,L>& o);
+
+  /**
+   * Load a tile of particles from another state.
+   *
+   * @param o Source state.
+   * @param p Index of the first particle of the tile, relative to the start
+   * of the active range of @p o.
+   *
+   * Copies the r-, d- and dx-vars of particles @p p to
+   * <tt>p + size() - 1</tt> of @p o into the active range of this state.
+   * The alternative buffers are not copied. This state is usually
+   * constructed with the width of a SIMD register, so that all variables of
+   * the tile are contiguous and aligned. There is no inverse: the user of
+   * the tile writes back only those variables that it updates.
+   */
+  void loadTile(const State<B,L>& o, const int p);
+
   /**
    * @name Built-in variables
    */
@@ -907,7 +934,24 @@ typename bi::State<B,L>::vector_reference_type bi::State<B,L>::select(
 template<class B, bi::Location L>
 template<class V1>
 void bi::State<B,L>::gather(const V1 as) {
-  bi::gather_rows(as, getDyn(), getDyn());
+  bi::gather_rows_permuted(as, getDyn());
+}
+
+template<class B, bi::Location L>
+inline void bi::State<B,L>::loadCommons(const State<B,L>& o) {
+  Kdn = o.Kdn;
+  for (int i = 0; i < NB; ++i) {
+    builtin[i] = o.builtin[i];
+  }
+}
+
+template<class B, bi::Location L>
+inline void bi::State<B,L>::loadTile(const State<B,L>& o, const int p) {
+  /* pre-condition */
+  BI_ASSERT(p >= 0 && p + P <= o.P);
+
+  subrange(Xdn.ref(), this->p, P, 0, NR + ND + NDX) = subrange(o.Xdn.ref(),
+      o.p + p, P, 0, NR + ND + NDX);
 }
 
 template<class B, bi::Location L>
@@ -8,6 +8,8 @@
 #ifndef BI_TRAITS_ACTION_TRAITS_HPP
 #define BI_TRAITS_ACTION_TRAITS_HPP
 
+#include "var_traits.hpp"
+
 namespace bi {
 /**
  * Size of action.
@@ -33,6 +35,34 @@ struct action_is_matrix {
   static const int value = A::IS_MATRIX;
 };
 
+/**
+ * Number of particle-invariant terms of action, per element, evaluated once
+ * by its @c commons() function and shared across all particles by its
+ * log-density function. Zero if the action has no such terms.
+ *
+ * @ingroup model_low
+ *
+ * @tparam A Action type.
+ */
+template<class A>
+struct action_common_size {
+  static const int value = A::NCOMMON;
+};
+
+/**
+ * Can action sample a pack of particles at once, with RngSSE? Only element
+ * actions with a per-particle target.
+ *
+ * @ingroup model_low
+ *
+ * @tparam A Action type.
+ */
+template<class A>
+struct action_is_simd_sampler {
+  static const bool value = A::IS_SIMD_SAMPLER && !A::IS_MATRIX &&
+      !is_common_var<typename A::target_type>::value;
+};
+
 /**
  * Start of action in action type list (cumulative sum of the sizes of
  * all preceding actions).
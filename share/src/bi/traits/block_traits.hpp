@@ -58,6 +58,35 @@ struct block_size<empty_typelist> {
   static const int value = 0;
 };
 
+/**
+ * Number of particle-invariant terms of block, summed over all elements of
+ * all actions.
+ *
+ * @ingroup model_low
+ *
+ * @tparam S Action type list.
+ */
+template<class S>
+struct block_common_size {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+
+  static const int value = action_size<front>::value*
+      action_common_size<front>::value + block_common_size<pop_front>::value;
+};
+
+/**
+ * @internal
+ *
+ * Base case of block_common_size.
+ *
+ * @ingroup model_low
+ */
+template<>
+struct block_common_size<empty_typelist> {
+  static const int value = 0;
+};
+
 /**
  * Does block contain a particular action?
  *
@@ -122,6 +151,30 @@ struct block_is_matrix<empty_typelist> {
   static const bool value = true;
 };
 
+/**
+ * Can all actions of block sample a pack of particles at once, with
+ * RngSSE?
+ */
+template<class S>
+struct block_is_simd_sampler {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+
+  static const bool value = action_is_simd_sampler<front>::value && block_is_simd_sampler<pop_front>::value;
+};
+
+/**
+ * @internal
+ *
+ * Base case of block_is_simd_sampler.
+ *
+ * @ingroup model_low
+ */
+template<>
+struct block_is_simd_sampler<empty_typelist> {
+  static const bool value = true;
+};
+
 }
 
 #endif
@@ -0,0 +1,113 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_UPDATER_FUSEDSAMPLER_HPP
+#define BI_UPDATER_FUSEDSAMPLER_HPP
+
+#include "../state/ScheduleIterator.hpp"
+#include "../state/Mask.hpp"
+
+namespace bi {
+/**
+ * Fused sampler, running the transition and observation blocks of the
+ * model one particle at a time.
+ *
+ * @ingroup method_updater
+ *
+ * @tparam B Model type.
+ *
+ * Rather than one pass over all particles for each block and each step of
+ * the schedule, each particle is propagated through all steps, and
+ * weighted, before moving to the next, so that its state remains in cache
+ * throughout. Available only when @c B::FUSED is true, which the model
+ * sets when its transition and observation blocks can be evaluated for a
+ * single particle on host.
+ */
+template<class B>
+class FusedSampler {
+public:
+  /**
+   * Sample state over steps of the schedule.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of steps.
+   * @param last End of steps.
+   * @param[in,out] s State.
+   */
+  static void samples(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, State<B,ON_HOST>& s);
+
+  /**
+   * Sample state over steps of the schedule, then evaluate observation
+   * log-density at the end.
+   *
+   * @tparam V1 Vector type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of steps.
+   * @param last End of steps.
+   * @param[in,out] s State.
+   * @param mask Observation mask.
+   * @param[in,out] lp Log-density. On output, contains the updated
+   * log-density (by addition).
+   */
+  template<class V1>
+  static void samples(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, State<B,ON_HOST>& s,
+      const Mask<ON_HOST>& mask, V1 lp);
+
+  #ifdef __CUDACC__
+  /**
+   * @copydoc samples(Random&, const ScheduleIterator, const ScheduleIterator, State<B,ON_HOST>&)
+   */
+  static void samples(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, State<B,ON_DEVICE>& s);
+
+  /**
+   * @copydoc samples(Random&, const ScheduleIterator, const ScheduleIterator, State<B,ON_HOST>&, const Mask<ON_HOST>&, V1)
+   */
+  template<class V1>
+  static void samples(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, State<B,ON_DEVICE>& s,
+      const Mask<ON_HOST>& mask, V1 lp);
+  #endif
+};
+}
+
+#include "../host/updater/FusedSamplerHost.hpp"
+
+template<class B>
+void bi::FusedSampler<B>::samples(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, State<B,ON_HOST>& s) {
+  FusedSamplerHost<B>::samples(rng, first, last, s);
+}
+
+template<class B>
+template<class V1>
+void bi::FusedSampler<B>::samples(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, State<B,ON_HOST>& s,
+    const Mask<ON_HOST>& mask, V1 lp) {
+  FusedSamplerHost<B>::samples(rng, first, last, s, mask, lp);
+}
+
+#ifdef __CUDACC__
+template<class B>
+void bi::FusedSampler<B>::samples(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, State<B,ON_DEVICE>& s) {
+  BI_ERROR_MSG(false, "Fused sampling is not supported on device");
+}
+
+template<class B>
+template<class V1>
+void bi::FusedSampler<B>::samples(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, State<B,ON_DEVICE>& s,
+    const Mask<ON_HOST>& mask, V1 lp) {
+  BI_ERROR_MSG(false, "Fused sampling is not supported on device");
+}
+#endif
+
+#endif
@@ -51,6 +51,37 @@ public:
   static void logDensities(State<B,ON_HOST>& s, const int p,
       const Mask<ON_HOST>& mask, V1 lp);
 
+  /**
+   * Evaluate particle-invariant terms of log-density, for use by
+   * logDensities() for single trajectories.
+   *
+   * @param s State.
+   * @param mask Sparsity mask.
+   * @param[out] c Particle-invariant terms, of length
+   * <tt>block_common_size<S>::value</tt>.
+   */
+  static void commons(State<B,ON_HOST>& s, const Mask<ON_HOST>& mask,
+      real* c);
+
+  /**
+   * Evaluate log-density for single trajectory, reusing particle-invariant
+   * terms.
+   *
+   * @tparam V1 Vector type.
+   *
+   * @param[in,out] s State.
+   * @param p Trajectory index.
+   * @param mask Sparsity mask.
+   * @param c Particle-invariant terms, as output by commons() with the same
+   * mask.
+   * @param[in,out] lp Log-density.
+   *
+   * The log density is <i>added to</i> @p lp.
+   */
+  template<class V1>
+  static void logDensities(State<B,ON_HOST>& s, const int p,
+      const Mask<ON_HOST>& mask, const real* c, V1 lp);
+
   #ifdef __CUDACC__
   /**
    * Evaluate log-density.
@@ -117,6 +148,19 @@ void bi::SparseStaticLogDensity<B,S>::logDensities(State<B,ON_HOST>& s,
   SparseStaticLogDensityHost<B,S>::logDensities(s, p, mask, lp);
 }
 
+template<class B, class S>
+void bi::SparseStaticLogDensity<B,S>::commons(State<B,ON_HOST>& s,
+    const Mask<ON_HOST>& mask, real* c) {
+  SparseStaticLogDensityHost<B,S>::commons(s, mask, c);
+}
+
+template<class B, class S>
+template<class V1>
+void bi::SparseStaticLogDensity<B,S>::logDensities(State<B,ON_HOST>& s,
+    const int p, const Mask<ON_HOST>& mask, const real* c, V1 lp) {
+  SparseStaticLogDensityHost<B,S>::logDensities(s, p, mask, c, lp);
+}
+
 #ifdef __CUDACC__
 template<class B, class S>
 template<class V1>
@@ -0,0 +1,6 @@
+use Test::More tests => 2;
+
+my $cmd = 'script/libbi sample @test.conf --target posterior --with-early-reject --dry-build --dry-run';
+
+unlike(`$cmd --filter bootstrap 2>&1`, qr/--with-early-reject has been set to 0/, 'early rejection with bootstrap filter');
+like(`$cmd --filter bridge 2>&1`, qr/--with-early-reject has been set to 0/, 'no early rejection with bridge filter');
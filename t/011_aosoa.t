@@ -0,0 +1,9 @@
+use Test::More tests => 2;
+
+my $cmd = 'script/libbi test_ode @test_ode.conf';
+
+my @default = grep { /checksum/ } `$cmd 2>&1`;
+my @aosoa = grep { /checksum/ } `$cmd --enable-aosoa 2>&1`;
+
+is(scalar(@default), 3, 'test_ode');
+is_deeply(\@aosoa, \@default, 'same results with --enable-aosoa');